@@ -0,0 +1,201 @@
+// End-to-end load test: replays synthetic interactions against persona
+// shards sharing one analysis executor and reports throughput and latency
+// percentiles as JSON.
+//
+//   interaction_replay [--shards N] [--clients N] [--interactions N]
+//                      [--memory-every N] [--threads N] [--seed N] [--out FILE]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "synthetic_data.hpp"
+#include "../metrics.hpp"
+#include "../task_executor.hpp"
+
+namespace shandris::cognitive::bench {
+namespace {
+
+struct ReplayConfig {
+    size_t shards = 4;
+    size_t clients = 4;
+    size_t interactions = 20000;
+    size_t memory_every = 4;    // every Nth request also stores a memory
+    size_t threads = 0;         // analysis executor; 0 uses the hardware concurrency
+    uint32_t seed = 42;
+    std::string out;
+};
+
+bool ParseArgs(int argc, char** argv, ReplayConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--shards") config.shards = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (arg == "--clients") config.clients = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+        else if (arg == "--interactions") config.interactions = std::strtoul(value, nullptr, 10);
+        else if (arg == "--memory-every") config.memory_every = std::strtoul(value, nullptr, 10);
+        else if (arg == "--threads") config.threads = std::strtoul(value, nullptr, 10);
+        else if (arg == "--seed") config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--out") config.out = value;
+        else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nearest-rank percentile of sorted samples, in microseconds
+double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+nlohmann::json Summarize(std::vector<double>& latencies, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0.0;
+    for (double latency : latencies) total += latency;
+    return {
+        {"count", latencies.size()},
+        {"throughput_per_sec", seconds > 0.0 ? latencies.size() / seconds : 0.0},
+        {"mean_us", latencies.empty() ? 0.0 : total / latencies.size()},
+        {"p50_us", Percentile(latencies, 50)},
+        {"p90_us", Percentile(latencies, 90)},
+        {"p99_us", Percentile(latencies, 99)},
+        {"max_us", latencies.empty() ? 0.0 : latencies.back()}
+    };
+}
+
+int Run(const ReplayConfig& config) {
+    using Clock = std::chrono::steady_clock;
+
+    // One system per shard with the same persona, as PersonaRuntime hosts them
+    auto executor = std::make_shared<WorkStealingExecutor>(config.threads);
+    std::vector<std::shared_ptr<PersonaSystem>> shards;
+    for (size_t s = 0; s < config.shards; ++s) {
+        auto shard = std::make_shared<PersonaSystem>(executor);
+        if (!shard->SwitchPersona("sapphic_teaser", "replay")) {
+            std::cerr << "could not activate the replay persona" << std::endl;
+            return 1;
+        }
+        shards.push_back(std::move(shard));
+    }
+
+    SyntheticConfig data;
+    data.memories = std::max<size_t>(config.interactions / std::max<size_t>(config.memory_every, 1), 1);
+    data.seed = config.seed;
+    const auto memories = MakePersonaMemories(data);
+    const auto interactions = MakeInteractions(config.interactions, config.seed);
+
+    // Each client replays its own slice and keeps its own latency log
+    std::vector<std::vector<double>> respondLatencies(config.clients);
+    std::vector<std::vector<double>> memoryLatencies(config.clients);
+    std::atomic<size_t> next{0};
+    auto client = [&](size_t c) {
+        auto micros = [](Clock::time_point start) {
+            return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        };
+        for (size_t i; (i = next.fetch_add(1)) < interactions.size();) {
+            auto& shard = *shards[i % shards.size()];
+            auto start = Clock::now();
+            shard.RespondToInteraction(interactions[i]);
+            respondLatencies[c].push_back(micros(start));
+
+            if (config.memory_every && i % config.memory_every == 0) {
+                start = Clock::now();
+                shard.AddMemory(memories[(i / config.memory_every) % memories.size()]);
+                memoryLatencies[c].push_back(micros(start));
+            }
+        }
+    };
+
+    const auto started = Clock::now();
+    std::vector<std::thread> clients;
+    for (size_t c = 0; c < config.clients; ++c) {
+        clients.emplace_back(client, c);
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    const auto foregroundDone = Clock::now();
+
+    // Background stages finish before the totals are taken
+    for (auto& shard : shards) {
+        shard->Sync();
+    }
+    const auto drained = Clock::now();
+
+    std::vector<double> respond, memory;
+    for (size_t c = 0; c < config.clients; ++c) {
+        respond.insert(respond.end(), respondLatencies[c].begin(), respondLatencies[c].end());
+        memory.insert(memory.end(), memoryLatencies[c].begin(), memoryLatencies[c].end());
+    }
+    const double foregroundSeconds = std::chrono::duration<double>(foregroundDone - started).count();
+    const double totalSeconds = std::chrono::duration<double>(drained - started).count();
+
+    PipelineStats analysis, persistence;
+    for (const auto& shard : shards) {
+        const auto a = shard->GetPipelineStats(PipelineStage::Analysis);
+        const auto p = shard->GetPipelineStats(PipelineStage::Persistence);
+        analysis.completed += a.completed;
+        analysis.coalesced += a.coalesced;
+        analysis.failed += a.failed;
+        persistence.completed += p.completed;
+        persistence.failed += p.failed;
+    }
+    const ExecutorStats executorStats = executor->Stats();
+
+    nlohmann::json report = {
+        {"benchmark", "interaction_replay"},
+        {"config", {
+            {"shards", config.shards},
+            {"clients", config.clients},
+            {"interactions", config.interactions},
+            {"memory_every", config.memory_every},
+            {"analysis_threads", executor->ThreadCount()},
+            {"seed", config.seed}
+        }},
+        {"foreground_seconds", foregroundSeconds},
+        {"total_seconds", totalSeconds},
+        {"respond_to_interaction", Summarize(respond, foregroundSeconds)},
+        {"add_memory", Summarize(memory, foregroundSeconds)},
+        {"end_to_end_throughput_per_sec", totalSeconds > 0.0 ? respond.size() / totalSeconds : 0.0},
+        {"pipeline", {
+            {"analysis_completed", analysis.completed},
+            {"analysis_coalesced", analysis.coalesced},
+            {"analysis_failed", analysis.failed},
+            {"persistence_completed", persistence.completed},
+            {"persistence_failed", persistence.failed}
+        }},
+        {"executor", {{"executed", executorStats.executed}, {"stolen", executorStats.stolen}}},
+        {"metrics", MetricsRegistry::Global().Snapshot()}
+    };
+
+    if (config.out.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream(config.out) << report.dump(2) << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
+} // namespace shandris::cognitive::bench
+
+int main(int argc, char** argv) {
+    shandris::cognitive::bench::ReplayConfig config;
+    if (!shandris::cognitive::bench::ParseArgs(argc, argv, config)) {
+        return 2;
+    }
+    return shandris::cognitive::bench::Run(config);
+}
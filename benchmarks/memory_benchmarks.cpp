@@ -0,0 +1,261 @@
+#include <benchmark/benchmark.h>
+#include "synthetic_data.hpp"
+#include "../emotion_schema.hpp"
+#include "../memory_clustering.hpp"
+#include "../memory_similarity.hpp"
+#include "../personality_history.hpp"
+#include "../trait_trends.hpp"
+
+namespace shandris::cognitive::bench {
+namespace {
+
+// Arguments: {memories, traits}
+void MemoryShapes(benchmark::internal::Benchmark* b) {
+    for (int64_t memories : {1000, 10000, 50000}) {
+        for (int64_t traits : {16, 128}) {
+            b->Args({memories, traits});
+        }
+    }
+}
+
+SyntheticConfig ConfigFor(const benchmark::State& state) {
+    SyntheticConfig config;
+    config.memories = static_cast<size_t>(state.range(0));
+    config.traits = static_cast<size_t>(state.range(1));
+    return config;
+}
+
+std::unique_ptr<MemoryManager> MakeManager(const std::vector<MemoryEvent>& memories) {
+    auto manager = std::make_unique<MemoryManager>();
+    if (!manager->Initialize()) return nullptr;
+    for (const auto& memory : memories) {
+        manager->SaveMemory(memory);
+    }
+    manager->FlushPendingWrites();
+    return manager;
+}
+
+// Incremental pass after a fraction of the working set changed
+void BM_UpdateMemoryAssociations(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+    manager->UpdateMemoryAssociations();
+
+    const size_t touched = std::max<size_t>(memories.size() / 100, 1);
+    size_t next = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t i = 0; i < touched; ++i) {
+            MemoryEvent memory = memories[next++ % memories.size()];
+            memory.emotional_weight = 1.0 - memory.emotional_weight;
+            manager->UpdateMemory(memory);
+        }
+        state.ResumeTiming();
+        manager->UpdateMemoryAssociations();
+    }
+    state.counters["touched"] = static_cast<double>(touched);
+    state.SetItemsProcessed(state.iterations() * touched);
+}
+BENCHMARK(BM_UpdateMemoryAssociations)->Apply(MemoryShapes)->Unit(benchmark::kMicrosecond);
+
+// Full feature build plus pair scoring, as a cold connection pass does it
+void BM_ScorePairs(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    std::vector<MemoryFeatures> features;
+    features.reserve(memories.size());
+    for (const auto& memory : memories) {
+        MemoryFeatures record;
+        for (const auto& [trait, _] : memory.trait_influences) {
+            record.traits.push_back(trait);
+        }
+        record.tags = memory.tags.ids();
+        record.emotional_weight = memory.emotional_weight;
+        features.push_back(std::move(record));
+    }
+    const SimilarityWeights weights{.shared_trait = 0.3, .shared_tag = 0.2};
+
+    for (auto _ : state) {
+        ScratchScope scratch;
+        size_t matches = 0;
+        SimilarityEngine::ScorePairs(features, weights, 0.5,
+            [&](size_t, size_t, double) { ++matches; });
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * memories.size());
+}
+BENCHMARK(BM_ScorePairs)->Apply(MemoryShapes)->Unit(benchmark::kMillisecond);
+
+void BM_UpdateMemoryIndex(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+
+    size_t next = 0;
+    for (auto _ : state) {
+        manager->UpdateMemoryIndex("bench", memories[next++ % memories.size()]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateMemoryIndex)->Apply(MemoryShapes);
+
+void BM_RecallRelevantMemories(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+    manager->UpdateMemoryIndex();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager->RecallRelevantMemories("rain library evening", 10));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecallRelevantMemories)->Apply(MemoryShapes)->Unit(benchmark::kMicrosecond);
+
+// Online placement of one changed memory, then the split/merge pass over
+// the clusters it touched
+void BM_ClusterUpsert(benchmark::State& state) {
+    auto memories = MakeStoredMemories(ConfigFor(state));
+    MemoryClusterIndex index;
+    for (const auto& memory : memories) {
+        index.Upsert(memory);
+    }
+    index.Maintain();
+
+    size_t next = 0;
+    for (auto _ : state) {
+        MemoryEvent& memory = memories[next++ % memories.size()];
+        memory.emotional_weight = 1.0 - memory.emotional_weight;
+        index.Upsert(memory);
+        index.Maintain();
+    }
+    state.counters["clusters"] = static_cast<double>(index.ClusterCount());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ClusterUpsert)->Apply(MemoryShapes);
+
+// Per-sample cost of the streaming trend statistics; argument is retention
+void BM_TraitTrendSample(benchmark::State& state) {
+    TraitTrendStream stream(static_cast<size_t>(state.range(0)));
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    TraitTrendAnalysis analysis;
+    for (auto _ : state) {
+        stream.Add(unit(rng));
+        stream.Fill(analysis);
+        benchmark::DoNotOptimize(analysis);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TraitTrendSample)->Arg(100)->Arg(1000)->Arg(10000);
+
+// One delta snapshot into a full history plus a read of every trait's
+// weighted average; argument is the trait count, with 1 in 10 changing
+void BM_PersonalitySnapshot(benchmark::State& state) {
+    const auto traits = static_cast<SymbolID>(state.range(0));
+    PersonalityHistory history;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto now = std::chrono::system_clock::now();
+    double sum = 0.0;
+    for (auto _ : state) {
+        PersonalityHistory::Snapshot snapshot;
+        now += std::chrono::hours(1);
+        snapshot.timestamp = now;
+        for (SymbolID trait = 0; trait < traits; ++trait) {
+            if (rng() % 10 == 0 || history.Size() == 0) {
+                snapshot.changes.emplace_back(trait, unit(rng));
+            }
+        }
+        history.Record(std::move(snapshot));
+        for (SymbolID trait = 0; trait < traits; ++trait) {
+            double average = 0.0;
+            history.WeightedAverage(trait, average);
+            sum += average;
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PersonalitySnapshot)->Arg(16)->Arg(128)->Arg(1024);
+
+void BM_EmotionStateBlend(benchmark::State& state) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    StateVector current;
+    StateVector weights;
+    StateVector gains;
+    for (size_t i = 0; i < current.SIZE; ++i) {
+        current.values[i] = unit(rng);
+        weights.values[i] = unit(rng) * 0.2;
+        gains.values[i] = i % 4 == 0 ? 0.1 : 0.0;
+    }
+    const StateVector target = StateVector::Filled(0.5);
+    for (auto _ : state) {
+        current = Lerp(current, target, weights);
+        current = AddCapped(current, gains, 0.7, 1.0);
+        current = DecayTowards(current, target, 0.99);
+        benchmark::DoNotOptimize(current);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EmotionStateBlend);
+
+void BM_AnalyzeTraitTrends(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+    const auto traits = MakeTraitNames(ConfigFor(state));
+    for (const auto& trait : traits) {
+        manager->UpdateTraitBaseline(trait, 0.1);
+    }
+
+    for (auto _ : state) {
+        manager->AnalyzeTraitTrends();
+    }
+    state.SetItemsProcessed(state.iterations() * traits.size());
+}
+BENCHMARK(BM_AnalyzeTraitTrends)->Apply(MemoryShapes)->Unit(benchmark::kMicrosecond);
+
+void BM_ProcessTraitInteractions(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+    const auto traits = MakeTraitNames(ConfigFor(state));
+
+    size_t next = 0;
+    for (auto _ : state) {
+        manager->ProcessTraitInteractions(traits[next++ % traits.size()]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProcessTraitInteractions)->Apply(MemoryShapes)->Unit(benchmark::kMicrosecond);
+
+// Steady-state prune pass after 1% of the working set changed: only due
+// memories and one refresh slice are scored
+void BM_PruneMemoriesBasedOnTraits(benchmark::State& state) {
+    const auto memories = MakeStoredMemories(ConfigFor(state));
+    auto manager = MakeManager(memories);
+    if (!manager) return state.SkipWithError("MemoryManager failed to initialize");
+    for (const auto& trait : MakeTraitNames(ConfigFor(state))) {
+        manager->UpdateTraitBaseline(trait, 0.1);
+    }
+    manager->PruneMemoriesBasedOnTraits();
+
+    const size_t touched = std::max<size_t>(memories.size() / 100, 1);
+    size_t next = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t i = 0; i < touched; ++i) {
+            manager->UpdateMemory(memories[next++ % memories.size()]);
+        }
+        state.ResumeTiming();
+        manager->PruneMemoriesBasedOnTraits();
+    }
+    state.counters["touched"] = static_cast<double>(touched);
+    state.SetItemsProcessed(state.iterations() * touched);
+}
+BENCHMARK(BM_PruneMemoriesBasedOnTraits)->Apply(MemoryShapes)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace shandris::cognitive::bench
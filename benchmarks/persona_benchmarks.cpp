@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+#include "synthetic_data.hpp"
+#include "shandris/persona.hpp"
+
+namespace shandris::cognitive::bench {
+namespace {
+
+// Arguments: {depth, rows, cols}
+void TensorShapes(benchmark::internal::Benchmark* b) {
+    b->Args({8, 16, 16})->Args({16, 64, 64})->Args({32, 128, 128});
+}
+
+void BM_SolvePersonalityPDE(benchmark::State& state) {
+    PersonaManager manager;
+    PersonalityField field;
+    field.FieldTensor.Resize(state.range(0), state.range(1), state.range(2));
+    FillRandom(field.FieldTensor, 1);
+
+    for (auto _ : state) {
+        manager.SolvePersonalityPDE(field, 0.01);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * field.FieldTensor.size());
+}
+BENCHMARK(BM_SolvePersonalityPDE)->Apply(TensorShapes)->Unit(benchmark::kMicrosecond);
+
+void BM_ProcessTensorEvolution(benchmark::State& state) {
+    PersonaManager manager;
+    Tensor3 tensor(state.range(0), state.range(1), state.range(2));
+    FillRandom(tensor, 2);
+    Tensor2 transformation(state.range(2), state.range(2), 1.0 / state.range(2));
+
+    for (auto _ : state) {
+        manager.ProcessTensorEvolution(tensor, transformation);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * tensor.size());
+}
+BENCHMARK(BM_ProcessTensorEvolution)->Apply(TensorShapes)->Unit(benchmark::kMicrosecond);
+
+// Arguments: {recorded events, latent dimension}
+void BM_FindSimilarEvents(benchmark::State& state) {
+    PersonaManager manager;
+    std::mt19937 rng(3);
+    const size_t dimension = static_cast<size_t>(state.range(1));
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        EventEmbedding event;
+        event.LatentVector = RandomVector(rng, dimension);
+        manager.RecordEvent(event);
+    }
+
+    EventEmbedding query;
+    std::vector<EventEmbedding> similar;
+    for (auto _ : state) {
+        state.PauseTiming();
+        query.LatentVector = RandomVector(rng, dimension);
+        state.ResumeTiming();
+        manager.FindSimilarEvents(query, similar);
+        benchmark::DoNotOptimize(similar.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindSimilarEvents)
+    ->Args({1000, 64})->Args({10000, 64})->Args({100000, 128})
+    ->Unit(benchmark::kMicrosecond);
+
+// Foreground cost only; the pipeline is drained outside the timed region
+void BM_PersonaSystemAddMemory(benchmark::State& state) {
+    SyntheticConfig config;
+    config.memories = 4096;
+    const auto memories = MakePersonaMemories(config);
+    PersonaSystem system;
+    system.SwitchPersona("sapphic_teaser", "benchmark");
+
+    size_t next = 0;
+    for (auto _ : state) {
+        system.AddMemory(memories[next++ % memories.size()]);
+        if (next % 256 == 0) {
+            state.PauseTiming();
+            system.Sync();
+            state.ResumeTiming();
+        }
+    }
+    system.Sync();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PersonaSystemAddMemory)->Unit(benchmark::kMicrosecond);
+
+// Argument: memories held by the active persona
+void BM_PersonaSystemRecall(benchmark::State& state) {
+    SyntheticConfig config;
+    config.memories = static_cast<size_t>(state.range(0));
+    PersonaSystem system;
+    system.SwitchPersona("sapphic_teaser", "benchmark");
+    for (const auto& memory : MakePersonaMemories(config)) {
+        system.AddMemory(memory);
+    }
+    system.Sync();
+
+    std::vector<const MemoryEvent*> results;
+    for (auto _ : state) {
+        system.RecallRelevantMemories("tag_3", 10, std::chrono::system_clock::now(), results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PersonaSystemRecall)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+std::vector<HistoricalInteraction> MakeHistory(size_t entries) {
+    SyntheticConfig config;
+    config.memories = entries;
+    auto memories = MakePersonaMemories(config);
+    auto interactions = MakeInteractions(entries, 5);
+    std::vector<HistoricalInteraction> history(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        history[i].interaction = std::move(interactions[i]);
+        history[i].memories.push_back(std::move(memories[i]));
+    }
+    return history;
+}
+
+// Argument: history entries, one interaction and one memory each. The
+// baseline replays them through the foreground calls, syncing at the end.
+void BM_PersonaSystemSequentialReplay(benchmark::State& state) {
+    const auto history = MakeHistory(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        PersonaSystem system;
+        system.SwitchPersona("sapphic_teaser", "benchmark");
+        for (const auto& entry : history) {
+            system.RespondToInteraction(entry.interaction);
+            for (const auto& memory : entry.memories) {
+                system.AddMemory(memory);
+            }
+        }
+        system.Sync();
+    }
+    state.SetItemsProcessed(state.iterations() * history.size());
+}
+BENCHMARK(BM_PersonaSystemSequentialReplay)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+// Arguments: {history entries, checkpoint interval}
+void BM_PersonaSystemIngestHistory(benchmark::State& state) {
+    const auto history = MakeHistory(static_cast<size_t>(state.range(0)));
+    IngestOptions options;
+    options.checkpoint_interval = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        PersonaSystem system;
+        system.SwitchPersona("sapphic_teaser", "benchmark");
+        system.IngestHistory(history, options);
+        system.Sync();
+    }
+    state.SetItemsProcessed(state.iterations() * history.size());
+}
+BENCHMARK(BM_PersonaSystemIngestHistory)
+    ->Args({1000, 0})->Args({10000, 0})->Args({10000, 1000})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace shandris::cognitive::bench
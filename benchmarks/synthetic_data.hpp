@@ -0,0 +1,157 @@
+#pragma once
+
+#include <any>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../memory.hpp"
+#include "../persona_system.hpp"
+#include "../tensor.hpp"
+
+namespace shandris::cognitive::bench {
+
+// Shape of a synthetic workload. Everything is derived from seed, so runs
+// with the same config see the same data.
+struct SyntheticConfig {
+    size_t memories = 1000;
+    size_t traits = 16;
+    size_t tags = 64;
+    size_t traits_per_memory = 3;
+    size_t tags_per_memory = 4;
+    size_t words_per_memory = 24;
+    uint32_t seed = 42;
+};
+
+inline std::vector<std::string> MakeNames(const std::string& prefix, size_t count) {
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back(prefix + std::to_string(i));
+    }
+    return names;
+}
+
+inline std::vector<std::string> MakeTraitNames(const SyntheticConfig& config) {
+    return MakeNames("trait_", config.traits);
+}
+
+// Content drawn from a small Zipf-like vocabulary, so text queries hit
+inline std::string MakeContent(std::mt19937& rng, size_t words) {
+    static const char* VOCABULARY[] = {
+        "she", "smiled", "remembered", "coffee", "rain", "library", "music", "laughed",
+        "quiet", "evening", "letter", "garden", "trust", "promise", "window", "story",
+        "warm", "nervous", "dance", "city", "train", "secret", "poem", "morning"
+    };
+    constexpr size_t VOCABULARY_SIZE = sizeof(VOCABULARY) / sizeof(VOCABULARY[0]);
+    std::geometric_distribution<size_t> pick(0.15);
+
+    std::string content;
+    for (size_t w = 0; w < words; ++w) {
+        if (w) content += ' ';
+        content += VOCABULARY[std::min(pick(rng), VOCABULARY_SIZE - 1)];
+    }
+    return content;
+}
+
+// Working-set memories in the MemoryManager layout
+inline std::vector<MemoryEvent> MakeStoredMemories(const SyntheticConfig& config) {
+    std::mt19937 rng(config.seed);
+    std::uniform_int_distribution<size_t> trait(0, config.traits - 1);
+    std::uniform_int_distribution<size_t> tag(0, config.tags - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto now = std::chrono::system_clock::now();
+
+    std::vector<MemoryEvent> memories;
+    memories.reserve(config.memories);
+    for (size_t i = 0; i < config.memories; ++i) {
+        MemoryEvent memory;
+        memory.id = "memory_" + std::to_string(i);
+        memory.content = MakeContent(rng, config.words_per_memory);
+        memory.context = "bench";
+        memory.importance = unit(rng);
+        memory.emotional_weight = unit(rng);
+        for (size_t t = 0; t < config.traits_per_memory; ++t) {
+            memory.trait_influences[InternTrait("trait_" + std::to_string(trait(rng)))] = unit(rng);
+        }
+        for (size_t t = 0; t < config.tags_per_memory; ++t) {
+            memory.tags.insert("tag_" + std::to_string(tag(rng)));
+        }
+        memory.created_at = now - std::chrono::hours(i % 720);
+        memory.updated_at = memory.created_at;
+        memories.push_back(std::move(memory));
+    }
+    return memories;
+}
+
+// Memories in the layout PersonaSystem::AddMemory consumes
+inline std::vector<MemoryEvent> MakePersonaMemories(const SyntheticConfig& config) {
+    std::mt19937 rng(config.seed);
+    std::uniform_int_distribution<size_t> trait(0, config.traits - 1);
+    std::uniform_int_distribution<size_t> tag(0, config.tags - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto now = std::chrono::system_clock::now();
+
+    std::vector<MemoryEvent> memories;
+    memories.reserve(config.memories);
+    for (size_t i = 0; i < config.memories; ++i) {
+        MemoryEvent memory;
+        memory.Type = "interaction";
+        memory.Content = MakeContent(rng, config.words_per_memory);
+        memory.Importance = unit(rng);
+        memory.EmotionalWeight = unit(rng);
+        for (size_t t = 0; t < config.traits_per_memory; ++t) {
+            memory.TraitInfluences["trait_" + std::to_string(trait(rng))] = unit(rng);
+        }
+        for (size_t t = 0; t < config.tags_per_memory; ++t) {
+            memory.Tags.push_back("tag_" + std::to_string(tag(rng)));
+        }
+        memory.Timestamp = now - std::chrono::hours(i % 720);
+        memories.push_back(std::move(memory));
+    }
+    return memories;
+}
+
+// Interactions exercising both branches of EvolvePersonality
+inline std::vector<std::shared_ptr<Interaction>> MakeInteractions(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::vector<std::shared_ptr<Interaction>> interactions;
+    interactions.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto interaction = std::make_shared<Interaction>();
+        interaction->Type = (i % 3 == 0) ? "conversation" : "reaction";
+        interaction->Data["emotional_reaction"] = unit(rng);
+        if (i % 4 == 0) {
+            interaction->Data["topic"] = std::string("sapphic");
+        }
+        interactions.push_back(std::move(interaction));
+    }
+    return interactions;
+}
+
+inline void FillRandom(Tensor3& tensor, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto [d0, d1, d2] = tensor.shape();
+    for (size_t i = 0; i < d0; ++i) {
+        for (size_t j = 0; j < d1; ++j) {
+            double* row = tensor.Row(i, j);
+            for (size_t k = 0; k < d2; ++k) row[k] = unit(rng);
+        }
+    }
+}
+
+inline std::vector<double> RandomVector(std::mt19937& rng, size_t dimension) {
+    std::normal_distribution<double> normal;
+    std::vector<double> vector(dimension);
+    for (double& value : vector) value = normal(rng);
+    return vector;
+}
+
+} // namespace shandris::cognitive::bench
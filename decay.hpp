@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace shandris {
+namespace cognitive {
+
+// Time-based decay evaluated in closed form. A value is stored as of its
+// last materialization and read as a function of the time since, so
+// nothing has to sweep it between reads.
+
+using DecayClock = std::chrono::system_clock;
+using DecayHours = std::ratio<3600>;
+using DecayDays = std::ratio<86400>;
+
+// Fractional Period units from from to to; zero if to is earlier
+template<typename Period>
+double Elapsed(DecayClock::time_point from, DecayClock::time_point to) {
+    return std::max(std::chrono::duration<double, Period>(to - from).count(), 0.0);
+}
+
+inline double ExponentialDecay(double value, double rate, double elapsed) {
+    return value * std::exp(-rate * elapsed);
+}
+
+// Moves towards target at rate per unit and stops there
+inline double LinearDecay(double value, double rate, double elapsed, double target = 0.0) {
+    const double step = rate * elapsed;
+    return value > target ? std::max(target, value - step) : std::min(target, value + step);
+}
+
+// Total accumulated by a rate that itself decays: the integral of
+// rate * exp(-decay * s) over [0, elapsed]
+inline double DecayedIntegral(double rate, double decay, double elapsed) {
+    if (decay <= 0.0) return rate * elapsed;
+    return rate * -std::expm1(-decay * elapsed) / decay;
+}
+
+// Units until an exponentially decaying value reaches threshold; infinity
+// if it never does
+inline double ExponentialCrossing(double value, double rate, double threshold) {
+    if (std::abs(value) <= std::abs(threshold)) return 0.0;
+    if (rate <= 0.0 || threshold == 0.0 || (value > 0.0) != (threshold > 0.0)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::log(value / threshold) / rate;
+}
+
+// Min-heap of per-key deadlines for threshold crossings, so a tick looks
+// only at what is due. Rescheduling leaves the old entry behind; PopDue
+// skips entries that no longer match their key's deadline.
+template<typename Key, typename Hash = std::hash<Key>>
+class DeadlineQueue {
+public:
+    using TimePoint = DecayClock::time_point;
+
+    void Schedule(const Key& key, TimePoint deadline) {
+        deadlines_[key] = deadline;
+        heap_.push({deadline, key});
+        if (heap_.size() > 2 * deadlines_.size() + COMPACT_SLACK) Compact();
+    }
+
+    void Cancel(const Key& key) { deadlines_.erase(key); }
+
+    void Clear() {
+        deadlines_.clear();
+        heap_ = {};
+    }
+
+    size_t Size() const { return deadlines_.size(); }
+    bool Empty() const { return deadlines_.empty(); }
+
+    // Earliest live deadline; TimePoint::max() when empty
+    TimePoint Next() {
+        DropStale();
+        return heap_.empty() ? TimePoint::max() : heap_.top().deadline;
+    }
+
+    // Unschedules the key with the earliest deadline, due or not; false
+    // when empty
+    bool PopFirst(Key& key) {
+        DropStale();
+        if (heap_.empty()) return false;
+        key = heap_.top().key;
+        heap_.pop();
+        deadlines_.erase(key);
+        return true;
+    }
+
+    // Calls fn(key) for every key due by now, earliest first, stopping after
+    // limit of them. Each key is unscheduled before fn runs, so fn may
+    // schedule it again.
+    template<typename Fn>
+    size_t PopDue(TimePoint now, Fn&& fn, size_t limit = std::numeric_limits<size_t>::max()) {
+        size_t popped = 0;
+        for (DropStale(); popped < limit && !heap_.empty() && heap_.top().deadline <= now; DropStale()) {
+            Key key = heap_.top().key;
+            heap_.pop();
+            deadlines_.erase(key);
+            fn(key);
+            ++popped;
+        }
+        return popped;
+    }
+
+private:
+    static constexpr size_t COMPACT_SLACK = 16;
+
+    struct Entry {
+        TimePoint deadline;
+        Key key;
+        bool operator>(const Entry& other) const { return deadline > other.deadline; }
+    };
+
+    bool Live(const Entry& entry) const {
+        auto it = deadlines_.find(entry.key);
+        return it != deadlines_.end() && it->second == entry.deadline;
+    }
+
+    void DropStale() {
+        while (!heap_.empty() && !Live(heap_.top())) heap_.pop();
+    }
+
+    void Compact() {
+        std::vector<Entry> live;
+        live.reserve(deadlines_.size());
+        for (const auto& [key, deadline] : deadlines_) {
+            live.push_back({deadline, key});
+        }
+        heap_ = Heap(std::greater<Entry>(), std::move(live));
+    }
+
+    using Heap = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>;
+    Heap heap_;
+    std::unordered_map<Key, TimePoint, Hash> deadlines_;
+};
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,47 @@
+#include "emotion_schema.hpp"
+#include "memory.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+// Fields in schema order
+constexpr std::array<double EmotionalState::*, DIMENSIONS<Emotion>> EMOTION_FIELDS = {
+    &EmotionalState::happiness, &EmotionalState::sadness, &EmotionalState::anger,
+    &EmotionalState::fear, &EmotionalState::surprise, &EmotionalState::disgust,
+    &EmotionalState::trust, &EmotionalState::anticipation
+};
+
+constexpr std::array<double SapphicTraits::*, DIMENSIONS<SapphicTrait>> TRAIT_FIELDS = {
+    &SapphicTraits::seductiveness, &SapphicTraits::intellectuality, &SapphicTraits::protectiveness,
+    &SapphicTraits::clinginess, &SapphicTraits::independence, &SapphicTraits::playfulness,
+    &SapphicTraits::sassiness, &SapphicTraits::emotional_depth, &SapphicTraits::confidence,
+    &SapphicTraits::sensitivity, &SapphicTraits::lesbian_identity, &SapphicTraits::feminine_attraction,
+    &SapphicTraits::sapphic_energy
+};
+
+} // namespace
+
+EmotionVector EmotionsOf(const EmotionalState& state) {
+    EmotionVector v;
+    for (size_t i = 0; i < v.SIZE; ++i) v.values[i] = state.*EMOTION_FIELDS[i];
+    return v;
+}
+
+void SetEmotions(EmotionalState& state, const EmotionVector& emotions) {
+    for (size_t i = 0; i < emotions.SIZE; ++i) state.*EMOTION_FIELDS[i] = emotions.values[i];
+}
+
+SapphicTraitVector TraitsOf(const SapphicTraits& traits) {
+    SapphicTraitVector v;
+    for (size_t i = 0; i < v.SIZE; ++i) v.values[i] = traits.*TRAIT_FIELDS[i];
+    return v;
+}
+
+void SetTraits(SapphicTraits& traits, const SapphicTraitVector& values) {
+    for (size_t i = 0; i < values.SIZE; ++i) traits.*TRAIT_FIELDS[i] = values.values[i];
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace shandris {
+namespace cognitive {
+
+struct EmotionalState;
+struct SapphicTraits;
+
+// Compile-time schemas for the fixed sets of named doubles: each dimension
+// is an enum index into a std::array, with its name in a constexpr table
+// for serialization. Blending, decay and distance run as fixed-width loops
+// over the array, which compile to straight-line vector code with no
+// lookups or branches.
+
+// EmotionalState in memory.hpp
+enum class Emotion : uint8_t {
+    Happiness, Sadness, Anger, Fear, Surprise, Disgust, Trust, Anticipation,
+    Count
+};
+
+// SapphicTraits, in memory.hpp and on personas
+enum class SapphicTrait : uint8_t {
+    Seductiveness, Intellectuality, Protectiveness, Clinginess, Independence,
+    Playfulness, Sassiness, EmotionalDepth, Confidence, Sensitivity,
+    LesbianIdentity, FeminineAttraction, SapphicEnergy,
+    Count
+};
+
+// The numeric dimensions of a persona's current emotional state
+enum class StateDimension : uint8_t {
+    Arousal, Mood, Energy, Flirtation, Intimacy, Playfulness, Confidence,
+    FemininePresence, SapphicConnection, EmotionalDepth, Vulnerability,
+    Empathy, Sensuality, Creativity, Intuition, Passion, Authenticity,
+    Count
+};
+
+template<typename Dimension>
+inline constexpr size_t DIMENSIONS = static_cast<size_t>(Dimension::Count);
+
+template<typename Dimension>
+struct SchemaNames;
+
+template<>
+struct SchemaNames<Emotion> {
+    static constexpr std::array<std::string_view, DIMENSIONS<Emotion>> NAMES = {
+        "happiness", "sadness", "anger", "fear", "surprise", "disgust", "trust", "anticipation"
+    };
+};
+
+template<>
+struct SchemaNames<SapphicTrait> {
+    static constexpr std::array<std::string_view, DIMENSIONS<SapphicTrait>> NAMES = {
+        "seductiveness", "intellectuality", "protectiveness", "clinginess", "independence",
+        "playfulness", "sassiness", "emotional_depth", "confidence", "sensitivity",
+        "lesbian_identity", "feminine_attraction", "sapphic_energy"
+    };
+};
+
+template<>
+struct SchemaNames<StateDimension> {
+    static constexpr std::array<std::string_view, DIMENSIONS<StateDimension>> NAMES = {
+        "arousal", "mood", "energy", "flirtation", "intimacy", "playfulness", "confidence",
+        "feminine_presence", "sapphic_connection", "emotional_depth", "vulnerability",
+        "empathy", "sensuality", "creativity", "intuition", "passion", "authenticity"
+    };
+};
+
+template<typename Dimension>
+constexpr std::string_view DimensionName(Dimension dimension) {
+    return SchemaNames<Dimension>::NAMES[static_cast<size_t>(dimension)];
+}
+
+namespace schema_detail {
+
+constexpr char Fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// ASCII case-insensitive, ignoring underscores: "FemininePresence" and
+// "feminine_presence" are the same dimension
+constexpr bool SameName(std::string_view a, std::string_view b) {
+    size_t i = 0;
+    size_t j = 0;
+    while (true) {
+        while (i < a.size() && a[i] == '_') ++i;
+        while (j < b.size() && b[j] == '_') ++j;
+        if (i == a.size() || j == b.size()) return i == a.size() && j == b.size();
+        if (Fold(a[i++]) != Fold(b[j++])) return false;
+    }
+}
+
+} // namespace schema_detail
+
+template<typename Dimension>
+constexpr bool FindDimension(std::string_view name, Dimension& dimension) {
+    const auto& names = SchemaNames<Dimension>::NAMES;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (schema_detail::SameName(names[i], name)) {
+            dimension = static_cast<Dimension>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Dimension>
+struct SchemaVector {
+    static constexpr size_t SIZE = DIMENSIONS<Dimension>;
+
+    std::array<double, SIZE> values{};
+
+    static constexpr SchemaVector Filled(double value) {
+        SchemaVector v;
+        v.values.fill(value);
+        return v;
+    }
+
+    constexpr double& operator[](Dimension dimension) { return values[static_cast<size_t>(dimension)]; }
+    constexpr double operator[](Dimension dimension) const { return values[static_cast<size_t>(dimension)]; }
+
+    constexpr bool operator==(const SchemaVector&) const = default;
+};
+
+using EmotionVector = SchemaVector<Emotion>;
+using SapphicTraitVector = SchemaVector<SapphicTrait>;
+using StateVector = SchemaVector<StateDimension>;
+
+// a + (b - a) * t
+template<typename Dimension>
+constexpr SchemaVector<Dimension> Lerp(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& b, double t) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) out.values[i] = a.values[i] * (1.0 - t) + b.values[i] * t;
+    return out;
+}
+
+// Per-dimension weights; a zero weight keeps a's value exactly
+template<typename Dimension>
+constexpr SchemaVector<Dimension> Lerp(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& b,
+                                       const SchemaVector<Dimension>& t) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) out.values[i] = a.values[i] * (1.0 - t.values[i]) + b.values[i] * t.values[i];
+    return out;
+}
+
+// a + b * scale
+template<typename Dimension>
+constexpr SchemaVector<Dimension> AddScaled(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& b,
+                                            double scale) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) out.values[i] = a.values[i] + b.values[i] * scale;
+    return out;
+}
+
+// a + gains * scale, capped at cap only where a gain applies; dimensions
+// without a gain are left as they are
+template<typename Dimension>
+constexpr SchemaVector<Dimension> AddCapped(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& gains,
+                                            double scale, double cap) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) {
+        const double raised = std::min(cap, a.values[i] + gains.values[i] * scale);
+        out.values[i] = gains.values[i] != 0.0 ? raised : a.values[i];
+    }
+    return out;
+}
+
+template<typename Dimension>
+constexpr SchemaVector<Dimension> Clamp(const SchemaVector<Dimension>& a, double low, double high) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) out.values[i] = std::clamp(a.values[i], low, high);
+    return out;
+}
+
+// Moves every dimension towards target, keeping factor of the gap
+template<typename Dimension>
+constexpr SchemaVector<Dimension> DecayTowards(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& target,
+                                               double factor) {
+    SchemaVector<Dimension> out;
+    for (size_t i = 0; i < out.SIZE; ++i) out.values[i] = target.values[i] + (a.values[i] - target.values[i]) * factor;
+    return out;
+}
+
+template<typename Dimension>
+constexpr double Dot(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.SIZE; ++i) sum += a.values[i] * b.values[i];
+    return sum;
+}
+
+template<typename Dimension>
+double Distance(const SchemaVector<Dimension>& a, const SchemaVector<Dimension>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.SIZE; ++i) {
+        const double d = a.values[i] - b.values[i];
+        sum += d * d;
+    }
+    return std::sqrt(sum);
+}
+
+// Objects keyed by the schema names; dimensions missing from the input keep
+// their current value
+template<typename Dimension>
+void to_json(nlohmann::json& j, const SchemaVector<Dimension>& v) {
+    j = nlohmann::json::object();
+    for (size_t i = 0; i < v.SIZE; ++i) {
+        j[std::string(SchemaNames<Dimension>::NAMES[i])] = v.values[i];
+    }
+}
+
+template<typename Dimension>
+void from_json(const nlohmann::json& j, SchemaVector<Dimension>& v) {
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        Dimension dimension;
+        if (FindDimension(it.key(), dimension)) {
+            v[dimension] = it.value().template get<double>();
+        }
+    }
+}
+
+// The memory-side structs as schema vectors and back
+EmotionVector EmotionsOf(const EmotionalState& state);
+void SetEmotions(EmotionalState& state, const EmotionVector& emotions);
+SapphicTraitVector TraitsOf(const SapphicTraits& traits);
+void SetTraits(SapphicTraits& traits, const SapphicTraitVector& values);
+
+} // namespace cognitive
+} // namespace shandris
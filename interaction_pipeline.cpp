@@ -0,0 +1,188 @@
+#include "interaction_pipeline.hpp"
+#include "metrics.hpp"
+#include "scratch_arena.hpp"
+#include <iostream>
+#include <stdexcept>
+
+namespace shandris::cognitive {
+
+namespace {
+
+const char* StageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Analysis: return "analysis";
+        case PipelineStage::Persistence: return "persistence";
+        default: return "unknown";
+    }
+}
+
+struct StageMetrics {
+    Histogram latency;
+    Counter failures;
+};
+
+const StageMetrics& MetricsFor(PipelineStage stage) {
+    static const auto METRICS = [] {
+        std::array<StageMetrics, static_cast<size_t>(PipelineStage::Count)> metrics;
+        auto& registry = MetricsRegistry::Global();
+        for (size_t i = 0; i < metrics.size(); ++i) {
+            const std::string labels = std::string("stage=\"") + StageName(static_cast<PipelineStage>(i)) + "\"";
+            metrics[i].latency = registry.GetHistogram("shandris_pipeline_job_seconds", labels,
+                                                       "Background pipeline job latency");
+            metrics[i].failures = registry.GetCounter("shandris_pipeline_job_failures_total", labels,
+                                                      "Background pipeline jobs that threw");
+        }
+        return metrics;
+    }();
+    return METRICS[static_cast<size_t>(stage)];
+}
+
+} // namespace
+
+InteractionPipeline::InteractionPipeline(size_t analysisCapacity, size_t persistenceCapacity) {
+    stages_[static_cast<size_t>(PipelineStage::Analysis)] = std::make_unique<Stage>(analysisCapacity);
+    stages_[static_cast<size_t>(PipelineStage::Persistence)] = std::make_unique<Stage>(persistenceCapacity);
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        stages_[i]->worker = std::thread(&InteractionPipeline::Run, this, static_cast<PipelineStage>(i));
+    }
+}
+
+InteractionPipeline::InteractionPipeline(WorkStealingExecutor& analysisExecutor,
+                                         size_t analysisCapacity, size_t persistenceCapacity) {
+    stages_[static_cast<size_t>(PipelineStage::Analysis)] = std::make_unique<Stage>(analysisCapacity);
+    stages_[static_cast<size_t>(PipelineStage::Persistence)] = std::make_unique<Stage>(persistenceCapacity);
+    stages_[static_cast<size_t>(PipelineStage::Analysis)]->strand = Strand::Create(analysisExecutor);
+    stages_[static_cast<size_t>(PipelineStage::Persistence)]->worker =
+        std::thread(&InteractionPipeline::Run, this, PipelineStage::Persistence);
+}
+
+InteractionPipeline::~InteractionPipeline() {
+    // Upstream first, so its last jobs can still reach persistence
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        Stage& stage = *stages_[i];
+        if (stage.strand) Drain(static_cast<PipelineStage>(i));
+        stage.queue.Close();
+        if (stage.worker.joinable()) stage.worker.join();
+    }
+}
+
+InteractionPipeline::Stage& InteractionPipeline::StageFor(PipelineStage stage) const {
+    if (stage >= PipelineStage::Count) {
+        throw std::out_of_range("InteractionPipeline: unknown stage");
+    }
+    return *stages_[static_cast<size_t>(stage)];
+}
+
+void InteractionPipeline::Enqueue(Stage& stage, PipelineStage id, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        ++stage.stats.submitted;
+    }
+    if (!stage.queue.Push(std::move(job))) {
+        // Closed while shutting down; count it so Drain cannot wait on it
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        ++stage.stats.completed;
+        ++stage.stats.failed;
+        stage.progress.notify_all();
+        std::cerr << "Dropping " << StageName(id) << " job after shutdown" << std::endl;
+        return;
+    }
+
+    // One strand task per job, so the strand runs them in queue order
+    if (stage.strand) {
+        stage.strand->Post([this, &stage, id] {
+            Job next;
+            if (stage.queue.TryPop(next)) RunJob(stage, id, next);
+        });
+    }
+}
+
+void InteractionPipeline::Submit(PipelineStage stage, Job job) {
+    Enqueue(StageFor(stage), stage, std::move(job));
+}
+
+void InteractionPipeline::Schedule(PipelineStage stage, const std::string& key, Job job) {
+    Stage& target = StageFor(stage);
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (!target.pending.insert(key).second) {
+            ++target.stats.coalesced;
+            return;
+        }
+    }
+
+    // The key is released as the job starts, so later state gets its own run
+    Enqueue(target, stage, [&target, key, job = std::move(job)] {
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            target.pending.erase(key);
+        }
+        job();
+    });
+}
+
+void InteractionPipeline::Drain(PipelineStage stage) {
+    Stage& target = StageFor(stage);
+    if (std::this_thread::get_id() == target.worker.get_id()) {
+        throw std::logic_error("InteractionPipeline::Drain called from its own stage");
+    }
+
+    std::unique_lock<std::mutex> lock(target.mutex);
+    const uint64_t submitted = target.stats.submitted;
+    target.progress.wait(lock, [&] { return target.stats.completed >= submitted; });
+}
+
+void InteractionPipeline::Drain() {
+    for (size_t i = 0; i < stages_.size(); ++i) {
+        Drain(static_cast<PipelineStage>(i));
+    }
+}
+
+void InteractionPipeline::SetErrorHandler(ErrorHandler handler) {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    onError_ = std::move(handler);
+}
+
+PipelineStats InteractionPipeline::Stats(PipelineStage stage) const {
+    Stage& target = StageFor(stage);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    PipelineStats stats = target.stats;
+    stats.depth = target.queue.Size();
+    return stats;
+}
+
+void InteractionPipeline::Run(PipelineStage id) {
+    Stage& stage = StageFor(id);
+    Job job;
+    while (stage.queue.Pop(job)) {
+        RunJob(stage, id, job);
+    }
+}
+
+void InteractionPipeline::RunJob(Stage& stage, PipelineStage id, Job& job) {
+    const StageMetrics& metrics = MetricsFor(id);
+    bool failed = false;
+    try {
+        ScopedTimer timer(metrics.latency);
+        ScratchScope scratch;
+        job();
+    } catch (const std::exception& e) {
+        failed = true;
+        metrics.failures.Add();
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (onError_) {
+            onError_(id, e);
+        } else {
+            std::cerr << "Error in " << StageName(id) << " stage: " << e.what() << std::endl;
+        }
+    }
+    job = nullptr;
+
+    // Last touch of the stage; Drain may destroy the pipeline once notified
+    std::lock_guard<std::mutex> lock(stage.mutex);
+    ++stage.stats.completed;
+    if (failed) ++stage.stats.failed;
+    stage.progress.notify_all();
+}
+
+} // namespace shandris::cognitive
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include "task_executor.hpp"
+
+namespace shandris::cognitive {
+
+// Fixed-capacity FIFO shared between threads. Push blocks while the queue
+// is full, so a producer that outruns its consumer is slowed to its pace.
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    // False once the queue is closed; the item is dropped
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+        items_.push_back(std::move(item));
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Never blocks; false if the queue is full or closed
+    bool TryPush(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_ || items_.size() >= capacity_) return false;
+        items_.push_back(std::move(item));
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Never blocks; false if the queue is empty
+    bool TryPop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.empty()) return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    // Blocks until an item arrives; false once closed and drained
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    // Wakes every waiter; queued items can still be popped
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    std::deque<T> items_;
+    const size_t capacity_;
+    bool closed_ = false;
+};
+
+// Background stages behind the interaction path, in dependency order:
+// analysis jobs may submit persistence jobs, never the reverse
+enum class PipelineStage : size_t {
+    Analysis,
+    Persistence,
+    Count
+};
+
+struct PipelineStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t coalesced = 0;  // Schedule calls absorbed by an already queued job
+    uint64_t failed = 0;
+    size_t depth = 0;        // jobs waiting right now
+};
+
+// One worker thread per stage, fed through a bounded queue; the analysis
+// stage can instead run as a strand over a shared executor, so many
+// pipelines share one pool. Jobs in a stage run one at a time in
+// submission order. Drain is the explicit consistency point: once it
+// returns every job submitted before the call has finished, including the
+// persistence writes analysis jobs made.
+class InteractionPipeline {
+public:
+    using Job = std::function<void()>;
+    using ErrorHandler = std::function<void(PipelineStage, const std::exception&)>;
+
+    static constexpr size_t DEFAULT_ANALYSIS_CAPACITY = 64;
+    static constexpr size_t DEFAULT_PERSISTENCE_CAPACITY = 1024;
+
+    explicit InteractionPipeline(size_t analysisCapacity = DEFAULT_ANALYSIS_CAPACITY,
+                                 size_t persistenceCapacity = DEFAULT_PERSISTENCE_CAPACITY);
+    // Analysis runs on analysisExecutor, which must outlive the pipeline
+    explicit InteractionPipeline(WorkStealingExecutor& analysisExecutor,
+                                 size_t analysisCapacity = DEFAULT_ANALYSIS_CAPACITY,
+                                 size_t persistenceCapacity = DEFAULT_PERSISTENCE_CAPACITY);
+    // Runs everything still queued, then joins the workers
+    ~InteractionPipeline();
+
+    InteractionPipeline(const InteractionPipeline&) = delete;
+    InteractionPipeline& operator=(const InteractionPipeline&) = delete;
+
+    // Blocks while the stage's queue is full
+    void Submit(PipelineStage stage, Job job);
+
+    // Like Submit, but skipped while a job with the same key is still
+    // waiting, for recomputations where only the latest state matters
+    void Schedule(PipelineStage stage, const std::string& key, Job job);
+
+    // Must not be called from a job, or while holding anything a job takes
+    void Drain(PipelineStage stage);
+    void Drain();
+
+    // Job exceptions go here instead of ending the worker; defaults to stderr
+    void SetErrorHandler(ErrorHandler handler);
+
+    PipelineStats Stats(PipelineStage stage) const;
+
+private:
+    struct Stage {
+        explicit Stage(size_t capacity) : queue(capacity) {}
+
+        BoundedQueue<Job> queue;
+        std::thread worker;             // unless strand is set
+        std::shared_ptr<Strand> strand;
+        mutable std::mutex mutex;
+        std::condition_variable progress;
+        std::unordered_set<std::string> pending;  // keys of scheduled jobs not yet started
+        PipelineStats stats;
+    };
+
+    Stage& StageFor(PipelineStage stage) const;
+    void Enqueue(Stage& stage, PipelineStage id, Job job);
+    void Run(PipelineStage id);
+    void RunJob(Stage& stage, PipelineStage id, Job& job);
+
+    std::array<std::unique_ptr<Stage>, static_cast<size_t>(PipelineStage::Count)> stages_;
+    mutable std::mutex errorMutex_;
+    ErrorHandler onError_;
+};
+
+} // namespace shandris::cognitive
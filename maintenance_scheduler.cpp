@@ -0,0 +1,205 @@
+#include "maintenance_scheduler.hpp"
+#include "scratch_arena.hpp"
+#include <iostream>
+#include <stdexcept>
+
+namespace shandris::cognitive {
+
+namespace {
+
+enum class SliceState : uint8_t {
+    Idle,     // not pending when the slice started
+    Waiting,
+    Running,
+    Done
+};
+
+} // namespace
+
+MaintenanceScheduler::MaintenanceScheduler(WorkStealingExecutor& executor, size_t maxConcurrentPasses)
+    : executor_(executor), maxConcurrentPasses_(std::max<size_t>(maxConcurrentPasses, 1)) {
+}
+
+void MaintenanceScheduler::AddPass(MaintenancePass pass) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        throw std::logic_error("MaintenanceScheduler::AddPass: passes are running");
+    }
+    if (byName_.count(pass.name)) {
+        throw std::invalid_argument("MaintenanceScheduler::AddPass: duplicate pass " + pass.name);
+    }
+
+    Node node;
+    const size_t id = nodes_.size();
+    for (const auto& dependency : pass.after) {
+        auto it = byName_.find(dependency);
+        if (it == byName_.end()) {
+            throw std::invalid_argument("MaintenanceScheduler::AddPass: " + pass.name +
+                                        " depends on unregistered pass " + dependency);
+        }
+        node.dependencies.push_back(it->second);
+        nodes_[it->second].dependents.push_back(id);
+    }
+    const std::string labels = "pass=\"" + pass.name + "\"";
+    auto& registry = MetricsRegistry::Global();
+    node.latency = registry.GetHistogram("shandris_maintenance_pass_seconds", labels, "Maintenance pass latency");
+    node.failures = registry.GetCounter("shandris_maintenance_pass_failures_total", labels,
+                                        "Maintenance passes that threw");
+    byName_.emplace(pass.name, id);
+    node.pass = std::move(pass);
+    nodes_.push_back(std::move(node));
+}
+
+void MaintenanceScheduler::MarkPending(size_t node) {
+    if (nodes_[node].pending) {
+        ++stats_.coalesced;
+        return;
+    }
+    nodes_[node].pending = true;
+    for (size_t dependent : nodes_[node].dependents) {
+        if (!nodes_[dependent].pending) MarkPending(dependent);
+    }
+}
+
+void MaintenanceScheduler::Trigger(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byName_.find(name);
+    if (it == byName_.end()) {
+        throw std::invalid_argument("MaintenanceScheduler::Trigger: unknown pass " + name);
+    }
+    MarkPending(it->second);
+}
+
+void MaintenanceScheduler::TriggerAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& node : nodes_) {
+        node.pending = true;
+    }
+}
+
+bool MaintenanceScheduler::HasPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& node : nodes_) {
+        if (node.pending) return true;
+    }
+    return false;
+}
+
+void MaintenanceScheduler::SetMaxConcurrentPasses(size_t maxConcurrentPasses) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxConcurrentPasses_ = std::max<size_t>(maxConcurrentPasses, 1);
+}
+
+MaintenanceStats MaintenanceScheduler::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t MaintenanceScheduler::RunPending(std::chrono::steady_clock::duration budget) {
+    const bool bounded = budget != std::chrono::steady_clock::duration::max();
+    const auto deadline = bounded ? std::chrono::steady_clock::now() + budget
+                                  : std::chrono::steady_clock::time_point::max();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (running_) {
+        throw std::logic_error("MaintenanceScheduler::RunPending: already running");
+    }
+    running_ = true;
+
+    // The slice covers what is pending now; triggers from here on wait for the next one
+    std::vector<SliceState> states(nodes_.size(), SliceState::Idle);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].pending) states[i] = SliceState::Waiting;
+    }
+
+    size_t inFlight = 0;
+    size_t ran = 0;
+    const bool inline_ = executor_.InWorker();
+    auto canStart = [&](size_t i) {
+        for (size_t dependency : nodes_[i].dependencies) {
+            if (states[dependency] == SliceState::Waiting || states[dependency] == SliceState::Running) {
+                return false;
+            }
+        }
+        const MaintenancePass& pass = nodes_[i].pass;
+        for (size_t j = 0; j < nodes_.size(); ++j) {
+            if (states[j] != SliceState::Running) continue;
+            const MaintenancePass& other = nodes_[j].pass;
+            if ((pass.writes & (other.reads | other.writes)) || (pass.reads & other.writes)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto finish = [this, &states, &inFlight, &ran](size_t i, bool failed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        states[i] = SliceState::Done;
+        --inFlight;
+        ++ran;
+        ++stats_.runs;
+        if (failed) ++stats_.failures;
+        finished_.notify_all();
+    };
+    auto execute = [this, &finish](size_t i) {
+        // However the pass exits, or the slice would wait on it forever
+        struct Finish {
+            decltype(finish)& done;
+            size_t i;
+            bool failed = true;
+            ~Finish() { done(i, failed); }
+        } guard{finish, i};
+
+        try {
+            ScopedTimer timer(nodes_[i].latency);
+            ScratchScope scratch;
+            nodes_[i].pass.run();
+            guard.failed = false;
+        } catch (const std::exception& e) {
+            nodes_[i].failures.Add();
+            std::cerr << "Error in maintenance pass " << nodes_[i].pass.name << ": "
+                      << e.what() << std::endl;
+        } catch (...) {
+            nodes_[i].failures.Add();
+            std::cerr << "Error in maintenance pass " << nodes_[i].pass.name
+                      << ": unknown exception" << std::endl;
+        }
+    };
+
+    for (;;) {
+        // Registration order is topological, so one sweep finds every ready pass
+        bool ranInline = false;
+        if (std::chrono::steady_clock::now() < deadline) {
+            for (size_t i = 0; i < nodes_.size() && inFlight < maxConcurrentPasses_; ++i) {
+                if (states[i] != SliceState::Waiting || !canStart(i)) continue;
+
+                states[i] = SliceState::Running;
+                nodes_[i].pending = false;
+                ++inFlight;
+                if (inline_) {
+                    // One at a time, rechecking the deadline between passes
+                    lock.unlock();
+                    execute(i);
+                    lock.lock();
+                    ranInline = true;
+                    break;
+                }
+                executor_.Post([&execute, i] { execute(i); });
+            }
+        }
+        if (ranInline) continue;
+
+        // Nothing in flight means nothing more can start in this slice
+        if (inFlight == 0) break;
+        const size_t before = ran;
+        finished_.wait(lock, [&] { return ran != before; });
+    }
+
+    for (SliceState state : states) {
+        if (state == SliceState::Waiting) ++stats_.deferred;
+    }
+    running_ = false;
+    return ran;
+}
+
+} // namespace shandris::cognitive
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "metrics.hpp"
+#include "task_executor.hpp"
+
+namespace shandris::cognitive {
+
+// Bit set of the state a pass touches; the meaning of each bit is up to the
+// owner registering the passes
+using MaintenanceResources = uint32_t;
+
+struct MaintenancePass {
+    std::string name;
+    std::vector<std::string> after;   // passes that must finish first when both are pending
+    MaintenanceResources reads = 0;
+    MaintenanceResources writes = 0;
+    std::function<void()> run;
+};
+
+struct MaintenanceStats {
+    uint64_t runs = 0;
+    uint64_t failures = 0;
+    uint64_t coalesced = 0;  // triggers for a pass that was already pending
+    uint64_t deferred = 0;   // pending passes left for a later slice when the budget ran out
+};
+
+// Dependency-ordered maintenance over a shared executor. Triggering a pass
+// marks it and everything downstream of it pending; repeated triggers
+// coalesce. RunPending launches every pass whose pending dependencies have
+// finished and whose resources do not conflict with a running pass (any
+// write overlapping another pass's reads or writes), so independent passes
+// run side by side. A time budget bounds each slice: once it is spent no
+// new pass starts and the rest stay pending.
+class MaintenanceScheduler {
+public:
+    static constexpr size_t DEFAULT_MAX_CONCURRENT_PASSES = 4;
+
+    explicit MaintenanceScheduler(WorkStealingExecutor& executor,
+                                  size_t maxConcurrentPasses = DEFAULT_MAX_CONCURRENT_PASSES);
+
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    // Dependencies must already be registered, which keeps the graph acyclic
+    void AddPass(MaintenancePass pass);
+
+    void Trigger(const std::string& name);
+    void TriggerAll();
+    bool HasPending() const;
+
+    // Runs pending passes until none are left or the budget is spent, and
+    // returns how many ran. From a thread outside the executor the passes go
+    // to its workers and this waits for them; from one of its workers they
+    // run inline, one at a time, since waiting there could hold the only
+    // worker that would run them.
+    size_t RunPending(std::chrono::steady_clock::duration budget =
+                          std::chrono::steady_clock::duration::max());
+
+    // Caps passes in flight, leaving workers free for interactive work
+    void SetMaxConcurrentPasses(size_t maxConcurrentPasses);
+
+    MaintenanceStats Stats() const;
+
+private:
+    struct Node {
+        MaintenancePass pass;
+        std::vector<size_t> dependencies;
+        std::vector<size_t> dependents;
+        bool pending = false;
+        Histogram latency;
+        Counter failures;
+    };
+
+    void MarkPending(size_t node);
+
+    WorkStealingExecutor& executor_;
+    mutable std::mutex mutex_;
+    std::condition_variable finished_;
+    std::vector<Node> nodes_;  // registration order is a topological order
+    std::unordered_map<std::string, size_t> byName_;
+    size_t maxConcurrentPasses_;
+    bool running_ = false;
+    MaintenanceStats stats_;
+};
+
+// Runs fn(i) for every i in [0, count) on the executor. The caller takes
+// indices too and only waits for helpers that actually started, so it is
+// safe to call from inside an executor task.
+template<typename Fn>
+void ParallelFor(WorkStealingExecutor& executor, size_t count, Fn&& fn) {
+    if (count == 0) return;
+    const size_t helpers = std::min(count, executor.ThreadCount()) - 1;
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    struct Shared {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> active{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto shared = std::make_shared<Shared>();
+    auto* body = &fn;
+
+    auto work = [shared, body, count] {
+        try {
+            for (size_t i; (i = shared->next.fetch_add(1)) < count;) (*body)(i);
+        } catch (...) {
+            // Stop handing out indices; the first error is rethrown
+            shared->next.store(count);
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (!shared->error) shared->error = std::current_exception();
+        }
+    };
+    for (size_t h = 0; h < helpers; ++h) {
+        executor.Post([shared, work] {
+            // Registered before taking an index, so the caller waits for it
+            shared->active.fetch_add(1);
+            work();
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (shared->active.fetch_sub(1) == 1) shared->done.notify_all();
+        });
+    }
+    work();
+
+    // Late helpers find no index left and never touch fn
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->done.wait(lock, [&] { return shared->active.load() == 0; });
+    if (shared->error) std::rethrow_exception(shared->error);
+}
+
+} // namespace shandris::cognitive
@@ -1,5 +1,10 @@
 #include "memory.hpp"
 #include "database.hpp"
+#include "memory_similarity.hpp"
+#include "metrics.hpp"
+#include "scratch_arena.hpp"
+#include "prompt_matcher.hpp"
+#include "session_store.hpp"
 #include <algorithm>
 #include <cmath>
 #include <random>
@@ -10,9 +15,82 @@
 namespace shandris {
 namespace cognitive {
 
-MemoryManager::MemoryManager() {
+namespace {
+
+// Erase entries whose ID is not in sortedIDs, calling onErase for each
+template<typename Map, typename OnErase>
+void DropMissing(Map& entries, const std::vector<std::string>& sortedIDs, OnErase onErase) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!std::binary_search(sortedIDs.begin(), sortedIDs.end(), it->first)) {
+            onErase(it->first);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// State the maintenance passes read and write, for conflict checks
+constexpr MaintenanceResources RESOURCE_MEMORIES = 1u << 0;
+constexpr MaintenanceResources RESOURCE_CONNECTIONS = 1u << 1;  // association index and connections
+constexpr MaintenanceResources RESOURCE_PATTERNS = 1u << 2;
+constexpr MaintenanceResources RESOURCE_TRAIT_BASELINES = 1u << 3;
+constexpr MaintenanceResources RESOURCE_TRAIT_METRICS = 1u << 4;
+constexpr MaintenanceResources RESOURCE_TRAIT_TRENDS = 1u << 5;
+constexpr MaintenanceResources RESOURCE_EVOLUTION = 1u << 6;
+constexpr MaintenanceResources RESOURCE_INSIGHTS = 1u << 7;
+
+// fn(i) for every i, in parallel when an executor is available
+template<typename Fn>
+void ForEachIndex(WorkStealingExecutor* executor, size_t count, Fn&& fn) {
+    if (executor) {
+        ParallelFor(*executor, count, fn);
+    } else {
+        for (size_t i = 0; i < count; ++i) fn(i);
+    }
+}
+
+// Process-wide; with several managers the gauges hold the last one sampled
+struct ManagerMetrics {
+    Counter workingSetHits;
+    Counter cacheHits;
+    Counter misses;
+    Histogram loadQuery;
+    Gauge workingSet;
+    Gauge warm;
+    Gauge cached;
+    Gauge pendingWrites;
+    Gauge connections;
+    Gauge clusters;
+};
+
+const ManagerMetrics& Metrics() {
+    static const ManagerMetrics METRICS = [] {
+        auto& registry = MetricsRegistry::Global();
+        ManagerMetrics metrics;
+        metrics.workingSetHits = registry.GetCounter("shandris_memory_lookups_total", "result=\"working_set\"",
+                                                     "LoadMemory lookups by where they were served");
+        metrics.cacheHits = registry.GetCounter("shandris_memory_lookups_total", "result=\"cache\"");
+        metrics.misses = registry.GetCounter("shandris_memory_lookups_total", "result=\"database\"");
+        metrics.loadQuery = registry.GetHistogram("shandris_db_query_seconds", "query=\"load_memory\"",
+                                                  "Database read latency");
+        metrics.workingSet = registry.GetGauge("shandris_memory_tier_entries", "tier=\"working_set\"",
+                                               "Memories held per tier");
+        metrics.warm = registry.GetGauge("shandris_memory_tier_entries", "tier=\"warm\"");
+        metrics.cached = registry.GetGauge("shandris_memory_tier_entries", "tier=\"cache\"");
+        metrics.pendingWrites = registry.GetGauge("shandris_memory_tier_entries", "tier=\"pending_writes\"");
+        metrics.connections = registry.GetGauge("shandris_memory_connections", {}, "Memory connections after the last pass");
+        metrics.clusters = registry.GetGauge("shandris_memory_clusters", {}, "Memory clusters in the default context");
+        return metrics;
+    }();
+    return METRICS;
+}
+
+} // namespace
+
+MemoryManager::MemoryManager()
+    : memory_cache_(MAX_CACHE_BYTES, MAX_CACHE_SIZE, MemoryFootprint) {
     db_ = std::make_shared<database::Database>();
-    maxCacheSize_ = 1000;
 }
 
 MemoryManager::~MemoryManager() {
@@ -20,158 +98,247 @@ MemoryManager::~MemoryManager() {
 }
 
 bool MemoryManager::Initialize() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!db_->Initialize()) {
         return false;
     }
+    WriteBehindStore::Config config;
+    config.column_encoding = column_encoding_;
+    store_ = std::make_unique<WriteBehindStore>(db_, config);
     is_initialized_ = true;
     return true;
 }
 
+bool MemoryManager::FlushPendingWrites() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    return store_->Flush();
+}
+
+std::vector<WriteBehindStore::DeadLetter> MemoryManager::TakeDeadLetters() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return {};
+    return store_->TakeDeadLetters();
+}
+
+bool MemoryManager::FlushDueWrites() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    const bool flushed = store_->MaybeFlush();
+    RecordTierSizes();
+    return flushed;
+}
+
+void MemoryManager::RecordTierSizes() const {
+    if (!MetricsRegistry::Enabled()) return;
+    const auto& metrics = Metrics();
+    metrics.workingSet.Set(static_cast<double>(memories_.size()));
+    metrics.warm.Set(static_cast<double>(memory_tiers_.WarmSize()));
+    metrics.cached.Set(static_cast<double>(memory_cache_.Size()));
+    metrics.pendingWrites.Set(static_cast<double>(store_->PendingCount()));
+}
+
 bool MemoryManager::SaveMemory(const MemoryEvent& memory) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return false;
     
-    std::string query = "INSERT INTO memories (id, content, context, importance, emotional_weight, trait_influences, tags, created_at, updated_at) "
-                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    
-    std::vector<std::string> params = {
-        memory.id,
-        memory.content,
-        memory.context,
-        std::to_string(memory.importance),
-        std::to_string(memory.emotional_weight),
-        nlohmann::json(memory.trait_influences).dump(),
-        nlohmann::json(memory.tags).dump(),
-        std::to_string(std::chrono::system_clock::to_time_t(memory.created_at)),
-        std::to_string(std::chrono::system_clock::to_time_t(memory.updated_at))
-    };
+    // Stamped as written now, which is what WarmStart replays by
+    MemoryEvent stamped = memory;
+    stamped.updated_at = std::chrono::system_clock::now();
     
-    if (!db_->ExecuteQueryWithParams(query, params)) {
-        return false;
-    }
+    // Queued; flushed in batches by the store
+    store_->UpsertMemory(stamped);
     
-    // Update cache
+    // Update cache; the working set now owns this memory
+    AdmitMemory(stamped);
+    TriggerMemoryPasses();
+    
+    return true;
+}
+
+void MemoryManager::AdmitMemory(const MemoryEvent& memory) {
+    if (loading_) load_touched_.insert(memory.id);
+    ++memory_writes_;
     memories_[memory.id] = memory;
+    memory_cache_.Erase(memory.id);
+    association_index_.Upsert(memory);
+    trait_aggregates_.Upsert(memory);
+    text_index_.Upsert(memory);
     UpdateMemoryIndex("default", memory);
     UpdateMemoryCluster("default", memory);
-    
-    return true;
+    const auto now = std::chrono::system_clock::now();
+    memory_tiers_.Hot(memory.id, TraitRelevance(memory.trait_influences, memory.emotional_weight,
+                                                memory.created_at, now).Crossing(MemoryTiers::DEMOTE_THRESHOLD));
+    RecordTierSizes();
 }
 
 bool MemoryManager::LoadMemory(const std::string& id, MemoryEvent& memory) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return false;
     
-    // Check cache first
-    auto it = memories_.find(id);
-    if (it != memories_.end()) {
-        memory = it->second;
-        return true;
-    }
-    
-    std::string query = "SELECT * FROM memories WHERE id = ?";
-    auto result = db_->ExecuteQueryWithResultAndParams(query, {id});
+    // Check the working set, then the cache
+    auto held = [&] {
+        auto it = memories_.find(id);
+        if (it != memories_.end()) {
+            Metrics().workingSetHits.Add();
+            memory = it->second;
+            return true;
+        }
+        if (const MemoryEvent* cached = memory_cache_.Get(id)) {
+            Metrics().cacheHits.Add();
+            memory = *cached;
+            return true;
+        }
+        return false;
+    };
+    if (held()) return true;
+    Metrics().misses.Add();
     
-    if (result.empty()) {
+    // Queued writes must land before reading back
+    if (!store_->Flush()) {
         return false;
     }
     
-    memory.id = result[0]["id"];
-    memory.content = result[0]["content"];
-    memory.context = result[0]["context"];
-    memory.importance = std::stod(result[0]["importance"]);
-    memory.emotional_weight = std::stod(result[0]["emotional_weight"]);
-    memory.trait_influences = nlohmann::json::parse(result[0]["trait_influences"]).get<std::map<std::string, double>>();
-    memory.tags = nlohmann::json::parse(result[0]["tags"]).get<std::set<std::string>>();
-    memory.created_at = std::chrono::system_clock::from_time_t(std::stoll(result[0]["created_at"]));
-    memory.updated_at = std::chrono::system_clock::from_time_t(std::stoll(result[0]["updated_at"]));
+    // The read runs unlocked, so other calls go on while it waits on the database
+    const uint64_t writes = memory_writes_;
+    lock.unlock();
+    
+    // The same columns as the bulk loader, read as bytes where they may be BLOBs
+    auto result = db_->Query(
+        "SELECT id, content, context, importance, emotional_weight, trait_influences, tags, "
+        "created_at, updated_at FROM memories WHERE id = ?", {id});
+    const bool found = [&] {
+        ScopedTimer timer(Metrics().loadQuery);
+        return result->Next();
+    }();
+    
+    MemoryEvent loaded;
+    if (found) {
+        loaded.id = result->GetString(0);
+        loaded.content = result->GetString(1);
+        loaded.context = result->GetString(2);
+        loaded.importance = result->GetDouble(3);
+        loaded.emotional_weight = result->GetDouble(4);
+        loaded.trait_influences = codec::DecodeTraitInfluences(result->GetBlob(5));
+        loaded.tags = codec::DecodeTags(result->GetBlob(6));
+        loaded.created_at = std::chrono::system_clock::from_time_t(result->GetInt64(7));
+        loaded.updated_at = std::chrono::system_clock::from_time_t(result->GetInt64(8));
+    }
+    result.reset();
+    
+    // Whatever was written or loaded meanwhile is at least as new as the read
+    lock.lock();
+    if (held()) return true;
+    if (!found) {
+        return false;
+    }
+    memory = std::move(loaded);
+    // A write raced the read, maybe deleting this memory; serve the read
+    // but keep it out of the tiers
+    if (memory_writes_ != writes) {
+        return true;
+    }
     
-    // Update cache
-    memories_[id] = memory;
+    // A warm memory in use again goes back to the working set; other cold
+    // reads go to the bounded cache, not the working set
+    if (memory_tiers_.FindWarm(id)) {
+        AdmitMemory(memory);
+    } else {
+        memory_cache_.Put(id, memory);
+        RecordTierSizes();
+    }
     
     return true;
 }
 
 bool MemoryManager::UpdateMemory(const MemoryEvent& memory) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return false;
+    if (!ApplyUpdate(memory)) return false;
+    TriggerMemoryPasses();
+    return true;
+}
+
+bool MemoryManager::ApplyUpdate(const MemoryEvent& memory) {
+    // An update never creates the memory
+    const auto createdAt = StoredCreatedAt(memory.id);
+    if (!createdAt) return false;
     
-    std::string query = "UPDATE memories SET content = ?, context = ?, importance = ?, emotional_weight = ?, "
-                       "trait_influences = ?, tags = ?, updated_at = ? WHERE id = ?";
-    
-    std::vector<std::string> params = {
-        memory.content,
-        memory.context,
-        std::to_string(memory.importance),
-        std::to_string(memory.emotional_weight),
-        nlohmann::json(memory.trait_influences).dump(),
-        nlohmann::json(memory.tags).dump(),
-        std::to_string(std::chrono::system_clock::to_time_t(memory.updated_at)),
-        memory.id
-    };
+    // created_at stays as stored; updated_at is when this write happened,
+    // so WarmStart replays it over an older snapshot
+    MemoryEvent updated = memory;
+    updated.created_at = *createdAt;
+    updated.updated_at = std::chrono::system_clock::now();
     
-    if (!db_->ExecuteQueryWithParams(query, params)) {
-        return false;
-    }
+    // Coalesces with any queued write for this ID
+    if (!store_->UpdateMemory(updated)) return false;
     
-    // Update cache
-    memories_[memory.id] = memory;
-    UpdateMemoryIndex("default", memory);
-    UpdateMemoryCluster("default", memory);
+    // Update cache; the working set now owns this memory
+    AdmitMemory(updated);
     
     return true;
 }
 
+std::optional<std::chrono::system_clock::time_point> MemoryManager::StoredCreatedAt(const std::string& id) {
+    const auto pending = store_->PendingMemory(id);
+    if (pending == WriteBehindStore::PendingWrite::Delete) return std::nullopt;
+    
+    auto it = memories_.find(id);
+    if (it != memories_.end()) return it->second.created_at;
+    if (const WarmMemory* warm = memory_tiers_.FindWarm(id)) return warm->created_at;
+    if (const MemoryEvent* cached = memory_cache_.Get(id)) return cached->created_at;
+    
+    // Queued writes must land before reading back
+    if (pending != WriteBehindStore::PendingWrite::None && !store_->Flush()) return std::nullopt;
+    auto result = db_->ExecuteQueryWithResultAndParams("SELECT created_at FROM memories WHERE id = ?", {id});
+    if (result.empty()) return std::nullopt;
+    return std::chrono::system_clock::from_time_t(std::stoll(result[0]["created_at"]));
+}
+
 bool MemoryManager::DeleteMemory(const std::string& id) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return false;
     
-    std::string query = "DELETE FROM memories WHERE id = ?";
-    if (!db_->ExecuteQueryWithParams(query, {id})) {
-        return false;
-    }
+    store_->DeleteMemory(id);
+    if (loading_) load_touched_.insert(id);
+    ++memory_writes_;
     
     // Update cache
     memories_.erase(id);
+    memory_cache_.Erase(id);
+    memory_tiers_.Forget(id);
+    association_index_.Remove(id);
+    trait_aggregates_.Remove(id);
+    text_index_.Remove(id);
+    for (auto& [session, clusters] : memory_clusters_) {
+        clusters.Remove(id);
+    }
     RemoveMemory(id);
+    RecordTierSizes();
+    TriggerMemoryPasses();
     
     return true;
 }
 
 bool MemoryManager::SaveEmotionalState(const EmotionalState& state) {
-    try {
-        // Convert state to JSON
-        nlohmann::json j = state;
-        
-        // Prepare SQL statement
-        const char* sql = R"(
-            INSERT INTO emotional_states (
-                id, happiness, sadness, anger, fear, surprise,
-                disgust, trust, anticipation, timestamp
-            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        )";
-        
-        // Execute SQL with parameters
-        if (!db_->ExecuteSQL(sql, {
-            state.id,
-            std::to_string(state.happiness),
-            std::to_string(state.sadness),
-            std::to_string(state.anger),
-            std::to_string(state.fear),
-            std::to_string(state.surprise),
-            std::to_string(state.disgust),
-            std::to_string(state.trust),
-            std::to_string(state.anticipation),
-            std::to_string(std::chrono::system_clock::to_time_t(state.timestamp))
-        })) {
-            return false;
-        }
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving emotional state: " << e.what() << std::endl;
-        return false;
-    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    
+    store_->UpsertEmotionalState(state);
+    emotional_states_[state.id] = state;
+    return true;
 }
 
 bool MemoryManager::LoadEmotionalState(const std::string& stateId, EmotionalState& state) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    
     try {
+        // Queued writes must land before reading back
+        if (!store_->Flush()) {
+            return false;
+        }
+        
         // Prepare SQL statement
         const char* sql = "SELECT * FROM emotional_states WHERE id = ?";
         
@@ -201,67 +368,37 @@ bool MemoryManager::LoadEmotionalState(const std::string& stateId, EmotionalStat
 }
 
 bool MemoryManager::UpdateEmotionalState(const EmotionalState& state) {
-    try {
-        // Prepare SQL statement
-        const char* sql = R"(
-            UPDATE emotional_states SET
-                happiness = ?,
-                sadness = ?,
-                anger = ?,
-                fear = ?,
-                surprise = ?,
-                disgust = ?,
-                trust = ?,
-                anticipation = ?,
-                timestamp = ?
-            WHERE id = ?
-        )";
-        
-        // Execute SQL with parameters
-        if (!db_->ExecuteSQL(sql, {
-            std::to_string(state.happiness),
-            std::to_string(state.sadness),
-            std::to_string(state.anger),
-            std::to_string(state.fear),
-            std::to_string(state.surprise),
-            std::to_string(state.disgust),
-            std::to_string(state.trust),
-            std::to_string(state.anticipation),
-            std::to_string(std::chrono::system_clock::to_time_t(state.timestamp)),
-            state.id
-        })) {
-            return false;
-        }
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error updating emotional state: " << e.what() << std::endl;
-        return false;
-    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    
+    // An update never creates the state
+    if (!EmotionalStateStored(state.id)) return false;
+    if (!store_->UpdateEmotionalState(state)) return false;
+    emotional_states_[state.id] = state;
+    return true;
+}
+
+bool MemoryManager::EmotionalStateStored(const std::string& id) {
+    const auto pending = store_->PendingEmotionalState(id);
+    if (pending == WriteBehindStore::PendingWrite::Delete) return false;
+    if (emotional_states_.count(id)) return true;
+    
+    // Queued writes must land before reading back
+    if (pending != WriteBehindStore::PendingWrite::None && !store_->Flush()) return false;
+    return !db_->ExecuteQueryWithResultAndParams("SELECT id FROM emotional_states WHERE id = ?", {id}).empty();
 }
 
 bool MemoryManager::DeleteEmotionalState(const std::string& stateId) {
-    try {
-        // Prepare SQL statement
-        const char* sql = "DELETE FROM emotional_states WHERE id = ?";
-        
-        // Execute SQL with parameters
-        if (!db_->ExecuteSQL(sql, {stateId})) {
-            return false;
-        }
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error deleting emotional state: " << e.what() << std::endl;
-        return false;
-    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return false;
+    
+    store_->DeleteEmotionalState(stateId);
+    emotional_states_.erase(stateId);
+    return true;
 }
 
 bool MemoryManager::SaveTraits(const SapphicTraits& traits) {
     try {
-        // Convert traits to JSON
-        nlohmann::json j = traits;
-        
         // Prepare SQL statement
         const char* sql = R"(
             INSERT INTO sapphic_traits (
@@ -400,109 +537,98 @@ bool MemoryManager::DeleteTraits(const std::string& traitsId) {
 
 std::map<std::string, std::string> RecallTraits(const std::string& sessionID) {
     std::map<std::string, std::string> traits;
-
-    // TODO: Implement database retrieval
-    // std::string traitsStr = Database::GetInstance().RecallTraits(sessionID);
-    // nlohmann::json traitsJson = nlohmann::json::parse(traitsStr);
-    // traits = traitsJson.get<std::map<std::string, std::string>>();
-
+    SessionStore::Global().Read(sessionID, [&](const SessionState& session) {
+        traits = session.traits;
+    });
     return traits;
 }
 
+void StoreTraits(const std::string& sessionID, const std::map<std::string, std::string>& traits) {
+    SessionStore::Global().Update(sessionID, [&](SessionState& session) {
+        for (const auto& [name, value] : traits) {
+            session.traits[name] = value;
+        }
+    });
+}
+
 std::string extractName(const std::string& prompt) {
-    std::string lowerPrompt = prompt;
-    std::transform(lowerPrompt.begin(), lowerPrompt.end(), lowerPrompt.begin(), ::tolower);
-    
-    size_t idx = lowerPrompt.find("my name is");
-    if (idx == std::string::npos) {
-        return "";
-    }
-    
-    std::string namePart = prompt.substr(idx + 10);
-    namePart = std::regex_replace(namePart, std::regex(R"(^\s+)"), "");
-    
-    size_t spacePos = namePart.find(' ');
-    if (spacePos != std::string::npos) {
-        namePart = namePart.substr(0, spacePos);
-    }
-    
-    if (!namePart.empty()) {
-        namePart[0] = std::toupper(namePart[0]);
-    }
-    
-    return namePart;
+    return ExtractName(prompt, AnalyzePrompt(prompt));
 }
 
 std::string extractMood(const std::string& prompt) {
-    std::string lowerPrompt = prompt;
-    std::transform(lowerPrompt.begin(), lowerPrompt.end(), lowerPrompt.begin(), ::tolower);
-
-    std::vector<std::string> moods = {
-        "happy", "sad", "angry", "tired", "excited",
-        "grumpy", "anxious", "stressed", "curious", "bored"
-    };
-
-    for (const auto& mood : moods) {
-        if (lowerPrompt.find("i'm feeling " + mood) != std::string::npos ||
-            lowerPrompt.find("i feel " + mood) != std::string::npos ||
-            lowerPrompt.find("i am " + mood) != std::string::npos) {
-            return mood;
-        }
-    }
-    return "";
+    return ExtractMood(AnalyzePrompt(prompt));
 }
 
 bool detectMoodClear(const std::string& prompt) {
-    std::string lowerPrompt = prompt;
-    std::transform(lowerPrompt.begin(), lowerPrompt.end(), lowerPrompt.begin(), ::tolower);
-    
-    return lowerPrompt.find("forget my mood") != std::string::npos ||
-           lowerPrompt.find("reset my mood") != std::string::npos ||
-           lowerPrompt.find("ignore how i feel") != std::string::npos ||
-           lowerPrompt.find("never mind my feelings") != std::string::npos ||
-           lowerPrompt.find("i'm over it") != std::string::npos ||
-           lowerPrompt.find("it doesn't matter how i feel") != std::string::npos ||
-           lowerPrompt.find("change the subject") != std::string::npos ||
-           lowerPrompt.find("move on from that") != std::string::npos ||
-           lowerPrompt.find("stop talking about my mood") != std::string::npos;
+    return AnalyzePrompt(prompt).mood_clear;
 }
 
 std::string FindUserByName(const std::string& name) {
-    // TODO: Implement database query
-    // return Database::GetInstance().FindUserByName(name);
-    return "";
+    return SessionStore::Global().FindUser(name);
 }
 
 bool HasExistingProfile(const std::string& sessionID) {
-    // TODO: Implement database query
-    // return Database::GetInstance().HasExistingProfile(sessionID);
-    return false;
+    bool hasProfile = false;
+    SessionStore::Global().Read(sessionID, [&](const SessionState& session) {
+        hasProfile = session.has_profile;
+    });
+    return hasProfile;
+}
+
+void SaveUserProfile(const std::string& sessionID, const std::string& userName) {
+    // Update reindexes the name, so FindUserByName sees it at once
+    SessionStore::Global().Update(sessionID, [&](SessionState& session) {
+        session.user_name = userName;
+        session.has_profile = true;
+    });
 }
 
 std::vector<std::string> GetMoodHistory(const std::string& sessionID) {
-    // TODO: Implement database query
-    // return Database::GetInstance().GetMoodHistory(sessionID);
-    return {};
+    std::vector<std::string> moods;
+    SessionStore::Global().Read(sessionID, [&](const SessionState& session) {
+        moods = session.mood_history;
+    });
+    return moods;
 }
 
 void SaveMoodHistory(const std::string& sessionID, const std::vector<std::string>& moods) {
-    // TODO: Implement database save
-    // Database::GetInstance().SaveMoodHistory(sessionID, moods);
+    SessionStore::Global().Update(sessionID, [&](SessionState& session) {
+        session.mood_history = moods;
+    });
 }
 
+float calculateMemoryStrength(float importance, int recallCount);
+void createRelatedMemories(const std::string& sessionID,
+                          const std::string& content,
+                          const std::vector<std::string>& tags);
+
 void ConsolidateMemories(const std::string& sessionID) {
     std::cout << "🧠 Consolidating memories for session: " << sessionID << std::endl;
 
-    // TODO: Implement database query and update
-    // auto memories = Database::GetInstance().GetMemoriesForConsolidation(sessionID);
-    // for (const auto& mem : memories) {
-    //     float strength = calculateMemoryStrength(mem.Importance, mem.RecallCount);
-    //     Database::GetInstance().UpdateMemoryStrength(mem.MemoryID, strength);
-    //     
-    //     if (mem.Importance > 0.8f) {
-    //         createRelatedMemories(sessionID, mem.Content, mem.Tags);
-    //     }
-    // }
+    // Strengths are recomputed under the session's lock; related memories
+    // are created after it is released
+    std::vector<std::pair<std::string, std::vector<std::string>>> important;
+    SessionStore::Global().Update(sessionID, [&](SessionState& session) {
+        auto& symbols = SymbolTable::Global();
+        for (const auto* memories : {&session.context.short_term_memories, &session.context.long_term_memories}) {
+            for (const auto& memory : *memories) {
+                // Recalls are not tracked per session yet
+                session.context.memory_weights[memory.id] =
+                    calculateMemoryStrength(static_cast<float>(memory.importance), 0);
+                if (memory.importance > 0.8) {
+                    std::vector<std::string> tags;
+                    for (SymbolID tag : memory.tags) {
+                        tags.push_back(symbols.Name(SymbolKind::Tag, tag));
+                    }
+                    important.emplace_back(memory.content, std::move(tags));
+                }
+            }
+        }
+    }, false);
+
+    for (const auto& [content, tags] : important) {
+        createRelatedMemories(sessionID, content, tags);
+    }
 }
 
 float calculateMemoryStrength(float importance, int recallCount) {
@@ -621,68 +747,75 @@ void UpdateEmotionalPatterns(const std::string& sessionID) {
 }
 
 void CreateMemoryConnections(const std::string& sessionID) {
+    constexpr SimilarityWeights CONNECTION_WEIGHTS{
+        .shared_trait = 0.3,
+        .shared_tag = 0.2,
+        .emotional_match = 0.2,
+        .emotional_match_window = 0.2
+    };
+
     auto& memoryContext = GetMemoryContext(sessionID);
-    
-    // Combine all memories
-    std::vector<MemoryEvent> allMemories = memoryContext.ShortTermMemories;
-    allMemories.insert(allMemories.end(), 
-                      memoryContext.LongTermMemories.begin(), 
-                      memoryContext.LongTermMemories.end());
+    auto& symbols = SymbolTable::Global();
 
-    // Create connections between similar memories
-    for (size_t i = 0; i < allMemories.size(); ++i) {
-        for (size_t j = i + 1; j < allMemories.size(); ++j) {
-            const auto& mem1 = allMemories[i];
-            const auto& mem2 = allMemories[j];
-
-            // Calculate connection strength
-            double strength = 0.0;
-            std::vector<std::string> sharedTraits;
-
-            // Check shared traits
-            for (const auto& [trait, _] : mem1.TraitInfluences) {
-                if (mem2.TraitInfluences.find(trait) != mem2.TraitInfluences.end()) {
-                    strength += 0.3;
-                    sharedTraits.push_back(trait);
-                }
-            }
+    // Reference all memories in place and build their feature records once
+    std::pmr::vector<const MemoryEvent*> allMemories(ScratchResource());
+    allMemories.reserve(memoryContext.ShortTermMemories.size() + memoryContext.LongTermMemories.size());
+    for (const auto& memory : memoryContext.ShortTermMemories) allMemories.push_back(&memory);
+    for (const auto& memory : memoryContext.LongTermMemories) allMemories.push_back(&memory);
 
-            // Check shared tags
-            for (const auto& tag : mem1.Tags) {
-                if (std::find(mem2.Tags.begin(), mem2.Tags.end(), tag) != mem2.Tags.end()) {
-                    strength += 0.2;
-                }
-            }
+    std::vector<MemoryFeatures> features;
+    features.reserve(allMemories.size());
+    for (const auto* memory : allMemories) {
+        features.push_back({
+            .traits = symbols.InternKeys(SymbolKind::Trait, memory->TraitInfluences),
+            .tags = symbols.InternAll(SymbolKind::Tag, memory->Tags),
+            .emotional_weight = memory->EmotionalWeight
+        });
+    }
 
-            // Check emotional similarity
-            if (std::abs(mem1.EmotionalWeight - mem2.EmotionalWeight) < 0.2) {
-                strength += 0.2;
+    // Create connections between similar memories
+    FeatureList shared;
+    SimilarityEngine::ScorePairs(features, CONNECTION_WEIGHTS, 0.5,
+        [&](size_t i, size_t j, double strength) {
+            MemoryConnection connection;
+            connection.SourceMemory = allMemories[i]->Content;
+            connection.TargetMemory = allMemories[j]->Content;
+            connection.Strength = strength;
+            connection.ConnectionType = "emotional";
+
+            SimilarityEngine::SharedFeatures(features[i].traits, features[j].traits, shared);
+            for (FeatureID trait : shared) {
+                connection.SharedTraits.push_back(symbols.Name(SymbolKind::Trait, trait));
             }
 
-            if (strength > 0.5) {
-                MemoryConnection connection;
-                connection.SourceMemory = mem1.Content;
-                connection.TargetMemory = mem2.Content;
-                connection.Strength = strength;
-                connection.ConnectionType = "emotional";
-                connection.SharedTraits = sharedTraits;
-
-                memoryContext.MemoryConnections.push_back(connection);
-            }
-        }
-    }
+            memoryContext.MemoryConnections.push_back(std::move(connection));
+        });
 }
 
 void MemoryManager::ProcessMemoryClusters(const std::string& sessionID) {
-    auto& context = GetMemoryContext(sessionID);
-    for (const auto& cluster : context.clusters) {
-        ProcessMemoryCluster(sessionID, cluster);
+    auto& clusters = memory_clusters_[sessionID];
+
+    // Memories that bypassed the hooks (bulk loads) force a full re-cluster
+    if (sessionID == "default" && clusters.Size() != memories_.size()) {
+        clusters.Rebuild(memories_);
+    }
+
+    // Split and merge only the clusters touched since the last pass
+    clusters.Maintain();
+    for (auto id : clusters.ClusterIDs()) {
+        ProcessMemoryCluster(sessionID, *clusters.Cluster(id));
     }
+    Metrics().clusters.Set(static_cast<double>(clusters.ClusterCount()));
 }
 
-void MemoryManager::ProcessMemoryCluster(const std::string& sessionID, const std::vector<MemoryEvent>& cluster) {
-    for (const auto& memory : cluster) {
-        ProcessMemoryEvent(sessionID, memory);
+void MemoryManager::ProcessMemoryCluster(const std::string& sessionID, const MemoryCluster& cluster) {
+    auto& context = GetMemoryContext(sessionID);
+    for (const auto& id : cluster.memory_ids) {
+        if (auto it = memories_.find(id); it != memories_.end()) {
+            ProcessMemoryEvent(sessionID, it->second);
+        } else if (auto indexed = context.memory_index.find(id); indexed != context.memory_index.end()) {
+            ProcessMemoryEvent(sessionID, indexed->second);
+        }
     }
 }
 
@@ -692,22 +825,16 @@ void MemoryManager::UpdateMemoryIndex(const std::string& sessionID, const Memory
 }
 
 void MemoryManager::UpdateMemoryCluster(const std::string& sessionID, const MemoryEvent& memory) {
-    auto& context = GetMemoryContext(sessionID);
-    bool added = false;
-    for (auto& cluster : context.clusters) {
-        if (cluster.empty()) continue;
-        if (std::abs(cluster[0].emotional_weight - memory.emotional_weight) < 0.1) {
-            cluster.push_back(memory);
-            added = true;
-            break;
-        }
-    }
-    if (!added) {
-        context.clusters.push_back({memory});
-    }
+    // Grid lookup against nearby centroids; re-places the memory if it moved
+    memory_clusters_[sessionID].Upsert(memory);
+}
+
+const MemoryClusterIndex& MemoryManager::GetMemoryClusters(const std::string& sessionID) {
+    return memory_clusters_[sessionID];
 }
 
 void MemoryManager::UpdateTraitBaseline(const std::string& traitName, double influence) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) {
         throw std::runtime_error("MemoryManager not initialized");
     }
@@ -718,84 +845,72 @@ void MemoryManager::UpdateTraitBaseline(const std::string& traitName, double inf
     }
     
     // Update trait baseline with new influence
-    auto& baseline = trait_baselines_[traitName];
-    baseline.CurrentValue += influence;
-    baseline.LastAdjustment = std::chrono::system_clock::now();
-    
-    // Update stability based on recent changes
-    UpdateTraitStability(traitName);
+    const SymbolID trait = InternTrait(traitName);
+    auto& baseline = trait_baselines_[trait];
+    baseline.current_value += influence;
+    baseline.last_adjustment = std::chrono::system_clock::now();
+    
+    // Record the new value, then update stability based on recent changes
+    UpdateEvolutionMetrics(trait, baseline.current_value);
+    UpdateTraitStability(trait);
+    if (maintenance_) maintenance_->Trigger("trait_trends");
 }
 
-void MemoryManager::UpdateTraitStability(const std::string& traitName) {
-    auto& baseline = traitBaselines_[traitName];
-    auto& metrics = traitEvolutionMetrics_[traitName];
+void MemoryManager::UpdateTraitStability(SymbolID trait) {
+    auto& baseline = trait_baselines_[trait];
+    auto& metrics = trait_evolution_metrics_[trait];
     
-    // Calculate volatility from historical values
-    if (metrics.HistoricalValues.size() >= 2) {
-        double sum = 0.0;
-        for (double value : metrics.HistoricalValues) {
-            sum += value;
-        }
-        double mean = sum / metrics.HistoricalValues.size();
-        
-        double variance = 0.0;
-        for (double value : metrics.HistoricalValues) {
-            variance += std::pow(value - mean, 2);
-        }
-        variance /= metrics.HistoricalValues.size();
-        
-        metrics.Volatility = std::sqrt(variance);
+    // Volatility of the retained history, kept by the trend stream
+    if (metrics.historical_values.size() >= 2) {
+        metrics.volatility = TrendStream(trait).Volatility();
     }
     
     // Update stability based on volatility and confidence
-    baseline.Stability = std::exp(-metrics.Volatility) * metrics.Confidence;
+    baseline.stability = std::exp(-metrics.volatility) * metrics.confidence;
 }
 
-void MemoryManager::UpdateEvolutionMetrics(const std::string& traitName, double newValue) {
-    auto& metrics = traitEvolutionMetrics_[traitName];
+void MemoryManager::UpdateEvolutionMetrics(SymbolID trait, double newValue) {
+    auto& metrics = trait_evolution_metrics_[trait];
+    
+    const auto now = std::chrono::system_clock::now();
     
-    // Update historical values
-    metrics.HistoricalValues.push_back(newValue);
-    if (metrics.HistoricalValues.size() > 100) {
-        metrics.HistoricalValues.erase(metrics.HistoricalValues.begin());
+    // Stream first, so it replays any history it has not seen yet
+    TraitTrendStream& stream = TrendStream(trait);
+    stream.Add(newValue);
+    trait_correlations_.Record(trait, newValue, now);
+    metrics.historical_values.push_back(newValue);
+    while (metrics.historical_values.size() > trend_retention_) {
+        metrics.historical_values.pop_front();
     }
     
     // Calculate short-term change
-    if (metrics.HistoricalValues.size() >= 2) {
-        metrics.ShortTermChange = newValue - metrics.HistoricalValues[metrics.HistoricalValues.size() - 2];
+    if (metrics.historical_values.size() >= 2) {
+        metrics.short_term_change = newValue - metrics.historical_values[metrics.historical_values.size() - 2];
     }
     
-    // Calculate long-term trend
-    if (metrics.HistoricalValues.size() >= 10) {
-        double sum = 0.0;
-        for (size_t i = metrics.HistoricalValues.size() - 10; i < metrics.HistoricalValues.size(); ++i) {
-            sum += metrics.HistoricalValues[i];
-        }
-        double recentMean = sum / 10;
-        
-        sum = 0.0;
-        for (size_t i = 0; i < 10; ++i) {
-            sum += metrics.HistoricalValues[i];
-        }
-        double oldMean = sum / 10;
-        
-        metrics.LongTermTrend = recentMean - oldMean;
+    // Long-term trend: newest ten against oldest ten retained, from the
+    // stream's running sums over the same window
+    if (metrics.historical_values.size() >= TraitTrendStream::EDGE_WINDOW) {
+        metrics.long_term_trend = stream.EdgeTrend();
     }
     
     // Update confidence based on consistency
-    metrics.Confidence = CalculateTraitConfidence(traitName);
-    metrics.LastUpdate = std::chrono::system_clock::now();
+    metrics.confidence = CalculateTraitConfidence(trait);
+    metrics.last_update = now;
+    
+    // Slopes for TraitRelevance, read out of the stream just fed
+    AnalyzeTraitTrend(trait);
 }
 
-double MemoryManager::CalculateTraitConfidence(const std::string& traitName) {
-    const auto& baseline = traitBaselines_[traitName];
-    const auto& metrics = traitEvolutionMetrics_[traitName];
+double MemoryManager::CalculateTraitConfidence(SymbolID trait) {
+    const auto& baseline = trait_baselines_[trait];
+    const auto& metrics = trait_evolution_metrics_[trait];
     
     // Calculate confidence based on multiple factors
-    double consistencyScore = 1.0 - metrics.Volatility;
-    double memorySupportScore = static_cast<double>(baseline.SupportingMemories.size()) /
-                              (baseline.SupportingMemories.size() + baseline.ConflictingMemories.size() + 1);
-    double trendConfidence = std::exp(-std::abs(metrics.LongTermTrend));
+    double consistencyScore = 1.0 - metrics.volatility;
+    double memorySupportScore = static_cast<double>(baseline.supporting_memories.size()) /
+                              (baseline.supporting_memories.size() + baseline.conflicting_memories.size() + 1);
+    double trendConfidence = std::exp(-std::abs(metrics.long_term_trend));
     
     // Combine factors with weights
     return consistencyScore * 0.4 +
@@ -803,298 +918,288 @@ double MemoryManager::CalculateTraitConfidence(const std::string& traitName) {
            trendConfidence * 0.3;
 }
 
-void MemoryManager::AnalyzeTraitTrends(const std::string& traitName) {
-    auto& metrics = traitEvolutionMetrics_[traitName];
-    auto& trendAnalysis = traitTrendAnalyses_[traitName];
-    
-    // Calculate moving averages for different time windows
-    const size_t shortWindow = 5;
-    const size_t longWindow = 20;
-    const size_t seasonalWindow = 24; // Assuming daily seasonality
-    
-    std::vector<double> shortMA, longMA, seasonalMA;
-    for (size_t i = 0; i < metrics.HistoricalValues.size(); ++i) {
-        if (i >= shortWindow - 1) {
-            double sum = 0.0;
-            for (size_t j = 0; j < shortWindow; ++j) {
-                sum += metrics.HistoricalValues[i - j];
-            }
-            shortMA.push_back(sum / shortWindow);
-        }
-        
-        if (i >= longWindow - 1) {
-            double sum = 0.0;
-            for (size_t j = 0; j < longWindow; ++j) {
-                sum += metrics.HistoricalValues[i - j];
-            }
-            longMA.push_back(sum / longWindow);
-        }
-        
-        if (i >= seasonalWindow - 1) {
-            double sum = 0.0;
-            for (size_t j = 0; j < seasonalWindow; ++j) {
-                sum += metrics.HistoricalValues[i - j];
-            }
-            seasonalMA.push_back(sum / seasonalWindow);
-        }
-    }
-    
-    // Calculate slopes and acceleration
-    if (shortMA.size() >= 2) {
-        trendAnalysis.ShortTermSlope = (shortMA.back() - shortMA[shortMA.size() - 2]) / shortWindow;
-    }
-    if (longMA.size() >= 2) {
-        trendAnalysis.LongTermSlope = (longMA.back() - longMA[longMA.size() - 2]) / longWindow;
+TraitTrendStream& MemoryManager::TrendStream(SymbolID trait) {
+    auto& stream = trait_trend_streams_[trait];
+    const auto& history = trait_evolution_metrics_[trait].historical_values;
+    if (stream.Retention() != trend_retention_) {
+        stream.SetRetention(trend_retention_);
     }
-    if (shortMA.size() >= 3) {
-        trendAnalysis.Acceleration = (shortMA.back() - 2 * shortMA[shortMA.size() - 2] + 
-                                    shortMA[shortMA.size() - 3]) / (shortWindow * shortWindow);
+    // History restored or trimmed elsewhere is replayed once
+    if (stream.Size() != std::min(history.size(), trend_retention_)) {
+        stream.Reset(history);
     }
-    
-    // Calculate volatility
-    double sum = 0.0;
-    for (double value : metrics.HistoricalValues) {
-        sum += value;
+    return stream;
+}
+
+void MemoryManager::SetTrendRetention(size_t samples) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    trend_retention_ = std::max<size_t>(samples, 1);
+    for (auto& [trait, metrics] : trait_evolution_metrics_) {
+        while (metrics.historical_values.size() > trend_retention_) {
+            metrics.historical_values.pop_front();
+        }
     }
-    double mean = sum / metrics.HistoricalValues.size();
-    
-    double variance = 0.0;
-    for (double value : metrics.HistoricalValues) {
-        variance += std::pow(value - mean, 2);
+    for (auto& [trait, stream] : trait_trend_streams_) {
+        stream.SetRetention(trend_retention_);
     }
-    variance /= metrics.HistoricalValues.size();
-    trendAnalysis.Volatility = std::sqrt(variance);
+}
+
+const TraitCorrelationMatrix& MemoryManager::GetTraitCorrelations() const {
+    return trait_correlations_;
+}
+
+void MemoryManager::SetTraitCorrelationForgetting(double forgetting) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    trait_correlations_.SetForgetting(forgetting);
+}
+
+void MemoryManager::AnalyzeTraitTrends(const std::string& traitName) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    AnalyzeTraitTrend(InternTrait(traitName));
+}
+
+void MemoryManager::AnalyzeTraitTrend(SymbolID trait) {
+    auto& trendAnalysis = trait_trend_analyses_[trait];
     
-    // Calculate seasonality
-    if (seasonalMA.size() >= 2) {
-        double seasonalSum = 0.0;
-        for (size_t i = 0; i < seasonalMA.size() - 1; ++i) {
-            seasonalSum += std::abs(seasonalMA[i + 1] - seasonalMA[i]);
-        }
-        trendAnalysis.Seasonality = seasonalSum / (seasonalMA.size() - 1);
-    }
+    // Statistics are maintained per sample; this only reads them out
+    TrendStream(trait).Fill(trendAnalysis);
+    trendAnalysis.last_analysis = std::chrono::system_clock::now();
+}
+
+void MemoryManager::AnalyzeTraitTrends() {
+    // Held across the parallel analyses, which run for this call
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     
-    // Calculate cyclicality
-    if (metrics.HistoricalValues.size() >= 4) {
-        std::vector<double> differences;
-        for (size_t i = 1; i < metrics.HistoricalValues.size(); ++i) {
-            differences.push_back(metrics.HistoricalValues[i] - metrics.HistoricalValues[i - 1]);
-        }
-        
-        double cycleSum = 0.0;
-        for (size_t i = 1; i < differences.size(); ++i) {
-            cycleSum += std::abs(differences[i] - differences[i - 1]);
-        }
-        trendAnalysis.Cyclicality = cycleSum / (differences.size() - 1);
+    // Entries are created up front so the parallel analyses only look up
+    std::vector<SymbolID> traits;
+    traits.reserve(trait_evolution_metrics_.size());
+    for (const auto& [trait, metrics] : trait_evolution_metrics_) {
+        traits.push_back(trait);
+        trait_trend_analyses_[trait];
+        TrendStream(trait);
     }
     
-    trendAnalysis.MovingAverages = shortMA;
-    trendAnalysis.SeasonalComponents = seasonalMA;
-    trendAnalysis.LastAnalysis = std::chrono::system_clock::now();
+    ForEachIndex(maintenance_executor_.get(), traits.size(), [&](size_t i) {
+        AnalyzeTraitTrend(traits[i]);
+    });
 }
 
 void MemoryManager::ProcessTraitInteractions(const std::string& traitName) {
-    auto& interactions = traitInteractions_[traitName];
-    auto& memories = GetMemoriesByTrait(traitName);
-    
-    // Find related traits
-    std::set<std::string> relatedTraits;
-    for (const auto& memory : memories) {
-        for (const auto& [trait, _] : memory.TraitInfluences) {
-            if (trait != traitName) {
-                relatedTraits.insert(trait);
-            }
-        }
-    }
-    
-    // Analyze interactions with each related trait
-    for (const auto& relatedTrait : relatedTraits) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const SymbolID sourceTrait = InternTrait(traitName);
+    auto& interactions = trait_interactions_.try_emplace(sourceTrait).first->second;
+    
+    // Memories that bypassed the hooks (bulk loads) force a full rebuild
+    if (trait_aggregates_.Size() != memories_.size()) {
+        trait_aggregates_.Rebuild(memories_);
+    }
+    
+    // Related traits and their strengths come from the running pair sums.
+    // Every entry is refreshed, so a trait whose partners all went away
+    // ends up with none rather than keeping what it last had.
+    const auto* partners = trait_aggregates_.Partners(sourceTrait);
+    interactions.erase_if([partners](const auto& entry) {
+        return !partners || !partners->count(entry.first);
+    });
+    if (!partners) return;
+    
+    const auto now = std::chrono::system_clock::now();
+    const double emotionalCorrelation = trait_aggregates_.EmotionalCorrelation(sourceTrait);
+    trait_correlations_.Flush();
+    for (const auto& [relatedTrait, pair] : *partners) {
         TraitInteraction interaction;
-        interaction.SourceTrait = traitName;
-        interaction.TargetTrait = relatedTrait;
-        
-        // Calculate influence strength
-        double totalInfluence = 0.0;
-        int influenceCount = 0;
-        for (const auto& memory : memories) {
-            if (memory.TraitInfluences.find(relatedTrait) != memory.TraitInfluences.end()) {
-                totalInfluence += memory.TraitInfluences.at(relatedTrait);
-                influenceCount++;
-            }
-        }
-        interaction.InfluenceStrength = influenceCount > 0 ? totalInfluence / influenceCount : 0.0;
-        
-        // Calculate temporal correlation
-        auto& sourceMetrics = traitEvolutionMetrics_[traitName];
-        auto& targetMetrics = traitEvolutionMetrics_[relatedTrait];
+        interaction.source_trait = sourceTrait;
+        interaction.target_trait = relatedTrait;
+        interaction.influence_strength = pair.TargetMean();
         
-        if (sourceMetrics.HistoricalValues.size() == targetMetrics.HistoricalValues.size()) {
-            double sumX = 0.0, sumY = 0.0, sumXY = 0.0;
-            double sumX2 = 0.0, sumY2 = 0.0;
-            
-            for (size_t i = 0; i < sourceMetrics.HistoricalValues.size(); ++i) {
-                double x = sourceMetrics.HistoricalValues[i];
-                double y = targetMetrics.HistoricalValues[i];
-                sumX += x;
-                sumY += y;
-                sumXY += x * y;
-                sumX2 += x * x;
-                sumY2 += y * y;
-            }
-            
-            double n = sourceMetrics.HistoricalValues.size();
-            double numerator = n * sumXY - sumX * sumY;
-            double denominator = std::sqrt((n * sumX2 - sumX * sumX) * (n * sumY2 - sumY * sumY));
-            interaction.TemporalCorrelation = denominator != 0 ? numerator / denominator : 0.0;
-        }
+        // Temporal correlation from the streaming co-moments
+        interaction.temporal_correlation = trait_correlations_.LearnedCorrelation(sourceTrait, relatedTrait);
         
-        // Calculate emotional correlation
-        double emotionalSum = 0.0;
-        int emotionalCount = 0;
-        for (const auto& memory : memories) {
-            if (memory.EmotionalWeight > 0.0) {
-                emotionalSum += memory.EmotionalWeight;
-                emotionalCount++;
+        interaction.emotional_correlation = emotionalCorrelation;
+        interaction.last_interaction = now;
+        interactions[relatedTrait] = interaction;
+    }
+    
+    // Shared memories and triggers still need the memories themselves; one
+    // pass fills them in for every related trait at once
+    for (const auto& memory : GetMemoriesByTrait(sourceTrait)) {
+        for (const auto& [relatedTrait, _] : memory.trait_influences) {
+            if (relatedTrait == sourceTrait) continue;
+            // Every co-occurring trait is a partner; find() keeps this loop
+            // from inserting, so no entry moves while one is being filled
+            auto interaction = interactions.find(relatedTrait);
+            if (interaction == interactions.end()) continue;
+            interaction->second.shared_memories.push_back(memory.id);
+            for (const SymbolID tag : memory.tags) {
+                interaction->second.shared_triggers.insert(tag);
             }
         }
-        interaction.EmotionalCorrelation = emotionalCount > 0 ? emotionalSum / emotionalCount : 0.0;
-        
-        // Find shared memories and triggers
-        for (const auto& memory : memories) {
-            if (memory.TraitInfluences.find(relatedTrait) != memory.TraitInfluences.end()) {
-                interaction.SharedMemories.push_back(memory.ID);
-                for (const auto& trigger : memory.Triggers) {
-                    interaction.SharedTriggers.push_back(trigger);
-                }
-            }
+    }
+}
+
+RelevanceCurve MemoryManager::TraitRelevance(const TraitInfluenceMap& influences, double emotionalWeight,
+                                             std::chrono::system_clock::time_point createdAt,
+                                             std::chrono::system_clock::time_point now) const {
+    // 0.3 trait relevance + 0.2 emotional impact + 0.3 trait contribution +
+    // 0.2 temporal decay, each exponential folded into a coefficient as of now
+    double relevance = 0.0;
+    double contribution = 0.0;
+    size_t traitCount = 0;
+    for (const auto& [trait, influence] : influences) {
+        auto metricsIt = trait_evolution_metrics_.find(trait);
+        if (metricsIt == trait_evolution_metrics_.end()) continue;
+        relevance += ExponentialDecay(std::abs(influence), RelevanceCurve::FAST_RATE,
+                                      Elapsed<DecayHours>(metricsIt->second.last_update, now));
+        auto trendIt = trait_trend_analyses_.find(trait);
+        if (trendIt != trait_trend_analyses_.end()) {
+            const auto& trend = trendIt->second;
+            contribution += std::abs(trend.short_term_slope) * (1.0 - trend.volatility);
         }
-        
-        interaction.LastInteraction = std::chrono::system_clock::now();
-        interactions[relatedTrait] = interaction;
+        ++traitCount;
+    }
+
+    const double age = Elapsed<DecayHours>(createdAt, now);
+    RelevanceCurve curve;
+    curve.origin = now;
+    curve.fast = 0.2 * ExponentialDecay(1.0, RelevanceCurve::FAST_RATE, age);
+    curve.slow = 0.2 * ExponentialDecay(emotionalWeight, RelevanceCurve::SLOW_RATE, age);
+    if (traitCount > 0) {
+        curve.fast += 0.3 * relevance / traitCount;
+        curve.constant = 0.3 * contribution / traitCount;
     }
+    return curve;
+}
+
+void MemoryManager::RefreshRelevance(std::chrono::system_clock::time_point now, size_t limit) {
+    // Round robin from where the last pass stopped. Trait updates only raise
+    // scores, which a memory coming due rechecks, but a trend turning down
+    // lowers them; this bounds how far behind a deadline can fall.
+    const std::string* last = nullptr;
+    auto it = memories_.upper_bound(relevance_cursor_);
+    for (size_t i = 0; i < limit && i < memories_.size(); ++i, ++it) {
+        if (it == memories_.end()) it = memories_.begin();
+        const MemoryEvent& memory = it->second;
+        memory_tiers_.Hot(it->first, TraitRelevance(memory.trait_influences, memory.emotional_weight,
+                                                    memory.created_at, now).Crossing(MemoryTiers::DEMOTE_THRESHOLD));
+        last = &it->first;
+    }
+    if (last) relevance_cursor_ = *last;
+}
+
+void MemoryManager::DemoteMemory(MemoryMap::iterator it, std::chrono::system_clock::time_point now) {
+    const std::string id = it->first;
+    MemoryEvent& memory = it->second;
+    const auto coldAt = TraitRelevance(memory.trait_influences, memory.emotional_weight,
+                                       memory.created_at, now).Crossing(MemoryTiers::COLD_THRESHOLD);
+
+    // Out of every index; the database row has the rest for LoadMemory
+    association_index_.Remove(id);
+    trait_aggregates_.Remove(id);
+    text_index_.Remove(id);
+    for (auto& [session, clusters] : memory_clusters_) {
+        clusters.Remove(id);
+    }
+    memory_tiers_.Warm(id, {memory.importance, memory.emotional_weight, std::move(memory.trait_influences),
+                            std::move(memory.tags), memory.created_at}, coldAt);
+    memories_.erase(it);
 }
 
 void MemoryManager::PruneMemoriesBasedOnTraits() {
-    auto now = std::chrono::system_clock::now();
-    std::vector<std::string> memoriesToPrune;
-    
-    for (const auto& [memoryID, memory] : memories_) {
-        MemoryPruningMetrics metrics;
-        metrics.LastEvaluation = now;
-        
-        // Calculate relevance score based on trait evolution
-        double totalRelevance = 0.0;
-        int traitCount = 0;
-        for (const auto& [trait, influence] : memory.TraitInfluences) {
-            if (traitEvolutionMetrics_.find(trait) != traitEvolutionMetrics_.end()) {
-                const auto& metrics = traitEvolutionMetrics_[trait];
-                double timeSinceLast = std::chrono::duration_cast<std::chrono::hours>(
-                    now - metrics.LastUpdate).count();
-                double decayFactor = std::exp(-0.1 * timeSinceLast);
-                totalRelevance += std::abs(influence) * decayFactor;
-                traitCount++;
-                metrics.AffectedTraits.push_back(trait);
-            }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    const auto now = std::chrono::system_clock::now();
+
+    RefreshRelevance(now, TIER_REFRESH_SLICE);
+
+    // Hot memories below the cutoff leave the working set for warm. The
+    // curve is rebuilt first: trait updates since may have put it off.
+    memory_tiers_.PopHot(now, TIER_SLICE, [&](const std::string& id, bool overCapacity) {
+        auto it = memories_.find(id);
+        if (it == memories_.end()) return;
+        const MemoryEvent& memory = it->second;
+        const auto demoteAt = TraitRelevance(memory.trait_influences, memory.emotional_weight,
+                                             memory.created_at, now).Crossing(MemoryTiers::DEMOTE_THRESHOLD);
+        if (overCapacity || demoteAt <= now) {
+            DemoteMemory(it, now);
+        } else {
+            memory_tiers_.Hot(id, demoteAt);
         }
-        metrics.RelevanceScore = traitCount > 0 ? totalRelevance / traitCount : 0.0;
-        
-        // Calculate emotional impact
-        metrics.EmotionalImpact = memory.EmotionalWeight * 
-            std::exp(-0.05 * std::chrono::duration_cast<std::chrono::hours>(
-                now - memory.Timestamp).count());
-        
-        // Calculate trait contribution
-        double totalContribution = 0.0;
-        for (const auto& trait : metrics.AffectedTraits) {
-            if (traitTrendAnalyses_.find(trait) != traitTrendAnalyses_.end()) {
-                const auto& trend = traitTrendAnalyses_[trait];
-                totalContribution += std::abs(trend.ShortTermSlope) * 
-                    (1.0 - trend.Volatility);
-            }
+    });
+
+    // Warm memories go cold the same way, leaving only their database rows
+    memory_tiers_.PopWarm(now, TIER_SLICE, [&](const std::string& id, WarmMemory& memory, bool overCapacity) {
+        const auto coldAt = TraitRelevance(memory.trait_influences, memory.emotional_weight,
+                                           memory.created_at, now).Crossing(MemoryTiers::COLD_THRESHOLD);
+        if (!overCapacity && coldAt > now) {
+            memory_tiers_.Warm(id, std::move(memory), coldAt);
         }
-        metrics.TraitContribution = metrics.AffectedTraits.size() > 0 ? 
-            totalContribution / metrics.AffectedTraits.size() : 0.0;
-        
-        // Calculate temporal decay
-        auto timeSinceMemory = std::chrono::duration_cast<std::chrono::hours>(
-            now - memory.Timestamp).count();
-        metrics.TemporalDecay = std::exp(-0.1 * timeSinceMemory);
-        
-        // Calculate overall score
-        metrics.OverallScore = 
-            metrics.RelevanceScore * 0.3 +
-            metrics.EmotionalImpact * 0.2 +
-            metrics.TraitContribution * 0.3 +
-            metrics.TemporalDecay * 0.2;
-        
-        // Mark memory for pruning if score is below threshold
-        if (metrics.OverallScore < 0.2) {
-            memoriesToPrune.push_back(memoryID);
-        }
-    }
-    
-    // Remove pruned memories
-    for (const auto& memoryID : memoriesToPrune) {
-        RemoveMemory(memoryID);
+    });
+    RecordTierSizes();
+
+    // Whatever is still due runs in the next slice
+    if (maintenance_ && memory_tiers_.Due(now)) {
+        maintenance_->Trigger("prune");
     }
 }
 
 EnhancedConfidence MemoryManager::CalculateEnhancedConfidence(const std::string& traitName) {
+    // Exclusive: a trait seen for the first time gets its entries here
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     EnhancedConfidence confidence;
+    const SymbolID trait = InternTrait(traitName);
     
     // Get base confidence from existing metrics
-    confidence.BaseConfidence = CalculateTraitConfidence(traitName);
+    confidence.base_confidence = CalculateTraitConfidence(trait);
     
     // Calculate pattern consistency
-    if (traitTrendAnalyses_.find(traitName) != traitTrendAnalyses_.end()) {
-        const auto& trend = traitTrendAnalyses_[traitName];
-        confidence.PatternConsistency = 1.0 - (trend.Volatility * 0.5 + 
-            std::abs(trend.ShortTermSlope - trend.LongTermSlope) * 0.5);
+    auto trendIt = trait_trend_analyses_.find(trait);
+    if (trendIt != trait_trend_analyses_.end()) {
+        const auto& trend = trendIt->second;
+        confidence.pattern_consistency = 1.0 - (trend.volatility * 0.5 + 
+            std::abs(trend.short_term_slope - trend.long_term_slope) * 0.5);
     }
     
     // Calculate cross-validation
     double totalCorrelation = 0.0;
     int correlationCount = 0;
-    for (const auto& [relatedTrait, interactions] : traitInteractions_) {
-        for (const auto& interaction : interactions) {
-            if (interaction.TargetTrait == traitName) {
-                totalCorrelation += interaction.TemporalCorrelation;
-                correlationCount++;
-            }
+    for (const auto& [sourceTrait, interactions] : trait_interactions_) {
+        auto it = interactions.find(trait);
+        if (it != interactions.end()) {
+            totalCorrelation += it->second.temporal_correlation;
+            correlationCount++;
         }
     }
-    confidence.CrossValidation = correlationCount > 0 ? totalCorrelation / correlationCount : 0.0;
+    confidence.cross_validation = correlationCount > 0 ? totalCorrelation / correlationCount : 0.0;
     
     // Calculate temporal stability
-    if (traitEvolutionMetrics_.find(traitName) != traitEvolutionMetrics_.end()) {
-        const auto& metrics = traitEvolutionMetrics_[traitName];
-        confidence.TemporalStability = 1.0 - metrics.Volatility;
+    auto metricsIt = trait_evolution_metrics_.find(trait);
+    if (metricsIt != trait_evolution_metrics_.end()) {
+        const auto& metrics = metricsIt->second;
+        confidence.temporal_stability = 1.0 - metrics.volatility;
     }
     
     // Calculate emotional alignment
     double totalEmotionalCorrelation = 0.0;
     int emotionalCount = 0;
-    for (const auto& [relatedTrait, interactions] : traitInteractions_) {
-        for (const auto& interaction : interactions) {
-            if (interaction.TargetTrait == traitName) {
-                totalEmotionalCorrelation += interaction.EmotionalCorrelation;
-                emotionalCount++;
-            }
+    for (const auto& [sourceTrait, interactions] : trait_interactions_) {
+        auto it = interactions.find(trait);
+        if (it != interactions.end()) {
+            totalEmotionalCorrelation += it->second.emotional_correlation;
+            emotionalCount++;
         }
     }
-    confidence.EmotionalAlignment = emotionalCount > 0 ? totalEmotionalCorrelation / emotionalCount : 0.0;
+    confidence.emotional_alignment = emotionalCount > 0 ? totalEmotionalCorrelation / emotionalCount : 0.0;
     
     // Calculate trait correlation
-    confidence.TraitCorrelation = confidence.CrossValidation * 0.5 + confidence.EmotionalAlignment * 0.5;
+    confidence.trait_correlation = confidence.cross_validation * 0.5 + confidence.emotional_alignment * 0.5;
     
     // Calculate overall confidence
-    confidence.OverallConfidence = 
-        confidence.BaseConfidence * 0.2 +
-        confidence.PatternConsistency * 0.2 +
-        confidence.CrossValidation * 0.2 +
-        confidence.TemporalStability * 0.2 +
-        confidence.EmotionalAlignment * 0.1 +
-        confidence.TraitCorrelation * 0.1;
+    confidence.overall_confidence = 
+        confidence.base_confidence * 0.2 +
+        confidence.pattern_consistency * 0.2 +
+        confidence.cross_validation * 0.2 +
+        confidence.temporal_stability * 0.2 +
+        confidence.emotional_alignment * 0.1 +
+        confidence.trait_correlation * 0.1;
     
     return confidence;
 }
@@ -1124,6 +1229,7 @@ void MemoryManager::ProcessEmotionalResonance(const std::string& trigger, double
 }
 
 void MemoryManager::UpdateEmotionalPatterns() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return;
     
     auto& context = GetMemoryContext("default");
@@ -1140,6 +1246,11 @@ void MemoryManager::UpdateEmotionalPatterns() {
 }
 
 void MemoryManager::ProcessSelfReflection() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    AddSelfReflection();
+}
+
+void MemoryManager::AddSelfReflection() {
     if (!is_initialized_) return;
     
     auto& context = GetMemoryContext("default");
@@ -1165,6 +1276,11 @@ void MemoryManager::ProcessSelfReflection() {
 }
 
 void MemoryManager::ProcessLongTermReflection() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    AddLongTermReflection();
+}
+
+void MemoryManager::AddLongTermReflection() {
     if (!is_initialized_) return;
     
     auto& context = GetMemoryContext("default");
@@ -1176,8 +1292,8 @@ void MemoryManager::ProcessLongTermReflection() {
     std::stringstream ss;
     ss << "Trait Evolution Analysis:\n";
     for (const auto& trait : trait_baselines_) {
-        ss << trait.first << ": " << trait.second.CurrentValue << " (Target: " 
-           << trait.second.TargetValue << ")\n";
+        ss << TraitName(trait.first) << ": " << trait.second.current_value << " (Target: " 
+           << trait.second.target_value << ")\n";
     }
     
     reflection.Content = ss.str();
@@ -1187,16 +1303,20 @@ void MemoryManager::ProcessLongTermReflection() {
 }
 
 void MemoryManager::UpdateMemoryWeightsWithEmotion() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return;
     
     for (auto& memory : memories_) {
-        double emotionalBoost = memory.second.emotional_weight * 0.5; // Placeholder factor
-        memory.second.importance += emotionalBoost;
-        UpdateMemory(memory.second);
+        MemoryEvent updated = memory.second;
+        double emotionalBoost = updated.emotional_weight * 0.5; // Placeholder factor
+        updated.importance += emotionalBoost;
+        ApplyUpdate(updated);
     }
 }
 
 void MemoryManager::ProcessPatternRecognition() {
+    // Reads the connections; the patterns it writes belong to this pass
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) {
         throw std::runtime_error("MemoryManager not initialized");
     }
@@ -1222,6 +1342,7 @@ void MemoryManager::ProcessPatternRecognition() {
 }
 
 void MemoryManager::UpdateMemoryAssociations() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) {
         throw std::runtime_error("MemoryManager not initialized");
     }
@@ -1231,43 +1352,22 @@ void MemoryManager::UpdateMemoryAssociations() {
         throw std::runtime_error("Failed to get memory context");
     }
     
-    // Clear existing connections
-    context.MemoryConnections.clear();
-    
-    // Create new connections based on shared traits and tags
-    for (const auto& mem1 : memories_) {
-        for (const auto& mem2 : memories_) {
-            if (mem1.first >= mem2.first) continue; // Avoid duplicates
-            
-            MemoryConnection connection;
-            connection.SourceMemory = mem1.first;
-            connection.TargetMemory = mem2.first;
-            
-            // Calculate connection strength based on shared traits
-            double traitStrength = 0.0;
-            for (const auto& trait : mem1.second.trait_influences) {
-                if (mem2.second.trait_influences.find(trait.first) != mem2.second.trait_influences.end()) {
-                    traitStrength += std::min(trait.second, mem2.second.trait_influences[trait.first]);
-                }
-            }
-            
-            // Calculate connection strength based on shared tags
-            double tagStrength = 0.0;
-            for (const auto& tag : mem1.second.tags) {
-                if (mem2.second.tags.find(tag) != mem2.second.tags.end()) {
-                    tagStrength += 1.0;
-                }
-            }
-            
-            connection.Strength = (traitStrength + tagStrength) / 2.0;
-            if (connection.Strength > 0.3) { // Minimum threshold
-                context.MemoryConnections.push_back(connection);
-            }
+    // Memories that bypassed the hooks (bulk loads) force a full re-index
+    if (association_index_.Size() != memories_.size()) {
+        association_index_.Clear();
+        context.MemoryConnections.clear();
+        for (const auto& [id, memory] : memories_) {
+            association_index_.Upsert(memory);
         }
     }
+    
+    // Rescore only memories added or changed since the last pass
+    association_index_.Update(memories_, context.MemoryConnections);
+    Metrics().connections.Set(static_cast<double>(context.MemoryConnections.size()));
 }
 
 void MemoryManager::UpdateEmotionalConnections() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) {
         throw std::runtime_error("MemoryManager not initialized");
     }
@@ -1277,13 +1377,19 @@ void MemoryManager::UpdateEmotionalConnections() {
         throw std::runtime_error("Failed to get memory context");
     }
     
-    // Update emotional weights based on connections
+    // Update emotional weights based on connections. A connection can
+    // outlive a memory demoted or deleted since; it is skipped, as
+    // operator[] would bring the memory back empty.
     for (auto& connection : context.MemoryConnections) {
-        auto& mem1 = memories_[connection.SourceMemory];
-        auto& mem2 = memories_[connection.TargetMemory];
+        auto source = memories_.find(connection.source_memory);
+        auto target = memories_.find(connection.target_memory);
+        if (source == memories_.end() || target == memories_.end()) continue;
+        // Copies: ApplyUpdate re-admits them into memories_
+        MemoryEvent mem1 = source->second;
+        MemoryEvent mem2 = target->second;
         
         // Emotional influence between connected memories
-        double influence = connection.Strength * EMOTIONAL_INFLUENCE_FACTOR;
+        double influence = connection.strength * EMOTIONAL_INFLUENCE_FACTOR;
         mem1.emotional_weight += mem2.emotional_weight * influence;
         mem2.emotional_weight += mem1.emotional_weight * influence;
         
@@ -1295,33 +1401,31 @@ void MemoryManager::UpdateEmotionalConnections() {
                                          EMOTIONAL_WEIGHT_CLAMP_MIN, 
                                          EMOTIONAL_WEIGHT_CLAMP_MAX);
         
-        UpdateMemory(mem1);
-        UpdateMemory(mem2);
+        ApplyUpdate(mem1);
+        ApplyUpdate(mem2);
     }
 }
 
 void MemoryManager::UpdateTraitBaselines() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return;
     
+    // Memories that bypassed the hooks (bulk loads) force a full rebuild
+    if (trait_aggregates_.Size() != memories_.size()) {
+        trait_aggregates_.Rebuild(memories_);
+    }
+    
+    // Average influence from memories, read from the running sums
     for (auto& trait : trait_baselines_) {
-        double totalInfluence = 0.0;
-        int count = 0;
-        
-        // Calculate average influence from memories
-        for (const auto& memory : memories_) {
-            if (memory.second.trait_influences.find(trait.first) != memory.second.trait_influences.end()) {
-                totalInfluence += memory.second.trait_influences[trait.first];
-                count++;
-            }
-        }
-        
-        if (count > 0) {
-            trait.second.CurrentValue = totalInfluence / count;
+        if (const TraitMoments* moments = trait_aggregates_.Influence(trait.first)) {
+            trait.second.current_value = moments->Mean();
         }
     }
 }
 
 void MemoryManager::ProcessTraitEvolution() {
+    // Reads the baselines; the evolution entries belong to this pass
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return;
     
     auto& context = GetMemoryContext("default");
@@ -1329,18 +1433,20 @@ void MemoryManager::ProcessTraitEvolution() {
     // Analyze trait changes over time
     for (const auto& trait : trait_baselines_) {
         TraitEvolution evolution;
-        evolution.TraitName = trait.first;
-        evolution.CurrentValue = trait.second.CurrentValue;
-        evolution.TargetValue = trait.second.TargetValue;
+        evolution.TraitName = TraitName(trait.first);
+        evolution.CurrentValue = trait.second.current_value;
+        evolution.TargetValue = trait.second.target_value;
         evolution.ChangeRate = (evolution.CurrentValue - evolution.TargetValue) / 
                              std::chrono::duration_cast<std::chrono::hours>(
-                                 std::chrono::system_clock::now() - trait.second.LastUpdate).count();
+                                 std::chrono::system_clock::now() - trait.second.last_adjustment).count();
         
         context.Evolution.TraitChanges.push_back(evolution);
     }
 }
 
 void MemoryManager::UpdateGrowthInsights() {
+    // Reads memories and baselines; the insights belong to this pass
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_) return;
     
     auto& context = GetMemoryContext("default");
@@ -1349,10 +1455,10 @@ void MemoryManager::UpdateGrowthInsights() {
     context.GrowthInsights.clear();
     
     // Process self-reflection
-    ProcessSelfReflection();
+    AddSelfReflection();
     
     // Process long-term reflection
-    ProcessLongTermReflection();
+    AddLongTermReflection();
     
     // Sort insights by confidence
     std::sort(context.GrowthInsights.begin(), context.GrowthInsights.end(),
@@ -1361,132 +1467,346 @@ void MemoryManager::UpdateGrowthInsights() {
               });
 }
 
-void MemoryManager::UpdateMemoryIndex() {
-    if (!is_initialized_) return;
+bool MemoryManager::WarmStart(const std::shared_ptr<const MappedSnapshot>& snapshot,
+                              const LoadProgressCallback& onProgress) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_ || !db_ || !snapshot) return false;
     
-    // Clear existing index
-    memory_index_.clear();
-    
-    // Rebuild index
-    for (const auto& memory : memories_) {
-        // Index by content keywords
-        std::stringstream ss(memory.second.content);
-        std::string word;
-        while (ss >> word) {
-            if (word.length() > 3) { // Only index words longer than 3 characters
-                memory_index_[word].push_back(memory.first);
+    LoadProgress progress;
+    try {
+        // Queued writes must land before reading back
+        if (store_ && !store_->Flush()) {
+            return false;
+        }
+        
+        // Loaded memories are due at once, for the prune passes to score a
+        // slice at a time
+        const auto now = std::chrono::system_clock::now();
+        
+        // Hydrate straight from the mapping; no SQL or JSON involved
+        for (size_t i = 0; i < snapshot->MemoryCount(); ++i) {
+            MemoryEvent memory;
+            snapshot->HydrateMemory(i, memory);
+            association_index_.Upsert(memory);
+            trait_aggregates_.Upsert(memory);
+            memory_tiers_.Hot(memory.id, now);
+            std::string id = memory.id;
+            memories_[id] = std::move(memory);
+        }
+        for (size_t i = 0; i < snapshot->EmotionalStateCount(); ++i) {
+            EmotionalState state;
+            snapshot->HydrateEmotionalState(i, state);
+            emotional_states_[state.id] = state;
+        }
+        progress.memories_loaded = memories_.size();
+        if (onProgress) {
+            // The hydrated state can serve while the callback runs unlocked
+            lock.unlock();
+            onProgress(progress);
+            lock.lock();
+            // Writes made meanwhile land first, so the replay sees them
+            if (store_ && !store_->Flush()) {
+                return false;
             }
         }
         
-        // Index by tags
-        for (const auto& tag : memory.second.tags) {
-            memory_index_[tag].push_back(memory.first);
+        // Replay the log: drop rows deleted since, then reload changed ones
+        BulkMemoryLoader loader(db_);
+        DropMissing(memories_, loader.LoadIDs("memories"), [this](const std::string& id) {
+            association_index_.Remove(id);
+            trait_aggregates_.Remove(id);
+            memory_tiers_.Forget(id);
+        });
+        DropMissing(emotional_states_, loader.LoadIDs("emotional_states"), [](const std::string&) {});
+        
+        loader.LoadMemories([&](std::vector<MemoryEvent>& batch) {
+            for (auto& memory : batch) {
+                association_index_.Upsert(memory);
+                trait_aggregates_.Upsert(memory);
+                memory_tiers_.Hot(memory.id, now);
+                std::string id = memory.id;
+                memories_[id] = std::move(memory);
+            }
+        }, snapshot->CreatedAt());
+        // An emotional state's timestamp is when it was felt, not when its
+        // row was written, so it cannot bound the replay; there are few
+        // enough states to reload every one
+        loader.LoadEmotionalStates(emotional_states_);
+        
+        RebuildTextIndex();
+        
+        progress.memories_loaded = memories_.size();
+        progress.complete = true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error warm starting from snapshot: " << e.what() << std::endl;
+        return false;
+    }
+    
+    lock.unlock();
+    if (onProgress) onProgress(progress);
+    return true;
+}
+
+void MemoryManager::AppendToSnapshot(SnapshotWriter& writer) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [id, memory] : memories_) {
+        writer.AddMemory(memory);
+    }
+    for (const auto& [id, state] : emotional_states_) {
+        writer.AddEmotionalState(state);
+    }
+}
+
+void MemoryManager::SetMaintenanceExecutor(std::shared_ptr<WorkStealingExecutor> executor) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // A slice already running keeps its scheduler and executor alive
+    maintenance_.reset();
+    maintenance_executor_ = std::move(executor);
+}
+
+WorkStealingExecutor& MemoryManager::MaintenanceExecutor() {
+    if (!maintenance_executor_) {
+        maintenance_executor_ = std::make_shared<WorkStealingExecutor>();
+    }
+    return *maintenance_executor_;
+}
+
+MaintenanceScheduler& MemoryManager::Maintenance() {
+    if (!maintenance_) {
+        maintenance_ = std::make_shared<MaintenanceScheduler>(MaintenanceExecutor());
+        RegisterMaintenancePasses();
+        // Nothing has run yet, so every pass starts out due
+        maintenance_->TriggerAll();
+    }
+    return *maintenance_;
+}
+
+void MemoryManager::TriggerMemoryPasses() {
+    // Before the first run every pass is due anyway
+    if (!maintenance_) return;
+    maintenance_->Trigger("associations");
+    maintenance_->Trigger("trait_baselines");
+}
+
+void MemoryManager::RegisterMaintenancePasses() {
+    auto& scheduler = *maintenance_;
+    scheduler.AddPass({"associations", {}, RESOURCE_MEMORIES, RESOURCE_CONNECTIONS,
+                       [this] { UpdateMemoryAssociations(); }});
+    // Rewrites memories through UpdateMemory, which re-indexes associations
+    scheduler.AddPass({"emotional_connections", {"associations"}, RESOURCE_CONNECTIONS,
+                       RESOURCE_MEMORIES | RESOURCE_CONNECTIONS,
+                       [this] { UpdateEmotionalConnections(); }});
+    scheduler.AddPass({"patterns", {"associations"}, RESOURCE_CONNECTIONS, RESOURCE_PATTERNS,
+                       [this] { ProcessPatternRecognition(); }});
+    scheduler.AddPass({"trait_baselines", {}, RESOURCE_MEMORIES, RESOURCE_TRAIT_BASELINES,
+                       [this] { UpdateTraitBaselines(); }});
+    scheduler.AddPass({"trait_trends", {}, RESOURCE_TRAIT_METRICS, RESOURCE_TRAIT_TRENDS,
+                       [this] { AnalyzeTraitTrends(); }});
+    scheduler.AddPass({"trait_evolution", {"trait_baselines"}, RESOURCE_TRAIT_BASELINES, RESOURCE_EVOLUTION,
+                       [this] { ProcessTraitEvolution(); }});
+    scheduler.AddPass({"growth_insights", {"trait_baselines"}, RESOURCE_MEMORIES | RESOURCE_TRAIT_BASELINES,
+                       RESOURCE_INSIGHTS, [this] { UpdateGrowthInsights(); }});
+    // Last: pruning removes memories every other pass reads
+    scheduler.AddPass({"prune", {"emotional_connections", "patterns", "trait_trends",
+                                 "trait_evolution", "growth_insights"},
+                       RESOURCE_TRAIT_METRICS | RESOURCE_TRAIT_TRENDS, RESOURCE_MEMORIES | RESOURCE_CONNECTIONS,
+                       [this] { PruneMemoriesBasedOnTraits(); }});
+}
+
+void MemoryManager::TriggerMaintenance(const std::string& pass) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Maintenance().Trigger(pass);
+}
+
+void MemoryManager::TriggerMaintenance() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Maintenance().TriggerAll();
+}
+
+size_t MemoryManager::RunMaintenance(std::chrono::steady_clock::duration budget) {
+    // Shards sharing this manager tick it concurrently; one slice at a time
+    if (maintenance_running_.exchange(true)) return 0;
+    struct Release {
+        std::atomic<bool>& flag;
+        ~Release() { flag = false; }
+    } release{maintenance_running_};
+    
+    // Owned here as well, so SetMaintenanceExecutor cannot free either
+    // while the slice runs unlocked
+    std::shared_ptr<WorkStealingExecutor> executor;
+    std::shared_ptr<MaintenanceScheduler> scheduler;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (!is_initialized_) return 0;
+        
+        // Passes share the default context; create it before any of them run
+        GetMemoryContext("default");
+        Maintenance();
+        scheduler = maintenance_;
+        executor = maintenance_executor_;
+        if (memory_tiers_.Due(std::chrono::system_clock::now())) {
+            scheduler->Trigger("prune");
         }
     }
+    // Each pass takes the lock itself
+    return scheduler->RunPending(budget);
 }
 
-void MemoryManager::UpdateCache() {
+MaintenanceStats MemoryManager::GetMaintenanceStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return maintenance_ ? maintenance_->Stats() : MaintenanceStats{};
+}
+
+void MemoryManager::UpdateMemoryIndex() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    RebuildTextIndex();
+}
+
+void MemoryManager::RebuildTextIndex() {
     if (!is_initialized_) return;
     
-    // Remove least recently used memories if cache is full
-    while (memory_cache_.size() > maxCacheSize_) {
-        auto oldest = memory_cache_.begin();
-        for (auto it = memory_cache_.begin(); it != memory_cache_.end(); ++it) {
-            if (it->second.last_accessed < oldest->second.last_accessed) {
-                oldest = it;
-            }
+    // Full rebuild for bulk loads; single memories are indexed incrementally.
+    // Tokenizes on the maintenance executor, which it may be running on.
+    text_index_.Rebuild(memories_, &MaintenanceExecutor());
+}
+
+std::vector<TextSearchResult> MemoryManager::SearchMemories(const std::string& query, size_t k,
+                                                            const TextRankingParams& params) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return text_index_.Search(query, k, std::chrono::system_clock::now(), params);
+}
+
+std::vector<MemoryEvent> MemoryManager::RecallRelevantMemories(const std::string& context, size_t k) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<MemoryEvent> relevant;
+    for (const auto& result : text_index_.Search(context, k, std::chrono::system_clock::now())) {
+        auto it = memories_.find(result.id);
+        if (it != memories_.end()) {
+            relevant.push_back(it->second);
         }
-        memory_cache_.erase(oldest);
     }
+    return relevant;
+}
+
+void MemoryManager::UpdateCache() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_) return;
+    
+    // Eviction is O(1) per entry from the cold end of the LRU list
+    memory_cache_.Trim();
+}
+
+CacheStats MemoryManager::GetCacheStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return memory_cache_.Stats();
+}
+
+void MemoryManager::SetTierCapacity(size_t hotCapacity, size_t warmCapacity) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    memory_tiers_.SetCapacity(hotCapacity, warmCapacity);
+}
+
+MemoryTier MemoryManager::GetMemoryTier(const std::string& id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (memories_.count(id)) return MemoryTier::Hot;
+    return memory_tiers_.FindWarm(id) ? MemoryTier::Warm : MemoryTier::Cold;
+}
+
+void MemoryManager::SetCacheBudget(size_t maxBytes, size_t maxEntries) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    memory_cache_.SetBudget(maxBytes, maxEntries);
 }
 
 void MemoryManager::SaveToDatabase() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if (!is_initialized_ || !db_) {
         throw std::runtime_error("MemoryManager not properly initialized");
     }
     
-    try {
-        // Begin transaction
-        if (!db_->BeginTransaction()) {
-            throw std::runtime_error("Failed to begin database transaction");
-        }
-        
-        // Save memories
-        for (const auto& memory : memories_) {
-            if (!db_->SaveMemory(memory.second)) {
-                throw std::runtime_error("Failed to save memory: " + memory.second.id);
-            }
-        }
-        
-        // Save emotional states
-        for (const auto& state : emotional_states_) {
-            if (!db_->SaveEmotionalState(state.second)) {
-                throw std::runtime_error("Failed to save emotional state: " + state.second.id);
-            }
-        }
-        
-        // Commit transaction
-        if (!db_->CommitTransaction()) {
-            throw std::runtime_error("Failed to commit database transaction");
-        }
-    } catch (const std::exception& e) {
-        db_->RollbackTransaction();
-        throw std::runtime_error("Failed to save to database: " + std::string(e.what()));
+    // Queue everything, then write it as one batched transaction
+    for (const auto& memory : memories_) {
+        store_->UpsertMemory(memory.second);
+    }
+    for (const auto& state : emotional_states_) {
+        store_->UpsertEmotionalState(state.second);
+    }
+    
+    if (!store_->Flush()) {
+        throw std::runtime_error("Failed to save to database");
     }
 }
 
-void MemoryManager::LoadFromDatabase() {
-    if (!is_initialized_ || !db_) return;
+void MemoryManager::LoadFromDatabase(const LoadProgressCallback& onProgress) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!is_initialized_ || !db_ || loading_) return;
+    
+    // Each batch is committed under the lock, which is released while
+    // onProgress runs; memories saved or deleted meanwhile are newer than
+    // the rows the load reads after that
+    loading_ = true;
+    load_touched_.clear();
+    auto finish = [this] {
+        loading_ = false;
+        load_touched_.clear();
+    };
+    auto report = [&](const LoadProgress& progress) {
+        if (!onProgress) return;
+        lock.unlock();
+        try {
+            onProgress(progress);
+        } catch (...) {
+            lock.lock();
+            throw;
+        }
+        lock.lock();
+    };
     
+    LoadProgress progress;
     try {
-        // Load memories
-        std::string sql = "SELECT id, content, importance, emotional_weight, timestamp FROM memories";
-        auto results = db_->Query(sql);
+        // Queued writes must land before reading back
+        if (store_ && !store_->Flush()) {
+            throw std::runtime_error("Failed to flush pending writes");
+        }
         
-        while (results->Next()) {
-            MemoryEvent memory;
-            memory.id = results->GetString(0);
-            memory.content = results->GetString(1);
-            memory.importance = results->GetDouble(2);
-            memory.emotional_weight = results->GetDouble(3);
-            memory.timestamp = std::chrono::system_clock::from_time_t(results->GetInt64(4));
-            
-            // Load tags
-            sql = "SELECT tag FROM memory_tags WHERE memory_id = ?";
-            auto tagResults = db_->Query(sql, {memory.id});
-            while (tagResults->Next()) {
-                memory.tags.insert(tagResults->GetString(0));
-            }
-            
-            // Load trait influences
-            sql = "SELECT trait_name, influence FROM memory_traits WHERE memory_id = ?";
-            auto traitResults = db_->Query(sql, {memory.id});
-            while (traitResults->Next()) {
-                memory.trait_influences[traitResults->GetString(0)] = traitResults->GetDouble(1);
+        BulkMemoryLoader loader(db_);
+        // Loaded memories are due at once, for the prune passes to score a
+        // slice at a time
+        const auto now = std::chrono::system_clock::now();
+        
+        // Load memories in batches; each batch is fully assembled
+        loader.LoadMemories([&](std::vector<MemoryEvent>& batch) {
+            for (auto& memory : batch) {
+                if (load_touched_.count(memory.id)) continue;
+                association_index_.Upsert(memory);
+                trait_aggregates_.Upsert(memory);
+                memory_tiers_.Hot(memory.id, now);
+                std::string id = memory.id;
+                memories_[id] = std::move(memory);
             }
-            
-            memories_[memory.id] = memory;
-        }
+            progress.memories_loaded += batch.size();
+            report(progress);
+        });
         
-        // Load emotional states
-        sql = "SELECT id, happiness, sadness, timestamp FROM emotional_states";
-        results = db_->Query(sql);
-        while (results->Next()) {
-            EmotionalState state;
-            state.id = results->GetString(0);
-            state.happiness = results->GetDouble(1);
-            state.sadness = results->GetDouble(2);
-            state.timestamp = std::chrono::system_clock::from_time_t(results->GetInt64(3));
-            
-            emotional_states_[state.id] = state;
+        // Emotional states written while the lock was released land first
+        if (store_ && !store_->Flush()) {
+            throw std::runtime_error("Failed to flush pending writes");
         }
+        loader.LoadEmotionalStates(emotional_states_);
         
         // Update memory index
-        UpdateMemoryIndex();
-        
+        RebuildTextIndex();
+        finish();
     } catch (const std::exception& e) {
+        finish();
         throw std::runtime_error("Failed to load from database: " + std::string(e.what()));
+    } catch (...) {
+        finish();
+        throw;
     }
+    
+    lock.unlock();
+    progress.complete = true;
+    if (onProgress) onProgress(progress);
 }
 
 // ... existing code ...
@@ -2,18 +2,36 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <chrono>
 #include <map>
-#include <regex>
 #include <iostream>
 #include <sstream>
-#include <deque>
+#include <atomic>
 #include <set>
+#include <optional>
+#include <shared_mutex>
 #include <nlohmann/json.hpp>
 #include "../database/database.hpp"
+#include "symbol_table.hpp"
 #include "memory_types.hpp"
+#include "memory_association.hpp"
+#include "memory_codec.hpp"
+#include "memory_persistence.hpp"
+#include "memory_loader.hpp"
+#include "memory_snapshot.hpp"
+#include "memory_cache.hpp"
+#include "memory_tiers.hpp"
+#include "text_index.hpp"
+#include "maintenance_scheduler.hpp"
+#include "memory_pool.hpp"
+#include "trait_aggregates.hpp"
+#include "memory_clustering.hpp"
+#include "trait_trends.hpp"
+#include "trait_correlation.hpp"
 
 namespace shandris {
 namespace cognitive {
@@ -27,10 +45,10 @@ struct MemoryEvent {
     std::string context;
     double importance;
     double emotional_weight;
-    std::map<std::string, double> trait_influences;
-    std::set<std::string> tags;
+    TraitInfluenceMap trait_influences;
+    TagSet tags;
     std::chrono::system_clock::time_point created_at;
-    std::chrono::system_clock::time_point updated_at;
+    std::chrono::system_clock::time_point updated_at;  // set by SaveMemory and UpdateMemory
     
     NLOHMANN_DEFINE_TYPE_INTRUSIVE(MemoryEvent, 
         id, content, context, importance, emotional_weight, 
@@ -92,7 +110,7 @@ struct TraitEvolutionMetrics {
     double long_term_trend;
     double volatility;
     double confidence;
-    std::vector<double> historical_values;
+    std::deque<double> historical_values;  // the newest trend_retention_ values
     std::chrono::system_clock::time_point last_update;
 };
 
@@ -105,8 +123,19 @@ struct MemoryContext {
     std::vector<SelfReflection> growth_insights;
     std::map<std::string, double> trait_growth_rates;
     std::map<std::string, double> pattern_stabilities;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(MemoryContext,
+        short_term_memories, long_term_memories, memory_connections, memory_weights,
+        last_memory_update, growth_insights, trait_growth_rates, pattern_stabilities)
 };
 
+// Threading contract: the memory, emotional state, flush, bulk load,
+// snapshot, search, recall and cache calls below are safe from any thread;
+// lookups share a reader lock and everything that changes the working set
+// takes it exclusively. A LoadMemory cache miss queries the database with
+// the lock released. The clustering, trait and reflection passes are not
+// synchronized and must be run by one owner at a time, as PersonaRuntime
+// does by running them on the owning shard.
 class MemoryManager {
 public:
     // Configuration constants
@@ -114,14 +143,21 @@ public:
     static constexpr double MIN_CONNECTION_THRESHOLD = 0.3;
     static constexpr double EMOTIONAL_INFLUENCE_FACTOR = 0.5;
     static constexpr size_t MAX_CACHE_SIZE = 1000;
+    static constexpr size_t MAX_CACHE_BYTES = 16 * 1024 * 1024;
+    static constexpr size_t MAX_RECALLED_MEMORIES = 50;
     static constexpr double EMOTIONAL_WEIGHT_CLAMP_MIN = -1.0;
     static constexpr double EMOTIONAL_WEIGHT_CLAMP_MAX = 1.0;
+    static constexpr size_t TIER_SLICE = 4096;
+    static constexpr size_t TIER_REFRESH_SLICE = 4096;
 
     MemoryManager();
     ~MemoryManager();
 
     bool Initialize();
     bool IsInitialized() const { return is_initialized_; }
+    // Stored form of the trait and tag columns, applied by Initialize; rows
+    // in either form load, and existing rows keep theirs until rewritten
+    void SetColumnEncoding(codec::ColumnEncoding encoding) { column_encoding_ = encoding; }
     
     // Memory operations
     bool SaveMemory(const MemoryEvent& memory);
@@ -132,8 +168,18 @@ public:
     // Emotional state operations
     bool SaveEmotionalState(const EmotionalState& state);
     bool LoadEmotionalState(const std::string& id, EmotionalState& state);
+    // Rewrites an existing state; false if there is none with its ID
     bool UpdateEmotionalState(const EmotionalState& state);
     bool DeleteEmotionalState(const std::string& id);
+
+    // Write all queued saves, updates and deletes now
+    bool FlushPendingWrites();
+    // Queued writes the store gave up on, since the last call
+    std::vector<WriteBehindStore::DeadLetter> TakeDeadLetters();
+    // Write queued rows once the oldest is past the store's max_delay. The
+    // store checks age only as writes arrive, so an idle manager needs this
+    // called periodically (PersonaSystem::Tick)
+    bool FlushDueWrites();
     
     // Trait operations
     bool SaveTraits(const std::map<std::string, TraitBaseline>& traits);
@@ -143,9 +189,10 @@ public:
 
     // Memory clustering and analysis
     void ProcessMemoryClusters(const std::string& sessionID);
-    void ProcessMemoryCluster(const std::string& sessionID, const std::vector<MemoryEvent>& cluster);
+    void ProcessMemoryCluster(const std::string& sessionID, const MemoryCluster& cluster);
     void UpdateMemoryIndex(const std::string& sessionID, const MemoryEvent& memory);
     void UpdateMemoryCluster(const std::string& sessionID, const MemoryEvent& memory);
+    const MemoryClusterIndex& GetMemoryClusters(const std::string& sessionID = "default");
     void UpdateTraitBaseline(const std::string& traitName, double influence);
     void AnalyzeTraitTrends(const std::string& traitName);
     void ProcessTraitInteractions(const std::string& traitName);
@@ -166,48 +213,143 @@ public:
     void UpdateMemoryIndex();
     void UpdateCache();
     void SaveToDatabase();
-    void LoadFromDatabase();
+    // Bulk load; onProgress fires after each batch and once more when the
+    // index is ready, without the manager lock held, so it may call back in.
+    // Memories saved or deleted during the load are kept as they are.
+    void LoadFromDatabase(const LoadProgressCallback& onProgress = {});
+
+    // Ranked full-text lookups over content and tags
+    std::vector<TextSearchResult> SearchMemories(const std::string& query, size_t k,
+                                                 const TextRankingParams& params = {}) const;
+    std::vector<MemoryEvent> RecallRelevantMemories(const std::string& context,
+                                                    size_t k = MAX_RECALLED_MEMORIES) const;
+
+    // Read-through cache for memories fetched from the database on demand
+    void SetCacheBudget(size_t maxBytes, size_t maxEntries = MAX_CACHE_SIZE);
+    CacheStats GetCacheStats() const;
+
+    // Hot memories are the working set; the prune pass moves them to warm
+    // as their trait relevance fades, keeping only their features, and warm
+    // ones on to cold, in the database alone. LoadMemory brings a warm
+    // memory back into the working set. Capacities bound both tiers.
+    void SetTierCapacity(size_t hotCapacity, size_t warmCapacity);
+    MemoryTier GetMemoryTier(const std::string& id) const;
+
+    // Warm start: hydrate from a mapped snapshot, then replay memory rows
+    // whose updated_at is at or after its creation time, and every
+    // emotional state. Returns false if the snapshot
+    // cannot be used; callers then fall back to LoadFromDatabase. onProgress
+    // runs without the manager lock, once hydrated and once replayed.
+    bool WarmStart(const std::shared_ptr<const MappedSnapshot>& snapshot,
+                   const LoadProgressCallback& onProgress = {});
+    void AppendToSnapshot(SnapshotWriter& writer) const;
+
+    // Maintenance passes as a dependency graph: independent passes and
+    // per-trait work run in parallel, repeated triggers coalesce, and a
+    // budget bounds each slice. Pass names are "associations",
+    // "emotional_connections", "patterns", "trait_baselines", "trait_trends",
+    // "trait_evolution", "growth_insights" and "prune". Memory writes
+    // trigger the passes that read them and RunMaintenance the prune once
+    // tiers are due, as PersonaSystem::Tick does; a call while another is
+    // still running returns 0. Each pass takes the manager lock itself. A
+    // new executor drops the scheduler, so set it before the first run.
+    void SetMaintenanceExecutor(std::shared_ptr<WorkStealingExecutor> executor);
+    void TriggerMaintenance(const std::string& pass);
+    void TriggerMaintenance();
+    size_t RunMaintenance(std::chrono::steady_clock::duration budget =
+                              std::chrono::steady_clock::duration::max());
+    MaintenanceStats GetMaintenanceStats() const;
 
     // Memory analysis
     void AnalyzeMemoryPatterns();
     void ProcessMemoryClusters();
     void UpdateMemoryWeights();
     void PruneMemories();
+    // Moves at most TIER_SLICE memories per tier whose relevance crossed a
+    // threshold and rescores TIER_REFRESH_SLICE more; under the scheduler,
+    // work left over triggers "prune" again for the next slice
+    void PruneMemoriesBasedOnTraits();
 
     // Trait analysis
     void AnalyzeTraitTrends();
     void ProcessTraitInteractions();
     void UpdateTraitStability();
+    // Samples of history kept per trait; trend statistics cover exactly these
+    void SetTrendRetention(size_t samples);
+    // Samples recorded in the same second are aligned; below 1, forgetting
+    // down-weights older observations per observation since
+    const TraitCorrelationMatrix& GetTraitCorrelations() const;
+    void SetTraitCorrelationForgetting(double forgetting);
 
 private:
     std::shared_ptr<PersonaManager> persona_manager_;
     std::shared_ptr<database::Database> db_;
-    std::deque<MemoryEvent> short_term_cache_;
-    std::deque<MemoryEvent> long_term_cache_;
-    size_t max_cache_size_;
+    std::unique_ptr<WriteBehindStore> store_;
+    codec::ColumnEncoding column_encoding_ = codec::ColumnEncoding::Json;
+    LruCache<MemoryEvent> memory_cache_;
     
-    // Memory storage and indexing
-    std::map<std::string, MemoryEvent> memories_;
-    MemoryIndex memory_index_;
+    // Memory storage and indexing; the pool is declared first so it
+    // outlives the map drawing on it
+    std::pmr::unsynchronized_pool_resource memory_pool_;
+    MemoryMap memories_{&memory_pool_};
+    std::map<std::string, EmotionalState> emotional_states_;
+    MemoryTextIndex text_index_;
+    AssociationIndex association_index_;
+    TraitAggregates trait_aggregates_;
+    MemoryTiers memory_tiers_;
+    std::string relevance_cursor_;  // last memory the prune pass rescored
     
-    // Memory clustering
-    std::map<std::string, std::vector<MemoryCluster>> memory_clusters_;
+    // Online clusters per session, keyed by memory ID
+    std::map<std::string, MemoryClusterIndex> memory_clusters_;
     std::map<std::string, ClusterEvolution> cluster_evolutions_;
     std::vector<ClusterRelationship> cluster_relationships_;
     
     // Trait tracking
-    std::map<std::string, TraitBaseline> trait_baselines_;
-    std::map<std::string, TraitEvolutionMetrics> trait_evolution_metrics_;
-    std::map<std::string, TraitTrendAnalysis> trait_trend_analyses_;
-    std::map<std::string, std::vector<TraitInteraction>> trait_interactions_;
+    TraitTable<TraitBaseline> trait_baselines_;
+    TraitTable<TraitEvolutionMetrics> trait_evolution_metrics_;
+    TraitTable<TraitTrendAnalysis> trait_trend_analyses_;
+    TraitTable<TraitTrendStream> trait_trend_streams_;
+    size_t trend_retention_ = TraitTrendStream::DEFAULT_RETENTION;
+    TraitCorrelationMatrix trait_correlations_;
+    TraitTable<TraitTable<TraitInteraction>> trait_interactions_;
     
     // Memory context
     MemoryContext context_;
 
+    // Created on first use unless an executor was supplied
+    std::shared_ptr<WorkStealingExecutor> maintenance_executor_;
+    // Shared with a running RunMaintenance slice
+    std::shared_ptr<MaintenanceScheduler> maintenance_;
+    std::atomic<bool> maintenance_running_{false};  // RunMaintenance in progress
+    uint64_t memory_writes_ = 0;  // memories admitted or deleted, so LoadMemory sees races
+
     // Helper methods
     MemoryEvent* GetMemory(const std::string& id);
+    // Samples per-tier entry counts into the metrics gauges
+    void RecordTierSizes() const;
+    // Puts a memory in the working set and every index
+    void AdmitMemory(const MemoryEvent& memory);
+    // UpdateMemory with mutex_ held
+    bool ApplyUpdate(const MemoryEvent& memory);
+    // The reflections UpdateGrowthInsights collects, with mutex_ held
+    void AddSelfReflection();
+    void AddLongTermReflection();
+    // AnalyzeTraitTrends for one trait, with mutex_ held
+    void AnalyzeTraitTrend(SymbolID trait);
+    // Creation time of an existing memory from whichever tier holds it;
+    // nullopt if it is not stored or its delete is queued
+    std::optional<std::chrono::system_clock::time_point> StoredCreatedAt(const std::string& id);
+    // Whether the emotional state exists and no delete of it is queued
+    bool EmotionalStateStored(const std::string& id);
+    void DemoteMemory(MemoryMap::iterator it, std::chrono::system_clock::time_point now);
+    // Relevance from now on, as the prune pass scores it against the
+    // current trait metrics and trends
+    RelevanceCurve TraitRelevance(const TraitInfluenceMap& influences, double emotionalWeight,
+                                  std::chrono::system_clock::time_point createdAt,
+                                  std::chrono::system_clock::time_point now) const;
+    void RefreshRelevance(std::chrono::system_clock::time_point now, size_t limit);
     void UpdateClusterMetrics(MemoryCluster& cluster);
-    double CalculateTraitDivergence(const std::map<std::string, double>& trait_frequencies);
+    double CalculateTraitDivergence(const TraitInfluenceMap& trait_frequencies);
     double CalculateTemporalDivergence(const MemoryCluster& cluster);
     double CalculateEmotionalDivergence(const MemoryCluster& cluster);
     std::vector<MemoryCluster> SplitCluster(const MemoryCluster& cluster, const ClusterDivergence& divergence);
@@ -226,13 +368,29 @@ private:
     void UpdateTraitInfluence(const MemoryEvent& memory, const std::string& trait, double weight);
     void UpdateMemory(const MemoryEvent& memory);
     std::string GetCurrentMemoryID();
-    void UpdateTraitStability(const std::string& traitName);
-    void UpdateEvolutionMetrics(const std::string& traitName, double newValue);
-    double CalculateTraitConfidence(const std::string& traitName);
-    std::vector<MemoryEvent> GetMemoriesByTrait(const std::string& trait);
+    void UpdateTraitStability(SymbolID trait);
+    void UpdateEvolutionMetrics(SymbolID trait, double newValue);
+    // Stream for the trait, brought in line with its stored history
+    TraitTrendStream& TrendStream(SymbolID trait);
+    double CalculateTraitConfidence(SymbolID trait);
+    std::vector<MemoryEvent> GetMemoriesByTrait(SymbolID trait);
     void RemoveMemory(const std::string& id);
+    void RebuildTextIndex();
+    WorkStealingExecutor& MaintenanceExecutor();
+    MaintenanceScheduler& Maintenance();
+    void RegisterMaintenancePasses();
+    void TriggerMemoryPasses();
 
-    bool is_initialized_ = false;
+    // Guards memories_, emotional_states_, the indexes and tiers, the cache,
+    // store_ and the trait tables. Each maintenance pass takes it, shared
+    // when it only reads this state; what a pass writes besides is its own,
+    // kept apart by the single-owner contract and the scheduler.
+    mutable std::shared_mutex mutex_;
+    std::atomic<bool> is_initialized_{false};
+    // Set while LoadFromDatabase runs; IDs saved or deleted meanwhile, which
+    // the load must not overwrite. Guarded by mutex_.
+    bool loading_ = false;
+    std::unordered_set<std::string> load_touched_;
 };
 
 } // namespace cognitive
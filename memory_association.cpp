@@ -0,0 +1,165 @@
+#include "memory_association.hpp"
+#include "memory.hpp"
+#include <algorithm>
+
+namespace shandris {
+namespace cognitive {
+
+void AssociationIndex::Upsert(const MemoryEvent& memory) {
+    auto it = indexed_.find(memory.id);
+    if (it != indexed_.end()) {
+        // Only tags and trait influences feed the association strength
+        if (it->second.trait_influences == memory.trait_influences &&
+            it->second.tags == memory.tags) {
+            return;
+        }
+        RemovePostings(memory.id, it->second);
+    } else {
+        it = indexed_.emplace(memory.id, IndexedFeatures{}).first;
+    }
+
+    it->second.trait_influences = memory.trait_influences;
+    it->second.tags = memory.tags;
+    AddPostings(memory.id, it->second);
+
+    removed_.erase(memory.id);
+    dirty_.insert(memory.id);
+}
+
+void AssociationIndex::Remove(const std::string& id) {
+    auto it = indexed_.find(id);
+    if (it == indexed_.end()) return;
+
+    RemovePostings(id, it->second);
+    indexed_.erase(it);
+
+    dirty_.erase(id);
+    removed_.insert(id);
+}
+
+void AssociationIndex::Clear() {
+    by_tag_.clear();
+    by_trait_.clear();
+    indexed_.clear();
+    dirty_.clear();
+    removed_.clear();
+}
+
+void AssociationIndex::Update(const MemoryMap& memories,
+                              std::vector<MemoryConnection>& connections) {
+    if (!HasPendingChanges()) return;
+
+    // Drop every connection touching a changed or removed memory
+    auto touched = [this](const std::string& id) {
+        return dirty_.count(id) > 0 || removed_.count(id) > 0;
+    };
+    connections.erase(
+        std::remove_if(connections.begin(), connections.end(),
+            [&touched](const MemoryConnection& connection) {
+                return touched(connection.source_memory) || touched(connection.target_memory);
+            }),
+        connections.end());
+
+    std::unordered_set<std::string> candidates;
+    for (const auto& id : dirty_) {
+        auto memIt = memories.find(id);
+        if (memIt == memories.end()) continue;
+        const auto& features = indexed_[id];
+
+        // Candidates are the memories sharing at least one trait or tag posting
+        candidates.clear();
+        for (const auto& [trait, _] : features.trait_influences) {
+            const auto& postings = by_trait_[trait];
+            candidates.insert(postings.begin(), postings.end());
+        }
+        for (const auto& tag : features.tags) {
+            const auto& postings = by_tag_[tag];
+            candidates.insert(postings.begin(), postings.end());
+        }
+
+        for (const auto& otherID : candidates) {
+            if (otherID == id) continue;
+            // A pair of two pending memories is scored once, from the smaller ID
+            if (otherID < id && dirty_.count(otherID) > 0) continue;
+
+            auto otherIt = memories.find(otherID);
+            if (otherIt == memories.end()) continue;
+
+            double strength = CalculateStrength(memIt->second, otherIt->second);
+            if (strength > MIN_ASSOCIATION_STRENGTH) {
+                MemoryConnection connection;
+                connection.source_memory = std::min(id, otherID);
+                connection.target_memory = std::max(id, otherID);
+                connection.strength = strength;
+                connections.push_back(connection);
+            }
+        }
+    }
+
+    dirty_.clear();
+    removed_.clear();
+}
+
+double AssociationIndex::CalculateStrength(const MemoryEvent& mem1, const MemoryEvent& mem2) {
+    // Both containers are sorted by symbol ID, so shared keys fall out of a single merge
+    double traitStrength = 0.0;
+    auto a = mem1.trait_influences.begin();
+    auto b = mem2.trait_influences.begin();
+    while (a != mem1.trait_influences.end() && b != mem2.trait_influences.end()) {
+        if (a->first < b->first) {
+            ++a;
+        } else if (b->first < a->first) {
+            ++b;
+        } else {
+            traitStrength += std::min(a->second, b->second);
+            ++a;
+            ++b;
+        }
+    }
+
+    double tagStrength = 0.0;
+    auto ta = mem1.tags.begin();
+    auto tb = mem2.tags.begin();
+    while (ta != mem1.tags.end() && tb != mem2.tags.end()) {
+        if (*ta < *tb) {
+            ++ta;
+        } else if (*tb < *ta) {
+            ++tb;
+        } else {
+            tagStrength += 1.0;
+            ++ta;
+            ++tb;
+        }
+    }
+
+    return (traitStrength + tagStrength) / 2.0;
+}
+
+void AssociationIndex::AddPostings(const std::string& id, const IndexedFeatures& features) {
+    for (const auto& [trait, _] : features.trait_influences) {
+        by_trait_[trait].push_back(id);
+    }
+    for (const auto& tag : features.tags) {
+        by_tag_[tag].push_back(id);
+    }
+}
+
+void AssociationIndex::RemovePostings(const std::string& id, const IndexedFeatures& features) {
+    for (const auto& [trait, _] : features.trait_influences) {
+        ErasePosting(by_trait_[trait], id);
+    }
+    for (const auto& tag : features.tags) {
+        ErasePosting(by_tag_[tag], id);
+    }
+}
+
+void AssociationIndex::ErasePosting(std::vector<std::string>& postings, const std::string& id) {
+    auto it = std::find(postings.begin(), postings.end(), id);
+    if (it != postings.end()) {
+        *it = std::move(postings.back());
+        postings.pop_back();
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include "memory_pool.hpp"
+#include "memory_types.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+
+// Incremental association engine behind MemoryManager::UpdateMemoryAssociations.
+// Memories are posted under each of their tags and traits, so a pass only scores
+// pairs that share at least one posting, and only for memories that changed
+// since the previous pass.
+class AssociationIndex {
+public:
+    static constexpr double MIN_ASSOCIATION_STRENGTH = 0.3;
+
+    // Track a new or modified memory. Memories whose tags and trait influences
+    // are unchanged are not marked for rescoring.
+    void Upsert(const MemoryEvent& memory);
+    void Remove(const std::string& id);
+    void Clear();
+
+    bool HasPendingChanges() const { return !dirty_.empty() || !removed_.empty(); }
+    size_t Size() const { return indexed_.size(); }
+
+    // Rescore the pending memories against their posting-list candidates and
+    // replace their entries in connections. Connections between untouched
+    // memories are left as they are.
+    void Update(const MemoryMap& memories,
+                std::vector<MemoryConnection>& connections);
+
+    // Shared trait minimum plus shared tag count, averaged
+    static double CalculateStrength(const MemoryEvent& mem1, const MemoryEvent& mem2);
+
+private:
+    struct IndexedFeatures {
+        TraitInfluenceMap trait_influences;
+        TagSet tags;
+    };
+
+    void AddPostings(const std::string& id, const IndexedFeatures& features);
+    void RemovePostings(const std::string& id, const IndexedFeatures& features);
+    static void ErasePosting(std::vector<std::string>& postings, const std::string& id);
+
+    std::unordered_map<SymbolID, std::vector<std::string>> by_tag_;
+    std::unordered_map<SymbolID, std::vector<std::string>> by_trait_;
+    std::unordered_map<std::string, IndexedFeatures> indexed_;
+    std::unordered_set<std::string> dirty_;
+    std::unordered_set<std::string> removed_;
+};
+
+} // namespace cognitive
+} // namespace shandris
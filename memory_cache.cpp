@@ -0,0 +1,15 @@
+#include "memory_cache.hpp"
+#include "memory.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+size_t MemoryFootprint(const MemoryEvent& memory) {
+    return sizeof(MemoryEvent) +
+           memory.id.capacity() + memory.content.capacity() + memory.context.capacity() +
+           memory.tags.size() * sizeof(SymbolID) +
+           memory.trait_influences.size() * sizeof(TraitInfluenceMap::value_type);
+}
+
+} // namespace cognitive
+} // namespace shandris
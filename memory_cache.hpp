@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// LRU cache keyed by ID and budgeted in bytes as well as entries. Recency
+// is an intrusive doubly linked list threaded through the map nodes, so
+// lookups, promotions and evictions are all O(1).
+template<typename Value>
+class LruCache {
+public:
+    using Sizer = std::function<size_t(const Value&)>;
+
+    LruCache(size_t maxBytes, size_t maxEntries, Sizer sizer)
+        : max_bytes_(maxBytes), max_entries_(maxEntries), sizer_(std::move(sizer)) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    // Returns nullptr on a miss; a hit becomes most recently used
+    const Value* Get(const std::string& key) {
+        auto it = nodes_.find(key);
+        if (it == nodes_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        MoveToFront(&it->second);
+        return &it->second.value;
+    }
+
+    bool Contains(const std::string& key) const { return nodes_.count(key) > 0; }
+
+    void Put(const std::string& key, Value value) {
+        size_t bytes = sizer_(value) + key.capacity();
+        auto [it, inserted] = nodes_.try_emplace(key);
+        Node* node = &it->second;
+        if (inserted) {
+            node->key = &it->first;
+            LinkFront(node);
+        } else {
+            stats_.bytes -= node->bytes;
+            MoveToFront(node);
+        }
+        node->value = std::move(value);
+        node->bytes = bytes;
+        stats_.bytes += bytes;
+        Trim();
+    }
+
+    // Refresh an entry only if it is already cached; never admits
+    void Update(const std::string& key, const Value& value) {
+        auto it = nodes_.find(key);
+        if (it == nodes_.end()) return;
+        Node* node = &it->second;
+        stats_.bytes -= node->bytes;
+        node->value = value;
+        node->bytes = sizer_(value) + key.capacity();
+        stats_.bytes += node->bytes;
+        Trim();
+    }
+
+    bool Erase(const std::string& key) {
+        auto it = nodes_.find(key);
+        if (it == nodes_.end()) return false;
+        Unlink(&it->second);
+        stats_.bytes -= it->second.bytes;
+        nodes_.erase(it);
+        return true;
+    }
+
+    void Clear() {
+        nodes_.clear();
+        head_ = tail_ = nullptr;
+        stats_.bytes = 0;
+    }
+
+    // Evict from the cold end until both budgets hold
+    void Trim() {
+        while (tail_ && (stats_.bytes > max_bytes_ || nodes_.size() > max_entries_)) {
+            Node* victim = tail_;
+            Unlink(victim);
+            stats_.bytes -= victim->bytes;
+            ++stats_.evictions;
+            nodes_.erase(*victim->key);
+        }
+    }
+
+    void SetBudget(size_t maxBytes, size_t maxEntries) {
+        max_bytes_ = maxBytes;
+        max_entries_ = maxEntries;
+        Trim();
+    }
+
+    size_t Size() const { return nodes_.size(); }
+    size_t Bytes() const { return stats_.bytes; }
+
+    CacheStats Stats() const {
+        CacheStats stats = stats_;
+        stats.entries = nodes_.size();
+        return stats;
+    }
+
+private:
+    struct Node {
+        const std::string* key = nullptr;  // points at the owning map key
+        Value value{};
+        size_t bytes = 0;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+
+    void LinkFront(Node* node) {
+        node->prev = nullptr;
+        node->next = head_;
+        if (head_) head_->prev = node;
+        head_ = node;
+        if (!tail_) tail_ = node;
+    }
+
+    void Unlink(Node* node) {
+        if (node->prev) node->prev->next = node->next;
+        else head_ = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail_ = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    void MoveToFront(Node* node) {
+        if (node == head_) return;
+        Unlink(node);
+        LinkFront(node);
+    }
+
+    // Element addresses in an unordered_map survive rehashing, so the list
+    // can hold raw node pointers
+    std::unordered_map<std::string, Node> nodes_;
+    Node* head_ = nullptr;  // most recently used
+    Node* tail_ = nullptr;  // least recently used
+    size_t max_bytes_;
+    size_t max_entries_;
+    Sizer sizer_;
+    CacheStats stats_;
+};
+
+// Approximate heap footprint of a memory, including its strings
+size_t MemoryFootprint(const MemoryEvent& memory);
+
+} // namespace cognitive
+} // namespace shandris
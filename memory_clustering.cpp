@@ -0,0 +1,475 @@
+#include "memory_clustering.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace shandris {
+namespace cognitive {
+
+MemoryClusterIndex::MemoryClusterIndex(const ClusterConfig& config) : config_(config) {
+    config_.emotional_radius = std::max(config_.emotional_radius, 1e-6);
+    config_.min_split_size = std::max<size_t>(config_.min_split_size, 2);
+}
+
+ClusterFeatures MemoryClusterIndex::Extract(const MemoryEvent& memory) {
+    ClusterFeatures features;
+    features.traits.assign(memory.trait_influences.begin(), memory.trait_influences.end());
+    features.tags = memory.tags.ids();
+    features.emotional_weight = memory.emotional_weight;
+    features.timestamp = memory.updated_at;
+    return features;
+}
+
+MemoryClusterIndex::ClusterID MemoryClusterIndex::Upsert(const MemoryEvent& memory) {
+    return Upsert(memory.id, Extract(memory));
+}
+
+MemoryClusterIndex::ClusterID MemoryClusterIndex::Upsert(const std::string& id, ClusterFeatures features) {
+    if (!has_origin_) {
+        origin_ = features.timestamp;
+        has_origin_ = true;
+    }
+
+    auto [it, inserted] = members_.try_emplace(id);
+    Member& member = it->second;
+    if (!inserted) {
+        Detach(member);
+    }
+    member.features = std::move(features);
+
+    ClusterID cluster = FindCandidate(member.features);
+    if (cluster == INVALID_CLUSTER) {
+        cluster = NewCluster();
+    }
+    Attach(it->first, member, cluster);
+    return cluster;
+}
+
+void MemoryClusterIndex::Remove(const std::string& id) {
+    auto it = members_.find(id);
+    if (it == members_.end()) return;
+    Detach(it->second);
+    members_.erase(it);
+}
+
+void MemoryClusterIndex::Clear() {
+    members_.clear();
+    clusters_.clear();
+    grid_.clear();
+    dirty_.clear();
+    next_id_ = 0;
+    has_origin_ = false;
+}
+
+void MemoryClusterIndex::Rebuild(const MemoryMap& memories) {
+    Clear();
+    for (const auto& [id, memory] : memories) {
+        Upsert(memory);
+    }
+}
+
+MemoryClusterIndex::ClusterID MemoryClusterIndex::ClusterOf(const std::string& id) const {
+    auto it = members_.find(id);
+    return it != members_.end() ? it->second.cluster : INVALID_CLUSTER;
+}
+
+std::vector<MemoryClusterIndex::ClusterID> MemoryClusterIndex::ClusterIDs() const {
+    std::vector<ClusterID> ids;
+    ids.reserve(clusters_.size());
+    for (const auto& [id, state] : clusters_) {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+const MemoryCluster* MemoryClusterIndex::Cluster(ClusterID id) const {
+    auto it = clusters_.find(id);
+    if (it == clusters_.end()) return nullptr;
+    const State& state = it->second;
+    if (!state.view_stale) return &state.view;
+
+    const double count = static_cast<double>(state.members.size());
+    MemoryCluster& view = state.view;
+    view.memory_ids = state.members;
+
+    // Sorted first, so every insert appends to the flat containers
+    std::vector<std::pair<SymbolID, double>> frequencies;
+    frequencies.reserve(state.traits.size());
+    for (const auto& [trait, sum] : state.traits) {
+        frequencies.emplace_back(trait, sum.sum / count);
+    }
+    std::sort(frequencies.begin(), frequencies.end());
+    view.trait_frequencies.clear();
+    view.trait_frequencies.reserve(frequencies.size());
+    for (const auto& [trait, frequency] : frequencies) {
+        view.trait_frequencies[trait] = frequency;
+    }
+
+    std::vector<SymbolID> common;
+    for (const auto& [tag, tagged] : state.tags) {
+        if (tagged == state.members.size()) common.push_back(tag);
+    }
+    std::sort(common.begin(), common.end());
+    view.common_tags.clear();
+    view.common_tags.reserve(common.size());
+    for (SymbolID tag : common) {
+        view.common_tags.insert(tag);
+    }
+
+    const ClusterDivergence divergence = Divergence(id);
+    view.emotional_theme = state.Centroid();
+    view.stability = 1.0 / (1.0 + divergence.emotional_divergence / config_.emotional_radius
+                                + divergence.trait_divergence);
+    view.last_accessed = state.latest;
+    state.view_stale = false;
+    return &view;
+}
+
+ClusterDivergence MemoryClusterIndex::Divergence(ClusterID id) const {
+    ClusterDivergence divergence{};
+    auto it = clusters_.find(id);
+    if (it == clusters_.end() || it->second.members.empty()) return divergence;
+    const State& state = it->second;
+    const double count = static_cast<double>(state.members.size());
+
+    auto deviation = [count](double sum, double squares) {
+        const double mean = sum / count;
+        return std::sqrt(std::max(squares / count - mean * mean, 0.0));
+    };
+    divergence.emotional_divergence = deviation(state.emotional_sum, state.emotional_squares);
+    divergence.temporal_divergence = deviation(state.hours_sum, state.hours_squares);
+
+    // Share of the members' trait energy not explained by the centroid:
+    // sum |v_i - mean|^2 / sum |v_i|^2
+    if (state.member_norm_squares > 0.0) {
+        const double explained = state.trait_sum_squares / count / state.member_norm_squares;
+        divergence.trait_divergence = std::clamp(1.0 - explained, 0.0, 1.0);
+    }
+
+    // Traits carried by fewer than half the members
+    for (const auto& [trait, sum] : state.traits) {
+        if (2 * sum.count < state.members.size()) {
+            divergence.diverging_traits.push_back(TraitName(trait));
+        }
+    }
+    std::sort(divergence.diverging_traits.begin(), divergence.diverging_traits.end());
+    divergence.divergence_point = state.latest;
+    return divergence;
+}
+
+ClusterSimilarity MemoryClusterIndex::Similarity(ClusterID a, ClusterID b) const {
+    ClusterSimilarity similarity{};
+    auto itA = clusters_.find(a);
+    auto itB = clusters_.find(b);
+    if (itA == clusters_.end() || itB == clusters_.end()) return similarity;
+    const State& first = itA->second;
+    const State& second = itB->second;
+
+    // Cosine of the trait sum vectors
+    if (first.traits.empty() && second.traits.empty()) {
+        similarity.trait_similarity = 1.0;
+    } else if (first.trait_sum_squares > 0.0 && second.trait_sum_squares > 0.0) {
+        const State& smaller = first.traits.size() <= second.traits.size() ? first : second;
+        const State& larger = &smaller == &first ? second : first;
+        double dot = 0.0;
+        for (const auto& [trait, sum] : smaller.traits) {
+            auto match = larger.traits.find(trait);
+            if (match != larger.traits.end()) dot += sum.sum * match->second.sum;
+        }
+        similarity.trait_similarity = dot / std::sqrt(first.trait_sum_squares * second.trait_sum_squares);
+    }
+
+    // Jaccard over the tags either cluster carries
+    if (first.tags.empty() && second.tags.empty()) {
+        similarity.tag_overlap = 1.0;
+    } else {
+        const auto& smaller = first.tags.size() <= second.tags.size() ? first.tags : second.tags;
+        const auto& larger = &smaller == &first.tags ? second.tags : first.tags;
+        size_t shared = 0;
+        for (const auto& [tag, count] : smaller) {
+            shared += larger.count(tag);
+        }
+        similarity.tag_overlap = static_cast<double>(shared) / (first.tags.size() + second.tags.size() - shared);
+    }
+
+    similarity.emotional_alignment = 1.0 - std::min(std::abs(first.Centroid() - second.Centroid()), 1.0);
+    const double hoursApart = std::abs(first.hours_sum / first.members.size()
+                                     - second.hours_sum / second.members.size());
+    similarity.temporal_proximity = std::exp(-hoursApart / 24.0);
+    similarity.overall_similarity = 0.4 * similarity.trait_similarity + 0.2 * similarity.tag_overlap
+                                  + 0.3 * similarity.emotional_alignment + 0.1 * similarity.temporal_proximity;
+    return similarity;
+}
+
+size_t MemoryClusterIndex::Maintain() {
+    std::vector<ClusterID> touched(dirty_.begin(), dirty_.end());
+    std::sort(touched.begin(), touched.end());
+    dirty_.clear();
+
+    // Clusters reshaped here are dirty again and get their turn next call
+    size_t changes = 0;
+    for (ClusterID id : touched) {
+        if (!clusters_.count(id)) continue;
+        if (Split(id) || MergeNeighbour(id)) ++changes;
+    }
+    return changes;
+}
+
+int64_t MemoryClusterIndex::BucketFor(double emotionalWeight) const {
+    return static_cast<int64_t>(std::floor(emotionalWeight / config_.emotional_radius));
+}
+
+uint64_t MemoryClusterIndex::CellFor(int64_t bucket, SymbolID trait) const {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(bucket)) << 32) | trait;
+}
+
+double MemoryClusterIndex::Hours(std::chrono::system_clock::time_point time) const {
+    return std::chrono::duration<double, std::ratio<3600>>(time - origin_).count();
+}
+
+double MemoryClusterIndex::TraitCosine(const ClusterFeatures& features, const State& state) const {
+    if (features.traits.empty()) return state.traits.empty() ? 1.0 : 0.0;
+    if (state.trait_sum_squares <= 0.0) return 0.0;
+
+    double dot = 0.0;
+    double norm = 0.0;
+    for (const auto& [trait, value] : features.traits) {
+        norm += value * value;
+        auto it = state.traits.find(trait);
+        if (it != state.traits.end()) dot += value * it->second.sum;
+    }
+    return norm > 0.0 ? dot / std::sqrt(norm * state.trait_sum_squares) : 0.0;
+}
+
+MemoryClusterIndex::ClusterID MemoryClusterIndex::FindCandidate(const ClusterFeatures& features) const {
+    // Probe the cells of the memory's strongest traits, or the no-trait cells
+    SymbolID probes[LOOKUP_TRAITS];
+    size_t probeCount = 0;
+    if (features.traits.empty()) {
+        probes[probeCount++] = NO_TRAIT;
+    } else {
+        std::vector<std::pair<SymbolID, double>> strongest(features.traits);
+        const size_t keep = std::min(LOOKUP_TRAITS, strongest.size());
+        std::partial_sort(strongest.begin(), strongest.begin() + keep, strongest.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+        for (size_t i = 0; i < keep; ++i) probes[probeCount++] = strongest[i].first;
+    }
+
+    const int64_t bucket = BucketFor(features.emotional_weight);
+    ClusterID best = INVALID_CLUSTER;
+    double bestScore = -std::numeric_limits<double>::infinity();
+    for (size_t p = 0; p < probeCount; ++p) {
+        for (int64_t b = bucket - 1; b <= bucket + 1; ++b) {
+            auto cell = grid_.find(CellFor(b, probes[p]));
+            if (cell == grid_.end()) continue;
+            for (ClusterID id : cell->second) {
+                const State& state = clusters_.at(id);
+                const double distance = std::abs(features.emotional_weight - state.Centroid());
+                if (distance > config_.emotional_radius) continue;
+                const double similarity = TraitCosine(features, state);
+                if (similarity < config_.min_trait_similarity) continue;
+
+                const double score = 0.5 * (1.0 - distance / config_.emotional_radius) + 0.5 * similarity;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = id;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+MemoryClusterIndex::ClusterID MemoryClusterIndex::NewCluster() {
+    const ClusterID id = next_id_++;
+    clusters_.try_emplace(id);
+    return id;
+}
+
+void MemoryClusterIndex::Attach(const std::string& id, Member& member, ClusterID cluster) {
+    State& state = clusters_.at(cluster);
+    member.cluster = cluster;
+    member.slot = state.members.size();
+    state.members.push_back(id);
+    Apply(state, member.features, +1);
+    Rekey(cluster, state);
+    dirty_.insert(cluster);
+}
+
+void MemoryClusterIndex::Detach(Member& member) {
+    const ClusterID cluster = member.cluster;
+    State& state = clusters_.at(cluster);
+
+    // Swap-remove from the member list
+    const std::string last = state.members.back();
+    state.members[member.slot] = last;
+    members_.at(last).slot = member.slot;
+    state.members.pop_back();
+    Apply(state, member.features, -1);
+    member.cluster = INVALID_CLUSTER;
+
+    if (state.members.empty()) {
+        Drop(cluster);
+    } else {
+        Rekey(cluster, state);
+        dirty_.insert(cluster);
+    }
+}
+
+void MemoryClusterIndex::Apply(State& state, const ClusterFeatures& features, int sign) {
+    const double w = features.emotional_weight;
+    const double hours = Hours(features.timestamp);
+    state.emotional_sum += sign * w;
+    state.emotional_squares += sign * w * w;
+    state.hours_sum += sign * hours;
+    state.hours_squares += sign * hours * hours;
+
+    bool dominantLost = false;
+    for (const auto& [trait, value] : features.traits) {
+        TraitSum& sum = state.traits[trait];
+        const double before = sum.sum;
+        sum.sum += sign * value;
+        sum.count += sign;
+        state.trait_sum_squares += sum.sum * sum.sum - before * before;
+        state.member_norm_squares += sign * value * value;
+
+        if (sign > 0) {
+            if (state.dominant == NO_TRAIT || sum.sum > state.traits.at(state.dominant).sum) {
+                state.dominant = trait;
+            }
+        } else if (trait == state.dominant) {
+            dominantLost = true;
+        }
+        if (sum.count == 0) {
+            state.trait_sum_squares -= sum.sum * sum.sum;
+            state.traits.erase(trait);
+        }
+    }
+    if (state.traits.empty()) {
+        state.trait_sum_squares = 0.0;
+        state.member_norm_squares = 0.0;
+        state.dominant = NO_TRAIT;
+    } else if (dominantLost) {
+        state.dominant = NO_TRAIT;
+        double strongest = -std::numeric_limits<double>::infinity();
+        for (const auto& [trait, sum] : state.traits) {
+            if (sum.sum > strongest || (sum.sum == strongest && trait < state.dominant)) {
+                strongest = sum.sum;
+                state.dominant = trait;
+            }
+        }
+    }
+
+    for (SymbolID tag : features.tags) {
+        if (sign > 0) {
+            ++state.tags[tag];
+        } else {
+            auto it = state.tags.find(tag);
+            if (it != state.tags.end() && --it->second == 0) state.tags.erase(it);
+        }
+    }
+
+    if (sign > 0) state.latest = std::max(state.latest, features.timestamp);
+    state.view_stale = true;
+}
+
+void MemoryClusterIndex::Rekey(ClusterID id, State& state) {
+    const uint64_t cell = CellFor(BucketFor(state.Centroid()), state.dominant);
+    if (state.linked && state.cell == cell) return;
+    if (state.linked) Unlink(id, state.cell);
+    grid_[cell].push_back(id);
+    state.cell = cell;
+    state.linked = true;
+}
+
+void MemoryClusterIndex::Unlink(ClusterID id, uint64_t cell) {
+    auto it = grid_.find(cell);
+    if (it == grid_.end()) return;
+    auto& ids = it->second;
+    auto pos = std::find(ids.begin(), ids.end(), id);
+    if (pos != ids.end()) {
+        *pos = ids.back();
+        ids.pop_back();
+    }
+    if (ids.empty()) grid_.erase(it);
+}
+
+void MemoryClusterIndex::Drop(ClusterID id) {
+    auto it = clusters_.find(id);
+    if (it == clusters_.end()) return;
+    if (it->second.linked) Unlink(id, it->second.cell);
+    clusters_.erase(it);
+    dirty_.erase(id);
+}
+
+bool MemoryClusterIndex::Split(ClusterID id) {
+    const State& state = clusters_.at(id);
+    if (state.members.size() < config_.min_split_size) return false;
+
+    // Cut along whichever axis diverges: emotional weight about the
+    // centroid, or membership of the dominant trait
+    const ClusterDivergence divergence = Divergence(id);
+    const double centroid = state.Centroid();
+    const SymbolID dominant = state.dominant;
+    const bool emotional = divergence.emotional_divergence > config_.split_emotional;
+    if (!emotional && divergence.trait_divergence <= config_.split_trait) return false;
+
+    std::vector<std::string> moving;
+    for (const auto& memberID : state.members) {
+        const ClusterFeatures& features = members_.at(memberID).features;
+        const bool move = emotional
+            ? features.emotional_weight > centroid
+            : !std::binary_search(features.traits.begin(), features.traits.end(), std::make_pair(dominant, 0.0),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        if (move) moving.push_back(memberID);
+    }
+    if (moving.empty() || moving.size() == state.members.size()) return false;
+
+    const ClusterID split = NewCluster();
+    for (const auto& memberID : moving) {
+        auto it = members_.find(memberID);
+        Detach(it->second);
+        Attach(it->first, it->second, split);
+    }
+    return true;
+}
+
+bool MemoryClusterIndex::MergeNeighbour(ClusterID id) {
+    const State& state = clusters_.at(id);
+    const double centroid = state.Centroid();
+    const int64_t bucket = BucketFor(centroid);
+
+    ClusterID best = INVALID_CLUSTER;
+    double bestSimilarity = config_.merge_similarity;
+    for (int64_t b = bucket - 1; b <= bucket + 1; ++b) {
+        auto cell = grid_.find(CellFor(b, state.dominant));
+        if (cell == grid_.end()) continue;
+        for (ClusterID other : cell->second) {
+            if (other == id) continue;
+            if (std::abs(clusters_.at(other).Centroid() - centroid) > config_.emotional_radius) continue;
+            const double similarity = Similarity(id, other).overall_similarity;
+            if (similarity >= bestSimilarity) {
+                bestSimilarity = similarity;
+                best = other;
+            }
+        }
+    }
+    if (best == INVALID_CLUSTER) return false;
+
+    // The smaller cluster moves into the larger one
+    ClusterID from = id;
+    ClusterID to = best;
+    if (clusters_.at(from).members.size() > clusters_.at(to).members.size()) std::swap(from, to);
+    const std::vector<std::string> moving = clusters_.at(from).members;
+    for (const auto& memberID : moving) {
+        auto it = members_.find(memberID);
+        Detach(it->second);
+        Attach(it->first, it->second, to);
+    }
+    return true;
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "memory_pool.hpp"
+#include "memory_types.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+
+struct ClusterConfig {
+    double emotional_radius = 0.1;        // join distance from a centroid; also the grid cell width
+    double min_trait_similarity = 0.3;    // cosine of a memory's traits against the centroid's
+    double split_emotional = 0.1;         // emotional stddev above which a cluster splits
+    double split_trait = 0.6;             // trait divergence above which a cluster splits
+    double merge_similarity = 0.85;       // overall similarity at which neighbours merge
+    size_t min_split_size = 4;
+};
+
+// What clustering reads from a memory, in either memory layout
+struct ClusterFeatures {
+    std::vector<std::pair<SymbolID, double>> traits;    // sorted by ID
+    std::vector<SymbolID> tags;                         // sorted
+    double emotional_weight = 0.0;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+// Online clustering keyed by memory ID. A memory joins the best cluster
+// among those in neighbouring grid cells (emotional weight bucket by
+// dominant trait), so assignment looks at a handful of candidates instead
+// of every cluster. Centroids, trait frequencies and tag counts are kept as
+// running sums; Maintain splits and merges only clusters touched since the
+// last call.
+class MemoryClusterIndex {
+public:
+    using ClusterID = uint32_t;
+    static constexpr ClusterID INVALID_CLUSTER = UINT32_MAX;
+
+    explicit MemoryClusterIndex(const ClusterConfig& config = {});
+
+    // Place or re-place one memory; returns its cluster
+    ClusterID Upsert(const std::string& id, ClusterFeatures features);
+    ClusterID Upsert(const MemoryEvent& memory);
+    void Remove(const std::string& id);
+    void Clear();
+    void Rebuild(const MemoryMap& memories);
+
+    size_t Size() const { return members_.size(); }
+    size_t ClusterCount() const { return clusters_.size(); }
+
+    // Split and merge the clusters touched since the last call; returns the
+    // number of splits plus merges
+    size_t Maintain();
+
+    ClusterID ClusterOf(const std::string& id) const;
+    // Null for an unknown cluster; the view is refreshed on read
+    const MemoryCluster* Cluster(ClusterID id) const;
+    std::vector<ClusterID> ClusterIDs() const;
+
+    ClusterDivergence Divergence(ClusterID id) const;
+    ClusterSimilarity Similarity(ClusterID a, ClusterID b) const;
+
+    static ClusterFeatures Extract(const MemoryEvent& memory);
+
+private:
+    static constexpr SymbolID NO_TRAIT = UINT32_MAX;
+    static constexpr size_t LOOKUP_TRAITS = 3;    // strongest memory traits probed in the grid
+
+    struct TraitSum {
+        double sum = 0.0;
+        uint32_t count = 0;
+    };
+
+    struct State {
+        std::vector<std::string> members;
+        double emotional_sum = 0.0;
+        double emotional_squares = 0.0;
+        double hours_sum = 0.0;
+        double hours_squares = 0.0;
+        std::unordered_map<SymbolID, TraitSum> traits;
+        double trait_sum_squares = 0.0;       // sum over traits of sum^2
+        double member_norm_squares = 0.0;     // sum over members of |traits|^2
+        std::unordered_map<SymbolID, uint32_t> tags;
+        std::chrono::system_clock::time_point latest{};
+        SymbolID dominant = NO_TRAIT;
+        uint64_t cell = 0;
+        bool linked = false;    // listed in grid_ under cell
+
+        mutable MemoryCluster view;
+        mutable bool view_stale = true;
+
+        double Centroid() const { return members.empty() ? 0.0 : emotional_sum / members.size(); }
+    };
+
+    struct Member {
+        ClusterID cluster = INVALID_CLUSTER;
+        size_t slot = 0;    // position in the cluster's member list
+        ClusterFeatures features;
+    };
+
+    uint64_t CellFor(int64_t bucket, SymbolID trait) const;
+    int64_t BucketFor(double emotionalWeight) const;
+    double Hours(std::chrono::system_clock::time_point time) const;
+    ClusterID FindCandidate(const ClusterFeatures& features) const;
+    double TraitCosine(const ClusterFeatures& features, const State& state) const;
+
+    ClusterID NewCluster();
+    void Attach(const std::string& id, Member& member, ClusterID cluster);
+    void Detach(Member& member);
+    void Apply(State& state, const ClusterFeatures& features, int sign);
+    void Rekey(ClusterID id, State& state);
+    void Unlink(ClusterID id, uint64_t cell);
+    void Drop(ClusterID id);
+
+    bool Split(ClusterID id);
+    bool MergeNeighbour(ClusterID id);
+
+    ClusterConfig config_;
+    std::unordered_map<std::string, Member> members_;
+    std::unordered_map<ClusterID, State> clusters_;
+    std::unordered_map<uint64_t, std::vector<ClusterID>> grid_;
+    std::unordered_set<ClusterID> dirty_;
+    ClusterID next_id_ = 0;
+    // Timestamps are summed relative to the first one seen, for precision
+    std::chrono::system_clock::time_point origin_{};
+    bool has_origin_ = false;
+};
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,393 @@
+#include "memory_codec.hpp"
+#include "emotion_schema.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace shandris {
+namespace cognitive {
+namespace codec {
+
+namespace {
+
+constexpr size_t DOUBLE_BYTES = sizeof(uint64_t);
+
+void WriteTraits(Writer& writer, const TraitInfluenceMap& traits) {
+    writer.Varint(traits.size());
+    for (const auto& [trait, value] : traits) {
+        writer.Symbol(SymbolKind::Trait, trait);
+        writer.Double(value);
+    }
+}
+
+void ReadTraits(Reader& reader, TraitInfluenceMap& traits) {
+    traits.clear();
+    const size_t count = reader.Count(1 + DOUBLE_BYTES);
+    traits.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const SymbolID trait = reader.Symbol(SymbolKind::Trait);
+        traits[trait] = reader.Double();
+    }
+}
+
+template<SymbolKind Kind>
+void WriteSymbols(Writer& writer, const SymbolSet<Kind>& symbols) {
+    writer.Varint(symbols.size());
+    for (SymbolID id : symbols) {
+        writer.Symbol(Kind, id);
+    }
+}
+
+template<SymbolKind Kind>
+void ReadSymbols(Reader& reader, SymbolSet<Kind>& symbols) {
+    symbols.clear();
+    const size_t count = reader.Count();
+    symbols.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        symbols.insert(reader.Symbol(Kind));
+    }
+}
+
+void WriteStrings(Writer& writer, const std::vector<std::string>& values) {
+    writer.Varint(values.size());
+    for (const auto& value : values) {
+        writer.String(value);
+    }
+}
+
+void ReadStrings(Reader& reader, std::vector<std::string>& values) {
+    values.resize(reader.Count());
+    for (auto& value : values) {
+        value = reader.String();
+    }
+}
+
+void WriteDoubles(Writer& writer, const std::vector<double>& values) {
+    writer.Varint(values.size());
+    for (double value : values) {
+        writer.Double(value);
+    }
+}
+
+void ReadDoubles(Reader& reader, std::vector<double>& values) {
+    values.resize(reader.Count(DOUBLE_BYTES));
+    for (double& value : values) {
+        value = reader.Double();
+    }
+}
+
+// Rows written before the binary form hold JSON text
+template<typename T>
+bool DecodeLegacy(std::string_view bytes, T& value) {
+    if (IsBinary(bytes)) return false;
+    nlohmann::json::parse(bytes.begin(), bytes.end()).get_to(value);
+    return true;
+}
+
+} // namespace
+
+Writer::Writer(RecordKind kind) {
+    bytes_.push_back(static_cast<char>(MAGIC));
+    Varint(VERSION);
+    bytes_.push_back(static_cast<char>(kind));
+}
+
+void Writer::Varint(uint64_t value) {
+    while (value >= 0x80) {
+        bytes_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bytes_.push_back(static_cast<char>(value));
+}
+
+void Writer::Signed(int64_t value) {
+    // Zigzag, so small negative values stay short
+    Varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void Writer::Double(double value) {
+    const uint64_t bits = std::bit_cast<uint64_t>(value);
+    for (size_t i = 0; i < DOUBLE_BYTES; ++i) {
+        bytes_.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+    }
+}
+
+void Writer::String(std::string_view value) {
+    Varint(value.size());
+    bytes_.append(value);
+}
+
+void Writer::Time(std::chrono::system_clock::time_point time) {
+    Signed(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+void Writer::Symbol(SymbolKind kind, SymbolID id) {
+    String(SymbolTable::Global().Name(kind, id));
+}
+
+Reader::Reader(std::string_view bytes, RecordKind kind) : bytes_(bytes) {
+    if (!IsBinary(bytes_)) {
+        throw std::runtime_error("codec: not a binary value");
+    }
+    position_ = 1;
+    const uint64_t version = Varint();
+    if (version == 0 || version > VERSION) {
+        throw std::runtime_error("codec: unsupported schema version " + std::to_string(version));
+    }
+    version_ = static_cast<uint32_t>(version);
+    Require(1);
+    if (static_cast<uint8_t>(bytes_[position_++]) != static_cast<uint8_t>(kind)) {
+        throw std::runtime_error("codec: unexpected record kind");
+    }
+}
+
+void Reader::Require(size_t bytes) const {
+    if (bytes > bytes_.size() - position_) {
+        throw std::runtime_error("codec: truncated value");
+    }
+}
+
+void Reader::Finish() const {
+    if (!AtEnd()) {
+        throw std::runtime_error("codec: trailing bytes");
+    }
+}
+
+uint64_t Reader::Varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        Require(1);
+        const auto byte = static_cast<uint8_t>(bytes_[position_++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("codec: varint too long");
+}
+
+int64_t Reader::Signed() {
+    const uint64_t value = Varint();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+double Reader::Double() {
+    Require(DOUBLE_BYTES);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < DOUBLE_BYTES; ++i) {
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(bytes_[position_++])) << (8 * i);
+    }
+    return std::bit_cast<double>(bits);
+}
+
+std::string Reader::String() {
+    const size_t length = Count();
+    std::string value(bytes_.substr(position_, length));
+    position_ += length;
+    return value;
+}
+
+std::chrono::system_clock::time_point Reader::Time() {
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(Signed())));
+}
+
+SymbolID Reader::Symbol(SymbolKind kind) {
+    return SymbolTable::Global().Intern(kind, String());
+}
+
+size_t Reader::Count(size_t minBytes) {
+    const uint64_t count = Varint();
+    if (count > (bytes_.size() - position_) / std::max<size_t>(minBytes, 1)) {
+        throw std::runtime_error("codec: truncated value");
+    }
+    return static_cast<size_t>(count);
+}
+
+std::string EncodeTraitInfluences(const TraitInfluenceMap& influences, ColumnEncoding encoding) {
+    if (encoding == ColumnEncoding::Json) {
+        return nlohmann::json(influences).dump();
+    }
+    Writer writer(RecordKind::TraitInfluences);
+    WriteTraits(writer, influences);
+    return writer.Take();
+}
+
+std::string EncodeTags(const TagSet& tags, ColumnEncoding encoding) {
+    if (encoding == ColumnEncoding::Json) {
+        return nlohmann::json(tags).dump();
+    }
+    Writer writer(RecordKind::Tags);
+    WriteSymbols(writer, tags);
+    return writer.Take();
+}
+
+TraitInfluenceMap DecodeTraitInfluences(std::string_view column) {
+    TraitInfluenceMap influences;
+    if (column.empty() || DecodeLegacy(column, influences)) return influences;
+    Reader reader(column, RecordKind::TraitInfluences);
+    ReadTraits(reader, influences);
+    reader.Finish();
+    return influences;
+}
+
+TagSet DecodeTags(std::string_view column) {
+    TagSet tags;
+    if (column.empty() || DecodeLegacy(column, tags)) return tags;
+    Reader reader(column, RecordKind::Tags);
+    ReadSymbols(reader, tags);
+    reader.Finish();
+    return tags;
+}
+
+std::string Encode(const MemoryEvent& memory) {
+    Writer writer(RecordKind::MemoryEvent);
+    writer.String(memory.id);
+    writer.String(memory.content);
+    writer.String(memory.context);
+    writer.Double(memory.importance);
+    writer.Double(memory.emotional_weight);
+    WriteTraits(writer, memory.trait_influences);
+    WriteSymbols(writer, memory.tags);
+    writer.Time(memory.created_at);
+    writer.Time(memory.updated_at);
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, MemoryEvent& memory) {
+    if (DecodeLegacy(bytes, memory)) return;
+    Reader reader(bytes, RecordKind::MemoryEvent);
+    memory.id = reader.String();
+    memory.content = reader.String();
+    memory.context = reader.String();
+    memory.importance = reader.Double();
+    memory.emotional_weight = reader.Double();
+    ReadTraits(reader, memory.trait_influences);
+    ReadSymbols(reader, memory.tags);
+    memory.created_at = reader.Time();
+    memory.updated_at = reader.Time();
+    reader.Finish();
+}
+
+std::string Encode(const EmotionalState& state) {
+    Writer writer(RecordKind::EmotionalState);
+    writer.String(state.id);
+    for (double value : EmotionsOf(state).values) {
+        writer.Double(value);
+    }
+    writer.Time(state.timestamp);
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, EmotionalState& state) {
+    if (DecodeLegacy(bytes, state)) return;
+    Reader reader(bytes, RecordKind::EmotionalState);
+    state.id = reader.String();
+    EmotionVector emotions;
+    for (double& value : emotions.values) {
+        value = reader.Double();
+    }
+    SetEmotions(state, emotions);
+    state.timestamp = reader.Time();
+    reader.Finish();
+}
+
+std::string Encode(const MemoryCluster& cluster) {
+    Writer writer(RecordKind::MemoryCluster);
+    WriteStrings(writer, cluster.memory_ids);
+    WriteTraits(writer, cluster.trait_frequencies);
+    WriteSymbols(writer, cluster.common_tags);
+    writer.Double(cluster.emotional_theme);
+    writer.Double(cluster.stability);
+    writer.Time(cluster.last_accessed);
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, MemoryCluster& cluster) {
+    if (DecodeLegacy(bytes, cluster)) return;
+    Reader reader(bytes, RecordKind::MemoryCluster);
+    ReadStrings(reader, cluster.memory_ids);
+    ReadTraits(reader, cluster.trait_frequencies);
+    ReadSymbols(reader, cluster.common_tags);
+    cluster.emotional_theme = reader.Double();
+    cluster.stability = reader.Double();
+    cluster.last_accessed = reader.Time();
+    reader.Finish();
+}
+
+std::string Encode(const SapphicTraits& traits) {
+    Writer writer(RecordKind::SapphicTraits);
+    writer.String(traits.id);
+    for (double value : TraitsOf(traits).values) {
+        writer.Double(value);
+    }
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, SapphicTraits& traits) {
+    if (DecodeLegacy(bytes, traits)) return;
+    Reader reader(bytes, RecordKind::SapphicTraits);
+    traits.id = reader.String();
+    SapphicTraitVector values;
+    for (double& value : values.values) {
+        value = reader.Double();
+    }
+    SetTraits(traits, values);
+    reader.Finish();
+}
+
+std::string Encode(const TraitTrendAnalysis& analysis) {
+    Writer writer(RecordKind::TraitTrendAnalysis);
+    for (double value : {analysis.short_term_slope, analysis.long_term_slope, analysis.acceleration,
+                         analysis.volatility, analysis.seasonality, analysis.cyclicality}) {
+        writer.Double(value);
+    }
+    WriteDoubles(writer, analysis.moving_averages);
+    WriteDoubles(writer, analysis.seasonal_components);
+    writer.Time(analysis.last_analysis);
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, TraitTrendAnalysis& analysis) {
+    if (DecodeLegacy(bytes, analysis)) return;
+    Reader reader(bytes, RecordKind::TraitTrendAnalysis);
+    for (double* value : {&analysis.short_term_slope, &analysis.long_term_slope, &analysis.acceleration,
+                          &analysis.volatility, &analysis.seasonality, &analysis.cyclicality}) {
+        *value = reader.Double();
+    }
+    ReadDoubles(reader, analysis.moving_averages);
+    ReadDoubles(reader, analysis.seasonal_components);
+    analysis.last_analysis = reader.Time();
+    reader.Finish();
+}
+
+std::string Encode(const TraitInteraction& interaction) {
+    Writer writer(RecordKind::TraitInteraction);
+    writer.Symbol(SymbolKind::Trait, interaction.source_trait);
+    writer.Symbol(SymbolKind::Trait, interaction.target_trait);
+    writer.Double(interaction.influence_strength);
+    writer.Double(interaction.temporal_correlation);
+    writer.Double(interaction.emotional_correlation);
+    WriteStrings(writer, interaction.shared_memories);
+    WriteSymbols(writer, interaction.shared_triggers);
+    writer.Time(interaction.last_interaction);
+    return writer.Take();
+}
+
+void Decode(std::string_view bytes, TraitInteraction& interaction) {
+    if (DecodeLegacy(bytes, interaction)) return;
+    Reader reader(bytes, RecordKind::TraitInteraction);
+    interaction.source_trait = reader.Symbol(SymbolKind::Trait);
+    interaction.target_trait = reader.Symbol(SymbolKind::Trait);
+    interaction.influence_strength = reader.Double();
+    interaction.temporal_correlation = reader.Double();
+    interaction.emotional_correlation = reader.Double();
+    ReadStrings(reader, interaction.shared_memories);
+    ReadSymbols(reader, interaction.shared_triggers);
+    interaction.last_interaction = reader.Time();
+    reader.Finish();
+}
+
+} // namespace codec
+} // namespace cognitive
+} // namespace shandris
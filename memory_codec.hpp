@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "memory_types.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+struct EmotionalState;
+struct SapphicTraits;
+
+// Compact binary encoding for stored columns and records, as an
+// alternative to JSON text. A value starts with MAGIC, the schema version
+// and the kind of record, followed by varint counts and lengths,
+// zigzag-varint timestamps (nanoseconds since the epoch) and little-endian
+// doubles. Interned IDs are not stable across runs, so symbols are written
+// by name, once per value.
+//
+// Every Decode also accepts the JSON text the same value used to be stored
+// as, so existing rows load unchanged and are rewritten in the binary form
+// when next saved. Malformed input throws: std::runtime_error for binary
+// values, the nlohmann::json exceptions for JSON text.
+namespace codec {
+
+inline constexpr uint8_t MAGIC = 0xC5;    // never the first byte of JSON text
+inline constexpr uint32_t VERSION = 1;
+
+enum class ColumnEncoding { Json, Binary };
+
+enum class RecordKind : uint8_t {
+    TraitInfluences = 1,
+    Tags,
+    MemoryEvent,
+    EmotionalState,
+    MemoryCluster,
+    SapphicTraits,
+    TraitTrendAnalysis,
+    TraitInteraction
+};
+
+class Writer {
+public:
+    explicit Writer(RecordKind kind);
+
+    void Varint(uint64_t value);
+    void Signed(int64_t value);
+    void Double(double value);
+    void String(std::string_view value);
+    void Time(std::chrono::system_clock::time_point time);
+    void Symbol(SymbolKind kind, SymbolID id);
+
+    const std::string& Bytes() const { return bytes_; }
+    std::string Take() { return std::move(bytes_); }
+
+private:
+    std::string bytes_;
+};
+
+// Reads one value; the constructor checks the header and throws on a
+// wrong kind or a version newer than this build knows
+class Reader {
+public:
+    Reader(std::string_view bytes, RecordKind kind);
+
+    // Schema version the value was written with, for migrating older layouts
+    uint32_t Version() const { return version_; }
+    bool AtEnd() const { return position_ == bytes_.size(); }
+    // Throws if anything is left over
+    void Finish() const;
+
+    uint64_t Varint();
+    int64_t Signed();
+    double Double();
+    std::string String();
+    std::chrono::system_clock::time_point Time();
+    SymbolID Symbol(SymbolKind kind);
+    // A count of entries that each take at least minBytes, checked against
+    // what is left so corrupt input cannot request a huge allocation
+    size_t Count(size_t minBytes = 1);
+
+private:
+    void Require(size_t bytes) const;
+
+    std::string_view bytes_;
+    size_t position_ = 0;
+    uint32_t version_ = 0;
+};
+
+// Whether a stored value is in the binary form rather than legacy JSON
+inline bool IsBinary(std::string_view bytes) {
+    return !bytes.empty() && static_cast<uint8_t>(bytes.front()) == MAGIC;
+}
+
+// Column values for the memories table
+std::string EncodeTraitInfluences(const TraitInfluenceMap& influences, ColumnEncoding encoding);
+std::string EncodeTags(const TagSet& tags, ColumnEncoding encoding);
+TraitInfluenceMap DecodeTraitInfluences(std::string_view column);
+TagSet DecodeTags(std::string_view column);
+
+// Whole records, always binary
+std::string Encode(const MemoryEvent& memory);
+std::string Encode(const EmotionalState& state);
+std::string Encode(const MemoryCluster& cluster);
+std::string Encode(const SapphicTraits& traits);
+std::string Encode(const TraitTrendAnalysis& analysis);
+std::string Encode(const TraitInteraction& interaction);
+
+void Decode(std::string_view bytes, MemoryEvent& memory);
+void Decode(std::string_view bytes, EmotionalState& state);
+void Decode(std::string_view bytes, MemoryCluster& cluster);
+void Decode(std::string_view bytes, SapphicTraits& traits);
+void Decode(std::string_view bytes, TraitTrendAnalysis& analysis);
+void Decode(std::string_view bytes, TraitInteraction& interaction);
+
+} // namespace codec
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,100 @@
+#include "memory_loader.hpp"
+#include "memory.hpp"
+#include "memory_codec.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace shandris {
+namespace cognitive {
+
+BulkMemoryLoader::BulkMemoryLoader(std::shared_ptr<database::Database> db, size_t batchSize)
+    : db_(std::move(db)), batch_size_(std::max<size_t>(batchSize, 1)) {}
+
+size_t BulkMemoryLoader::LoadMemories(const BatchHandler& onBatch, std::optional<int64_t> updatedSince) {
+    std::string filter;
+    std::vector<std::string> params;
+    if (updatedSince) {
+        filter = " WHERE updated_at >= ?";
+        params.push_back(std::to_string(*updatedSince));
+    }
+
+    // One set-based query over the same columns WriteBehindStore writes
+    auto memories = db_->Query(
+        "SELECT id, content, context, importance, emotional_weight, trait_influences, tags, "
+        "created_at, updated_at FROM memories" + filter + " ORDER BY id", params);
+
+    std::vector<MemoryEvent> batch;
+    batch.reserve(batch_size_);
+    size_t loaded = 0;
+
+    while (memories->Next()) {
+        MemoryEvent memory;
+        memory.id = memories->GetString(0);
+        memory.content = memories->GetString(1);
+        memory.context = memories->GetString(2);
+        memory.importance = memories->GetDouble(3);
+        memory.emotional_weight = memories->GetDouble(4);
+        // As bytes: the column holds a BLOB for binary rows, TEXT for JSON ones
+        memory.trait_influences = codec::DecodeTraitInfluences(memories->GetBlob(5));
+        memory.tags = codec::DecodeTags(memories->GetBlob(6));
+        memory.created_at = std::chrono::system_clock::from_time_t(memories->GetInt64(7));
+        memory.updated_at = std::chrono::system_clock::from_time_t(memories->GetInt64(8));
+
+        batch.push_back(std::move(memory));
+        ++loaded;
+        if (batch.size() >= batch_size_) {
+            onBatch(batch);
+            batch.clear();
+        }
+    }
+
+    if (!batch.empty()) {
+        onBatch(batch);
+    }
+    return loaded;
+}
+
+std::vector<std::string> BulkMemoryLoader::LoadIDs(const std::string& table) {
+    std::vector<std::string> ids;
+    auto results = db_->Query("SELECT id FROM " + table + " ORDER BY id");
+    while (results->Next()) {
+        ids.push_back(results->GetString(0));
+    }
+    return ids;
+}
+
+size_t BulkMemoryLoader::LoadEmotionalStates(std::map<std::string, EmotionalState>& states,
+                                             std::optional<int64_t> updatedSince) {
+    std::string filter;
+    std::vector<std::string> params;
+    if (updatedSince) {
+        filter = " WHERE timestamp >= ?";
+        params.push_back(std::to_string(*updatedSince));
+    }
+
+    auto results = db_->Query(
+        "SELECT id, happiness, sadness, anger, fear, surprise, disgust, trust, anticipation, timestamp "
+        "FROM emotional_states" + filter, params);
+
+    size_t loaded = 0;
+    while (results->Next()) {
+        EmotionalState state;
+        state.id = results->GetString(0);
+        state.happiness = results->GetDouble(1);
+        state.sadness = results->GetDouble(2);
+        state.anger = results->GetDouble(3);
+        state.fear = results->GetDouble(4);
+        state.surprise = results->GetDouble(5);
+        state.disgust = results->GetDouble(6);
+        state.trust = results->GetDouble(7);
+        state.anticipation = results->GetDouble(8);
+        state.timestamp = std::chrono::system_clock::from_time_t(results->GetInt64(9));
+
+        states[state.id] = std::move(state);
+        ++loaded;
+    }
+    return loaded;
+}
+
+} // namespace cognitive
+} // namespace shandris
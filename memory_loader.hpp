@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/database.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+struct EmotionalState;
+
+struct LoadProgress {
+    size_t memories_loaded = 0;
+    bool complete = false;  // set once the index is built and the manager can serve
+};
+
+using LoadProgressCallback = std::function<void(const LoadProgress&)>;
+
+// Cold-start loader for MemoryManager::LoadFromDatabase. Memories come from
+// a single query ordered by ID, with tags and trait influences decoded from
+// the columns WriteBehindStore writes, so the number of round trips is
+// fixed no matter how many memories a persona has.
+class BulkMemoryLoader {
+public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = 4096;
+
+    using BatchHandler = std::function<void(std::vector<MemoryEvent>& batch)>;
+
+    explicit BulkMemoryLoader(std::shared_ptr<database::Database> db,
+                              size_t batchSize = DEFAULT_BATCH_SIZE);
+
+    // Hands fully assembled memories to onBatch in ID order, batchSize at a
+    // time. With updatedSince (unix seconds) only rows changed in or after that
+    // second are read, for replaying the log over a snapshot. Returns the number of
+    // memories loaded.
+    size_t LoadMemories(const BatchHandler& onBatch, std::optional<int64_t> updatedSince = std::nullopt);
+    // updatedSince here compares against the state's own timestamp
+    size_t LoadEmotionalStates(std::map<std::string, EmotionalState>& states,
+                               std::optional<int64_t> updatedSince = std::nullopt);
+    // Every ID stored in table ("memories" or "emotional_states"), ascending
+    std::vector<std::string> LoadIDs(const std::string& table);
+
+private:
+    std::shared_ptr<database::Database> db_;
+    size_t batch_size_;
+};
+
+} // namespace cognitive
+} // namespace shandris
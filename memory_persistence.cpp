@@ -0,0 +1,475 @@
+#include "memory_persistence.hpp"
+#include "memory.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+int64_t ToUnixSeconds(std::chrono::system_clock::time_point time) {
+    return static_cast<int64_t>(std::chrono::system_clock::to_time_t(time));
+}
+
+// Payload bytes sent for one bound parameter
+size_t BoundBytes(const SqlValue& value) {
+    if (const auto* text = std::get_if<std::string>(&value)) return text->size();
+    if (const auto* blob = std::get_if<SqlBlob>(&value)) return blob->bytes.size();
+    return sizeof(int64_t);
+}
+
+SqlValue FeatureColumn(std::string encoded, codec::ColumnEncoding encoding) {
+    if (encoding == codec::ColumnEncoding::Binary) return SqlBlob{std::move(encoded)};
+    return encoded;
+}
+
+SqlRow MemoryRow(const MemoryEvent& memory, codec::ColumnEncoding encoding) {
+    return {
+        memory.id,
+        memory.content,
+        memory.context,
+        memory.importance,
+        memory.emotional_weight,
+        FeatureColumn(codec::EncodeTraitInfluences(memory.trait_influences, encoding), encoding),
+        FeatureColumn(codec::EncodeTags(memory.tags, encoding), encoding),
+        ToUnixSeconds(memory.created_at),
+        ToUnixSeconds(memory.updated_at)
+    };
+}
+
+SqlRow EmotionalStateRow(const EmotionalState& state) {
+    return {
+        state.id,
+        state.happiness,
+        state.sadness,
+        state.anger,
+        state.fear,
+        state.surprise,
+        state.disgust,
+        state.trust,
+        state.anticipation,
+        ToUnixSeconds(state.timestamp)
+    };
+}
+
+struct StoreMetrics {
+    Histogram flush;
+    Counter roundTrips;
+    Counter rows;
+    Counter bytes;
+    Counter failedFlushes;
+    Counter deadLetters;
+};
+
+const StoreMetrics& Metrics() {
+    static const StoreMetrics METRICS = [] {
+        auto& registry = MetricsRegistry::Global();
+        StoreMetrics metrics;
+        metrics.flush = registry.GetHistogram("shandris_db_flush_seconds", {}, "Write-behind flush latency");
+        metrics.roundTrips = registry.GetCounter("shandris_db_round_trips_total", "source=\"write_behind\"",
+                                                 "Statements executed against the database");
+        metrics.rows = registry.GetCounter("shandris_db_rows_written_total", {}, "Rows upserted or deleted");
+        metrics.bytes = registry.GetCounter("shandris_db_bytes_written_total", {}, "Bound parameter bytes sent");
+        metrics.failedFlushes = registry.GetCounter("shandris_db_flush_failures_total", {}, "Flushes rolled back");
+        metrics.deadLetters = registry.GetCounter("shandris_db_dead_letters_total", {},
+                                                  "Rows dropped after failing on their own");
+        return metrics;
+    }();
+    return METRICS;
+}
+
+} // namespace
+
+const WriteBehindStore::TableSchema WriteBehindStore::MEMORY_SCHEMA{
+    "memories",
+    {"id", "content", "context", "importance", "emotional_weight",
+     "trait_influences", "tags", "created_at", "updated_at"},
+    {"created_at"}
+};
+
+const WriteBehindStore::TableSchema WriteBehindStore::EMOTIONAL_STATE_SCHEMA{
+    "emotional_states",
+    {"id", "happiness", "sadness", "anger", "fear", "surprise",
+     "disgust", "trust", "anticipation", "timestamp"},
+    {}
+};
+
+WriteBehindStore::WriteBehindStore(std::shared_ptr<database::Database> db)
+    : WriteBehindStore(std::move(db), Config{}) {}
+
+WriteBehindStore::WriteBehindStore(std::shared_ptr<database::Database> db, const Config& config)
+    : db_(std::move(db)), config_(config) {
+    config_.max_rows_per_statement = std::max<size_t>(config_.max_rows_per_statement, 1);
+    config_.max_failed_flushes = std::max<size_t>(config_.max_failed_flushes, 1);
+}
+
+WriteBehindStore::~WriteBehindStore() {
+    try {
+        if (HasPending() && !Flush()) {
+            std::cerr << "Dropping " << PendingCount() << " unsaved rows" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error flushing pending writes: " << e.what() << std::endl;
+    }
+}
+
+void WriteBehindStore::UpsertMemory(const MemoryEvent& memory) {
+    Enqueue(memories_, memory.id, MemoryRow(memory, config_.column_encoding));
+}
+
+bool WriteBehindStore::UpdateMemory(const MemoryEvent& memory) {
+    return EnqueueUpdate(memories_, memory.id, MemoryRow(memory, config_.column_encoding));
+}
+
+void WriteBehindStore::DeleteMemory(const std::string& id) {
+    EnqueueDelete(memories_, id);
+}
+
+WriteBehindStore::PendingWrite WriteBehindStore::PendingMemory(const std::string& id) const {
+    return Pending(memories_, id);
+}
+
+void WriteBehindStore::UpsertEmotionalState(const EmotionalState& state) {
+    Enqueue(emotional_states_, state.id, EmotionalStateRow(state));
+}
+
+bool WriteBehindStore::UpdateEmotionalState(const EmotionalState& state) {
+    return EnqueueUpdate(emotional_states_, state.id, EmotionalStateRow(state));
+}
+
+void WriteBehindStore::DeleteEmotionalState(const std::string& id) {
+    EnqueueDelete(emotional_states_, id);
+}
+
+WriteBehindStore::PendingWrite WriteBehindStore::PendingEmotionalState(const std::string& id) const {
+    return Pending(emotional_states_, id);
+}
+
+WriteBehindStore::PendingWrite WriteBehindStore::Pending(const PendingTable& table, const std::string& id) {
+    if (table.deletes.count(id)) return PendingWrite::Delete;
+    if (table.upserts.count(id)) return PendingWrite::Upsert;
+    if (table.updates.count(id)) return PendingWrite::Update;
+    return PendingWrite::None;
+}
+
+size_t WriteBehindStore::PendingCount() const {
+    return memories_.upserts.size() + memories_.updates.size() + memories_.deletes.size() +
+           emotional_states_.upserts.size() + emotional_states_.updates.size() +
+           emotional_states_.deletes.size();
+}
+
+void WriteBehindStore::Enqueue(PendingTable& table, const std::string& id, SqlRow row) {
+    MarkPending();
+    // Latest write for an ID wins
+    table.deletes.erase(id);
+    table.updates.erase(id);
+    table.upserts[id] = std::move(row);
+    MaybeFlush();
+}
+
+bool WriteBehindStore::EnqueueUpdate(PendingTable& table, const std::string& id, SqlRow row) {
+    if (table.deletes.count(id)) return false;
+    MarkPending();
+
+    // Folded into a queued upsert, the row it inserts keeps its own
+    // preserved columns
+    auto upsert = table.upserts.find(id);
+    if (upsert != table.upserts.end()) {
+        const auto& columns = table.schema->columns;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (table.schema->preserved.count(columns[c])) row[c] = std::move(upsert->second[c]);
+        }
+        upsert->second = std::move(row);
+    } else {
+        table.updates[id] = std::move(row);
+    }
+    MaybeFlush();
+    return true;
+}
+
+void WriteBehindStore::EnqueueDelete(PendingTable& table, const std::string& id) {
+    MarkPending();
+    table.upserts.erase(id);
+    table.updates.erase(id);
+    table.deletes.insert(id);
+    MaybeFlush();
+}
+
+void WriteBehindStore::MarkPending() {
+    if (!HasPending()) {
+        oldest_pending_ = std::chrono::steady_clock::now();
+    }
+}
+
+bool WriteBehindStore::MaybeFlush() {
+    if (!HasPending()) return true;
+
+    bool full = PendingCount() >= config_.max_pending_rows;
+    bool stale = std::chrono::steady_clock::now() - oldest_pending_ >= config_.max_delay;
+    if (!full && !stale) return true;
+
+    return Flush();
+}
+
+bool WriteBehindStore::Flush() {
+    if (!HasPending()) return true;
+    if (!db_) return false;
+
+    if (FlushBatch()) {
+        failed_flushes_ = 0;
+        return true;
+    }
+    if (++failed_flushes_ < config_.max_failed_flushes) return false;
+
+    // The same rows keep failing one transaction; find the ones to blame
+    if (!FlushRowByRow()) return false;
+    failed_flushes_ = 0;
+    return true;
+}
+
+std::vector<WriteBehindStore::DeadLetter> WriteBehindStore::TakeDeadLetters() {
+    std::vector<DeadLetter> letters(std::make_move_iterator(dead_letters_.begin()),
+                                    std::make_move_iterator(dead_letters_.end()));
+    dead_letters_.clear();
+    return letters;
+}
+
+bool WriteBehindStore::FlushBatch() {
+    const StoreMetrics& metrics = Metrics();
+    ScopedTimer timer(metrics.flush);
+    try {
+        if (!db_->BeginTransaction()) {
+            metrics.failedFlushes.Add();
+            return false;
+        }
+
+        if (!FlushTable(memories_) || !FlushTable(emotional_states_)) {
+            db_->RollbackTransaction();
+            metrics.failedFlushes.Add();
+            return false;
+        }
+
+        if (!db_->CommitTransaction()) {
+            db_->RollbackTransaction();
+            metrics.failedFlushes.Add();
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error flushing pending writes: " << e.what() << std::endl;
+        db_->RollbackTransaction();
+        metrics.failedFlushes.Add();
+        return false;
+    }
+
+    for (auto* table : {&memories_, &emotional_states_}) {
+        table->upserts.clear();
+        table->updates.clear();
+        table->deletes.clear();
+    }
+    return true;
+}
+
+bool WriteBehindStore::FlushRowByRow() {
+    // Written or rejected, a row leaves the queue; an unavailable database
+    // stops the retry with the rest still queued
+    auto settle = [this](const PendingTable& table, const PendingTable& row, const std::string& id,
+                         PendingWrite write) {
+        std::string error;
+        const RowResult result = FlushRow(row, error);
+        if (result == RowResult::Unavailable) return false;
+        if (result == RowResult::Rejected) AddDeadLetter(table, id, write, std::move(error));
+        return true;
+    };
+
+    for (auto* table : {&memories_, &emotional_states_}) {
+        for (auto it = table->deletes.begin(); it != table->deletes.end();) {
+            if (!settle(*table, {table->schema, {}, {}, {*it}}, *it, PendingWrite::Delete)) return false;
+            it = table->deletes.erase(it);
+        }
+        for (auto it = table->upserts.begin(); it != table->upserts.end();) {
+            if (!settle(*table, {table->schema, {*it}, {}, {}}, it->first, PendingWrite::Upsert)) return false;
+            it = table->upserts.erase(it);
+        }
+        for (auto it = table->updates.begin(); it != table->updates.end();) {
+            if (!settle(*table, {table->schema, {}, {*it}, {}}, it->first, PendingWrite::Update)) return false;
+            it = table->updates.erase(it);
+        }
+    }
+    return true;
+}
+
+WriteBehindStore::RowResult WriteBehindStore::FlushRow(const PendingTable& row, std::string& error) {
+    try {
+        if (!db_->BeginTransaction()) return RowResult::Unavailable;
+        if (FlushTable(row) && db_->CommitTransaction()) return RowResult::Written;
+        error = "statement failed";
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    db_->RollbackTransaction();
+    return RowResult::Rejected;
+}
+
+void WriteBehindStore::AddDeadLetter(const PendingTable& table, const std::string& id, PendingWrite write,
+                                     std::string error) {
+    std::cerr << "Dropping write to " << table.schema->table << " row " << id << ": " << error << std::endl;
+    Metrics().deadLetters.Add();
+    dead_letters_.push_back({table.schema->table, id, write, std::move(error)});
+    while (dead_letters_.size() > config_.max_dead_letters) {
+        dead_letters_.pop_front();
+    }
+}
+
+bool WriteBehindStore::FlushTable(const PendingTable& table) {
+    const TableSchema& schema = *table.schema;
+    const size_t batch = config_.max_rows_per_statement;
+    const StoreMetrics& metrics = Metrics();
+
+    // Deletes, batch rows per statement
+    auto deleteIt = table.deletes.begin();
+    while (deleteIt != table.deletes.end()) {
+        size_t rows = std::min(batch, static_cast<size_t>(std::distance(deleteIt, table.deletes.end())));
+        auto& statement = GetStatement(schema, StatementKind::Delete, rows);
+        size_t bytes = 0;
+        for (size_t r = 0; r < rows; ++r, ++deleteIt) {
+            statement.Bind(static_cast<int>(r + 1), *deleteIt);
+            bytes += deleteIt->size();
+        }
+        bool executed = statement.Execute();
+        statement.Reset();
+        metrics.roundTrips.Add();
+        if (!executed) return false;
+        metrics.rows.Add(rows);
+        metrics.bytes.Add(bytes);
+    }
+
+    // Upserts, batch rows per statement
+    const size_t columns = schema.columns.size();
+    auto upsertIt = table.upserts.begin();
+    while (upsertIt != table.upserts.end()) {
+        size_t rows = std::min(batch, static_cast<size_t>(std::distance(upsertIt, table.upserts.end())));
+        auto& statement = GetStatement(schema, StatementKind::Upsert, rows);
+        size_t bytes = 0;
+        for (size_t r = 0; r < rows; ++r, ++upsertIt) {
+            const SqlRow& row = upsertIt->second;
+            for (size_t c = 0; c < columns; ++c) {
+                Bind(statement, static_cast<int>(r * columns + c + 1), row[c]);
+                bytes += BoundBytes(row[c]);
+            }
+        }
+        bool executed = statement.Execute();
+        statement.Reset();
+        metrics.roundTrips.Add();
+        if (!executed) return false;
+        metrics.rows.Add(rows);
+        metrics.bytes.Add(bytes);
+    }
+
+    // Updates, one row per statement: an UPDATE cannot insert, and a row
+    // deleted meanwhile simply matches nothing
+    for (const auto& [id, row] : table.updates) {
+        auto& statement = GetStatement(schema, StatementKind::Update, 1);
+        size_t bytes = 0;
+        int index = 1;
+        for (size_t c = 1; c < columns; ++c) {
+            if (schema.preserved.count(schema.columns[c])) continue;
+            Bind(statement, index++, row[c]);
+            bytes += BoundBytes(row[c]);
+        }
+        Bind(statement, index, row[0]);
+        bytes += BoundBytes(row[0]);
+        bool executed = statement.Execute();
+        statement.Reset();
+        metrics.roundTrips.Add();
+        if (!executed) return false;
+        metrics.rows.Add();
+        metrics.bytes.Add(bytes);
+    }
+
+    return true;
+}
+
+database::Statement& WriteBehindStore::GetStatement(const TableSchema& schema, StatementKind kind, size_t rows) {
+    StatementKey key{&schema, kind, rows};
+    auto it = statements_.find(key);
+    if (it == statements_.end()) {
+        std::string sql = kind == StatementKind::Upsert ? BuildUpsertSql(schema, rows)
+                        : kind == StatementKind::Update ? BuildUpdateSql(schema)
+                                                        : BuildDeleteSql(schema, rows);
+        auto statement = db_->Prepare(sql);
+        if (!statement) {
+            throw std::runtime_error("Failed to prepare statement: " + sql);
+        }
+        it = statements_.emplace(key, std::move(statement)).first;
+    }
+    return *it->second;
+}
+
+std::string WriteBehindStore::BuildUpsertSql(const TableSchema& schema, size_t rows) {
+    std::ostringstream sql;
+    sql << "INSERT INTO " << schema.table << " (";
+    for (size_t c = 0; c < schema.columns.size(); ++c) {
+        sql << (c ? ", " : "") << schema.columns[c];
+    }
+    sql << ") VALUES ";
+
+    std::string placeholders = "(";
+    for (size_t c = 0; c < schema.columns.size(); ++c) {
+        placeholders += c ? ", ?" : "?";
+    }
+    placeholders += ")";
+    for (size_t r = 0; r < rows; ++r) {
+        sql << (r ? ", " : "") << placeholders;
+    }
+
+    sql << " ON CONFLICT(" << schema.columns[0] << ") DO UPDATE SET ";
+    bool first = true;
+    for (size_t c = 1; c < schema.columns.size(); ++c) {
+        if (schema.preserved.count(schema.columns[c])) continue;
+        sql << (first ? "" : ", ") << schema.columns[c] << " = excluded." << schema.columns[c];
+        first = false;
+    }
+    return sql.str();
+}
+
+std::string WriteBehindStore::BuildUpdateSql(const TableSchema& schema) {
+    std::ostringstream sql;
+    sql << "UPDATE " << schema.table << " SET ";
+    bool first = true;
+    for (size_t c = 1; c < schema.columns.size(); ++c) {
+        if (schema.preserved.count(schema.columns[c])) continue;
+        sql << (first ? "" : ", ") << schema.columns[c] << " = ?";
+        first = false;
+    }
+    sql << " WHERE " << schema.columns[0] << " = ?";
+    return sql.str();
+}
+
+std::string WriteBehindStore::BuildDeleteSql(const TableSchema& schema, size_t rows) {
+    std::ostringstream sql;
+    sql << "DELETE FROM " << schema.table << " WHERE " << schema.columns[0] << " IN (";
+    for (size_t r = 0; r < rows; ++r) {
+        sql << (r ? ", ?" : "?");
+    }
+    sql << ")";
+    return sql.str();
+}
+
+void WriteBehindStore::Bind(database::Statement& statement, int index, const SqlValue& value) {
+    std::visit([&statement, index](const auto& v) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(v)>, SqlBlob>) {
+            statement.BindBlob(index, v.bytes);
+        } else {
+            statement.Bind(index, v);
+        }
+    }, value);
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+#include "../database/database.hpp"
+#include "memory_codec.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+struct EmotionalState;
+
+// Bytes bound as a BLOB. Binary-encoded columns contain NULs, which a TEXT
+// binding or column_text read would cut short.
+struct SqlBlob {
+    std::string bytes;
+};
+
+// Typed column value; bound directly, never formatted into SQL text
+using SqlValue = std::variant<int64_t, double, std::string, SqlBlob>;
+using SqlRow = std::vector<SqlValue>;
+
+// Write-behind persistence for MemoryManager. Writes are coalesced per row
+// ID and flushed as multi-row upserts and deletes, plus single-row updates,
+// through cached prepared statements, one transaction per flush.
+class WriteBehindStore {
+public:
+    struct Config {
+        size_t max_pending_rows = 256;                 // flush once this many rows are queued
+        std::chrono::milliseconds max_delay{500};      // or once the oldest queued row is this old
+        size_t max_rows_per_statement = 64;            // keeps bound parameters under 999
+        // Form of the trait_influences and tags columns, bound as TEXT for
+        // Json and as BLOB for Binary. Readers accept both per row, so a
+        // table can mix them: existing rows are not migrated, and each
+        // rewrites in the configured form when next saved.
+        codec::ColumnEncoding column_encoding = codec::ColumnEncoding::Json;
+        // Consecutive failed flushes before the batch is retried a row per
+        // transaction, so the rows that fail on their own can be set aside
+        size_t max_failed_flushes = 3;
+        size_t max_dead_letters = 256;                 // oldest dropped past this
+    };
+
+    explicit WriteBehindStore(std::shared_ptr<database::Database> db);
+    WriteBehindStore(std::shared_ptr<database::Database> db, const Config& config);
+    ~WriteBehindStore();
+
+    WriteBehindStore(const WriteBehindStore&) = delete;
+    WriteBehindStore& operator=(const WriteBehindStore&) = delete;
+
+    enum class PendingWrite { None, Upsert, Update, Delete };
+
+    // A queued write that failed in a transaction of its own, taken out of
+    // the queue so the rows behind it can land
+    struct DeadLetter {
+        std::string table;
+        std::string id;
+        PendingWrite write = PendingWrite::None;
+        std::string error;
+    };
+
+    void UpsertMemory(const MemoryEvent& memory);
+    // Rewrites an existing row and never creates one; created_at keeps its
+    // stored value. Merges into a queued upsert. False if a delete is queued.
+    bool UpdateMemory(const MemoryEvent& memory);
+    void DeleteMemory(const std::string& id);
+    PendingWrite PendingMemory(const std::string& id) const;
+    void UpsertEmotionalState(const EmotionalState& state);
+    // As UpdateMemory: rewrites an existing row, never creates one
+    bool UpdateEmotionalState(const EmotionalState& state);
+    void DeleteEmotionalState(const std::string& id);
+    PendingWrite PendingEmotionalState(const std::string& id) const;
+
+    // Flush if a size or age threshold has been crossed
+    bool MaybeFlush();
+    // Write everything queued in one transaction. On failure the batch is
+    // rolled back and stays queued; after max_failed_flushes failures in a
+    // row, each row is retried alone, and the ones that still fail are
+    // logged and dead-lettered. True once nothing is left queued.
+    bool Flush();
+
+    size_t PendingCount() const;
+    bool HasPending() const { return PendingCount() > 0; }
+    // Dead letters since the last call, oldest first
+    std::vector<DeadLetter> TakeDeadLetters();
+
+private:
+    struct TableSchema {
+        std::string table;
+        std::vector<std::string> columns;  // columns[0] is the primary key
+        std::set<std::string> preserved;   // written on insert only
+    };
+
+    struct PendingTable {
+        const TableSchema* schema;
+        std::map<std::string, SqlRow> upserts;
+        std::map<std::string, SqlRow> updates;
+        std::set<std::string> deletes;
+    };
+
+    enum class StatementKind { Upsert, Update, Delete };
+    using StatementKey = std::tuple<const TableSchema*, StatementKind, size_t>;
+
+    static const TableSchema MEMORY_SCHEMA;
+    static const TableSchema EMOTIONAL_STATE_SCHEMA;
+
+    static PendingWrite Pending(const PendingTable& table, const std::string& id);
+    void Enqueue(PendingTable& table, const std::string& id, SqlRow row);
+    bool EnqueueUpdate(PendingTable& table, const std::string& id, SqlRow row);
+    void EnqueueDelete(PendingTable& table, const std::string& id);
+    void MarkPending();
+
+    enum class RowResult { Written, Rejected, Unavailable };
+
+    // One attempt at the whole queue, in one transaction
+    bool FlushBatch();
+    // Each queued row in a transaction of its own; false if the database
+    // would not start one, leaving what is still queued for later
+    bool FlushRowByRow();
+    RowResult FlushRow(const PendingTable& row, std::string& error);
+    void AddDeadLetter(const PendingTable& table, const std::string& id, PendingWrite write, std::string error);
+
+    bool FlushTable(const PendingTable& table);
+    database::Statement& GetStatement(const TableSchema& schema, StatementKind kind, size_t rows);
+    static std::string BuildUpsertSql(const TableSchema& schema, size_t rows);
+    static std::string BuildUpdateSql(const TableSchema& schema);
+    static std::string BuildDeleteSql(const TableSchema& schema, size_t rows);
+    static void Bind(database::Statement& statement, int index, const SqlValue& value);
+
+    std::shared_ptr<database::Database> db_;
+    Config config_;
+    PendingTable memories_{&MEMORY_SCHEMA, {}, {}, {}};
+    PendingTable emotional_states_{&EMOTIONAL_STATE_SCHEMA, {}, {}, {}};
+    std::chrono::steady_clock::time_point oldest_pending_;
+    size_t failed_flushes_ = 0;    // consecutive
+    std::deque<DeadLetter> dead_letters_;
+    std::map<StatementKey, std::shared_ptr<database::Statement>> statements_;
+};
+
+} // namespace cognitive
+} // namespace shandris
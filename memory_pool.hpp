@@ -0,0 +1,18 @@
+#pragma once
+
+#include <map>
+#include <memory_resource>
+#include <string>
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+
+// Working-set storage keyed by memory ID. Nodes come from the owner's pool
+// resource, so inserts and erases recycle same-sized blocks instead of
+// going back to the global heap.
+using MemoryMap = std::pmr::map<std::string, MemoryEvent>;
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,111 @@
+#include "memory_similarity.hpp"
+#include <cmath>
+#include <iterator>
+
+namespace shandris {
+namespace cognitive {
+
+size_t SimilarityEngine::CountShared(const FeatureList& a, const FeatureList& b) {
+    size_t shared = 0;
+    auto ia = a.begin();
+    auto ib = b.begin();
+    while (ia != a.end() && ib != b.end()) {
+        if (*ia < *ib) {
+            ++ia;
+        } else if (*ib < *ia) {
+            ++ib;
+        } else {
+            ++shared;
+            ++ia;
+            ++ib;
+        }
+    }
+    return shared;
+}
+
+void SimilarityEngine::SharedFeatures(const FeatureList& a, const FeatureList& b, FeatureList& shared) {
+    shared.clear();
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(shared));
+}
+
+double SimilarityEngine::Score(const MemoryFeatures& a, const MemoryFeatures& b,
+                               const SimilarityWeights& weights) {
+    double score = 0.0;
+
+    if (weights.shared_trait != 0.0) {
+        score += weights.shared_trait * CountShared(a.traits, b.traits);
+    }
+    if (weights.shared_tag != 0.0) {
+        score += weights.shared_tag * CountShared(a.tags, b.tags);
+    }
+    if (weights.shared_trigger != 0.0) {
+        score += weights.shared_trigger * CountShared(a.triggers, b.triggers);
+    }
+
+    double difference = std::abs(a.emotional_weight - b.emotional_weight);
+    if (difference < weights.emotional_match_window) {
+        score += weights.emotional_match;
+    }
+    score += weights.emotional_proximity * (1.0 - difference);
+
+    return std::min(weights.max_score, score);
+}
+
+void SimilarityEngine::ScoreBatch(const MemoryFeatures& query,
+                                  const std::vector<MemoryFeatures>& batch,
+                                  const SimilarityWeights& weights,
+                                  std::vector<double>& scores) {
+    scores.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        scores[i] = Score(query, batch[i], weights);
+    }
+}
+
+void SimilarityEngine::CollectCandidates(const std::vector<MemoryFeatures>& features,
+                                         const SimilarityWeights& weights,
+                                         CandidateLists& candidates) {
+    using Postings = std::pmr::unordered_map<FeatureID, std::pmr::vector<size_t>>;
+    std::pmr::memory_resource* scratch = candidates.get_allocator().resource();
+
+    // Postings for every channel that contributes to the score
+    Postings traitPostings(scratch);
+    Postings tagPostings(scratch);
+    Postings triggerPostings(scratch);
+    for (size_t i = 0; i < features.size(); ++i) {
+        if (weights.shared_trait != 0.0) {
+            for (FeatureID id : features[i].traits) traitPostings[id].push_back(i);
+        }
+        if (weights.shared_tag != 0.0) {
+            for (FeatureID id : features[i].tags) tagPostings[id].push_back(i);
+        }
+        if (weights.shared_trigger != 0.0) {
+            for (FeatureID id : features[i].triggers) triggerPostings[id].push_back(i);
+        }
+    }
+
+    candidates.clear();
+    candidates.resize(features.size());
+    std::pmr::vector<size_t> lastSeen(features.size(), features.size(), scratch);
+    auto collect = [&](size_t i, const FeatureList& ids, const Postings& postings) {
+        for (FeatureID id : ids) {
+            auto it = postings.find(id);
+            if (it == postings.end()) continue;
+            for (size_t j : it->second) {
+                if (j > i && lastSeen[j] != i) {
+                    lastSeen[j] = i;
+                    candidates[i].push_back(j);
+                }
+            }
+        }
+    };
+
+    for (size_t i = 0; i < features.size(); ++i) {
+        collect(i, features[i].traits, traitPostings);
+        collect(i, features[i].tags, tagPostings);
+        collect(i, features[i].triggers, triggerPostings);
+        std::sort(candidates[i].begin(), candidates[i].end());
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
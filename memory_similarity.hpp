@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "scratch_arena.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+using FeatureID = SymbolID;
+using FeatureList = std::vector<FeatureID>; // sorted, no duplicates
+
+// Compact per-memory record scored by SimilarityEngine. Built once per pass
+// so scoring never touches the original MemoryEvent or its strings.
+struct MemoryFeatures {
+    FeatureList traits;
+    FeatureList tags;
+    FeatureList triggers;
+    double emotional_weight = 0.0;
+};
+
+// Per-caller scoring weights. Every shared trait, tag and trigger adds its
+// weight; the emotional terms compare emotional_weight.
+struct SimilarityWeights {
+    double shared_trait = 0.0;
+    double shared_tag = 0.0;
+    double shared_trigger = 0.0;
+    double emotional_match = 0.0;        // flat bonus when |difference| < emotional_match_window
+    double emotional_match_window = 0.0;
+    double emotional_proximity = 0.0;    // scaled by 1 - |difference|
+    double max_score = std::numeric_limits<double>::infinity();
+};
+
+class SimilarityEngine {
+public:
+    static size_t CountShared(const FeatureList& a, const FeatureList& b);
+    static void SharedFeatures(const FeatureList& a, const FeatureList& b, FeatureList& shared);
+
+    static double Score(const MemoryFeatures& a, const MemoryFeatures& b,
+                        const SimilarityWeights& weights);
+
+    // Score one query against a batch of records
+    static void ScoreBatch(const MemoryFeatures& query,
+                           const std::vector<MemoryFeatures>& batch,
+                           const SimilarityWeights& weights,
+                           std::vector<double>& scores);
+
+    // Invoke onMatch(i, j, score) for every pair i < j scoring above threshold,
+    // in ascending (i, j) order. When the emotional terms alone cannot reach the
+    // threshold, only pairs sharing a trait, tag or trigger are scored.
+    template<typename OnMatch>
+    static void ScorePairs(const std::vector<MemoryFeatures>& features,
+                           const SimilarityWeights& weights,
+                           double threshold,
+                           OnMatch&& onMatch);
+
+private:
+    static bool NeedsSharedFeature(const SimilarityWeights& weights, double threshold) {
+        return threshold >= weights.emotional_match + weights.emotional_proximity;
+    }
+
+    using CandidateLists = std::pmr::vector<std::pmr::vector<size_t>>;
+
+    // Postings and candidate lists live in the caller's scratch arena
+    static void CollectCandidates(const std::vector<MemoryFeatures>& features,
+                                  const SimilarityWeights& weights,
+                                  CandidateLists& candidates);
+};
+
+template<typename OnMatch>
+void SimilarityEngine::ScorePairs(const std::vector<MemoryFeatures>& features,
+                                  const SimilarityWeights& weights,
+                                  double threshold,
+                                  OnMatch&& onMatch) {
+    if (NeedsSharedFeature(weights, threshold)) {
+        CandidateLists candidates(ScratchResource());
+        CollectCandidates(features, weights, candidates);
+        for (size_t i = 0; i < features.size(); ++i) {
+            for (size_t j : candidates[i]) {
+                double score = Score(features[i], features[j], weights);
+                if (score > threshold) {
+                    onMatch(i, j, score);
+                }
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < features.size(); ++i) {
+        for (size_t j = i + 1; j < features.size(); ++j) {
+            double score = Score(features[i], features[j], weights);
+            if (score > threshold) {
+                onMatch(i, j, score);
+            }
+        }
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
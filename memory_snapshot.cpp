@@ -0,0 +1,413 @@
+#include "memory_snapshot.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace shandris {
+namespace cognitive {
+
+namespace snapshot {
+
+static_assert(sizeof(StringRef) == 16);
+static_assert(sizeof(Header) == 40);
+static_assert(sizeof(Section) == 32);
+static_assert(sizeof(SymbolRecord) == 24);
+static_assert(sizeof(MemoryRecord) == 96);
+static_assert(sizeof(TraitRecord) == 16);
+static_assert(sizeof(EmotionalStateRecord) == 88);
+
+uint64_t Checksum(const void* data, size_t size) {
+    // FNV-1a
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace snapshot
+
+namespace {
+
+constexpr size_t SECTION_COUNT = 7;
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+int64_t ToUnixSeconds(std::chrono::system_clock::time_point time) {
+    return static_cast<int64_t>(std::chrono::system_clock::to_time_t(time));
+}
+
+std::chrono::system_clock::time_point FromUnixSeconds(int64_t seconds) {
+    return std::chrono::system_clock::from_time_t(static_cast<std::time_t>(seconds));
+}
+
+size_t AlignUp(size_t value) {
+    return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// fsync of a file or directory by path
+bool SyncPath(const std::string& path, int flags) {
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0) return false;
+    const bool synced = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && synced;
+}
+
+} // namespace
+
+snapshot::StringRef SnapshotWriter::AddString(std::string_view value) {
+    snapshot::StringRef ref{strings_.size(), static_cast<uint32_t>(value.size()), 0};
+    strings_.insert(strings_.end(), value.begin(), value.end());
+    return ref;
+}
+
+std::string_view SnapshotWriter::View(const snapshot::StringRef& ref) const {
+    return {strings_.data() + ref.offset, ref.length};
+}
+
+uint32_t SnapshotWriter::MapSymbol(SymbolKind kind, SymbolID id) {
+    uint64_t key = (static_cast<uint64_t>(kind) << 32) | id;
+    auto [it, inserted] = symbol_index_.emplace(key, static_cast<uint32_t>(symbols_.size()));
+    if (inserted) {
+        snapshot::SymbolRecord record{};
+        record.kind = kind;
+        record.name = AddString(SymbolTable::Global().Name(kind, id));
+        symbols_.push_back(record);
+    }
+    return it->second;
+}
+
+void SnapshotWriter::AddMemory(const MemoryEvent& memory) {
+    snapshot::MemoryRecord record{};
+    record.id = AddString(memory.id);
+    record.content = AddString(memory.content);
+    record.context = AddString(memory.context);
+    record.importance = memory.importance;
+    record.emotional_weight = memory.emotional_weight;
+    record.created_at = ToUnixSeconds(memory.created_at);
+    record.updated_at = ToUnixSeconds(memory.updated_at);
+
+    record.tag_begin = static_cast<uint32_t>(tags_.size());
+    for (SymbolID tag : memory.tags) {
+        tags_.push_back(MapSymbol(SymbolKind::Tag, tag));
+    }
+    record.tag_count = static_cast<uint32_t>(tags_.size()) - record.tag_begin;
+
+    record.trait_begin = static_cast<uint32_t>(traits_.size());
+    for (const auto& [trait, influence] : memory.trait_influences) {
+        traits_.push_back({MapSymbol(SymbolKind::Trait, trait), 0, influence});
+    }
+    record.trait_count = static_cast<uint32_t>(traits_.size()) - record.trait_begin;
+
+    memories_.push_back(record);
+}
+
+void SnapshotWriter::AddEmotionalState(const EmotionalState& state) {
+    emotional_states_.push_back({
+        AddString(state.id),
+        state.happiness, state.sadness, state.anger, state.fear,
+        state.surprise, state.disgust, state.trust, state.anticipation,
+        ToUnixSeconds(state.timestamp)
+    });
+}
+
+void SnapshotWriter::AddProfile(const std::string& id, const std::vector<uint8_t>& data) {
+    snapshot::ProfileRecord record{};
+    record.id = AddString(id);
+    record.data = AddString(std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+    profiles_.push_back(record);
+}
+
+bool SnapshotWriter::WriteFile(const std::string& path, int64_t createdAt) const {
+    // Sorted copies so readers can binary search by ID
+    auto byID = [this](const auto& a, const auto& b) { return View(a.id) < View(b.id); };
+    auto memories = memories_;
+    std::sort(memories.begin(), memories.end(), byID);
+    auto profiles = profiles_;
+    std::sort(profiles.begin(), profiles.end(), byID);
+
+    struct Payload {
+        snapshot::SectionKind kind;
+        const void* data;
+        size_t size;
+    };
+    const Payload payloads[SECTION_COUNT] = {
+        {snapshot::SectionKind::Strings, strings_.data(), strings_.size()},
+        {snapshot::SectionKind::Symbols, symbols_.data(), symbols_.size() * sizeof(snapshot::SymbolRecord)},
+        {snapshot::SectionKind::Memories, memories.data(), memories.size() * sizeof(snapshot::MemoryRecord)},
+        {snapshot::SectionKind::Tags, tags_.data(), tags_.size() * sizeof(uint32_t)},
+        {snapshot::SectionKind::Traits, traits_.data(), traits_.size() * sizeof(snapshot::TraitRecord)},
+        {snapshot::SectionKind::EmotionalStates, emotional_states_.data(),
+         emotional_states_.size() * sizeof(snapshot::EmotionalStateRecord)},
+        {snapshot::SectionKind::Profiles, profiles.data(), profiles.size() * sizeof(snapshot::ProfileRecord)}
+    };
+
+    snapshot::Section sections[SECTION_COUNT] = {};
+    size_t offset = sizeof(snapshot::Header) + sizeof(sections);
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        offset = AlignUp(offset);
+        sections[i] = {payloads[i].kind, 0, offset, payloads[i].size,
+                       snapshot::Checksum(payloads[i].data, payloads[i].size)};
+        offset += payloads[i].size;
+    }
+
+    snapshot::Header header{};
+    std::memcpy(header.magic, snapshot::MAGIC, sizeof(header.magic));
+    header.version = snapshot::VERSION;
+    header.section_count = SECTION_COUNT;
+    header.created_at = createdAt;
+    header.file_size = offset;
+    header.table_checksum = snapshot::Checksum(sections, sizeof(sections));
+
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        static const char padding[SECTION_ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+        size_t written = sizeof(header) + sizeof(sections);
+        for (size_t i = 0; i < SECTION_COUNT; ++i) {
+            out.write(padding, static_cast<std::streamsize>(sections[i].offset - written));
+            out.write(static_cast<const char*>(payloads[i].data), static_cast<std::streamsize>(payloads[i].size));
+            written = sections[i].offset + payloads[i].size;
+        }
+        out.flush();
+        if (!out) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // Contents on disk before the rename can expose them, and the rename
+    // itself once it returns; readers never see a partially written snapshot
+    if (!SyncPath(tempPath, O_WRONLY)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    if (directory.empty()) directory = ".";
+    return SyncPath(directory, O_RDONLY | O_DIRECTORY);
+}
+
+std::shared_ptr<const MappedSnapshot> MappedSnapshot::Open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open snapshot: " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(snapshot::Header))) {
+        ::close(fd);
+        throw std::runtime_error("Snapshot too small: " + path);
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map snapshot: " + path);
+    }
+
+    std::shared_ptr<MappedSnapshot> result(new MappedSnapshot());
+    result->base_ = static_cast<const char*>(mapping);
+    result->size_ = size;
+    result->Validate();
+    return result;
+}
+
+MappedSnapshot::~MappedSnapshot() {
+    if (base_) {
+        ::munmap(const_cast<char*>(base_), size_);
+    }
+}
+
+template<typename T>
+const T* MappedSnapshot::SectionArray(const snapshot::Section& section, size_t& count) const {
+    if (section.size % sizeof(T) != 0) {
+        throw std::runtime_error("Snapshot section has a partial record");
+    }
+    count = section.size / sizeof(T);
+    return reinterpret_cast<const T*>(base_ + section.offset);
+}
+
+void MappedSnapshot::Validate() {
+    header_ = reinterpret_cast<const snapshot::Header*>(base_);
+    if (std::memcmp(header_->magic, snapshot::MAGIC, sizeof(header_->magic)) != 0) {
+        throw std::runtime_error("Not a snapshot file");
+    }
+    if (header_->version != snapshot::VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header_->version));
+    }
+    if (header_->section_count != SECTION_COUNT || header_->file_size != size_ ||
+        size_ < sizeof(snapshot::Header) + SECTION_COUNT * sizeof(snapshot::Section)) {
+        throw std::runtime_error("Truncated snapshot");
+    }
+
+    const auto* sections = reinterpret_cast<const snapshot::Section*>(base_ + sizeof(snapshot::Header));
+    if (snapshot::Checksum(sections, SECTION_COUNT * sizeof(snapshot::Section)) != header_->table_checksum) {
+        throw std::runtime_error("Snapshot section table checksum mismatch");
+    }
+
+    const snapshot::Section* symbolSection = nullptr;
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        const auto& section = sections[i];
+        if (section.offset % SECTION_ALIGNMENT != 0 || section.offset > size_ ||
+            section.size > size_ - section.offset) {
+            throw std::runtime_error("Snapshot section out of bounds");
+        }
+        if (snapshot::Checksum(base_ + section.offset, section.size) != section.checksum) {
+            throw std::runtime_error("Snapshot section checksum mismatch");
+        }
+
+        switch (section.kind) {
+            case snapshot::SectionKind::Strings:
+                strings_ = base_ + section.offset;
+                strings_size_ = section.size;
+                break;
+            case snapshot::SectionKind::Symbols:
+                symbolSection = &section;
+                break;
+            case snapshot::SectionKind::Memories:
+                memories_ = SectionArray<snapshot::MemoryRecord>(section, memory_count_);
+                break;
+            case snapshot::SectionKind::Tags:
+                tags_ = SectionArray<uint32_t>(section, tag_count_);
+                break;
+            case snapshot::SectionKind::Traits:
+                traits_ = SectionArray<snapshot::TraitRecord>(section, trait_count_);
+                break;
+            case snapshot::SectionKind::EmotionalStates:
+                emotional_states_ = SectionArray<snapshot::EmotionalStateRecord>(section, emotional_state_count_);
+                break;
+            case snapshot::SectionKind::Profiles:
+                profiles_ = SectionArray<snapshot::ProfileRecord>(section, profile_count_);
+                break;
+            default:
+                throw std::runtime_error("Unknown snapshot section");
+        }
+    }
+
+    // Remap snapshot-local symbols to this process's interned IDs
+    if (symbolSection) {
+        size_t count = 0;
+        const auto* records = SectionArray<snapshot::SymbolRecord>(*symbolSection, count);
+        symbols_.reserve(count);
+        auto& table = SymbolTable::Global();
+        for (size_t i = 0; i < count; ++i) {
+            if (records[i].kind >= SymbolKind::Count) {
+                throw std::runtime_error("Snapshot symbol has an unknown kind");
+            }
+            symbols_.push_back(table.Intern(records[i].kind, std::string(View(records[i].name))));
+        }
+    }
+
+    // Bounds-check every reference once so accessors can stay unchecked
+    for (size_t i = 0; i < memory_count_; ++i) {
+        const auto& record = memories_[i];
+        View(record.id);
+        View(record.content);
+        View(record.context);
+        if (record.tag_begin + static_cast<uint64_t>(record.tag_count) > tag_count_ ||
+            record.trait_begin + static_cast<uint64_t>(record.trait_count) > trait_count_) {
+            throw std::runtime_error("Snapshot memory references missing tags or traits");
+        }
+    }
+    for (size_t i = 0; i < tag_count_; ++i) {
+        if (tags_[i] >= symbols_.size()) throw std::runtime_error("Snapshot tag out of range");
+    }
+    for (size_t i = 0; i < trait_count_; ++i) {
+        if (traits_[i].symbol >= symbols_.size()) throw std::runtime_error("Snapshot trait out of range");
+    }
+    for (size_t i = 0; i < emotional_state_count_; ++i) {
+        View(emotional_states_[i].id);
+    }
+    for (size_t i = 0; i < profile_count_; ++i) {
+        View(profiles_[i].id);
+        View(profiles_[i].data);
+    }
+}
+
+std::string_view MappedSnapshot::View(const snapshot::StringRef& ref) const {
+    if (ref.offset > strings_size_ || ref.length > strings_size_ - ref.offset) {
+        throw std::runtime_error("Snapshot string out of bounds");
+    }
+    return {strings_ + ref.offset, ref.length};
+}
+
+bool MappedSnapshot::FindMemory(std::string_view id, size_t& index) const {
+    const auto* end = memories_ + memory_count_;
+    const auto* it = std::lower_bound(memories_, end, id,
+        [this](const snapshot::MemoryRecord& record, std::string_view key) { return View(record.id) < key; });
+    if (it == end || View(it->id) != id) {
+        return false;
+    }
+    index = static_cast<size_t>(it - memories_);
+    return true;
+}
+
+void MappedSnapshot::HydrateMemory(size_t index, MemoryEvent& memory) const {
+    const auto& record = memories_[index];
+    memory.id = View(record.id);
+    memory.content = View(record.content);
+    memory.context = View(record.context);
+    memory.importance = record.importance;
+    memory.emotional_weight = record.emotional_weight;
+    memory.created_at = FromUnixSeconds(record.created_at);
+    memory.updated_at = FromUnixSeconds(record.updated_at);
+
+    memory.tags.clear();
+    memory.tags.reserve(record.tag_count);
+    for (uint32_t i = 0; i < record.tag_count; ++i) {
+        memory.tags.insert(symbols_[tags_[record.tag_begin + i]]);
+    }
+
+    memory.trait_influences.clear();
+    for (uint32_t i = 0; i < record.trait_count; ++i) {
+        const auto& trait = traits_[record.trait_begin + i];
+        memory.trait_influences[symbols_[trait.symbol]] = trait.influence;
+    }
+}
+
+void MappedSnapshot::HydrateEmotionalState(size_t index, EmotionalState& state) const {
+    const auto& record = emotional_states_[index];
+    state.id = View(record.id);
+    state.happiness = record.happiness;
+    state.sadness = record.sadness;
+    state.anger = record.anger;
+    state.fear = record.fear;
+    state.surprise = record.surprise;
+    state.disgust = record.disgust;
+    state.trust = record.trust;
+    state.anticipation = record.anticipation;
+    state.timestamp = FromUnixSeconds(record.timestamp);
+}
+
+bool MappedSnapshot::FindProfile(std::string_view id, std::string_view& data) const {
+    const auto* end = profiles_ + profile_count_;
+    const auto* it = std::lower_bound(profiles_, end, id,
+        [this](const snapshot::ProfileRecord& record, std::string_view key) { return View(record.id) < key; });
+    if (it == end || View(it->id) != id) {
+        return false;
+    }
+    data = View(it->data);
+    return true;
+}
+
+} // namespace cognitive
+} // namespace shandris
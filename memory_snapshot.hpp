@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+struct EmotionalState;
+
+// On-disk layout of a warm-start snapshot. Everything is fixed-size and
+// 8-byte aligned so a mapped file can be read in place; strings live in one
+// blob and are referenced by offset. Tag and trait IDs are snapshot-local
+// indices into the symbol section and are remapped to process symbols on
+// open, since interned IDs are not stable across runs.
+namespace snapshot {
+
+inline constexpr char MAGIC[8] = {'S', 'H', 'N', 'D', 'S', 'N', 'A', 'P'};
+inline constexpr uint32_t VERSION = 1;
+
+enum class SectionKind : uint32_t {
+    Strings = 1,
+    Symbols,
+    Memories,
+    Tags,
+    Traits,
+    EmotionalStates,
+    Profiles
+};
+
+struct StringRef {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    int64_t created_at;       // unix seconds; rows updated later are replayed from SQL
+    uint64_t file_size;
+    uint64_t table_checksum;  // over the section table
+};
+
+struct Section {
+    SectionKind kind;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+struct SymbolRecord {
+    SymbolKind kind;
+    uint8_t padding[3];  // named so a value-initialized record has no indeterminate bytes
+    uint32_t reserved;
+    StringRef name;
+};
+
+struct MemoryRecord {
+    StringRef id;
+    StringRef content;
+    StringRef context;
+    double importance;
+    double emotional_weight;
+    int64_t created_at;
+    int64_t updated_at;
+    uint32_t tag_begin;
+    uint32_t tag_count;
+    uint32_t trait_begin;
+    uint32_t trait_count;
+};
+
+struct TraitRecord {
+    uint32_t symbol;
+    uint32_t reserved;
+    double influence;
+};
+
+struct EmotionalStateRecord {
+    StringRef id;
+    double happiness;
+    double sadness;
+    double anger;
+    double fear;
+    double surprise;
+    double disgust;
+    double trust;
+    double anticipation;
+    int64_t timestamp;
+};
+
+struct ProfileRecord {
+    StringRef id;
+    StringRef data;  // MessagePack-encoded persona state
+};
+
+uint64_t Checksum(const void* data, size_t size);
+
+} // namespace snapshot
+
+// Accumulates state from MemoryManager and PersonaSystem and writes it as a
+// single snapshot file. Records are sorted by ID on write so readers can
+// binary search them.
+class SnapshotWriter {
+public:
+    void AddMemory(const MemoryEvent& memory);
+    void AddEmotionalState(const EmotionalState& state);
+    void AddProfile(const std::string& id, const std::vector<uint8_t>& data);
+
+    // Written to a temporary file and renamed into place
+    bool WriteFile(const std::string& path, int64_t createdAt) const;
+
+private:
+    snapshot::StringRef AddString(std::string_view value);
+    uint32_t MapSymbol(SymbolKind kind, SymbolID id);
+    std::string_view View(const snapshot::StringRef& ref) const;
+
+    std::vector<char> strings_;
+    std::vector<snapshot::SymbolRecord> symbols_;
+    std::unordered_map<uint64_t, uint32_t> symbol_index_;  // (kind, SymbolID) -> local index
+    std::vector<snapshot::MemoryRecord> memories_;
+    std::vector<uint32_t> tags_;
+    std::vector<snapshot::TraitRecord> traits_;
+    std::vector<snapshot::EmotionalStateRecord> emotional_states_;
+    std::vector<snapshot::ProfileRecord> profiles_;
+};
+
+// Read-only mapping of a snapshot file. Open validates the magic, version
+// and every section checksum and throws std::runtime_error on mismatch.
+// Strings and profile bytes are served straight from the mapping; memories
+// are hydrated on request.
+class MappedSnapshot {
+public:
+    static std::shared_ptr<const MappedSnapshot> Open(const std::string& path);
+    ~MappedSnapshot();
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    int64_t CreatedAt() const { return header_->created_at; }
+
+    size_t MemoryCount() const { return memory_count_; }
+    std::string_view MemoryID(size_t index) const { return View(memories_[index].id); }
+    bool FindMemory(std::string_view id, size_t& index) const;
+    void HydrateMemory(size_t index, MemoryEvent& memory) const;
+
+    size_t EmotionalStateCount() const { return emotional_state_count_; }
+    void HydrateEmotionalState(size_t index, EmotionalState& state) const;
+
+    bool FindProfile(std::string_view id, std::string_view& data) const;
+
+private:
+    MappedSnapshot() = default;
+
+    void Validate();
+    std::string_view View(const snapshot::StringRef& ref) const;
+
+    template<typename T>
+    const T* SectionArray(const snapshot::Section& section, size_t& count) const;
+
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    const snapshot::Header* header_ = nullptr;
+
+    const char* strings_ = nullptr;
+    size_t strings_size_ = 0;
+    std::vector<SymbolID> symbols_;  // local index -> process symbol
+    const snapshot::MemoryRecord* memories_ = nullptr;
+    size_t memory_count_ = 0;
+    const uint32_t* tags_ = nullptr;
+    size_t tag_count_ = 0;
+    const snapshot::TraitRecord* traits_ = nullptr;
+    size_t trait_count_ = 0;
+    const snapshot::EmotionalStateRecord* emotional_states_ = nullptr;
+    size_t emotional_state_count_ = 0;
+    const snapshot::ProfileRecord* profiles_ = nullptr;
+    size_t profile_count_ = 0;
+};
+
+} // namespace cognitive
+} // namespace shandris
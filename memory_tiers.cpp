@@ -0,0 +1,86 @@
+#include "memory_tiers.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+double RelevanceCurve::At(DecayClock::time_point time) const {
+    const double hours = Elapsed<DecayHours>(origin, time);
+    return constant + ExponentialDecay(fast, FAST_RATE, hours) + ExponentialDecay(slow, SLOW_RATE, hours);
+}
+
+DecayClock::time_point RelevanceCurve::Crossing(double threshold) const {
+    // With x = e^(-SLOW_RATE h), which falls from 1 towards 0, the score is
+    // fast x^2 + slow x + constant; find the largest x in (0, 1] below it
+    const double c = constant - threshold;
+    auto below = [&](double x) { return (fast * x + slow) * x + c < 0.0; };
+    if (below(1.0)) return origin;
+
+    double roots[2];
+    size_t count = 0;
+    if (fast == 0.0) {
+        if (slow != 0.0) roots[count++] = -c / slow;
+    } else {
+        const double discriminant = slow * slow - 4.0 * fast * c;
+        if (discriminant >= 0.0) {
+            // The stable form, without cancellation between slow and the root
+            const double q = -0.5 * (slow + std::copysign(std::sqrt(discriminant), slow));
+            roots[count++] = q / fast;
+            if (q != 0.0) roots[count++] = c / q;
+        }
+    }
+
+    // A root the score only touches does not take it below
+    double crossing = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const double x = roots[i];
+        if (x > crossing && x < 1.0 && below(x * (1.0 - 1e-9))) crossing = x;
+    }
+    if (crossing == 0.0) {
+        // Below only in the limit, or never
+        return c < 0.0 ? origin : DecayClock::time_point::max();
+    }
+    const std::chrono::duration<double, DecayHours> hours(-std::log(crossing) / SLOW_RATE);
+    return origin + std::chrono::duration_cast<DecayClock::duration>(hours);
+}
+
+void MemoryTiers::SetCapacity(size_t hotCapacity, size_t warmCapacity) {
+    hot_capacity_ = hotCapacity;
+    warm_capacity_ = warmCapacity;
+}
+
+const WarmMemory* MemoryTiers::FindWarm(const std::string& id) const {
+    auto it = warm_.find(id);
+    return it != warm_.end() ? &it->second : nullptr;
+}
+
+void MemoryTiers::Hot(const std::string& id, TimePoint demoteAt) {
+    warm_.erase(id);
+    cold_.Cancel(id);
+    hot_.Schedule(id, demoteAt);
+}
+
+void MemoryTiers::Warm(const std::string& id, WarmMemory memory, TimePoint coldAt) {
+    hot_.Cancel(id);
+    warm_.insert_or_assign(id, std::move(memory));
+    cold_.Schedule(id, coldAt);
+}
+
+void MemoryTiers::Forget(const std::string& id) {
+    hot_.Cancel(id);
+    cold_.Cancel(id);
+    warm_.erase(id);
+}
+
+void MemoryTiers::Clear() {
+    hot_.Clear();
+    cold_.Clear();
+    warm_.clear();
+}
+
+bool MemoryTiers::Due(TimePoint now) {
+    return hot_.Next() <= now || hot_.Size() > hot_capacity_
+        || cold_.Next() <= now || cold_.Size() > warm_capacity_;
+}
+
+} // namespace cognitive
+} // namespace shandris
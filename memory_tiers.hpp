@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "decay.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+// Trait-based relevance of a memory as a function of time, in closed form:
+// constant + fast * e^(-FAST_RATE h) + slow * e^(-SLOW_RATE h), for h hours
+// after origin. FAST_RATE is twice SLOW_RATE, so the time a score crosses a
+// threshold is the root of a quadratic rather than something to search for.
+struct RelevanceCurve {
+    static constexpr double FAST_RATE = 0.1;
+    static constexpr double SLOW_RATE = 0.05;
+
+    DecayClock::time_point origin;
+    double constant = 0.0;
+    double fast = 0.0;
+    double slow = 0.0;
+
+    double At(DecayClock::time_point time) const;
+    // First time from origin on at which the score is below threshold;
+    // time_point::max() if it never gets there
+    DecayClock::time_point Crossing(double threshold) const;
+};
+
+enum class MemoryTier : uint8_t {
+    Hot,     // in the working set and every index
+    Warm,    // features only; the content reloads from the database
+    Cold     // in the database only
+};
+
+// What stays resident of a warm memory: the trait and tag features that
+// relevance and similarity scoring need, without the content or context
+struct WarmMemory {
+    double importance = 0.0;
+    double emotional_weight = 0.0;
+    TraitInfluenceMap trait_influences;
+    TagSet tags;
+    DecayClock::time_point created_at;
+};
+
+// Tier bookkeeping for the working set, as two deadline queues ordered by
+// relevance. A hot memory is due for warm once its relevance falls below
+// DEMOTE_THRESHOLD, and a warm one for cold below COLD_THRESHOLD; over
+// capacity, the memories with the earliest crossings go first. A pass
+// visits only memories whose tier is due to change, in slices of at most
+// limit. Not synchronized; the owner locks.
+class MemoryTiers {
+public:
+    using TimePoint = DecayClock::time_point;
+
+    // Where PruneMemoriesBasedOnTraits used to drop memories outright
+    static constexpr double DEMOTE_THRESHOLD = 0.2;
+    static constexpr double COLD_THRESHOLD = 0.1;
+    static constexpr size_t DEFAULT_HOT_CAPACITY = 100000;
+    static constexpr size_t DEFAULT_WARM_CAPACITY = 1000000;
+
+    // Takes effect as the next passes pop the overflow
+    void SetCapacity(size_t hotCapacity, size_t warmCapacity);
+
+    size_t HotSize() const { return hot_.Size(); }
+    size_t WarmSize() const { return warm_.size(); }
+    const WarmMemory* FindWarm(const std::string& id) const;
+
+    // Schedules a memory for warm at demoteAt, dropping any warm entry: it
+    // is back in the working set
+    void Hot(const std::string& id, TimePoint demoteAt);
+    // Moves a memory to warm, due for cold at coldAt
+    void Warm(const std::string& id, WarmMemory memory, TimePoint coldAt);
+    // Stops tracking it; the memory is cold or gone
+    void Forget(const std::string& id);
+    void Clear();
+
+    // fn(id, overCapacity) for up to limit hot memories due by now, then
+    // for the earliest crossings while the tier is over capacity. Each is
+    // unscheduled first; fn moves it on through Warm, or when not over
+    // capacity may reschedule it through Hot. Returns how many were visited.
+    template<typename Fn>
+    size_t PopHot(TimePoint now, size_t limit, Fn&& fn);
+    // The same for warm memories; fn(id, memory, overCapacity) gets the
+    // entry already removed, and an entry Warm does not bring back goes cold
+    template<typename Fn>
+    size_t PopWarm(TimePoint now, size_t limit, Fn&& fn);
+
+    // Whether either Pop would visit anything at now
+    bool Due(TimePoint now);
+
+private:
+    DeadlineQueue<std::string> hot_;     // crossings of DEMOTE_THRESHOLD
+    DeadlineQueue<std::string> cold_;    // crossings of COLD_THRESHOLD
+    std::unordered_map<std::string, WarmMemory> warm_;
+    size_t hot_capacity_ = DEFAULT_HOT_CAPACITY;
+    size_t warm_capacity_ = DEFAULT_WARM_CAPACITY;
+};
+
+template<typename Fn>
+size_t MemoryTiers::PopHot(TimePoint now, size_t limit, Fn&& fn) {
+    size_t visited = hot_.PopDue(now, [&](const std::string& id) { fn(id, false); }, limit);
+    std::string id;
+    for (; visited < limit && hot_.Size() > hot_capacity_ && hot_.PopFirst(id); ++visited) {
+        fn(id, true);
+    }
+    return visited;
+}
+
+template<typename Fn>
+size_t MemoryTiers::PopWarm(TimePoint now, size_t limit, Fn&& fn) {
+    auto visit = [&](const std::string& id, bool overCapacity) {
+        auto node = warm_.extract(id);
+        if (!node.empty()) fn(id, node.mapped(), overCapacity);
+    };
+    size_t visited = cold_.PopDue(now, [&](const std::string& id) { visit(id, false); }, limit);
+    std::string id;
+    for (; visited < limit && cold_.Size() > warm_capacity_ && cold_.PopFirst(id); ++visited) {
+        visit(id, true);
+    }
+    return visited;
+}
+
+} // namespace cognitive
+} // namespace shandris
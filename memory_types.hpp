@@ -6,6 +6,7 @@
 #include <set>
 #include <chrono>
 #include <nlohmann/json.hpp>
+#include "symbol_table.hpp"
 
 namespace shandris {
 namespace cognitive {
@@ -54,8 +55,8 @@ struct MemoryIndex {
 
 struct MemoryCluster {
     std::vector<std::string> memory_ids;
-    std::map<std::string, double> trait_frequencies;
-    std::set<std::string> common_tags;
+    TraitInfluenceMap trait_frequencies;
+    TagSet common_tags;
     double emotional_theme;
     double stability;
     std::chrono::system_clock::time_point last_accessed;
@@ -106,21 +107,41 @@ struct TraitTrendAnalysis {
 };
 
 struct TraitInteraction {
-    std::string source_trait;
-    std::string target_trait;
+    SymbolID source_trait;
+    SymbolID target_trait;
     double influence_strength;
     double temporal_correlation;
     double emotional_correlation;
     std::vector<std::string> shared_memories;
-    std::vector<std::string> shared_triggers;
+    TagSet shared_triggers; // memory tags acting as triggers
     std::chrono::system_clock::time_point last_interaction;
-    
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(TraitInteraction,
-        source_trait, target_trait, influence_strength,
-        temporal_correlation, emotional_correlation,
-        shared_memories, shared_triggers, last_interaction)
 };
 
+// Trait IDs are written by name so serialized interactions are unchanged
+inline void to_json(nlohmann::json& j, const TraitInteraction& interaction) {
+    j = nlohmann::json{
+        {"source_trait", TraitName(interaction.source_trait)},
+        {"target_trait", TraitName(interaction.target_trait)},
+        {"influence_strength", interaction.influence_strength},
+        {"temporal_correlation", interaction.temporal_correlation},
+        {"emotional_correlation", interaction.emotional_correlation},
+        {"shared_memories", interaction.shared_memories},
+        {"shared_triggers", interaction.shared_triggers},
+        {"last_interaction", interaction.last_interaction}
+    };
+}
+
+inline void from_json(const nlohmann::json& j, TraitInteraction& interaction) {
+    interaction.source_trait = InternTrait(j.at("source_trait").get<std::string>());
+    interaction.target_trait = InternTrait(j.at("target_trait").get<std::string>());
+    j.at("influence_strength").get_to(interaction.influence_strength);
+    j.at("temporal_correlation").get_to(interaction.temporal_correlation);
+    j.at("emotional_correlation").get_to(interaction.emotional_correlation);
+    j.at("shared_memories").get_to(interaction.shared_memories);
+    j.at("shared_triggers").get_to(interaction.shared_triggers);
+    j.at("last_interaction").get_to(interaction.last_interaction);
+}
+
 struct ClusterDivergence {
     double trait_divergence;
     double temporal_divergence;
@@ -145,4 +166,4 @@ struct ClusterSimilarity {
         temporal_proximity, overall_similarity)
 };
 
-}} // namespace shandris::cognitive 
\ No newline at end of file
+}} // namespace shandris::cognitive 
\ No newline at end of file
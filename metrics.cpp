@@ -0,0 +1,243 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+void AddInto(std::vector<uint64_t>& totals, const auto& cells) {
+    for (size_t i = 0; i < totals.size(); ++i) {
+        totals[i] += cells[i].load(std::memory_order_relaxed);
+    }
+}
+
+std::string FormatDouble(double value) {
+    std::ostringstream out;
+    out << std::setprecision(10) << value;
+    return out.str();
+}
+
+std::string Series(const std::string& name, const std::string& labels, const std::string& extra = {}) {
+    if (labels.empty() && extra.empty()) return name;
+    std::string series = name + "{" + labels;
+    if (!labels.empty() && !extra.empty()) series += ",";
+    return series + extra + "}";
+}
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::Global() {
+    // Never destroyed, so threads exiting during shutdown can still retire
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+MetricsRegistry::ThreadSlot::ThreadSlot(MetricsRegistry& registry)
+    : registry_(registry), block_(std::make_unique<ThreadBlock>()) {
+    std::lock_guard<std::mutex> lock(registry_.mutex_);
+    registry_.liveBlocks_.push_back(block_.get());
+}
+
+MetricsRegistry::ThreadSlot::~ThreadSlot() {
+    registry_.Retire(*block_);
+}
+
+MetricsRegistry::ThreadBlock& MetricsRegistry::LocalBlock() {
+    thread_local ThreadSlot slot(Global());
+    return slot.Block();
+}
+
+size_t MetricsRegistry::BucketFor(uint64_t nanoseconds) {
+    // Bucket b holds (2^(b-1), 2^b] ns, so its bound is an inclusive le
+    const size_t bucket = nanoseconds ? std::bit_width(nanoseconds - 1) : 0;
+    return std::min(bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+double MetricsRegistry::BucketBound(size_t bucket) {
+    return std::ldexp(1.0, static_cast<int>(bucket)) * 1e-9;
+}
+
+Counter MetricsRegistry::GetCounter(const std::string& name, const std::string& labels, const std::string& help) {
+    return Counter(Register(Kind::Counter, name, labels, help));
+}
+
+Histogram MetricsRegistry::GetHistogram(const std::string& name, const std::string& labels, const std::string& help) {
+    return Histogram(Register(Kind::Histogram, name, labels, help));
+}
+
+Gauge MetricsRegistry::GetGauge(const std::string& name, const std::string& labels, const std::string& help) {
+    return Gauge(Register(Kind::Gauge, name, labels, help));
+}
+
+uint32_t MetricsRegistry::Register(Kind kind, const std::string& name, const std::string& labels, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& definition : definitions_) {
+        if (definition.kind == kind && definition.name == name && definition.labels == labels) {
+            return definition.index;
+        }
+    }
+
+    uint32_t* count = kind == Kind::Counter ? &counterCount_
+                    : kind == Kind::Histogram ? &histogramCount_ : &gaugeCount_;
+    const size_t capacity = kind == Kind::Counter ? MAX_COUNTERS
+                          : kind == Kind::Histogram ? MAX_HISTOGRAMS : MAX_GAUGES;
+    if (*count >= capacity) return UINT32_MAX;
+
+    definitions_.push_back({kind, *count, name, labels, help});
+    return (*count)++;
+}
+
+void MetricsRegistry::Retire(const ThreadBlock& block) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < MAX_COUNTERS; ++i) {
+        auto& cell = retired_.counters[i];
+        cell.store(cell.load(std::memory_order_relaxed) + block.counters[i].load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+    }
+    for (size_t h = 0; h < MAX_HISTOGRAMS; ++h) {
+        const auto& from = block.histograms[h];
+        auto& to = retired_.histograms[h];
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+            to.buckets[b].store(to.buckets[b].load(std::memory_order_relaxed)
+                                + from.buckets[b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        to.count.store(to.count.load(std::memory_order_relaxed) + from.count.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+        to.sum.store(to.sum.load(std::memory_order_relaxed) + from.sum.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+    }
+    liveBlocks_.erase(std::remove(liveBlocks_.begin(), liveBlocks_.end(), &block), liveBlocks_.end());
+}
+
+// Caller holds mutex_
+void MetricsRegistry::Collect(std::vector<uint64_t>& counters, std::vector<HistogramTotals>& histograms) const {
+    counters.assign(counterCount_, 0);
+    histograms.assign(histogramCount_, {});
+
+    auto add = [&](const ThreadBlock& block) {
+        AddInto(counters, block.counters);
+        for (size_t h = 0; h < histograms.size(); ++h) {
+            const auto& cells = block.histograms[h];
+            auto& totals = histograms[h];
+            for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                totals.buckets[b] += cells.buckets[b].load(std::memory_order_relaxed);
+            }
+            totals.count += cells.count.load(std::memory_order_relaxed);
+            totals.sum += cells.sum.load(std::memory_order_relaxed);
+        }
+    };
+    add(retired_);
+    for (const ThreadBlock* block : liveBlocks_) {
+        add(*block);
+    }
+}
+
+std::string MetricsRegistry::ExportPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint64_t> counters;
+    std::vector<HistogramTotals> histograms;
+    Collect(counters, histograms);
+
+    // Series of one family must be contiguous
+    std::map<std::string, std::vector<const Definition*>> families;
+    for (const auto& definition : definitions_) {
+        families[definition.name].push_back(&definition);
+    }
+
+    std::ostringstream out;
+    for (const auto& [name, series] : families) {
+        const Definition& first = *series.front();
+        if (!first.help.empty()) {
+            out << "# HELP " << name << " " << first.help << "\n";
+        }
+        const char* type = first.kind == Kind::Counter ? "counter"
+                         : first.kind == Kind::Histogram ? "histogram" : "gauge";
+        out << "# TYPE " << name << " " << type << "\n";
+
+        for (const Definition* definition : series) {
+            if (definition->kind != first.kind) continue;
+            switch (definition->kind) {
+            case Kind::Counter:
+                out << Series(name, definition->labels) << " " << counters[definition->index] << "\n";
+                break;
+            case Kind::Gauge:
+                out << Series(name, definition->labels) << " "
+                    << FormatDouble(gauges_[definition->index].load(std::memory_order_relaxed)) << "\n";
+                break;
+            case Kind::Histogram: {
+                const auto& totals = histograms[definition->index];
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b + 1 < HISTOGRAM_BUCKETS; ++b) {
+                    cumulative += totals.buckets[b];
+                    out << Series(name + "_bucket", definition->labels, "le=\"" + FormatDouble(BucketBound(b)) + "\"")
+                        << " " << cumulative << "\n";
+                }
+                out << Series(name + "_bucket", definition->labels, "le=\"+Inf\"") << " " << totals.count << "\n";
+                out << Series(name + "_sum", definition->labels) << " " << FormatDouble(totals.sum * 1e-9) << "\n";
+                out << Series(name + "_count", definition->labels) << " " << totals.count << "\n";
+                break;
+            }
+            }
+        }
+    }
+    return out.str();
+}
+
+nlohmann::json MetricsRegistry::Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint64_t> counters;
+    std::vector<HistogramTotals> histograms;
+    Collect(counters, histograms);
+
+    // Upper bound of the bucket holding the p-th percentile
+    auto percentile = [](const HistogramTotals& totals, double p) {
+        if (totals.count == 0) return 0.0;
+        const uint64_t rank = static_cast<uint64_t>(std::ceil(p * totals.count));
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+            cumulative += totals.buckets[b];
+            if (cumulative >= rank) return BucketBound(b);
+        }
+        return BucketBound(HISTOGRAM_BUCKETS - 1);
+    };
+
+    nlohmann::json snapshot = {
+        {"counters", nlohmann::json::array()},
+        {"gauges", nlohmann::json::array()},
+        {"histograms", nlohmann::json::array()}
+    };
+    for (const auto& definition : definitions_) {
+        nlohmann::json entry = {{"name", definition.name}, {"labels", definition.labels}};
+        switch (definition.kind) {
+        case Kind::Counter:
+            entry["value"] = counters[definition.index];
+            snapshot["counters"].push_back(std::move(entry));
+            break;
+        case Kind::Gauge:
+            entry["value"] = gauges_[definition.index].load(std::memory_order_relaxed);
+            snapshot["gauges"].push_back(std::move(entry));
+            break;
+        case Kind::Histogram: {
+            const auto& totals = histograms[definition.index];
+            entry["count"] = totals.count;
+            entry["sum_seconds"] = totals.sum * 1e-9;
+            entry["mean_seconds"] = totals.count ? totals.sum * 1e-9 / totals.count : 0.0;
+            entry["p50_seconds"] = percentile(totals, 0.50);
+            entry["p90_seconds"] = percentile(totals, 0.90);
+            entry["p99_seconds"] = percentile(totals, 0.99);
+            snapshot["histograms"].push_back(std::move(entry));
+            break;
+        }
+        }
+    }
+    return snapshot;
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace shandris {
+namespace cognitive {
+
+class MetricsRegistry;
+
+// Handles are plain indices into the registry. A default handle, or one
+// returned once the registry is full, records nothing. Register once (a
+// function-local static or a member) and keep the handle; lookup takes a lock.
+class Counter {
+public:
+    Counter() = default;
+    void Add(uint64_t n = 1) const;
+    bool Valid() const { return index_ != INVALID; }
+
+private:
+    friend class MetricsRegistry;
+    static constexpr uint32_t INVALID = UINT32_MAX;
+    explicit Counter(uint32_t index) : index_(index) {}
+    uint32_t index_ = INVALID;
+};
+
+// Latency histogram with power-of-two nanosecond buckets
+class Histogram {
+public:
+    Histogram() = default;
+    void Record(std::chrono::nanoseconds elapsed) const;
+    bool Valid() const { return index_ != INVALID; }
+
+private:
+    friend class MetricsRegistry;
+    static constexpr uint32_t INVALID = UINT32_MAX;
+    explicit Histogram(uint32_t index) : index_(index) {}
+    uint32_t index_ = INVALID;
+};
+
+// Last-written value; for sizes sampled where they are already known
+class Gauge {
+public:
+    Gauge() = default;
+    void Set(double value) const;
+    bool Valid() const { return index_ != INVALID; }
+
+private:
+    friend class MetricsRegistry;
+    static constexpr uint32_t INVALID = UINT32_MAX;
+    explicit Gauge(uint32_t index) : index_(index) {}
+    uint32_t index_ = INVALID;
+};
+
+// Records the lifetime of the scope into a histogram. Reads no clock while
+// metrics are disabled.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram histogram);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Process-wide metrics. Hot-path writes go to a block owned by the calling
+// thread (relaxed stores, no sharing); export sums the live blocks and the
+// totals folded in from exited threads. Building with
+// SHANDRIS_METRICS_DISABLED compiles every recording call down to nothing.
+class MetricsRegistry {
+public:
+    static constexpr size_t MAX_COUNTERS = 256;
+    static constexpr size_t MAX_HISTOGRAMS = 64;
+    static constexpr size_t MAX_GAUGES = 256;
+    static constexpr size_t HISTOGRAM_BUCKETS = 40;    // 1ns .. ~9 minutes
+
+    static MetricsRegistry& Global();
+
+    // Labels are Prometheus label pairs without braces: stage="analysis"
+    Counter GetCounter(const std::string& name, const std::string& labels = {}, const std::string& help = {});
+    Histogram GetHistogram(const std::string& name, const std::string& labels = {}, const std::string& help = {});
+    Gauge GetGauge(const std::string& name, const std::string& labels = {}, const std::string& help = {});
+
+#ifdef SHANDRIS_METRICS_DISABLED
+    static constexpr bool Enabled() { return false; }
+    static void SetEnabled(bool) {}
+#else
+    // The disabled path costs one relaxed load
+    static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+#endif
+
+    // Pull API: Prometheus text exposition format, or a JSON snapshot with
+    // bucket-estimated percentiles for each histogram
+    std::string ExportPrometheus() const;
+    nlohmann::json Snapshot() const;
+
+private:
+    friend class Counter;
+    friend class Histogram;
+    friend class Gauge;
+
+    enum class Kind { Counter, Histogram, Gauge };
+
+    struct Definition {
+        Kind kind;
+        uint32_t index;
+        std::string name;
+        std::string labels;
+        std::string help;
+    };
+
+    struct HistogramCells {
+        std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};    // nanoseconds
+    };
+
+    struct ThreadBlock {
+        std::array<std::atomic<uint64_t>, MAX_COUNTERS> counters{};
+        std::array<HistogramCells, MAX_HISTOGRAMS> histograms{};
+    };
+
+    struct HistogramTotals {
+        std::array<uint64_t, HISTOGRAM_BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+    };
+
+    // Owns this thread's block; folds it into the retired totals on exit
+    class ThreadSlot {
+    public:
+        explicit ThreadSlot(MetricsRegistry& registry);
+        ~ThreadSlot();
+        ThreadBlock& Block() { return *block_; }
+
+    private:
+        MetricsRegistry& registry_;
+        std::unique_ptr<ThreadBlock> block_;
+    };
+
+    MetricsRegistry() = default;
+
+    static ThreadBlock& LocalBlock();
+    static size_t BucketFor(uint64_t nanoseconds);
+    // Upper bound of a bucket, in seconds
+    static double BucketBound(size_t bucket);
+
+    uint32_t Register(Kind kind, const std::string& name, const std::string& labels, const std::string& help);
+    void Retire(const ThreadBlock& block);
+    void Collect(std::vector<uint64_t>& counters, std::vector<HistogramTotals>& histograms) const;
+
+#ifndef SHANDRIS_METRICS_DISABLED
+    static inline std::atomic<bool> enabled_{true};
+#endif
+
+    mutable std::mutex mutex_;
+    std::vector<Definition> definitions_;
+    uint32_t counterCount_ = 0;
+    uint32_t histogramCount_ = 0;
+    uint32_t gaugeCount_ = 0;
+    std::vector<ThreadBlock*> liveBlocks_;
+    ThreadBlock retired_;
+    std::array<std::atomic<double>, MAX_GAUGES> gauges_{};
+};
+
+inline void Counter::Add(uint64_t n) const {
+    if (!MetricsRegistry::Enabled() || !Valid()) return;
+    auto& cell = MetricsRegistry::LocalBlock().counters[index_];
+    cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void Histogram::Record(std::chrono::nanoseconds elapsed) const {
+    if (!MetricsRegistry::Enabled() || !Valid()) return;
+    const uint64_t nanoseconds = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    auto& cells = MetricsRegistry::LocalBlock().histograms[index_];
+    auto& bucket = cells.buckets[MetricsRegistry::BucketFor(nanoseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cells.count.store(cells.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cells.sum.store(cells.sum.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+inline void Gauge::Set(double value) const {
+    if (!MetricsRegistry::Enabled() || !Valid()) return;
+    MetricsRegistry::Global().gauges_[index_].store(value, std::memory_order_relaxed);
+}
+
+inline ScopedTimer::ScopedTimer(Histogram histogram) : histogram_(histogram) {
+    if (MetricsRegistry::Enabled() && histogram_.Valid()) {
+        start_ = std::chrono::steady_clock::now();
+    } else {
+        histogram_ = Histogram();
+    }
+}
+
+inline ScopedTimer::~ScopedTimer() {
+    if (histogram_.Valid()) {
+        histogram_.Record(std::chrono::steady_clock::now() - start_);
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
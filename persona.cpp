@@ -1,11 +1,114 @@
 #include "shandris/persona.hpp"
+#include "decay.hpp"
+#include "emotion_schema.hpp"
+#include "memory_similarity.hpp"
+#include "recall.hpp"
+#include "scratch_arena.hpp"
+#include "tensor.hpp"
+#include "tensor_kernels.hpp"
+#include "vector_index.hpp"
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <cmath>
 #include <chrono>
 #include <numeric>
+#include <string_view>
 
 namespace shandris {
 
+namespace {
+
+// Emotional tags score as tags, triggers as triggers
+constexpr cognitive::SimilarityWeights ASSOCIATION_WEIGHTS{
+    .shared_tag = 0.3,
+    .shared_trigger = 0.2
+};
+
+constexpr cognitive::SimilarityWeights MEMORY_SIMILARITY_WEIGHTS{
+    .shared_tag = 0.3,
+    .shared_trigger = 0.2,
+    .emotional_proximity = 0.2,
+    .max_score = 1.0
+};
+
+cognitive::MemoryFeatures BuildMemoryFeatures(const MemoryEvent& memory) {
+    auto& symbols = cognitive::SymbolTable::Global();
+    return {
+        .tags = symbols.InternAll(cognitive::SymbolKind::Emotion, memory.EmotionalTags),
+        .triggers = symbols.InternAll(cognitive::SymbolKind::Trigger, memory.Triggers),
+        .emotional_weight = memory.EmotionalWeight
+    };
+}
+
+void AppendIndex(std::string& name, size_t index) {
+    char digits[20];
+    const char* end = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+    name.append(digits, end);
+}
+
+// prefix followed by the indices joined with '_', without temporaries
+std::string IndexedName(std::string_view prefix, size_t first) {
+    std::string name;
+    name.reserve(prefix.size() + 41);
+    name.append(prefix);
+    AppendIndex(name, first);
+    return name;
+}
+
+std::string IndexedName(std::string_view prefix, size_t first, size_t second) {
+    std::string name = IndexedName(prefix, first);
+    name += '_';
+    AppendIndex(name, second);
+    return name;
+}
+
+double Sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+using cognitive::StateDimension;
+using cognitive::StateVector;
+
+// CurrentState fields in schema order
+constexpr std::array<double EmotionalState::*, cognitive::DIMENSIONS<StateDimension>> STATE_FIELDS = {
+    &EmotionalState::Arousal, &EmotionalState::Mood, &EmotionalState::Energy,
+    &EmotionalState::Flirtation, &EmotionalState::Intimacy, &EmotionalState::Playfulness,
+    &EmotionalState::Confidence, &EmotionalState::FemininePresence, &EmotionalState::SapphicConnection,
+    &EmotionalState::EmotionalDepth, &EmotionalState::Vulnerability, &EmotionalState::Empathy,
+    &EmotionalState::Sensuality, &EmotionalState::Creativity, &EmotionalState::Intuition,
+    &EmotionalState::Passion, &EmotionalState::Authenticity
+};
+
+StateVector StateOf(const EmotionalState& state) {
+    StateVector v;
+    for (size_t i = 0; i < v.SIZE; ++i) v.values[i] = state.*STATE_FIELDS[i];
+    return v;
+}
+
+void SetState(EmotionalState& state, const StateVector& values) {
+    for (size_t i = 0; i < values.SIZE; ++i) state.*STATE_FIELDS[i] = values.values[i];
+}
+
+// Raised by a sapphic trigger, scaled by the trigger's sensitivity and
+// capped at 1
+constexpr StateVector SAPPHIC_RESPONSE_GAINS = [] {
+    StateVector gains;
+    gains[StateDimension::Flirtation] = 0.15;
+    gains[StateDimension::Intimacy] = 0.1;
+    gains[StateDimension::FemininePresence] = 0.2;
+    gains[StateDimension::SapphicConnection] = 0.15;
+    return gains;
+}();
+
+// Emotional state templates are not defined per state yet; every dimension
+// targets the midpoint
+StateVector TargetEmotionTemplate(const std::string& state) {
+    return StateVector::Filled(0.5);
+}
+
+} // namespace
+
 PersonaManager::PersonaManager() {
     // Initialize with default persona
     CurrentPersona = {
@@ -405,10 +508,8 @@ void PersonaManager::ProcessSapphicEmotionalResponse(const std::string& personaI
     pattern.Triggers = {trigger};
 
     // Update emotional state with enhanced sapphic responses
-    persona->CurrentState.Flirtation = std::min(1.0, persona->CurrentState.Flirtation + (0.15 * sensitivity));
-    persona->CurrentState.Intimacy = std::min(1.0, persona->CurrentState.Intimacy + (0.1 * sensitivity));
-    persona->CurrentState.FemininePresence = std::min(1.0, persona->CurrentState.FemininePresence + (0.2 * sensitivity));
-    persona->CurrentState.SapphicConnection = std::min(1.0, persona->CurrentState.SapphicConnection + (0.15 * sensitivity));
+    SetState(persona->CurrentState,
+             cognitive::AddCapped(StateOf(persona->CurrentState), SAPPHIC_RESPONSE_GAINS, sensitivity, 1.0));
 
     // Process any active conflicts that might be affected
     ProcessActiveConflicts(persona, trigger, emotionalImpact);
@@ -466,56 +567,43 @@ void PersonaManager::UpdateTrustDynamics(BasePersona* persona, const std::string
 }
 
 void PersonaManager::UpdateMemoryAssociations(BasePersona* persona) {
-    // Combine short and long term memories
-    std::vector<MemoryEvent> allMemories = persona->Memory.ShortTermMemories;
-    allMemories.insert(allMemories.end(), 
-                      persona->Memory.LongTermMemories.begin(), 
-                      persona->Memory.LongTermMemories.end());
-
-    // Create new associations between memories
-    for (size_t i = 0; i < allMemories.size(); ++i) {
-        for (size_t j = i + 1; j < allMemories.size(); ++j) {
-            const auto& mem1 = allMemories[i];
-            const auto& mem2 = allMemories[j];
-
-            // Calculate association strength based on shared elements
-            double strength = 0.0;
-            std::vector<std::string> sharedEmotions;
-            std::vector<std::string> sharedTriggers;
-
-            // Check shared emotions
-            for (const auto& emotion : mem1.EmotionalTags) {
-                if (std::find(mem2.EmotionalTags.begin(), mem2.EmotionalTags.end(), emotion) != 
-                    mem2.EmotionalTags.end()) {
-                    strength += 0.3;
-                    sharedEmotions.push_back(emotion);
-                }
-            }
+    auto& symbols = cognitive::SymbolTable::Global();
 
-            // Check shared triggers
-            for (const auto& trigger : mem1.Triggers) {
-                if (std::find(mem2.Triggers.begin(), mem2.Triggers.end(), trigger) != 
-                    mem2.Triggers.end()) {
-                    strength += 0.2;
-                    sharedTriggers.push_back(trigger);
-                }
-            }
+    // Reference short and long term memories in place
+    std::pmr::vector<const MemoryEvent*> allMemories(cognitive::ScratchResource());
+    allMemories.reserve(persona->Memory.ShortTermMemories.size() + persona->Memory.LongTermMemories.size());
+    for (const auto& memory : persona->Memory.ShortTermMemories) allMemories.push_back(&memory);
+    for (const auto& memory : persona->Memory.LongTermMemories) allMemories.push_back(&memory);
 
-            // If significant association found, create new association
-            if (strength > 0.4) {
-                MemoryAssociation association;
-                association.SourceMemory = mem1.Content;
-                association.TargetMemory = mem2.Content;
-                association.AssociationStrength = strength;
-                association.AssociationType = "emotional";
-                association.SharedEmotions = sharedEmotions;
-                association.SharedTriggers = sharedTriggers;
-                association.LastAccessed = std::chrono::system_clock::now();
-
-                persona->Memory.MemoryAssociations.push_back(association);
-            }
-        }
+    std::vector<cognitive::MemoryFeatures> features;
+    features.reserve(allMemories.size());
+    for (const auto* memory : allMemories) {
+        features.push_back(BuildMemoryFeatures(*memory));
     }
+
+    // Create new associations between memories sharing emotions or triggers
+    cognitive::FeatureList shared;
+    auto now = std::chrono::system_clock::now();
+    cognitive::SimilarityEngine::ScorePairs(features, ASSOCIATION_WEIGHTS, 0.4,
+        [&](size_t i, size_t j, double strength) {
+            MemoryAssociation association;
+            association.SourceMemory = allMemories[i]->Content;
+            association.TargetMemory = allMemories[j]->Content;
+            association.AssociationStrength = strength;
+            association.AssociationType = "emotional";
+            association.LastAccessed = now;
+
+            cognitive::SimilarityEngine::SharedFeatures(features[i].tags, features[j].tags, shared);
+            for (cognitive::FeatureID emotion : shared) {
+                association.SharedEmotions.push_back(symbols.Name(cognitive::SymbolKind::Emotion, emotion));
+            }
+            cognitive::SimilarityEngine::SharedFeatures(features[i].triggers, features[j].triggers, shared);
+            for (cognitive::FeatureID trigger : shared) {
+                association.SharedTriggers.push_back(symbols.Name(cognitive::SymbolKind::Trigger, trigger));
+            }
+
+            persona->Memory.MemoryAssociations.push_back(std::move(association));
+        });
 }
 
 void PersonaManager::UpdateRelationshipDynamics(BasePersona* persona) {
@@ -690,8 +778,18 @@ void PersonaManager::ProcessPatternEvolution(BasePersona* persona) {
 
 void PersonaManager::ProcessMemoryConsolidation(BasePersona* persona) {
     auto now = std::chrono::system_clock::now();
+    auto& shortTermMemories = persona->Memory.ShortTermMemories;
+
+    // Feature records are built once instead of per compared pair
+    std::vector<cognitive::MemoryFeatures> features;
+    features.reserve(shortTermMemories.size());
+    for (const auto& memory : shortTermMemories) {
+        features.push_back(BuildMemoryFeatures(memory));
+    }
+    std::vector<double> similarities;
     
-    for (auto& memory : persona->Memory.ShortTermMemories) {
+    for (size_t i = 0; i < shortTermMemories.size(); ++i) {
+        auto& memory = shortTermMemories[i];
         // Check if memory should be consolidated
         double consolidationChance = (persona->MemoryConsolidationSkill * 0.3) + 
                                    (memory.EmotionalWeight * 0.7);
@@ -704,12 +802,11 @@ void PersonaManager::ProcessMemoryConsolidation(BasePersona* persona) {
             consolidation.LastReinforcement = now;
             
             // Find related memories
-            for (const auto& otherMemory : persona->Memory.ShortTermMemories) {
-                if (otherMemory.Content != memory.Content) {
-                    double similarity = CalculateMemorySimilarity(memory, otherMemory);
-                    if (similarity > 0.5) {
-                        consolidation.RelatedMemories.push_back(otherMemory.Content);
-                    }
+            cognitive::SimilarityEngine::ScoreBatch(features[i], features, MEMORY_SIMILARITY_WEIGHTS, similarities);
+            for (size_t j = 0; j < shortTermMemories.size(); ++j) {
+                const auto& otherMemory = shortTermMemories[j];
+                if (otherMemory.Content != memory.Content && similarities[j] > 0.5) {
+                    consolidation.RelatedMemories.push_back(otherMemory.Content);
                 }
             }
             
@@ -733,14 +830,23 @@ void PersonaManager::ProcessStateTransitions(BasePersona* persona) {
                                 (transition.TransitionProbability * 0.6);
         
         if (transitionChance > 0.7) {
-            // Blend emotional states
+            // Blend emotional states: schema dimensions in one pass over
+            // per-dimension weights, anything else by name
+            StateVector weights;
             for (const auto& [emotion, blendFactor] : transition.StateBlendFactors) {
+                StateDimension dimension;
+                if (cognitive::FindDimension(emotion, dimension)) {
+                    weights[dimension] = blendFactor;
+                    continue;
+                }
                 double currentValue = persona->CurrentState.GetEmotionValue(emotion);
                 double targetValue = GetTargetEmotionValue(transition.ToState, emotion);
                 double newValue = (currentValue * (1 - blendFactor)) + 
                                 (targetValue * blendFactor);
                 persona->CurrentState.SetEmotionValue(emotion, newValue);
             }
+            SetState(persona->CurrentState, cognitive::Lerp(StateOf(persona->CurrentState),
+                                                            TargetEmotionTemplate(transition.ToState), weights));
             
             // Update transition history
             transition.LastTransition = now;
@@ -778,33 +884,15 @@ void PersonaManager::ProcessRelationshipEvolution(BasePersona* persona) {
 }
 
 double PersonaManager::CalculateMemorySimilarity(const MemoryEvent& mem1, const MemoryEvent& mem2) {
-    double similarity = 0.0;
-    
-    // Compare emotional tags
-    for (const auto& tag : mem1.EmotionalTags) {
-        if (std::find(mem2.EmotionalTags.begin(), mem2.EmotionalTags.end(), tag) != 
-            mem2.EmotionalTags.end()) {
-            similarity += 0.3;
-        }
-    }
-    
-    // Compare triggers
-    for (const auto& trigger : mem1.Triggers) {
-        if (std::find(mem2.Triggers.begin(), mem2.Triggers.end(), trigger) != 
-            mem2.Triggers.end()) {
-            similarity += 0.2;
-        }
-    }
-    
-    // Compare emotional weights
-    similarity += 0.2 * (1.0 - std::abs(mem1.EmotionalWeight - mem2.EmotionalWeight));
-    
-    return std::min(1.0, similarity);
+    return cognitive::SimilarityEngine::Score(
+        BuildMemoryFeatures(mem1), BuildMemoryFeatures(mem2), MEMORY_SIMILARITY_WEIGHTS);
 }
 
 double PersonaManager::GetTargetEmotionValue(const std::string& state, const std::string& emotion) {
-    // This would be implemented based on predefined emotional state templates
-    // For now, return a default value
+    StateDimension dimension;
+    if (cognitive::FindDimension(emotion, dimension)) {
+        return TargetEmotionTemplate(state)[dimension];
+    }
     return 0.5;
 }
 
@@ -1084,220 +1172,197 @@ void PersonaManager::InitializePersonaSystem(BasePersona& persona) {
     };
 }
 
-void PersonaManager::ProcessTensorEvolution(const std::vector<std::vector<std::vector<double>>>& inputTensor,
-                                          const std::vector<std::vector<double>>& transformationMatrix,
-                                          std::vector<std::vector<std::vector<double>>>& outputTensor) {
-    // Initialize output tensor with same dimensions as input
-    outputTensor = inputTensor;
+void PersonaManager::ProcessTensorEvolution(const Tensor3& inputTensor,
+                                          const Tensor2& transformationMatrix,
+                                          Tensor3& outputTensor) {
+    // Every element is scaled by its column sum, so sum the columns once
+    const size_t depth = inputTensor.dim(2);
+    thread_local std::vector<double> columnSums;
+    columnSums.assign(depth, 0.0);
+    for (size_t l = 0; l < transformationMatrix.rows(); ++l) {
+        const double* row = transformationMatrix.Row(l);
+        for (size_t k = 0; k < depth; ++k) {
+            columnSums[k] += row[k];
+        }
+    }
     
-    // Apply transformation matrix to each layer of the tensor
-    for (size_t i = 0; i < inputTensor.size(); ++i) {
-        for (size_t j = 0; j < inputTensor[i].size(); ++j) {
-            for (size_t k = 0; k < inputTensor[i][j].size(); ++k) {
-                double sum = 0.0;
-                for (size_t l = 0; l < transformationMatrix.size(); ++l) {
-                    sum += inputTensor[i][j][k] * transformationMatrix[l][k];
-                }
-                outputTensor[i][j][k] = sum;
+    // Apply transformation matrix to each layer of the tensor; outputTensor
+    // may be inputTensor
+    outputTensor.Resize(inputTensor.shape());
+    for (size_t i = 0; i < inputTensor.dim(0); ++i) {
+        for (size_t j = 0; j < inputTensor.dim(1); ++j) {
+            const double* in = inputTensor.Row(i, j);
+            double* out = outputTensor.Row(i, j);
+            for (size_t k = 0; k < depth; ++k) {
+                out[k] = in[k] * columnSums[k];
             }
         }
     }
 }
 
-void PersonaManager::ProcessFeedbackLoop(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                       const std::vector<std::vector<std::vector<double>>>& feedback,
-                                       std::vector<std::vector<std::vector<double>>>& evolvedState) {
+void PersonaManager::ProcessTensorEvolution(Tensor3& tensor, const Tensor2& transformationMatrix) {
+    ProcessTensorEvolution(tensor, transformationMatrix, tensor);
+}
+
+void PersonaManager::ProcessFeedbackLoop(const Tensor3& currentState,
+                                       const Tensor3& feedback,
+                                       Tensor3& evolvedState) {
     // Calculate feedback strength
     double feedbackStrength;
     CalculateFeedbackStrength(feedback, feedbackStrength);
     
-    // Apply feedback modulation
-    std::vector<std::vector<std::vector<double>>> modulatedState;
-    ApplyFeedbackModulation(currentState, feedback, modulatedState);
-    
-    // Blend current state with modulated state based on feedback strength
-    evolvedState = currentState;
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                evolvedState[i][j][k] = 
-                    (1.0 - feedbackStrength) * currentState[i][j][k] + 
-                    feedbackStrength * modulatedState[i][j][k];
-            }
-        }
-    }
+    // Modulate and blend in one pass instead of materializing the modulated state
+    TransformTensor(currentState, feedback, evolvedState,
+        [feedbackStrength](double state, double signal) {
+            double modulated = state * Sigmoid(signal);
+            return (1.0 - feedbackStrength) * state + feedbackStrength * modulated;
+        });
     
     // Update feedback history
     UpdateFeedbackHistory(feedback);
 }
 
-void PersonaManager::ProcessEvolutionaryStep(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                           const std::vector<std::vector<std::vector<double>>>& targetState,
-                                           std::vector<std::vector<std::vector<double>>>& evolvedState) {
+void PersonaManager::ProcessFeedbackLoop(Tensor3& state, const Tensor3& feedback) {
+    ProcessFeedbackLoop(state, feedback, state);
+}
+
+void PersonaManager::ProcessEvolutionaryStep(const Tensor3& currentState,
+                                           const Tensor3& targetState,
+                                           Tensor3& evolvedState) {
     auto& persona = CurrentPersona;
     
     // Calculate evolutionary fitness
     double fitness;
     CalculateEvolutionaryFitness(currentState, targetState, fitness);
     
-    // Apply evolution based on fitness
-    evolvedState = currentState;
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                double evolutionRate = persona.EvolutionMetrics.LearningRate * fitness;
-                evolvedState[i][j][k] = 
-                    (1.0 - evolutionRate) * currentState[i][j][k] + 
-                    evolutionRate * targetState[i][j][k];
-            }
-        }
-    }
+    // Apply evolution based on fitness. evolvedState must not alias
+    // currentState, the metrics below compare the two.
+    double evolutionRate = persona.EvolutionMetrics.LearningRate * fitness;
+    BlendTensors(currentState, targetState, evolutionRate, evolvedState);
     
     // Update evolution metrics
     UpdateEvolutionMetrics(evolvedState, currentState, persona.EvolutionMetrics);
 }
 
-void PersonaManager::ProcessResonancePatterns(const std::vector<std::vector<std::vector<double>>>& stateTensor,
+void PersonaManager::ProcessResonancePatterns(const Tensor3& stateTensor,
                                             std::vector<DynamicResonance>& resonances) {
     resonances.clear();
+    const auto now = std::chrono::system_clock::now();
+    std::pmr::vector<size_t> connected(cognitive::ScratchResource());
     
     // Analyze patterns in the state tensor
-    for (size_t i = 0; i < stateTensor.size(); ++i) {
-        for (size_t j = 0; j < stateTensor[i].size(); ++j) {
+    for (size_t i = 0; i < stateTensor.dim(0); ++i) {
+        for (size_t j = 0; j < stateTensor.dim(1); ++j) {
             // Check for resonance patterns
+            const double* row = stateTensor.Row(i, j);
             double patternStrength = 0.0;
-            std::vector<std::string> connectedPatterns;
+            connected.clear();
             
-            for (size_t k = 0; k < stateTensor[i][j].size(); ++k) {
-                if (stateTensor[i][j][k] > 0.7) { // Threshold for significant resonance
-                    patternStrength += stateTensor[i][j][k];
-                    connectedPatterns.push_back("pattern_" + std::to_string(k));
+            for (size_t k = 0; k < stateTensor.dim(2); ++k) {
+                if (row[k] > 0.7) { // Threshold for significant resonance
+                    patternStrength += row[k];
+                    connected.push_back(k);
                 }
             }
             
+            // Names are only built for cells that resonate
             if (patternStrength > 0.0) {
                 DynamicResonance resonance;
-                resonance.ResonanceID = "resonance_" + std::to_string(i) + "_" + std::to_string(j);
+                resonance.ResonanceID = IndexedName("resonance_", i, j);
                 resonance.BaseFrequency = patternStrength;
                 resonance.CurrentAmplitude = patternStrength;
-                resonance.ConnectedPatterns = connectedPatterns;
-                resonance.PatternInfluences = std::vector<double>(connectedPatterns.size(), patternStrength);
-                resonance.LastResonance = std::chrono::system_clock::now();
+                resonance.PatternInfluences.assign(connected.size(), patternStrength);
+                resonance.ConnectedPatterns.reserve(connected.size());
+                for (size_t k : connected) {
+                    resonance.ConnectedPatterns.push_back(IndexedName("pattern_", k));
+                }
+                resonance.LastResonance = now;
                 
-                resonances.push_back(resonance);
+                resonances.push_back(std::move(resonance));
             }
         }
     }
 }
 
-void PersonaManager::ProcessMemoryTensor(const std::vector<std::vector<std::vector<double>>>& memoryTensor,
-                                       const std::vector<std::vector<std::vector<double>>>& currentState,
-                                       std::vector<std::vector<std::vector<double>>>& processedMemory) {
-    // Initialize processed memory with same dimensions
-    processedMemory = memoryTensor;
+void PersonaManager::ProcessMemoryTensor(const Tensor3& memoryTensor,
+                                       const Tensor3& currentState,
+                                       Tensor3& processedMemory) {
+    // Relevance only depends on currentState summed over its first axis, so
+    // build that sum once instead of once per memory element
+    const size_t rows = memoryTensor.dim(1);
+    const size_t depth = memoryTensor.dim(2);
+    thread_local Tensor2 stateSums;
+    stateSums.Resize(rows, depth);
+    stateSums.Fill(0.0);
+    for (size_t l = 0; l < currentState.dim(0); ++l) {
+        for (size_t j = 0; j < rows; ++j) {
+            const double* state = currentState.Row(l, j);
+            double* sums = stateSums.Row(j);
+            for (size_t k = 0; k < depth; ++k) {
+                sums[k] += state[k];
+            }
+        }
+    }
     
     // Apply memory processing based on current state
-    for (size_t i = 0; i < memoryTensor.size(); ++i) {
-        for (size_t j = 0; j < memoryTensor[i].size(); ++j) {
-            for (size_t k = 0; k < memoryTensor[i][j].size(); ++k) {
-                // Calculate memory relevance based on current state
-                double relevance = 0.0;
-                for (size_t l = 0; l < currentState.size(); ++l) {
-                    relevance += currentState[l][j][k] * memoryTensor[i][j][k];
-                }
-                
+    processedMemory.Resize(memoryTensor.shape());
+    for (size_t i = 0; i < memoryTensor.dim(0); ++i) {
+        double decayFactor = std::exp(-0.1 * i); // Decay with memory age
+        for (size_t j = 0; j < rows; ++j) {
+            const double* memory = memoryTensor.Row(i, j);
+            const double* sums = stateSums.Row(j);
+            double* out = processedMemory.Row(i, j);
+            for (size_t k = 0; k < depth; ++k) {
                 // Apply memory decay and relevance
-                double decayFactor = std::exp(-0.1 * i); // Decay with memory age
-                processedMemory[i][j][k] = memoryTensor[i][j][k] * decayFactor * relevance;
+                double relevance = sums[k] * memory[k];
+                out[k] = memory[k] * decayFactor * relevance;
             }
         }
     }
 }
 
-void PersonaManager::ProcessSelfReferentialState(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                               const std::vector<std::vector<std::vector<double>>>& previousState,
-                                               std::vector<std::vector<std::vector<double>>>& selfReferentialState) {
-    // Initialize self-referential state
-    selfReferentialState = currentState;
-    
+void PersonaManager::ProcessSelfReferentialState(const Tensor3& currentState,
+                                               const Tensor3& previousState,
+                                               Tensor3& selfReferentialState) {
     // Calculate self-reference score
     double selfReferenceScore;
     CalculateSelfReferenceScore(currentState, previousState, selfReferenceScore);
     
-    // Apply self-referential processing
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                // Blend current state with previous state based on self-reference score
-                selfReferentialState[i][j][k] = 
-                    (1.0 - selfReferenceScore) * currentState[i][j][k] + 
-                    selfReferenceScore * previousState[i][j][k];
-            }
-        }
-    }
+    // Blend current state with previous state based on self-reference score
+    BlendTensors(currentState, previousState, selfReferenceScore, selfReferentialState);
 }
 
-void PersonaManager::ProcessGrowthPath(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                     const std::vector<std::vector<std::vector<double>>>& targetState,
-                                     std::vector<std::vector<std::vector<double>>>& growthPath) {
-    // Initialize growth path
-    growthPath = currentState;
-    
+void PersonaManager::ProcessGrowthPath(const Tensor3& currentState,
+                                     const Tensor3& targetState,
+                                     Tensor3& growthPath) {
     // Calculate growth potential
     double growthPotential;
     CalculateGrowthPotential(currentState, targetState, growthPotential);
     
-    // Apply growth path processing
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                // Calculate growth direction
-                double growthDirection = targetState[i][j][k] - currentState[i][j][k];
-                
-                // Apply growth with potential
-                growthPath[i][j][k] = currentState[i][j][k] + 
-                                    growthDirection * growthPotential;
-            }
-        }
-    }
+    // Step along the growth direction scaled by potential
+    TransformTensor(currentState, targetState, growthPath,
+        [growthPotential](double current, double target) {
+            return current + (target - current) * growthPotential;
+        });
 }
 
-void PersonaManager::CalculateFeedbackStrength(const std::vector<std::vector<std::vector<double>>>& feedback,
+void PersonaManager::CalculateFeedbackStrength(const Tensor3& feedback,
                                             double& strength) {
-    double sum = 0.0;
-    double count = 0.0;
-    
     // Calculate average magnitude of feedback
-    for (const auto& layer : feedback) {
-        for (const auto& row : layer) {
-            for (double value : row) {
-                sum += std::abs(value);
-                count += 1.0;
-            }
-        }
-    }
+    double sum = Kernels().SumAbs(feedback.data(), feedback.size());
     
-    strength = count > 0.0 ? sum / count : 0.0;
+    strength = feedback.empty() ? 0.0 : sum / feedback.size();
 }
 
-void PersonaManager::ApplyFeedbackModulation(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                          const std::vector<std::vector<std::vector<double>>>& feedback,
-                                          std::vector<std::vector<std::vector<double>>>& modulatedState) {
-    modulatedState = currentState;
-    
-    // Apply feedback as a modulation to current state
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                // Use sigmoid function to modulate the state
-                double modulation = 1.0 / (1.0 + std::exp(-feedback[i][j][k]));
-                modulatedState[i][j][k] = currentState[i][j][k] * modulation;
-            }
-        }
-    }
+void PersonaManager::ApplyFeedbackModulation(const Tensor3& currentState,
+                                          const Tensor3& feedback,
+                                          Tensor3& modulatedState) {
+    // Use sigmoid function to modulate the state
+    TransformTensor(currentState, feedback, modulatedState,
+        [](double state, double signal) { return state * Sigmoid(signal); });
 }
 
-void PersonaManager::UpdateFeedbackHistory(const std::vector<std::vector<std::vector<double>>>& feedback) {
+void PersonaManager::UpdateFeedbackHistory(const Tensor3& feedback) {
     auto& persona = CurrentPersona;
     
     // Create a new personality snapshot
@@ -1321,145 +1386,63 @@ void PersonaManager::UpdateFeedbackHistory(const std::vector<std::vector<std::ve
     }
 }
 
-void PersonaManager::CalculateResonancePatterns(const std::vector<std::vector<std::vector<double>>>& stateTensor,
+void PersonaManager::CalculateResonancePatterns(const Tensor3& stateTensor,
                                               std::vector<DynamicResonance>& resonances) {
-    resonances.clear();
-    
-    // Analyze patterns in the state tensor
-    for (size_t i = 0; i < stateTensor.size(); ++i) {
-        for (size_t j = 0; j < stateTensor[i].size(); ++j) {
-            // Check for resonance patterns
-            double patternStrength = 0.0;
-            std::vector<std::string> connectedPatterns;
-            
-            for (size_t k = 0; k < stateTensor[i][j].size(); ++k) {
-                if (stateTensor[i][j][k] > 0.7) { // Threshold for significant resonance
-                    patternStrength += stateTensor[i][j][k];
-                    connectedPatterns.push_back("pattern_" + std::to_string(k));
-                }
-            }
-            
-            if (patternStrength > 0.0) {
-                DynamicResonance resonance;
-                resonance.ResonanceID = "resonance_" + std::to_string(i) + "_" + std::to_string(j);
-                resonance.BaseFrequency = patternStrength;
-                resonance.CurrentAmplitude = patternStrength;
-                resonance.ConnectedPatterns = connectedPatterns;
-                resonance.PatternInfluences = std::vector<double>(connectedPatterns.size(), patternStrength);
-                resonance.LastResonance = std::chrono::system_clock::now();
-                
-                resonances.push_back(resonance);
-            }
-        }
-    }
+    ProcessResonancePatterns(stateTensor, resonances);
 }
 
-void PersonaManager::CalculateTensorSimilarity(const std::vector<std::vector<std::vector<double>>>& tensor1,
-                                            const std::vector<std::vector<std::vector<double>>>& tensor2,
+void PersonaManager::CalculateTensorSimilarity(const Tensor3& tensor1,
+                                            const Tensor3& tensor2,
                                             double& similarity) {
-    double sum = 0.0;
-    double count = 0.0;
-    
     // Calculate cosine similarity between tensors
-    for (size_t i = 0; i < tensor1.size(); ++i) {
-        for (size_t j = 0; j < tensor1[i].size(); ++j) {
-            for (size_t k = 0; k < tensor1[i][j].size(); ++k) {
-                sum += tensor1[i][j][k] * tensor2[i][j][k];
-                count += 1.0;
-            }
-        }
-    }
+    double sum = Kernels().Dot(tensor1.data(), tensor2.data(), tensor1.size());
     
-    similarity = count > 0.0 ? sum / count : 0.0;
+    similarity = tensor1.empty() ? 0.0 : sum / tensor1.size();
 }
 
-void PersonaManager::NormalizeTensor(std::vector<std::vector<std::vector<double>>>& tensor) {
-    double maxValue = 0.0;
+void PersonaManager::NormalizeTensor(Tensor3& tensor) {
+    const auto& kernels = Kernels();
     
     // Find maximum value
-    for (const auto& layer : tensor) {
-        for (const auto& row : layer) {
-            for (double value : row) {
-                maxValue = std::max(maxValue, std::abs(value));
-            }
-        }
-    }
+    double maxValue = kernels.MaxAbs(tensor.data(), tensor.size());
     
     // Normalize if maxValue is not zero
     if (maxValue > 0.0) {
-        for (auto& layer : tensor) {
-            for (auto& row : layer) {
-                for (double& value : row) {
-                    value /= maxValue;
-                }
-            }
-        }
+        kernels.Scale(tensor.data(), tensor.size(), 1.0 / maxValue);
     }
 }
 
-void PersonaManager::ApplyTensorTransformation(const std::vector<std::vector<std::vector<double>>>& inputTensor,
-                                            const std::vector<std::vector<double>>& transformationMatrix,
-                                            std::vector<std::vector<std::vector<double>>>& outputTensor) {
-    outputTensor = inputTensor;
-    
-    // Apply transformation matrix to each layer
-    for (size_t i = 0; i < inputTensor.size(); ++i) {
-        for (size_t j = 0; j < inputTensor[i].size(); ++j) {
-            for (size_t k = 0; k < inputTensor[i][j].size(); ++k) {
-                double sum = 0.0;
-                for (size_t l = 0; l < transformationMatrix.size(); ++l) {
-                    sum += inputTensor[i][j][k] * transformationMatrix[l][k];
-                }
-                outputTensor[i][j][k] = sum;
-            }
-        }
-    }
+void PersonaManager::ApplyTensorTransformation(const Tensor3& inputTensor,
+                                            const Tensor2& transformationMatrix,
+                                            Tensor3& outputTensor) {
+    // Same per-layer transformation as ProcessTensorEvolution
+    ProcessTensorEvolution(inputTensor, transformationMatrix, outputTensor);
 }
 
-void PersonaManager::CalculateTensorEigenvalues(const std::vector<std::vector<std::vector<double>>>& tensor,
+void PersonaManager::CalculateTensorEigenvalues(const Tensor3& tensor,
                                               std::vector<double>& eigenvalues) {
-    // Convert 3D tensor to 2D matrix for eigenvalue calculation
-    size_t rows = tensor.size() * tensor[0].size();
-    size_t cols = tensor[0][0].size();
-    std::vector<std::vector<double>> matrix(rows, std::vector<double>(cols, 0.0));
-    
-    // Flatten tensor into matrix
-    for (size_t i = 0; i < tensor.size(); ++i) {
-        for (size_t j = 0; j < tensor[i].size(); ++j) {
-            for (size_t k = 0; k < tensor[i][j].size(); ++k) {
-                matrix[i * tensor[i].size() + j][k] = tensor[i][j][k];
-            }
+    // Column norms of the (dim0 * dim1) x dim2 unfolding. Storage is already
+    // row-major in that shape, so no intermediate matrix is built.
+    const size_t cols = tensor.dim(2);
+    eigenvalues.assign(cols, 0.0);
+    for (const double* row = tensor.begin(); row != tensor.end(); row += cols) {
+        for (size_t k = 0; k < cols; ++k) {
+            eigenvalues[k] += row[k] * row[k];
         }
     }
-    
-    // Calculate eigenvalues (simplified version)
-    eigenvalues.resize(cols, 0.0);
-    for (size_t i = 0; i < cols; ++i) {
-        double sum = 0.0;
-        for (size_t j = 0; j < rows; ++j) {
-            sum += matrix[j][i] * matrix[j][i];
-        }
-        eigenvalues[i] = std::sqrt(sum);
+    for (double& value : eigenvalues) {
+        value = std::sqrt(value);
     }
 }
 
-void PersonaManager::UpdateEvolutionMetrics(const std::vector<std::vector<std::vector<double>>>& currentState,
-                                         const std::vector<std::vector<std::vector<double>>>& previousState,
+void PersonaManager::UpdateEvolutionMetrics(const Tensor3& currentState,
+                                         const Tensor3& previousState,
                                          EvolutionMetrics& metrics) {
     // Calculate learning rate based on state changes
-    double stateChange = 0.0;
-    double count = 0.0;
-    
-    for (size_t i = 0; i < currentState.size(); ++i) {
-        for (size_t j = 0; j < currentState[i].size(); ++j) {
-            for (size_t k = 0; k < currentState[i][j].size(); ++k) {
-                stateChange += std::abs(currentState[i][j][k] - previousState[i][j][k]);
-                count += 1.0;
-            }
-        }
-    }
+    double stateChange = Kernels().SumAbsDiff(currentState.data(), previousState.data(),
+                                              currentState.size());
     
-    metrics.LearningRate = count > 0.0 ? stateChange / count : 0.0;
+    metrics.LearningRate = currentState.empty() ? 0.0 : stateChange / currentState.size();
     
     // Update decay rate based on time since last update
     auto now = std::chrono::system_clock::now();
@@ -1482,16 +1465,15 @@ void PersonaManager::ApplyTraitDrift(BasePersona& persona, double elapsedHours)
     auto now = std::chrono::system_clock::now();
     
     for (auto& [trait, drift] : persona.Personality.TraitDrifts) {
+        // A settled drift moves nothing; leave it and its trait alone
+        if (drift.DriftRate == 0.0) continue;
+
         // Calculate time-based drift
-        auto hoursSinceUpdate = std::chrono::duration_cast<std::chrono::hours>(
-            now - drift.LastUpdate).count();
-        
-        // Apply base drift
-        double baseDrift = drift.DriftRate * elapsedHours;
-        
-        // Apply decay
-        double decayFactor = std::exp(-drift.DecayRate * hoursSinceUpdate);
-        baseDrift *= decayFactor;
+        const double hoursSinceUpdate = cognitive::Elapsed<cognitive::DecayHours>(drift.LastUpdate, now);
+
+        // Apply base drift, decayed
+        double baseDrift = cognitive::ExponentialDecay(drift.DriftRate * elapsedHours, drift.DecayRate,
+                                                       hoursSinceUpdate);
         
         // Update trait value
         double& traitValue = persona.Personality.CoreTraits[trait].CurrentValue;
@@ -1502,10 +1484,15 @@ void PersonaManager::ApplyTraitDrift(BasePersona& persona, double elapsedHours)
 }
 
 void PersonaManager::UpdateTraitDrift(BasePersona& persona, const std::string& trait, double influence) {
+    UpdateTraitDrift(persona, trait, influence, RecentTriggerWeights());
+}
+
+void PersonaManager::UpdateTraitDrift(BasePersona& persona, const std::string& trait, double influence,
+                                      const TriggerWeights& recent) {
     auto& drift = persona.Personality.TraitDrifts[trait];
     
     // Calculate reinforcement factor
-    double reinforcement = CalculateReinforcementFactor(persona, trait);
+    double reinforcement = CalculateReinforcementFactor(persona, trait, recent);
     
     // Update drift rate based on influence and reinforcement
     drift.DriftRate = std::clamp(
@@ -1549,8 +1536,10 @@ void PersonaManager::UpdatePatternStability(BasePersona& persona, const std::str
     
     // If stability exceeds threshold, reinforce pattern
     if (pattern.Stability > pattern.ReinforcementThreshold) {
+        // One recall for every trait the pattern touches
+        TriggerWeights recent = RecentTriggerWeights();
         for (const auto& [trait, influence] : pattern.TraitInfluences) {
-            UpdateTraitDrift(persona, trait, influence * pattern.Stability);
+            UpdateTraitDrift(persona, trait, influence * pattern.Stability, recent);
         }
     }
 }
@@ -1595,18 +1584,13 @@ void PersonaManager::AnalyzeEmotionDrift(BasePersona& persona, const std::vector
 
 void PersonaManager::UpdatePersonalityTensorField(BasePersona& persona) {
     // Update core traits tensor
-    for (size_t i = 0; i < persona.PersonalityTensor.CoreTraits.size(); ++i) {
-        for (size_t j = 0; j < persona.PersonalityTensor.CoreTraits[i].size(); ++j) {
-            for (size_t k = 0; k < persona.PersonalityTensor.CoreTraits[i][j].size(); ++k) {
-                // Apply drift to tensor values
-                double drift = persona.Personality.TraitDrifts["core_trait_" + std::to_string(i)].DriftRate;
-                persona.PersonalityTensor.CoreTraits[i][j][k] = std::clamp(
-                    persona.PersonalityTensor.CoreTraits[i][j][k] + drift,
-                    0.0,
-                    1.0
-                );
-            }
-        }
+    auto& coreTraits = persona.PersonalityTensor.CoreTraits;
+    const size_t layerSize = coreTraits.dim(1) * coreTraits.dim(2);
+    for (size_t i = 0; i < coreTraits.dim(0); ++i) {
+        // One drift lookup per trait layer instead of one per element
+        double drift = persona.Personality.TraitDrifts[IndexedName("core_trait_", i)].DriftRate;
+        // Apply drift to tensor values
+        Kernels().AddClamp(coreTraits.Row(i, 0), layerSize, drift, 0.0, 1.0);
     }
     
     // Update trait correlations
@@ -1615,67 +1599,56 @@ void PersonaManager::UpdatePersonalityTensorField(BasePersona& persona) {
 }
 
 void PersonaManager::ProcessTensorPerturbations(BasePersona& persona, const std::vector<MemoryEvent>& events) {
+    auto& coreTraits = persona.PersonalityTensor.CoreTraits;
     for (const auto& event : events) {
-        // Calculate perturbation strength
+        // Calculate perturbation strength with exponential decay
         double perturbation = event.EmotionalWeight * event.Importance;
+        double decay = std::exp(-0.1 * std::chrono::duration_cast<std::chrono::hours>(
+            std::chrono::system_clock::now() - event.Timestamp).count());
         
         // Apply perturbation to relevant tensor dimensions
         for (const auto& [trait, influence] : event.TraitInfluences) {
             size_t traitIndex = GetTraitIndex(trait);
-            if (traitIndex < persona.PersonalityTensor.CoreTraits.size()) {
-                // Apply perturbation with exponential decay
-                double decay = std::exp(-0.1 * std::chrono::duration_cast<std::chrono::hours>(
-                    std::chrono::system_clock::now() - event.Timestamp).count());
-                
-                for (auto& value : persona.PersonalityTensor.CoreTraits[traitIndex]) {
-                    value = std::clamp(value + (perturbation * influence * decay), 0.0, 1.0);
-                }
+            if (traitIndex < coreTraits.dim(0)) {
+                Kernels().AddClamp(coreTraits.Row(traitIndex, 0), coreTraits.dim(1) * coreTraits.dim(2),
+                                   perturbation * influence * decay, 0.0, 1.0);
             }
         }
     }
 }
 
 // Helper Methods
-double PersonaManager::CalculateReinforcementFactor(const BasePersona& persona, const std::string& trait) {
-    const auto& drift = persona.Personality.TraitDrifts.at(trait);
-    double factor = 1.0;
-    
-    // Check recent memory events for reinforcement triggers
-    auto recentEvents = RecallRelevantMemories("recent_interactions");
-    for (const auto& event : recentEvents) {
-        if (std::find(drift.ReinforcementTriggers.begin(), 
-                     drift.ReinforcementTriggers.end(), 
-                     event.Type) != drift.ReinforcementTriggers.end()) {
-            factor += 0.2 * event.EmotionalWeight;
-        }
+TriggerWeights PersonaManager::RecentTriggerWeights() {
+    TriggerWeights weights;
+    for (const auto& event : RecallRelevantMemories("recent_interactions")) {
+        weights[event.Type] += event.EmotionalWeight;
     }
-    
-    return std::min(2.0, factor);
+    return weights;
+}
+
+double PersonaManager::CalculateReinforcementFactor(const BasePersona& persona, const std::string& trait) {
+    return CalculateReinforcementFactor(persona, trait, RecentTriggerWeights());
+}
+
+double PersonaManager::CalculateReinforcementFactor(const BasePersona& persona, const std::string& trait,
+                                                    const TriggerWeights& recent) {
+    // Recent memory events that match a reinforcement trigger
+    return TriggerFactor(persona.Personality.TraitDrifts.at(trait).ReinforcementTriggers, recent);
 }
 
 double PersonaManager::CalculateDecayFactor(const BasePersona& persona, const std::string& trait) {
-    const auto& drift = persona.Personality.TraitDrifts.at(trait);
-    double factor = 1.0;
-    
-    // Check recent memory events for decay triggers
-    auto recentEvents = RecallRelevantMemories("recent_interactions");
-    for (const auto& event : recentEvents) {
-        if (std::find(drift.DecayTriggers.begin(), 
-                     drift.DecayTriggers.end(), 
-                     event.Type) != drift.DecayTriggers.end()) {
-            factor += 0.2 * event.EmotionalWeight;
-        }
-    }
-    
-    return std::min(2.0, factor);
+    return CalculateDecayFactor(persona, trait, RecentTriggerWeights());
+}
+
+double PersonaManager::CalculateDecayFactor(const BasePersona& persona, const std::string& trait,
+                                            const TriggerWeights& recent) {
+    // Recent memory events that match a decay trigger
+    return TriggerFactor(persona.Personality.TraitDrifts.at(trait).DecayTriggers, recent);
 }
 
 void PersonaManager::CalculateFieldDynamics(const PersonalityField& field, 
                                           PersonalityField& evolvedField) {
-    // Initialize evolved field
-    evolvedField = field;
-    
-    // Calculate field derivatives
+    // Calculate field derivatives into evolvedField's existing buffers
     CalculateFieldGradient(field.FieldTensor, evolvedField.FieldGradient);
     CalculateFieldDivergence(field.FieldTensor, evolvedField.FieldDivergence);
     CalculateFieldCurl(field.FieldTensor, evolvedField.FieldCurl);
@@ -1683,14 +1656,18 @@ void PersonaManager::CalculateFieldDynamics(const PersonalityField& field,
     // Update field energy
     ComputeFieldEnergy(field, evolvedField.FieldEnergy);
     
-    // Apply field evolution equations
-    for (size_t i = 0; i < field.FieldTensor.size(); ++i) {
-        for (size_t j = 0; j < field.FieldTensor[i].size(); ++j) {
-            for (size_t k = 0; k < field.FieldTensor[i][j].size(); ++k) {
-                // Apply field evolution equation
-                double evolution = field.FieldGradient[i][j] * field.FieldDivergence[i][j] +
-                                 field.FieldCurl[i][j] * field.FieldEnergy;
-                evolvedField.FieldTensor[i][j][k] += evolution;
+    // Apply field evolution equations. The evolution term is constant along
+    // the innermost axis, so it is computed once per row.
+    const auto& tensor = field.FieldTensor;
+    evolvedField.FieldTensor.Resize(tensor.shape());
+    for (size_t i = 0; i < tensor.dim(0); ++i) {
+        for (size_t j = 0; j < tensor.dim(1); ++j) {
+            double evolution = field.FieldGradient(i, j) * field.FieldDivergence(i, j) +
+                             field.FieldCurl(i, j) * field.FieldEnergy;
+            const double* in = tensor.Row(i, j);
+            double* out = evolvedField.FieldTensor.Row(i, j);
+            for (size_t k = 0; k < tensor.dim(2); ++k) {
+                out[k] = in[k] + evolution;
             }
         }
     }
@@ -1742,25 +1719,68 @@ void PersonaManager::ComputeTopologicalFeatures(const std::vector<std::vector<do
 void PersonaManager::SolvePersonalityPDE(const PersonalityField& field,
                                        double timeStep,
                                        PersonalityField& solution) {
-    // Initialize solution
-    solution = field;
-    
-    // Solve using finite difference method
-    for (size_t i = 1; i < field.FieldTensor.size() - 1; ++i) {
-        for (size_t j = 1; j < field.FieldTensor[i].size() - 1; ++j) {
-            for (size_t k = 1; k < field.FieldTensor[i][j].size() - 1; ++k) {
-                // Apply diffusion equation
-                double laplacian = (field.FieldTensor[i+1][j][k] + field.FieldTensor[i-1][j][k] +
-                                  field.FieldTensor[i][j+1][k] + field.FieldTensor[i][j-1][k] +
-                                  field.FieldTensor[i][j][k+1] + field.FieldTensor[i][j][k-1] -
-                                  6 * field.FieldTensor[i][j][k]);
-                
-                solution.FieldTensor[i][j][k] += timeStep * laplacian;
-            }
+    if (&solution == &field) {
+        SolvePersonalityPDE(solution, timeStep);
+        return;
+    }
+    
+    // Carry the derivatives over; assignment reuses solution's buffers
+    solution.FieldGradient = field.FieldGradient;
+    solution.FieldDivergence = field.FieldDivergence;
+    solution.FieldCurl = field.FieldCurl;
+    solution.FieldEnergy = field.FieldEnergy;
+    
+    // Solve using finite difference method, writing every element once
+    const auto& in = field.FieldTensor;
+    auto& out = solution.FieldTensor;
+    out.Resize(in.shape());
+    const auto [depth, rows, cols] = in.shape();
+    const size_t layerStride = rows * cols;
+    const auto& kernels = Kernels();
+    for (size_t i = 0; i < depth; ++i) {
+        for (size_t j = 0; j < rows; ++j) {
+            const double* center = in.Row(i, j);
+            double* dst = out.Row(i, j);
+            std::copy(center, center + cols, dst);
+            if (i == 0 || i + 1 >= depth || j == 0 || j + 1 >= rows) continue;
+            
+            // Apply diffusion equation
+            kernels.DiffuseRow(center - layerStride, center + layerStride,
+                               center + cols, center - cols,
+                               center, dst, cols, timeStep);
         }
     }
 }
 
+void PersonaManager::SolvePersonalityPDE(PersonalityField& field, double timeStep) {
+    auto& tensor = field.FieldTensor;
+    const auto [depth, rows, cols] = tensor.shape();
+    if (depth < 3 || rows < 3 || cols < 3) return;
+    
+    // The stencil reads the pre-step values of layers i - 1, i and i + 1.
+    // Layer i + 1 is untouched while layer i is written, so only the
+    // original copies of layers i - 1 and i need to be kept.
+    const size_t layerSize = rows * cols;
+    thread_local TensorStorage previous;
+    thread_local TensorStorage current;
+    previous.assign(tensor.Row(0, 0), tensor.Row(0, 0) + layerSize);
+    
+    const auto& kernels = Kernels();
+    for (size_t i = 1; i + 1 < depth; ++i) {
+        current.assign(tensor.Row(i, 0), tensor.Row(i, 0) + layerSize);
+        const double* next = tensor.Row(i + 1, 0);
+        for (size_t j = 1; j + 1 < rows; ++j) {
+            const size_t row = j * cols;
+            const double* center = current.data() + row;
+            // Apply diffusion equation
+            kernels.DiffuseRow(previous.data() + row, next + row,
+                               center + cols, center - cols,
+                               center, tensor.Row(i, j), cols, timeStep);
+        }
+        std::swap(previous, current);
+    }
+}
+
 void PersonaManager::CalculateBifurcationPoints(const std::vector<double>& parameters,
                                               std::vector<double>& bifurcations) {
     // Initialize bifurcation points
@@ -1781,53 +1801,61 @@ void PersonaManager::CalculateBifurcationPoints(const std::vector<double>& param
 
 void PersonaManager::ComputeFieldEnergy(const PersonalityField& field,
                                       double& energy) {
-    energy = 0.0;
-    
-    // Calculate total field energy
-    for (const auto& layer : field.FieldTensor) {
-        for (const auto& row : layer) {
-            for (double value : row) {
-                energy += value * value;  // Square of field values
-            }
-        }
-    }
+    // Calculate total field energy as the sum of squared field values
+    energy = Kernels().SumSquares(field.FieldTensor.data(), field.FieldTensor.size());
 }
 
 // Helper Methods
-void PersonaManager::CalculateFieldGradient(const std::vector<std::vector<std::vector<double>>>& field,
-                                          std::vector<std::vector<double>>& gradient) {
-    gradient.resize(field.size(), std::vector<double>(field[0].size(), 0.0));
-    
-    for (size_t i = 1; i < field.size() - 1; ++i) {
-        for (size_t j = 1; j < field[i].size() - 1; ++j) {
+void PersonaManager::CalculateFieldGradient(const Tensor3& field,
+                                          Tensor2& gradient) {
+    const size_t rows = field.dim(0);
+    const size_t cols = field.dim(1);
+    gradient.Resize(rows, cols);
+    gradient.Fill(0.0);
+    if (field.dim(2) == 0) return;
+    
+    // Derivatives are taken on the k = 0 plane
+    auto surface = field.Plane(0);
+    for (size_t i = 1; i + 1 < rows; ++i) {
+        for (size_t j = 1; j + 1 < cols; ++j) {
             // Calculate central difference
-            gradient[i][j] = (field[i+1][j][0] - field[i-1][j][0]) / 2.0;
+            gradient(i, j) = (surface(i+1, j) - surface(i-1, j)) / 2.0;
         }
     }
 }
 
-void PersonaManager::CalculateFieldDivergence(const std::vector<std::vector<std::vector<double>>>& field,
-                                            std::vector<std::vector<double>>& divergence) {
-    divergence.resize(field.size(), std::vector<double>(field[0].size(), 0.0));
+void PersonaManager::CalculateFieldDivergence(const Tensor3& field,
+                                            Tensor2& divergence) {
+    const size_t rows = field.dim(0);
+    const size_t cols = field.dim(1);
+    divergence.Resize(rows, cols);
+    divergence.Fill(0.0);
+    if (field.dim(2) == 0) return;
     
-    for (size_t i = 1; i < field.size() - 1; ++i) {
-        for (size_t j = 1; j < field[i].size() - 1; ++j) {
+    auto surface = field.Plane(0);
+    for (size_t i = 1; i + 1 < rows; ++i) {
+        for (size_t j = 1; j + 1 < cols; ++j) {
             // Calculate divergence using central differences
-            divergence[i][j] = (field[i+1][j][0] - field[i-1][j][0]) / 2.0 +
-                             (field[i][j+1][0] - field[i][j-1][0]) / 2.0;
+            divergence(i, j) = (surface(i+1, j) - surface(i-1, j)) / 2.0 +
+                             (surface(i, j+1) - surface(i, j-1)) / 2.0;
         }
     }
 }
 
-void PersonaManager::CalculateFieldCurl(const std::vector<std::vector<std::vector<double>>>& field,
-                                      std::vector<std::vector<double>>& curl) {
-    curl.resize(field.size(), std::vector<double>(field[0].size(), 0.0));
+void PersonaManager::CalculateFieldCurl(const Tensor3& field,
+                                      Tensor2& curl) {
+    const size_t rows = field.dim(0);
+    const size_t cols = field.dim(1);
+    curl.Resize(rows, cols);
+    curl.Fill(0.0);
+    if (field.dim(2) == 0) return;
     
-    for (size_t i = 1; i < field.size() - 1; ++i) {
-        for (size_t j = 1; j < field[i].size() - 1; ++j) {
+    auto surface = field.Plane(0);
+    for (size_t i = 1; i + 1 < rows; ++i) {
+        for (size_t j = 1; j + 1 < cols; ++j) {
             // Calculate curl using central differences
-            curl[i][j] = (field[i][j+1][0] - field[i][j-1][0]) / 2.0 -
-                        (field[i+1][j][0] - field[i-1][j][0]) / 2.0;
+            curl(i, j) = (surface(i, j+1) - surface(i, j-1)) / 2.0 -
+                        (surface(i+1, j) - surface(i-1, j)) / 2.0;
         }
     }
 }
@@ -1872,16 +1900,18 @@ void PersonaManager::UpdatePersonalityField(const std::vector<EventEmbedding>& e
 void PersonaManager::ApplyFieldPerturbation(PersonalityField& field, const EventEmbedding& event) {
     // Calculate perturbation strength based on emotional impact
     double perturbationStrength = event.EmotionalImpact;
+    auto& tensor = field.FieldTensor;
     
     // Apply perturbation to affected traits
     for (const auto& trait : event.RelatedTraits) {
         size_t traitIndex = GetTraitIndex(trait);
-        if (traitIndex < field.FieldTensor.size()) {
-            // Apply perturbation to trait field
-            for (size_t i = 0; i < field.FieldTensor[traitIndex].size(); ++i) {
-                for (size_t j = 0; j < field.FieldTensor[traitIndex][i].size(); ++j) {
-                    field.FieldTensor[traitIndex][i][j] += 
-                        perturbationStrength * event.LatentVector[i] * event.LatentVector[j];
+        if (traitIndex < tensor.dim(0)) {
+            // Apply the latent outer product to the trait layer
+            for (size_t i = 0; i < tensor.dim(1); ++i) {
+                double scale = perturbationStrength * event.LatentVector[i];
+                double* row = tensor.Row(traitIndex, i);
+                for (size_t j = 0; j < tensor.dim(2); ++j) {
+                    row[j] += scale * event.LatentVector[j];
                 }
             }
         }
@@ -1929,22 +1959,45 @@ void PersonaManager::CalculateEventSimilarity(const EventEmbedding& e1, const Ev
 }
 
 void PersonaManager::FindSimilarEvents(const EventEmbedding& query, std::vector<EventEmbedding>& similarEvents) {
-    // Calculate similarity with all events
-    std::vector<std::pair<double, EventEmbedding>> similarities;
-    for (const auto& event : eventHistory) {
-        double similarity;
-        CalculateEventSimilarity(query, event, similarity);
-        similarities.emplace_back(similarity, event);
+    static constexpr size_t SIMILAR_EVENT_COUNT = 10;
+    
+    similarEvents.clear();
+    SyncEventIndex();
+    if (query.LatentVector.size() != eventIndex->Dimension()) return;
+    
+    // Top matches by latent similarity, best first
+    thread_local std::vector<VectorSearchResult> matches;
+    eventIndex->Search(query.LatentVector, SIMILAR_EVENT_COUNT, matches);
+    
+    similarEvents.reserve(matches.size());
+    for (const auto& match : matches) {
+        similarEvents.push_back(eventHistory[match.id]);
+    }
+}
+
+void PersonaManager::RecordEvent(const EventEmbedding& event) {
+    eventHistory.push_back(event);
+    SyncEventIndex();
+}
+
+void PersonaManager::ConfigureEventIndex(VectorIndexType type, const HnswParams& params) {
+    eventIndex = CreateVectorIndex(type, params);
+    SyncEventIndex();
+}
+
+void PersonaManager::SyncEventIndex() {
+    if (!eventIndex) {
+        eventIndex = CreateVectorIndex(VectorIndexType::HNSW);
     }
     
-    // Sort by similarity
-    std::sort(similarities.begin(), similarities.end(), 
-              [](const auto& a, const auto& b) { return a.first > b.first; });
+    // Index IDs are history positions; if the history shrank they no longer line up
+    if (eventIndex->Size() > eventHistory.size()) {
+        eventIndex->Clear();
+    }
     
-    // Return top similar events
-    similarEvents.clear();
-    for (size_t i = 0; i < std::min(similarities.size(), size_t(10)); ++i) {
-        similarEvents.push_back(similarities[i].second);
+    // Index events appended since the last sync
+    for (size_t i = eventIndex->Size(); i < eventHistory.size(); ++i) {
+        eventIndex->Add(eventHistory[i].LatentVector);
     }
 }
 
@@ -1988,13 +2041,13 @@ void PersonaManager::AnalyzeFieldGeometry(const PersonalityField& field,
     
     // 1. Calculate field curvature
     double totalCurvature = 0.0;
-    for (size_t i = 0; i < field.FieldTensor.size(); ++i) {
-        for (size_t j = 0; j < field.FieldTensor[i].size(); ++j) {
+    for (size_t i = 0; i < field.FieldTensor.dim(0); ++i) {
+        for (size_t j = 0; j < field.FieldTensor.dim(1); ++j) {
             double curvature = CalculateLocalCurvature(field.FieldTensor, i, j);
             totalCurvature += curvature;
         }
     }
-    geometricMeasures.push_back(totalCurvature / (field.FieldTensor.size() * field.FieldTensor[0].size()));
+    geometricMeasures.push_back(totalCurvature / (field.FieldTensor.dim(0) * field.FieldTensor.dim(1)));
     
     // 2. Calculate field topology
     std::vector<int> bettiNumbers;
@@ -2070,13 +2123,14 @@ void PersonaManager::AnalyzeFieldDynamics(const PersonalityField& field,
 }
 
 // Helper methods for field analysis
-double PersonaManager::CalculateLocalCurvature(const std::vector<std::vector<std::vector<double>>>& tensor,
+double PersonaManager::CalculateLocalCurvature(const Tensor3& tensor,
                                              size_t i, size_t j) {
     // Calculate local curvature using finite differences
+    auto surface = tensor.Plane(0);
     double dx = 1.0, dy = 1.0;
-    double dxx = (tensor[i+1][j][0] - 2*tensor[i][j][0] + tensor[i-1][j][0]) / (dx*dx);
-    double dyy = (tensor[i][j+1][0] - 2*tensor[i][j][0] + tensor[i][j-1][0]) / (dy*dy);
-    double dxy = (tensor[i+1][j+1][0] - tensor[i+1][j-1][0] - tensor[i-1][j+1][0] + tensor[i-1][j-1][0]) / (4*dx*dy);
+    double dxx = (surface(i+1, j) - 2*surface(i, j) + surface(i-1, j)) / (dx*dx);
+    double dyy = (surface(i, j+1) - 2*surface(i, j) + surface(i, j-1)) / (dy*dy);
+    double dxy = (surface(i+1, j+1) - surface(i+1, j-1) - surface(i-1, j+1) + surface(i-1, j-1)) / (4*dx*dy);
     
     return std::abs(dxx * dyy - dxy * dxy) / std::pow(1 + dxx*dxx + dyy*dyy, 1.5);
 }
@@ -2084,12 +2138,13 @@ double PersonaManager::CalculateLocalCurvature(const std::vector<std::vector<std
 double PersonaManager::CalculateFieldSymmetry(const PersonalityField& field) {
     // Calculate symmetry score of the field
     double symmetry = 0.0;
-    size_t n = field.FieldTensor.size();
+    size_t n = field.FieldTensor.dim(0);
+    auto surface = field.FieldTensor.Plane(0);
     
     // Check for reflection symmetry
     for (size_t i = 0; i < n/2; ++i) {
         for (size_t j = 0; j < n; ++j) {
-            double diff = std::abs(field.FieldTensor[i][j][0] - field.FieldTensor[n-1-i][j][0]);
+            double diff = std::abs(surface(i, j) - surface(n-1-i, j));
             symmetry += 1.0 - diff;
         }
     }
@@ -2098,25 +2153,21 @@ double PersonaManager::CalculateFieldSymmetry(const PersonalityField& field) {
 }
 
 double PersonaManager::CalculateFieldEntropy(const PersonalityField& field) {
-    // Calculate Shannon entropy of the field
-    std::map<double, int> histogram;
-    double total = 0.0;
-    
-    // Build histogram
-    for (const auto& layer : field.FieldTensor) {
-        for (const auto& row : layer) {
-            for (double val : row) {
-                histogram[val]++;
-                total++;
-            }
-        }
-    }
+    // Calculate Shannon entropy of the field. The histogram is the run
+    // lengths of a sorted copy, which avoids one map node per distinct value.
+    thread_local TensorStorage sorted;
+    sorted.assign(field.FieldTensor.begin(), field.FieldTensor.end());
+    std::sort(sorted.begin(), sorted.end());
+    double total = static_cast<double>(sorted.size());
     
     // Calculate entropy
     double entropy = 0.0;
-    for (const auto& pair : histogram) {
-        double p = pair.second / total;
+    for (size_t start = 0; start < sorted.size();) {
+        size_t end = start + 1;
+        while (end < sorted.size() && sorted[end] == sorted[start]) ++end;
+        double p = (end - start) / total;
         entropy -= p * std::log2(p);
+        start = end;
     }
     
     return entropy;
@@ -2127,12 +2178,9 @@ double PersonaManager::CalculateFieldComplexity(const PersonalityField& field) {
     std::string binarySequence;
     
     // Convert field to binary sequence
-    for (const auto& layer : field.FieldTensor) {
-        for (const auto& row : layer) {
-            for (double val : row) {
-                binarySequence += (val > 0.5) ? '1' : '0';
-            }
-        }
+    binarySequence.reserve(field.FieldTensor.size());
+    for (double val : field.FieldTensor) {
+        binarySequence += (val > 0.5) ? '1' : '0';
     }
     
     // Calculate Lempel-Ziv complexity
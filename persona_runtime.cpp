@@ -0,0 +1,124 @@
+#include "persona_runtime.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace shandris::cognitive {
+
+PersonaRuntime::PersonaRuntime(size_t analysisThreads, std::chrono::milliseconds tickInterval)
+    : executor_(std::make_shared<WorkStealingExecutor>(analysisThreads)),
+      tickInterval_(tickInterval) {
+    if (tickInterval_.count() > 0) {
+        ticker_ = std::thread(&PersonaRuntime::RunTicker, this);
+    }
+}
+
+PersonaRuntime::~PersonaRuntime() {
+    {
+        std::lock_guard<std::mutex> lock(tickerMutex_);
+        stopping_ = true;
+    }
+    tickerWake_.notify_all();
+    if (ticker_.joinable()) ticker_.join();
+
+    Sync();
+    std::unique_lock<std::shared_mutex> lock(shardsMutex_);
+    shards_.clear();
+}
+
+bool PersonaRuntime::AddPersona(const std::string& personaID) {
+    if (HostsPersona(personaID)) return false;
+
+    // Built outside the map lock; constructing a shard touches the database
+    auto shard = std::make_shared<PersonaSystem>(executor_);
+    if (!shard->SwitchPersona(personaID, "runtime_shard")) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shardsMutex_);
+    return shards_.emplace(personaID, std::move(shard)).second;
+}
+
+bool PersonaRuntime::RemovePersona(const std::string& personaID) {
+    std::shared_ptr<PersonaSystem> shard;
+    {
+        std::unique_lock<std::shared_mutex> lock(shardsMutex_);
+        auto it = shards_.find(personaID);
+        if (it == shards_.end()) return false;
+        shard = std::move(it->second);
+        shards_.erase(it);
+    }
+
+    // Callers still holding the shard keep it alive; this only retires it
+    shard->Sync();
+    return true;
+}
+
+bool PersonaRuntime::HostsPersona(const std::string& personaID) const {
+    std::shared_lock<std::shared_mutex> lock(shardsMutex_);
+    return shards_.count(personaID) > 0;
+}
+
+std::vector<std::string> PersonaRuntime::HostedPersonas() const {
+    std::vector<std::string> ids;
+    {
+        std::shared_lock<std::shared_mutex> lock(shardsMutex_);
+        ids.reserve(shards_.size());
+        for (const auto& [id, shard] : shards_) {
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::shared_ptr<PersonaSystem> PersonaRuntime::GetShard(const std::string& personaID) const {
+    std::shared_lock<std::shared_mutex> lock(shardsMutex_);
+    auto it = shards_.find(personaID);
+    return it != shards_.end() ? it->second : nullptr;
+}
+
+InteractionResponse PersonaRuntime::RespondToInteraction(const std::string& personaID,
+                                                         const std::shared_ptr<Interaction>& interaction) {
+    auto shard = GetShard(personaID);
+    return shard ? shard->RespondToInteraction(interaction) : InteractionResponse{};
+}
+
+void PersonaRuntime::AddMemory(const std::string& personaID, const MemoryEvent& memory) {
+    if (auto shard = GetShard(personaID)) {
+        shard->AddMemory(memory);
+    }
+}
+
+std::vector<std::shared_ptr<PersonaSystem>> PersonaRuntime::SnapshotShards() const {
+    std::vector<std::shared_ptr<PersonaSystem>> shards;
+    std::shared_lock<std::shared_mutex> lock(shardsMutex_);
+    shards.reserve(shards_.size());
+    for (const auto& [id, shard] : shards_) {
+        shards.push_back(shard);
+    }
+    return shards;
+}
+
+void PersonaRuntime::Sync() {
+    // Waiting happens without the map lock, so shards can still be added
+    for (const auto& shard : SnapshotShards()) {
+        shard->Sync();
+    }
+}
+
+void PersonaRuntime::Tick() {
+    for (const auto& shard : SnapshotShards()) {
+        shard->Tick();
+    }
+}
+
+void PersonaRuntime::RunTicker() {
+    std::unique_lock<std::mutex> lock(tickerMutex_);
+    while (!tickerWake_.wait_for(lock, tickInterval_, [this] { return stopping_; })) {
+        lock.unlock();
+        Tick();
+        lock.lock();
+    }
+}
+
+} // namespace shandris::cognitive
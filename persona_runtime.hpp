@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "persona_system.hpp"
+#include "task_executor.hpp"
+
+namespace shandris::cognitive {
+
+// Hosts many personas in one process. Each persona is a shard: its own
+// PersonaSystem with that persona active, so callers working with
+// different personas never contend on persona state. The analysis passes
+// of every shard share one work-stealing executor, making CPU use follow
+// whichever personas are busy rather than one thread per persona.
+//
+// Threading contract: every call is safe from any thread. Calls for one
+// persona are serialized by its shard's state lock; calls for different
+// personas run in parallel, except their database writes: the shards share
+// one connection, and take turns on it a statement or a write batch at a
+// time. Sync and RemovePersona wait for background work and must not be
+// called from inside a pipeline job.
+class PersonaRuntime {
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_TICK_INTERVAL{250};
+
+    // analysisThreads == 0 uses the hardware concurrency. Every shard is
+    // ticked each tickInterval; zero leaves ticking to the caller.
+    explicit PersonaRuntime(size_t analysisThreads = 0,
+                            std::chrono::milliseconds tickInterval = DEFAULT_TICK_INTERVAL);
+    // Stops the ticker and syncs every shard before shutting the executor down
+    ~PersonaRuntime();
+
+    PersonaRuntime(const PersonaRuntime&) = delete;
+    PersonaRuntime& operator=(const PersonaRuntime&) = delete;
+
+    // False if the persona is already hosted or cannot be activated
+    bool AddPersona(const std::string& personaID);
+    // Waits for the shard's background work first
+    bool RemovePersona(const std::string& personaID);
+    bool HostsPersona(const std::string& personaID) const;
+    std::vector<std::string> HostedPersonas() const;
+
+    // Null if the persona is not hosted. The shard stays valid while held,
+    // even if the persona is removed meanwhile.
+    std::shared_ptr<PersonaSystem> GetShard(const std::string& personaID) const;
+
+    // Foreground paths, routed to the persona's shard; unknown personas
+    // get a default response or are ignored
+    InteractionResponse RespondToInteraction(const std::string& personaID,
+                                             const std::shared_ptr<Interaction>& interaction);
+    void AddMemory(const std::string& personaID, const MemoryEvent& memory);
+
+    // Consistency point across every shard
+    void Sync();
+    // PersonaSystem::Tick on every shard
+    void Tick();
+
+    ExecutorStats GetExecutorStats() const { return executor_->Stats(); }
+
+private:
+    std::vector<std::shared_ptr<PersonaSystem>> SnapshotShards() const;
+    void RunTicker();
+
+    // First, so it outlives every shard's pipeline
+    std::shared_ptr<WorkStealingExecutor> executor_;
+    mutable std::shared_mutex shardsMutex_;
+    std::unordered_map<std::string, std::shared_ptr<PersonaSystem>> shards_;
+
+    std::chrono::milliseconds tickInterval_;
+    std::mutex tickerMutex_;
+    std::condition_variable tickerWake_;
+    bool stopping_ = false;
+    std::thread ticker_;  // last, so it starts once everything above exists
+};
+
+} // namespace shandris::cognitive
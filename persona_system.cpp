@@ -1,6 +1,15 @@
 #include "persona_system.hpp"
+#include "decay.hpp"
 #include "memory.hpp"
+#include "memory_clustering.hpp"
+#include "memory_similarity.hpp"
+#include "interaction_pipeline.hpp"
+#include "metrics.hpp"
+#include "personality_history.hpp"
+#include "recall.hpp"
+#include "scratch_arena.hpp"
 #include <iostream>
+#include <iterator>
 #include <algorithm>
 #include <cmath>
 #include <ctime>
@@ -10,6 +19,77 @@
 
 namespace shandris::cognitive {
 
+namespace {
+
+struct PersonaMetrics {
+    Histogram respond;
+    Histogram addMemory;
+    Histogram processMemories;
+    Histogram ingest;
+};
+
+const PersonaMetrics& Metrics() {
+    static const PersonaMetrics METRICS = [] {
+        auto& registry = MetricsRegistry::Global();
+        PersonaMetrics metrics;
+        metrics.respond = registry.GetHistogram("shandris_interaction_seconds", "path=\"respond\"",
+                                                "Foreground interaction latency");
+        metrics.addMemory = registry.GetHistogram("shandris_interaction_seconds", "path=\"add_memory\"");
+        metrics.processMemories = registry.GetHistogram("shandris_pipeline_task_seconds", "task=\"process_memories\"",
+                                                        "Background persona task latency");
+        metrics.ingest = registry.GetHistogram("shandris_interaction_seconds", "path=\"ingest_history\"");
+        return metrics;
+    }();
+    return METRICS;
+}
+
+// Database::GetInstance() is one connection for the whole process, shared
+// by every PersonaSystem, and each one's persistence stage is a thread of
+// its own. Every statement and transaction on it holds this lock, so one
+// shard's writes never interleave with, or land inside, another's batch.
+std::mutex& DatabaseMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// duration_cast<hours>(age) > 24, the short-term cutoff, first holds here
+constexpr auto SHORT_TERM_EXPIRY = std::chrono::hours(25);
+constexpr double PROMOTION_IMPORTANCE = 0.7;
+// Long-term memories merged per ConsolidateMemories call
+constexpr size_t CONSOLIDATION_SLICE = 1024;
+// Maintenance budget per Tick; passes not started by then wait for the next
+constexpr auto MAINTENANCE_SLICE = std::chrono::milliseconds(50);
+
+// Long-term memories of the same type and content consolidate into one
+std::string ConsolidationKey(const MemoryEvent& memory) {
+    return memory.Type + "_" + memory.Content;
+}
+
+void MergeMemory(MemoryEvent& existing, const MemoryEvent& memory) {
+    existing.Importance = std::max(existing.Importance, memory.Importance);
+    existing.EmotionalWeight = std::max(existing.EmotionalWeight, memory.EmotionalWeight);
+    for (const auto& [trait, influence] : memory.TraitInfluences) {
+        existing.TraitInfluences[trait] += influence;
+    }
+}
+
+std::chrono::system_clock::time_point EffectExpiry(const TimeBasedEffect& effect) {
+    return effect.StartTime + effect.MaxEffectDuration + std::chrono::hours(1);
+}
+
+// Memory counts per tier; sampled after each memory pass
+void RecordMemoryTiers(const std::string& personaID, size_t shortTerm, size_t longTerm) {
+    if (!MetricsRegistry::Enabled()) return;
+    auto& registry = MetricsRegistry::Global();
+    const std::string persona = "persona=\"" + personaID + "\",tier=";
+    registry.GetGauge("shandris_persona_memories", persona + "\"short_term\"", "Memories held per tier")
+        .Set(static_cast<double>(shortTerm));
+    registry.GetGauge("shandris_persona_memories", persona + "\"long_term\"")
+        .Set(static_cast<double>(longTerm));
+}
+
+} // namespace
+
 // TransitionManager implementation
 TransitionManager::TransitionManager() {
     transitions_ = {};
@@ -64,11 +144,21 @@ void TraitManager::AddPattern(const std::string& trait, const std::vector<std::s
 
 // PersonaSystem implementation
 PersonaSystem::PersonaSystem() 
-    : db_(database::Database::GetInstance()) {
+    : PersonaSystem(nullptr) {
+}
+
+PersonaSystem::PersonaSystem(std::shared_ptr<WorkStealingExecutor> analysisExecutor)
+    : db_(database::Database::GetInstance()),
+      executor_(std::move(analysisExecutor)) {
     // Initialize database connection
+    std::unique_lock<std::mutex> dbLock(DatabaseMutex());
     if (!db_.Initialize()) {
         throw std::runtime_error("Failed to initialize database connection");
     }
+    dbLock.unlock();
+
+    pipeline_ = executor_ ? std::make_unique<InteractionPipeline>(*executor_)
+                          : std::make_unique<InteractionPipeline>();
 
     transitions_ = std::make_unique<TransitionManager>();
     context_ = std::make_shared<PersonaContext>();
@@ -182,6 +272,10 @@ bool PersonaSystem::SwitchPersona(const std::string& targetPersonaID, const std:
         return false;
     }
 
+    // Background work queued for the outgoing persona finishes against it
+    Sync();
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+
     std::string oldPersonaID;
     if (activePersona_) {
         oldPersonaID = activePersona_->ID;
@@ -292,17 +386,189 @@ std::shared_ptr<PersonaUpdate> PersonaSystem::ProcessInteraction(
     });
 }
 
+InteractionResponse PersonaSystem::RespondToInteraction(const std::shared_ptr<Interaction>& interaction) {
+    // Temporaries of this interaction come from one arena, freed on return
+    ScratchScope scratch;
+    ScopedTimer timer(Metrics().respond);
+    InteractionResponse response;
+    {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        if (!activePersona_ || !interaction) {
+            return response;
+        }
+
+        // Only what the reply depends on runs before returning
+        UpdateEmotionalState(interaction);
+        EvolvePersonality(interaction);
+        response = CalculateResponseStyle(interaction);
+    }
+
+    // Queued outside the lock, since a full queue waits on jobs that take it
+    pipeline_->Submit(PipelineStage::Analysis, [this, interaction] {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        ProcessEmotionalResonance(interaction);
+        ProcessEmotionalTriggers(interaction);
+    });
+    ScheduleReflection();
+    return response;
+}
+
+void PersonaSystem::Sync() {
+    pipeline_->Drain();
+}
+
+void PersonaSystem::Tick() {
+    std::shared_ptr<MemoryManager> memoryManager;
+    {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        memoryManager = memoryManager_;
+    }
+    if (memoryManager) {
+        pipeline_->Schedule(PipelineStage::Persistence, "flush", [memoryManager] {
+            memoryManager->FlushDueWrites();
+        });
+        pipeline_->Schedule(PipelineStage::Analysis, "maintenance", [memoryManager] {
+            memoryManager->RunMaintenance(MAINTENANCE_SLICE);
+        });
+    }
+}
+
+IngestStats PersonaSystem::IngestHistory(const std::vector<HistoricalInteraction>& history,
+                                         const IngestOptions& options) {
+    ScopedTimer timer(Metrics().ingest);
+    IngestStats stats;
+
+    // Jobs already queued were submitted before this history; they land first
+    Sync();
+
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+    if (!activePersona_) return stats;
+
+    std::vector<InteractionPipeline::Job> writes;
+    batchedWrites_ = &writes;
+
+    // What RespondToInteraction and AddMemory leave to the analysis stage
+    auto checkpoint = [&] {
+        ProcessMemories();
+        ProcessMemoryClusters();
+        ProcessPatternRecognition();
+        ProcessSelfReflection();
+        ++stats.checkpoints;
+        SubmitBatchedWrites(writes, options.write_batch_size, stats);
+    };
+
+    try {
+        for (size_t i = 0; i < history.size(); ++i) {
+            ScratchScope scratch;
+            const auto& entry = history[i];
+            if (const auto& interaction = entry.interaction) {
+                UpdateEmotionalState(interaction);
+                EvolvePersonality(interaction);
+                ProcessEmotionalResonance(interaction);
+                ProcessEmotionalTriggers(interaction);
+                ++stats.interactions;
+            }
+            for (const auto& memory : entry.memories) {
+                AppendMemory(memory);
+                ++stats.memories;
+            }
+
+            if (options.checkpoint_interval && (i + 1) % options.checkpoint_interval == 0
+                && i + 1 < history.size()) {
+                checkpoint();
+            }
+        }
+        checkpoint();
+    } catch (...) {
+        // Whatever was applied still reaches the database
+        SubmitBatchedWrites(writes, options.write_batch_size, stats);
+        batchedWrites_ = nullptr;
+        throw;
+    }
+
+    batchedWrites_ = nullptr;
+    return stats;
+}
+
+void PersonaSystem::Persist(InteractionPipeline::Job write) {
+    if (batchedWrites_) {
+        batchedWrites_->push_back(std::move(write));
+    } else {
+        pipeline_->Submit(PipelineStage::Persistence, [write = std::move(write)] {
+            std::lock_guard<std::mutex> dbLock(DatabaseMutex());
+            write();
+        });
+    }
+}
+
+void PersonaSystem::SubmitBatchedWrites(std::vector<InteractionPipeline::Job>& writes, size_t batchSize,
+                                        IngestStats& stats) {
+    batchSize = std::max<size_t>(batchSize, 1);
+    for (size_t begin = 0; begin < writes.size(); begin += batchSize) {
+        const auto first = writes.begin() + begin;
+        const auto last = writes.begin() + std::min(writes.size(), begin + batchSize);
+        pipeline_->Submit(PipelineStage::Persistence,
+            [this, batch = std::vector<InteractionPipeline::Job>(std::make_move_iterator(first),
+                                                                 std::make_move_iterator(last))] {
+                // One transaction per batch; without one the writes still go
+                // out one by one, as they would have unbatched. The lock spans
+                // the transaction, so no other shard's write lands inside it.
+                std::lock_guard<std::mutex> dbLock(DatabaseMutex());
+                const bool transaction = db_.BeginTransaction();
+                try {
+                    for (const auto& write : batch) {
+                        write();
+                    }
+                } catch (...) {
+                    if (transaction) db_.RollbackTransaction();
+                    throw;
+                }
+                if (transaction && !db_.CommitTransaction()) {
+                    db_.RollbackTransaction();
+                    throw std::runtime_error("Failed to commit batched history writes");
+                }
+            });
+        ++stats.write_batches;
+    }
+    writes.clear();
+}
+
+PipelineStats PersonaSystem::GetPipelineStats(PipelineStage stage) const {
+    return pipeline_->Stats(stage);
+}
+
+void PersonaSystem::ScheduleMemoryProcessing() {
+    pipeline_->Schedule(PipelineStage::Analysis, "memories", [this] {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        ProcessMemories();
+    });
+}
+
+void PersonaSystem::ScheduleReflection() {
+    pipeline_->Schedule(PipelineStage::Analysis, "reflection", [this] {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        ProcessMemoryClusters();
+        ProcessPatternRecognition();
+        ProcessSelfReflection();
+    });
+}
+
 void PersonaSystem::UpdateTrait(const std::string& traitName, double influence, const std::string& evidence) {
-    // Save trait to database
-    db_.SaveTrait(
-        activePersona_->ID,
-        traitName,
-        influence,
-        0.8  // confidence
-    );
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+    if (!activePersona_) return;
+
+    // Save trait to database in the background
+    Persist(
+        [this, personaID = activePersona_->ID, traitName, influence] {
+            db_.SaveTrait(
+                personaID,
+                traitName,
+                influence,
+                0.8  // confidence
+            );
+        });
 
     // Update local state
-    if (!activePersona_) return;
 
     auto& personality = activePersona_->Personality;
     auto it = personality.CoreTraits.find(traitName);
@@ -312,12 +578,11 @@ void PersonaSystem::UpdateTrait(const std::string& traitName, double influence,
     }
 
     auto& trait = it->second;
-    double timeSinceUpdate = std::chrono::duration_cast<std::chrono::hours>(
-        std::chrono::system_clock::now() - trait.LastUpdated).count() / 24.0; // Convert to days
+    const auto now = std::chrono::system_clock::now();
 
-    // Apply decay
-    double decayFactor = std::exp(-trait.DecayRate * timeSinceUpdate);
-    trait.CurrentValue *= decayFactor;
+    // Fold in the decay since the last update
+    trait.CurrentValue = ExponentialDecay(trait.CurrentValue, trait.DecayRate,
+                                          Elapsed<DecayDays>(trait.LastUpdated, now));
 
     // Apply new influence
     trait.CurrentValue = std::min(1.0, std::max(0.0, 
@@ -325,7 +590,7 @@ void PersonaSystem::UpdateTrait(const std::string& traitName, double influence,
 
     // Update evidence and timestamp
     trait.Evidence.push_back(evidence);
-    trait.LastUpdated = std::chrono::system_clock::now();
+    trait.LastUpdated = now;
 
     // Propagate influence to related traits
     PropagateTraitInfluence(traitName, influence);
@@ -358,28 +623,58 @@ void PersonaSystem::ApplyTraitDecay() {
     auto now = std::chrono::system_clock::now();
     auto& personality = activePersona_->Personality;
 
-    // Apply decay to all traits
-    for (auto& [name, trait] : personality.CoreTraits) {
-        double timeSinceUpdate = std::chrono::duration_cast<std::chrono::hours>(
-            now - trait.LastUpdated).count() / 24.0;
-        double decayFactor = std::exp(-trait.DecayRate * timeSinceUpdate);
-        trait.CurrentValue *= decayFactor;
-    }
-
-    for (auto& [name, trait] : personality.DerivedTraits) {
-        double timeSinceUpdate = std::chrono::duration_cast<std::chrono::hours>(
-            now - trait.LastUpdated).count() / 24.0;
-        double decayFactor = std::exp(-trait.DecayRate * timeSinceUpdate);
-        trait.CurrentValue *= decayFactor;
-    }
+    // Reads already see decay in closed form (GetTraitStrength); this folds
+    // it into the stored values, e.g. before they are persisted. Calling it
+    // again does not decay twice.
+    auto materialize = [&](auto& traits) {
+        for (auto& [name, trait] : traits) {
+            trait.CurrentValue = ExponentialDecay(trait.CurrentValue, trait.DecayRate,
+                                                  Elapsed<DecayDays>(trait.LastUpdated, now));
+            trait.LastUpdated = now;
+        }
+    };
+    materialize(personality.CoreTraits);
+    materialize(personality.DerivedTraits);
 }
 
 void PersonaSystem::AddTraitCorrelation(const std::string& trait1, const std::string& trait2, double correlation) {
     if (!activePersona_) return;
+    SyncTraitCorrelations();
 
     auto& personality = activePersona_->Personality;
     std::string key = trait1 + "_" + trait2;
     personality.TraitCorrelations[key] = correlation;
+    traitCorrelations_.Declare(InternTrait(trait1), InternTrait(trait2), correlation);
+    traitCorrelationsSynced_ = personality.TraitCorrelations.size();
+}
+
+void PersonaSystem::SyncTraitCorrelations() {
+    const auto& personality = activePersona_->Personality;
+    if (traitCorrelationsPersona_ == activePersona_->ID &&
+        traitCorrelationsSynced_ == personality.TraitCorrelations.size()) {
+        return;
+    }
+
+    // Persisted keys join two names with '_', which names contain too; the
+    // split whose halves are both known traits wins, else the longest
+    // known source
+    auto isTrait = [&](const std::string& name) {
+        return personality.CoreTraits.count(name) || personality.DerivedTraits.count(name);
+    };
+    traitCorrelations_.ClearDeclared();
+    for (const auto& [key, correlation] : personality.TraitCorrelations) {
+        size_t split = std::string::npos;
+        for (size_t pos = key.find('_'); pos != std::string::npos; pos = key.find('_', pos + 1)) {
+            if (!isTrait(key.substr(0, pos))) continue;
+            split = pos;
+            if (isTrait(key.substr(pos + 1))) break;
+        }
+        if (split == std::string::npos) continue;
+        traitCorrelations_.Declare(InternTrait(key.substr(0, split)),
+                                   InternTrait(key.substr(split + 1)), correlation);
+    }
+    traitCorrelationsPersona_ = activePersona_->ID;
+    traitCorrelationsSynced_ = personality.TraitCorrelations.size();
 }
 
 void PersonaSystem::AddDerivedTrait(const std::string& baseTrait, const std::string& newTrait, double influence) {
@@ -423,25 +718,27 @@ double PersonaSystem::GetTraitStrength(const std::string& traitName) const {
 
     const auto& personality = activePersona_->Personality;
     auto it = personality.CoreTraits.find(traitName);
-    if (it != personality.CoreTraits.end()) {
-        return it->second.CurrentValue;
-    }
-    it = personality.DerivedTraits.find(traitName);
-    if (it != personality.DerivedTraits.end()) {
-        return it->second.CurrentValue;
+    if (it == personality.CoreTraits.end()) {
+        it = personality.DerivedTraits.find(traitName);
+        if (it == personality.DerivedTraits.end()) return 0.0;
     }
-    return 0.0;
+
+    // Stored as of the last update; decayed to now on read
+    const auto& trait = it->second;
+    return ExponentialDecay(trait.CurrentValue, trait.DecayRate,
+                            Elapsed<DecayDays>(trait.LastUpdated, std::chrono::system_clock::now()));
 }
 
 void PersonaSystem::PropagateTraitInfluence(const std::string& traitName, double influence) {
     if (!activePersona_) return;
+    SyncTraitCorrelations();
 
-    auto& personality = activePersona_->Personality;
-    for (const auto& [key, correlation] : personality.TraitCorrelations) {
-        if (key.find(traitName) != std::string::npos) {
-            std::string otherTrait = key.substr(traitName.length() + 1);
-            UpdateTrait(otherTrait, influence * correlation, "correlated_trait");
-        }
+    // Copied: the updates below propagate in turn and may resync the matrix
+    const auto* declared = traitCorrelations_.Declared(InternTrait(traitName));
+    if (!declared) return;
+    const auto links = *declared;
+    for (const auto& [otherTrait, correlation] : links) {
+        UpdateTrait(TraitName(otherTrait), influence * correlation, "correlated_trait");
     }
 }
 
@@ -480,30 +777,33 @@ void PersonaSystem::CheckTraitConsistency() {
 }
 
 void PersonaSystem::UpdateEmotionalState(const std::shared_ptr<Interaction>& interaction) {
-    // Save emotional state to database
-    db_.SaveMood(
-        activePersona_->ID,
-        interaction->Type,
-        interaction->Data["intensity"].asDouble(),
-        0.5,  // base value
-        0.1   // decay rate
-    );
+    if (!activePersona_) return;
+
+    // Save emotional state to database in the background
+    Persist(
+        [this, personaID = activePersona_->ID, type = interaction->Type,
+         intensity = interaction->Data["intensity"].asDouble()] {
+            db_.SaveMood(
+                personaID,
+                type,
+                intensity,
+                0.5,  // base value
+                0.1   // decay rate
+            );
+        });
 
     // Update local state
-    if (!activePersona_) return;
 
     auto& state = activePersona_->CurrentState;
     auto& data = interaction->Data;
 
-    // Update last interaction time
+    // Update last interaction time; attachment accrues over the gap since
+    // the previous one
+    const auto previousInteraction = state.LastInteraction;
     state.LastInteraction = std::chrono::system_clock::now();
 
-    // Calculate time since last interaction
-    auto timeSinceLast = std::chrono::duration_cast<std::chrono::hours>(
-        state.LastInteraction - state.LastInteraction).count();
-
     // Update attachment level based on time
-    UpdateAttachmentLevel(state.LastInteraction);
+    UpdateAttachmentLevel(previousInteraction);
 
     // Process emotional content
     CalculateEmotionalInfluence(interaction);
@@ -520,21 +820,37 @@ void PersonaSystem::ApplyTimeBasedEffects() {
 
     auto now = std::chrono::system_clock::now();
     auto& effects = activePersona_->TimeEffects;
+    SyncEffectDeadlines();
+
+    // An effect's strength is BaseValue scaled by CalculateTimeDecay on read,
+    // so only expiry needs a tick, and only effects that are due are visited
+    effectDeadlines_.PopDue(now, [&](const std::string& name) {
+        auto it = effects.find(name);
+        if (it == effects.end()) return;
+        const auto expiry = EffectExpiry(it->second);
+        if (expiry > now) {
+            // Restarted without going through ProcessArousalChange
+            effectDeadlines_.Schedule(name, expiry);
+        } else {
+            effects.erase(it);
+        }
+    });
+}
 
-    for (auto& [name, effect] : effects) {
-        double decay = CalculateTimeDecay(effect);
-        effect.BaseValue *= decay;
+void PersonaSystem::SyncEffectDeadlines() {
+    const auto& effects = activePersona_->TimeEffects;
+    if (effectDeadlinesPersona_ == activePersona_->ID && effectDeadlines_.Size() == effects.size()) return;
 
-        // Remove expired effects
-        if (std::chrono::duration_cast<std::chrono::hours>(
-            now - effect.StartTime) > effect.MaxEffectDuration) {
-            effects.erase(name);
-        }
+    effectDeadlines_.Clear();
+    for (const auto& [name, effect] : effects) {
+        effectDeadlines_.Schedule(name, EffectExpiry(effect));
     }
+    effectDeadlinesPersona_ = activePersona_->ID;
 }
 
 InteractionResponse PersonaSystem::CalculateResponseStyle(
     const std::shared_ptr<Interaction>& interaction) const {
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
     if (!activePersona_) return InteractionResponse{};
 
     const auto& state = activePersona_->CurrentState;
@@ -591,11 +907,14 @@ void PersonaSystem::ProcessArousalChange(double change, const std::string& trigg
     effect.MaxEffectDuration = std::chrono::hours(2);
     effect.StartTime = std::chrono::system_clock::now();
 
+    SyncEffectDeadlines();
     activePersona_->TimeEffects[trigger] = effect;
+    effectDeadlines_.Schedule(trigger, EffectExpiry(effect));
 }
 
 void PersonaSystem::UpdateAttachmentLevel(const std::chrono::system_clock::time_point& lastInteraction) {
-    if (!activePersona_) return;
+    // Nothing to accrue before the first interaction
+    if (!activePersona_ || lastInteraction == std::chrono::system_clock::time_point{}) return;
 
     auto timeSinceLast = std::chrono::duration_cast<std::chrono::hours>(
         std::chrono::system_clock::now() - lastInteraction).count();
@@ -607,7 +926,10 @@ void PersonaSystem::UpdateAttachmentLevel(const std::chrono::system_clock::time_
         clinginessChange = 0.1 * (timeSinceLast / 24.0);
     }
 
-    UpdateTrait("clinginess", clinginessChange, "time_based_attachment");
+    // Nothing accrues within 12 hours, and the trait decays on read anyway
+    if (clinginessChange > 0.0) {
+        UpdateTrait("clinginess", clinginessChange, "time_based_attachment");
+    }
 }
 
 void PersonaSystem::AdjustResponseBiases(const std::shared_ptr<Interaction>& interaction) {
@@ -689,79 +1011,128 @@ void PersonaSystem::ApplyEmotionalFeedback(const std::shared_ptr<Interaction>& i
 }
 
 double PersonaSystem::CalculateTimeDecay(const TimeBasedEffect& effect) const {
-    auto timeSinceStart = std::chrono::duration_cast<std::chrono::hours>(
-        std::chrono::system_clock::now() - effect.StartTime).count();
-    return std::exp(-effect.DecayRate * timeSinceStart);
+    return ExponentialDecay(1.0, effect.DecayRate,
+                            Elapsed<DecayHours>(effect.StartTime, std::chrono::system_clock::now()));
 }
 
 void PersonaSystem::AddMemory(const MemoryEvent& memory) {
-    // Convert memory to database format
-    std::map<std::string, std::string> context;
-    for (const auto& [key, value] : memory.Context) {
-        context[key] = value;
-    }
-
-    std::map<std::string, double> emotions;
-    for (const auto& [key, value] : memory.EmotionalWeights) {
-        emotions[key] = value;
-    }
-
-    // Save to database
-    db_.SaveMemory(
-        activePersona_->ID,
-        memory.Type,
-        memory.Content,
-        memory.Importance,
-        context,
-        memory.Relations,
-        memory.Tags,
-        emotions
-    );
+    ScopedTimer timer(Metrics().addMemory);
+    {
+        std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+        if (!activePersona_) return;
+        AppendMemory(memory);
+    }
+
+    // Decay, promotion and reweighting catch up off the caller's thread;
+    // a burst of memories shares one pass
+    ScheduleMemoryProcessing();
+}
+
+void PersonaSystem::AppendMemory(const MemoryEvent& memory) {
+    // Save to database in the background
+    Persist([this, personaID = activePersona_->ID, memory] {
+        // Convert memory to database format
+        std::map<std::string, std::string> context;
+        for (const auto& [key, value] : memory.Context) {
+            context[key] = value;
+        }
+
+        std::map<std::string, double> emotions;
+        for (const auto& [key, value] : memory.EmotionalWeights) {
+            emotions[key] = value;
+        }
+
+        db_.SaveMemory(
+            personaID,
+            memory.Type,
+            memory.Content,
+            memory.Importance,
+            context,
+            memory.Relations,
+            memory.Tags,
+            emotions
+        );
+    });
 
     // Update local state
     auto& memoryContext = activePersona_->Memory;
-    
+
     // Add to short-term memory
+    const bool tracked = MemorySweepTracked();
     memoryContext.ShortTermMemories.push_back(memory);
-    
+    if (tracked) {
+        TrackShortTermMemory(memory);
+    }
+
     // Update memory weights if this is a new type
     if (memoryContext.MemoryWeights.find(memory.Type) == memoryContext.MemoryWeights.end()) {
         memoryContext.MemoryWeights[memory.Type] = 1.0;
     }
-
-    // Process the memory immediately
-    ProcessMemories();
 }
 
 void PersonaSystem::ProcessMemories() {
     if (!activePersona_) return;
+    ScopedTimer timer(Metrics().processMemories);
 
     auto& memoryContext = activePersona_->Memory;
     auto now = std::chrono::system_clock::now();
 
-    // Decay short-term memories
-    DecayShortTermMemories();
-
-    // Check for memories to move to long-term
-    for (auto it = memoryContext.ShortTermMemories.begin(); 
-         it != memoryContext.ShortTermMemories.end();) {
-        auto timeSinceMemory = std::chrono::duration_cast<std::chrono::hours>(
-            now - it->Timestamp).count();
-
-        // Move significant memories to long-term
-        if (it->Importance > 0.7 || timeSinceMemory > 24) {
-            MoveToLongTerm(*it);
-            it = memoryContext.ShortTermMemories.erase(it);
-        } else {
-            ++it;
+    // The sweeps below only change anything once a memory has aged out or
+    // crossed the promotion threshold, so between those they are skipped
+    if (!MemorySweepTracked()) RescheduleMemorySweep();
+    if (now >= shortTermDeadline_ || promotionPending_) {
+        // Decay short-term memories
+        DecayShortTermMemories();
+
+        // Check for memories to move to long-term
+        for (auto it = memoryContext.ShortTermMemories.begin(); 
+             it != memoryContext.ShortTermMemories.end();) {
+            auto timeSinceMemory = std::chrono::duration_cast<std::chrono::hours>(
+                now - it->Timestamp).count();
+
+            // Move significant memories to long-term
+            if (it->Importance > PROMOTION_IMPORTANCE || timeSinceMemory > 24) {
+                MoveToLongTerm(*it);
+                it = memoryContext.ShortTermMemories.erase(it);
+            } else {
+                ++it;
+            }
         }
+        RescheduleMemorySweep();
     }
 
+    // A slice at a time; nothing to do once everything is merged
+    if (autoConsolidation_) ConsolidateMemories();
+
     // Update memory weights
     UpdateMemoryWeights();
 
     // Apply memory influence to current state
     CalculateMemoryInfluence();
+
+    RecordMemoryTiers(activePersona_->ID, memoryContext.ShortTermMemories.size(),
+                      memoryContext.LongTermMemories.size());
+}
+
+bool PersonaSystem::MemorySweepTracked() const {
+    return memorySweepPersona_ == activePersona_->ID
+        && memorySweepTracked_ == activePersona_->Memory.ShortTermMemories.size();
+}
+
+void PersonaSystem::TrackShortTermMemory(const MemoryEvent& memory) {
+    shortTermDeadline_ = std::min(shortTermDeadline_, memory.Timestamp + SHORT_TERM_EXPIRY);
+    promotionPending_ = promotionPending_ || memory.Importance > PROMOTION_IMPORTANCE;
+    ++memorySweepTracked_;
+}
+
+void PersonaSystem::RescheduleMemorySweep() {
+    shortTermDeadline_ = std::chrono::system_clock::time_point::max();
+    promotionPending_ = false;
+    memorySweepTracked_ = 0;
+    memorySweepPersona_ = activePersona_->ID;
+    for (const auto& memory : activePersona_->Memory.ShortTermMemories) {
+        TrackShortTermMemory(memory);
+    }
 }
 
 void PersonaSystem::UpdateMemoryWeights() {
@@ -785,125 +1156,181 @@ void PersonaSystem::UpdateMemoryWeights() {
 
 std::vector<MemoryEvent> PersonaSystem::RecallRelevantMemories(
     const std::string& context) const {
-    if (!activePersona_) return {};
+    // Ranked lookup through the memory manager's text index when attached
+    if (memoryManager_) {
+        return memoryManager_->RecallRelevantMemories(context);
+    }
+
+    std::vector<const MemoryEvent*> ranked;
+    RecallRelevantMemories(context, SIZE_MAX, std::chrono::system_clock::now(), ranked);
 
     std::vector<MemoryEvent> relevantMemories;
-    const auto& memoryContext = activePersona_->Memory;
+    relevantMemories.reserve(ranked.size());
+    for (const MemoryEvent* memory : ranked) {
+        relevantMemories.push_back(*memory);
+    }
+    return relevantMemories;
+}
 
-    // Combine short and long term memories
-    std::vector<MemoryEvent> allMemories = memoryContext.ShortTermMemories;
-    allMemories.insert(allMemories.end(), 
-                      memoryContext.LongTermMemories.begin(), 
-                      memoryContext.LongTermMemories.end());
+void PersonaSystem::RecallRelevantMemories(const std::string& context, size_t k,
+                                           std::chrono::system_clock::time_point now,
+                                           std::vector<const MemoryEvent*>& results) const {
+    results.clear();
+    if (!activePersona_) return;
 
-    // Find relevant memories
-    for (const auto& memory : allMemories) {
-        // Check tags and content for relevance
-        bool isRelevant = false;
-        for (const auto& tag : memory.Tags) {
-            if (context.find(tag) != std::string::npos) {
-                isRelevant = true;
-                break;
+    // Scored once against a single now, then selected without copying
+    TopKRecall<MemoryEvent> recall(k, now);
+    auto offerRelevant = [&](const std::vector<MemoryEvent>& memories) {
+        for (const auto& memory : memories) {
+            // Check tags for relevance
+            for (const auto& tag : memory.Tags) {
+                if (context.find(tag) != std::string::npos) {
+                    recall.Offer(memory, memory.Importance, memory.Timestamp);
+                    break;
+                }
             }
         }
-        if (isRelevant) {
-            relevantMemories.push_back(memory);
-        }
-    }
-
-    // Sort by importance and recency
-    std::sort(relevantMemories.begin(), relevantMemories.end(),
-        [](const MemoryEvent& a, const MemoryEvent& b) {
-            auto timeA = std::chrono::duration_cast<std::chrono::hours>(
-                std::chrono::system_clock::now() - a.Timestamp).count();
-            auto timeB = std::chrono::duration_cast<std::chrono::hours>(
-                std::chrono::system_clock::now() - b.Timestamp).count();
-            return (a.Importance / (1 + timeA)) > (b.Importance / (1 + timeB));
-        });
-
-    return relevantMemories;
+    };
+    offerRelevant(activePersona_->Memory.ShortTermMemories);
+    offerRelevant(activePersona_->Memory.LongTermMemories);
+    recall.Finish(results);
 }
 
-void PersonaSystem::SavePersonalityState() {
+nlohmann::json PersonaSystem::SerializePersonalityState(const Persona& persona) {
     // Convert persona state to JSON
     nlohmann::json state;
-    state["id"] = activePersona_->ID;
-    state["name"] = activePersona_->Name;
-    state["type"] = static_cast<int>(activePersona_->Type);
-    state["traits"] = activePersona_->Personality.CoreTraits;
-    state["mood_bias"] = activePersona_->MoodBias;
-    state["preferences"] = activePersona_->Preferences;
-    state["constraints"] = activePersona_->Constraints;
-    state["active"] = activePersona_->Active;
-    state["last_used"] = std::chrono::system_clock::to_time_t(activePersona_->LastUsed);
+    state["id"] = persona.ID;
+    state["name"] = persona.Name;
+    state["type"] = static_cast<int>(persona.Type);
+    state["traits"] = persona.Personality.CoreTraits;
+    state["mood_bias"] = persona.MoodBias;
+    state["preferences"] = persona.Preferences;
+    state["constraints"] = persona.Constraints;
+    state["active"] = persona.Active;
+    state["last_used"] = std::chrono::system_clock::to_time_t(persona.LastUsed);
+    return state;
+}
+
+void PersonaSystem::ApplyPersonalityState(Persona& persona, const nlohmann::json& state) {
+    persona.ID = state["id"];
+    persona.Name = state["name"];
+    persona.Type = static_cast<PersonaType>(state["type"]);
+    persona.Personality.CoreTraits = state["traits"];
+    persona.MoodBias = state["mood_bias"];
+    persona.Preferences = state["preferences"];
+    persona.Constraints = state["constraints"];
+    persona.Active = state["active"];
+    persona.LastUsed = std::chrono::system_clock::from_time_t(state["last_used"]);
+}
+
+void PersonaSystem::SavePersonalityState() {
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+    if (!activePersona_) return;
 
-    // Save to database
-    db_.SavePersonaProfile(activePersona_->ID, state.dump());
+    // Serialized now, written in the background
+    Persist(
+        [this, personaID = activePersona_->ID, profile = SerializePersonalityState(*activePersona_).dump()] {
+            db_.SavePersonaProfile(personaID, profile);
+        });
+
+    // The stored profile is now newer than any attached snapshot
+    if (snapshot_) {
+        staleProfiles_.insert(activePersona_->ID);
+    }
 }
 
 void PersonaSystem::LoadPersonalityState() {
+    // Queued writes land before the database is read
+    Sync();
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+    if (!activePersona_) return;
+    // Loaded traits can change how stored links resolve
+    traitCorrelationsPersona_.clear();
+
+    // Snapshot profiles are binary and read in place from the mapping
+    std::string_view packed;
+    if (snapshot_ && !staleProfiles_.count(activePersona_->ID) &&
+        snapshot_->FindProfile(activePersona_->ID, packed)) {
+        ApplyPersonalityState(*activePersona_, nlohmann::json::from_msgpack(packed.begin(), packed.end()));
+        return;
+    }
+
     // Load from database
-    std::string stateStr = db_.GetPersonaProfile(activePersona_->ID);
+    std::string stateStr;
+    {
+        std::lock_guard<std::mutex> dbLock(DatabaseMutex());
+        stateStr = db_.GetPersonaProfile(activePersona_->ID);
+    }
     if (stateStr.empty()) {
         return;
     }
 
     // Parse JSON
-    nlohmann::json state = nlohmann::json::parse(stateStr);
-    
-    // Update persona state
-    activePersona_->ID = state["id"];
-    activePersona_->Name = state["name"];
-    activePersona_->Type = static_cast<PersonaType>(state["type"]);
-    activePersona_->Personality.CoreTraits = state["traits"];
-    activePersona_->MoodBias = state["mood_bias"];
-    activePersona_->Preferences = state["preferences"];
-    activePersona_->Constraints = state["constraints"];
-    activePersona_->Active = state["active"];
-    activePersona_->LastUsed = std::chrono::system_clock::from_time_t(state["last_used"]);
+    ApplyPersonalityState(*activePersona_, nlohmann::json::parse(stateStr));
+}
+
+void PersonaSystem::SetMemoryManager(std::shared_ptr<MemoryManager> memoryManager) {
+    // Maintenance shares the analysis workers rather than starting its own
+    if (memoryManager && executor_) memoryManager->SetMaintenanceExecutor(executor_);
+    memoryManager_ = std::move(memoryManager);
+}
+
+void PersonaSystem::AttachSnapshot(std::shared_ptr<const MappedSnapshot> snapshot) {
+    snapshot_ = std::move(snapshot);
+    staleProfiles_.clear();
+}
+
+void PersonaSystem::AppendToSnapshot(SnapshotWriter& writer) const {
+    for (const auto& [id, persona] : personas_) {
+        if (persona) {
+            writer.AddProfile(persona->ID, nlohmann::json::to_msgpack(SerializePersonalityState(*persona)));
+        }
+    }
 }
 
 void PersonaSystem::CreatePersonalitySnapshot() {
     if (!activePersona_) return;
 
-    PersonalitySnapshot snapshot;
-    snapshot.CoreTraits = activePersona_->Personality.CoreTraits;
-    snapshot.DerivedTraits = activePersona_->Personality.DerivedTraits;
-    snapshot.CurrentState = activePersona_->CurrentState;
-    snapshot.RecentEvents = activePersona_->Memory.ShortTermMemories;
-    snapshot.Timestamp = std::chrono::system_clock::now();
-
-    activePersona_->PersonalityHistory.push_back(snapshot);
+    // Only traits that moved since the last snapshot are stored, and
+    // memories by reference; the ring drops the oldest past its capacity
+    auto& history = histories_[activePersona_->ID];
+    PersonalityHistory::Snapshot snapshot;
+    snapshot.timestamp = std::chrono::system_clock::now();
+
+    auto addChanged = [&](const auto& traits) {
+        for (const auto& [name, trait] : traits) {
+            const SymbolID id = InternTrait(name);
+            if (history.Changed(id, trait.CurrentValue)) {
+                snapshot.changes.emplace_back(id, trait.CurrentValue);
+            }
+        }
+    };
+    addChanged(activePersona_->Personality.CoreTraits);
+    addChanged(activePersona_->Personality.DerivedTraits);
 
-    // Keep only last 100 snapshots
-    if (activePersona_->PersonalityHistory.size() > 100) {
-        activePersona_->PersonalityHistory.erase(activePersona_->PersonalityHistory.begin());
+    const auto& shortTermMemories = activePersona_->Memory.ShortTermMemories;
+    snapshot.memories.reserve(shortTermMemories.size());
+    for (const auto& memory : shortTermMemories) {
+        snapshot.memories.push_back(history.MemoryReference(memory.Type, memory.Content, memory.Timestamp));
     }
+    snapshot.mood = activePersona_->CurrentState.Mood;
+    snapshot.arousal = activePersona_->CurrentState.Arousal;
+
+    history.Record(std::move(snapshot));
 }
 
 void PersonaSystem::ApplyHistoricalInfluence() {
     if (!activePersona_) return;
 
-    const auto& history = activePersona_->PersonalityHistory;
-    if (history.empty()) return;
+    auto found = histories_.find(activePersona_->ID);
+    if (found == histories_.end() || found->second.Size() == 0) return;
+    const auto& history = found->second;
 
-    // Calculate weighted average of historical traits
+    // Weighted average of historical traits, kept up to date by the history
     for (auto& [traitName, trait] : activePersona_->Personality.CoreTraits) {
-        double weightedSum = 0.0;
-        double totalWeight = 0.0;
-
-        for (const auto& snapshot : history) {
-            auto it = snapshot.CoreTraits.find(traitName);
-            if (it != snapshot.CoreTraits.end()) {
-                double timeWeight = std::exp(-0.1 * std::chrono::duration_cast<std::chrono::days>(
-                    std::chrono::system_clock::now() - snapshot.Timestamp).count());
-                weightedSum += it->second.CurrentValue * timeWeight;
-                totalWeight += timeWeight;
-            }
-        }
-
-        if (totalWeight > 0) {
-            trait.CurrentValue = weightedSum / totalWeight;
+        double average = 0.0;
+        if (history.WeightedAverage(InternTrait(traitName), average)) {
+            trait.CurrentValue = average;
         }
     }
 }
@@ -916,34 +1343,73 @@ void PersonaSystem::UpdateTraitFromMemory(const MemoryEvent& memory) {
     }
 }
 
-void PersonaSystem::ConsolidateMemories() {
-    if (!activePersona_) return;
-
-    auto& memoryContext = activePersona_->Memory;
-    auto now = std::chrono::system_clock::now();
-
-    // Consolidate similar memories
-    std::map<std::string, MemoryEvent> consolidatedMemories;
-    for (const auto& memory : memoryContext.LongTermMemories) {
-        std::string key = memory.Type + "_" + memory.Content;
-        if (consolidatedMemories.find(key) == consolidatedMemories.end()) {
-            consolidatedMemories[key] = memory;
+bool PersonaSystem::ConsolidationTracked() const {
+    const auto& longTermMemories = activePersona_->Memory.LongTermMemories;
+    if (consolidationPersona_ != activePersona_->ID || consolidationTracked_ != longTermMemories.size()) {
+        return false;
+    }
+    // Same count is not same memories: the last merged one must still be
+    // where the index has it
+    if (consolidated_ == 0) return true;
+    auto it = consolidationIndex_.find(ConsolidationKey(longTermMemories[consolidated_ - 1]));
+    return it != consolidationIndex_.end() && it->second == consolidated_ - 1;
+}
+
+size_t PersonaSystem::ConsolidatedPosition(const std::string& key) {
+    auto it = consolidationIndex_.find(key);
+    if (it == consolidationIndex_.end()) return std::string::npos;
+    const auto& longTermMemories = activePersona_->Memory.LongTermMemories;
+    if (it->second < consolidated_ && it->second < longTermMemories.size()
+        && ConsolidationKey(longTermMemories[it->second]) == key) {
+        return it->second;
+    }
+    // Replaced elsewhere; the next call merges again from the start
+    consolidationTracked_ = std::string::npos;
+    return std::string::npos;
+}
+
+void PersonaSystem::SetAutoConsolidation(bool enabled) {
+    std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+    autoConsolidation_ = enabled;
+}
+
+bool PersonaSystem::ConsolidateMemories() {
+    if (!activePersona_) return false;
+
+    auto& longTermMemories = activePersona_->Memory.LongTermMemories;
+    if (!ConsolidationTracked()) {
+        // Another persona, or changed elsewhere: merge again from the start
+        consolidationIndex_.clear();
+        consolidationPersona_ = activePersona_->ID;
+        consolidated_ = 0;
+    }
+
+    // Fold the next slice into the merged prefix, keeping first occurrences
+    // in order and closing the gaps merged ones leave
+    const size_t end = std::min(longTermMemories.size(), consolidated_ + CONSOLIDATION_SLICE);
+    size_t kept = consolidated_;
+    for (size_t i = consolidated_; i < end; ++i) {
+        std::string key = ConsolidationKey(longTermMemories[i]);
+        const size_t position = ConsolidatedPosition(key);
+        if (consolidationTracked_ == std::string::npos) {
+            // The prefix changed under the index; stop here and start over
+            // on the next call, once the slice so far is compacted
+            longTermMemories.erase(longTermMemories.begin() + kept, longTermMemories.begin() + i);
+            return true;
+        }
+        if (position != std::string::npos) {
+            MergeMemory(longTermMemories[position], longTermMemories[i]);
         } else {
-            // Merge similar memories
-            auto& existing = consolidatedMemories[key];
-            existing.Importance = std::max(existing.Importance, memory.Importance);
-            existing.EmotionalWeight = std::max(existing.EmotionalWeight, memory.EmotionalWeight);
-            for (const auto& [trait, influence] : memory.TraitInfluences) {
-                existing.TraitInfluences[trait] += influence;
-            }
+            if (kept != i) longTermMemories[kept] = std::move(longTermMemories[i]);
+            consolidationIndex_[std::move(key)] = kept;
+            consolidated_ = ++kept;
         }
     }
+    longTermMemories.erase(longTermMemories.begin() + kept, longTermMemories.begin() + end);
 
-    // Update long-term memories
-    memoryContext.LongTermMemories.clear();
-    for (const auto& [_, memory] : consolidatedMemories) {
-        memoryContext.LongTermMemories.push_back(memory);
-    }
+    consolidated_ = kept;
+    consolidationTracked_ = longTermMemories.size();
+    return consolidated_ < longTermMemories.size();
 }
 
 void PersonaSystem::MoveToLongTerm(const MemoryEvent& memory) {
@@ -951,7 +1417,28 @@ void PersonaSystem::MoveToLongTerm(const MemoryEvent& memory) {
 
     // Only move significant memories
     if (memory.Importance > 0.5 || memory.EmotionalWeight > 0.7) {
-        activePersona_->Memory.LongTermMemories.push_back(memory);
+        auto& longTermMemories = activePersona_->Memory.LongTermMemories;
+        bool tracked = autoConsolidation_ && ConsolidationTracked();
+        std::string key = ConsolidationKey(memory);
+
+        // Merged on arrival when one like it is already merged
+        if (tracked) {
+            const size_t position = ConsolidatedPosition(key);
+            if (position != std::string::npos) {
+                MergeMemory(longTermMemories[position], memory);
+                return;
+            }
+            tracked = consolidationTracked_ != std::string::npos;
+        }
+
+        longTermMemories.push_back(memory);
+        if (tracked) {
+            // Joins the merged prefix only if it directly follows it
+            if (consolidated_ + 1 == longTermMemories.size()) {
+                consolidationIndex_.emplace(std::move(key), consolidated_++);
+            }
+            consolidationTracked_ = longTermMemories.size();
+        }
     }
 }
 
@@ -1087,56 +1574,49 @@ void PersonaSystem::UpdateEmotionalPatterns() {
 void PersonaSystem::CreateMemoryConnections() {
     if (!activePersona_) return;
 
+    constexpr SimilarityWeights CONNECTION_WEIGHTS{
+        .shared_trait = 0.3,
+        .shared_tag = 0.2,
+        .emotional_match = 0.2,
+        .emotional_match_window = 0.2
+    };
+
     auto& memoryContext = activePersona_->Memory;
+    auto& symbols = SymbolTable::Global();
     
-    // Combine all memories
-    std::vector<MemoryEvent> allMemories = memoryContext.ShortTermMemories;
-    allMemories.insert(allMemories.end(), 
-                      memoryContext.LongTermMemories.begin(), 
-                      memoryContext.LongTermMemories.end());
+    // Reference all memories in place and build their feature records once
+    std::pmr::vector<const MemoryEvent*> allMemories(ScratchResource());
+    allMemories.reserve(memoryContext.ShortTermMemories.size() + memoryContext.LongTermMemories.size());
+    for (const auto& memory : memoryContext.ShortTermMemories) allMemories.push_back(&memory);
+    for (const auto& memory : memoryContext.LongTermMemories) allMemories.push_back(&memory);
+
+    std::vector<MemoryFeatures> features;
+    features.reserve(allMemories.size());
+    for (const auto* memory : allMemories) {
+        features.push_back({
+            .traits = symbols.InternKeys(SymbolKind::Trait, memory->TraitInfluences),
+            .tags = symbols.InternAll(SymbolKind::Tag, memory->Tags),
+            .emotional_weight = memory->EmotionalWeight
+        });
+    }
 
     // Create connections between similar memories
-    for (size_t i = 0; i < allMemories.size(); ++i) {
-        for (size_t j = i + 1; j < allMemories.size(); ++j) {
-            const auto& mem1 = allMemories[i];
-            const auto& mem2 = allMemories[j];
-
-            // Calculate connection strength
-            double strength = 0.0;
-            std::vector<std::string> sharedTraits;
-
-            // Check shared traits
-            for (const auto& [trait, _] : mem1.TraitInfluences) {
-                if (mem2.TraitInfluences.find(trait) != mem2.TraitInfluences.end()) {
-                    strength += 0.3;
-                    sharedTraits.push_back(trait);
-                }
+    FeatureList shared;
+    SimilarityEngine::ScorePairs(features, CONNECTION_WEIGHTS, 0.5,
+        [&](size_t i, size_t j, double strength) {
+            MemoryConnection connection;
+            connection.SourceMemory = allMemories[i]->Content;
+            connection.TargetMemory = allMemories[j]->Content;
+            connection.Strength = strength;
+            connection.ConnectionType = "emotional";
+
+            SimilarityEngine::SharedFeatures(features[i].traits, features[j].traits, shared);
+            for (FeatureID trait : shared) {
+                connection.SharedTraits.push_back(symbols.Name(SymbolKind::Trait, trait));
             }
 
-            // Check shared tags
-            for (const auto& tag : mem1.Tags) {
-                if (std::find(mem2.Tags.begin(), mem2.Tags.end(), tag) != mem2.Tags.end()) {
-                    strength += 0.2;
-                }
-            }
-
-            // Check emotional similarity
-            if (std::abs(mem1.EmotionalWeight - mem2.EmotionalWeight) < 0.2) {
-                strength += 0.2;
-            }
-
-            if (strength > 0.5) {
-                MemoryConnection connection;
-                connection.SourceMemory = mem1.Content;
-                connection.TargetMemory = mem2.Content;
-                connection.Strength = strength;
-                connection.ConnectionType = "emotional";
-                connection.SharedTraits = sharedTraits;
-
-                memoryContext.MemoryConnections.push_back(connection);
-            }
-        }
-    }
+            memoryContext.MemoryConnections.push_back(std::move(connection));
+        });
 }
 
 void PersonaSystem::ProcessEmotionalTriggers(const std::shared_ptr<Interaction>& interaction) {
@@ -1182,52 +1662,57 @@ void PersonaSystem::UpdateEmotionalBaselines() {
 void PersonaSystem::ProcessMemoryClusters() {
     if (!activePersona_) return;
 
-    auto& memoryContext = activePersona_->Memory;
-    
-    // Group memories by emotional similarity
-    std::vector<std::vector<MemoryEvent>> clusters;
-    std::vector<bool> processed(memoryContext.ShortTermMemories.size(), false);
-
-    for (size_t i = 0; i < memoryContext.ShortTermMemories.size(); ++i) {
-        if (processed[i]) continue;
-
-        std::vector<MemoryEvent> cluster;
-        cluster.push_back(memoryContext.ShortTermMemories[i]);
-        processed[i] = true;
-
-        // Find similar memories
-        for (size_t j = i + 1; j < memoryContext.ShortTermMemories.size(); ++j) {
-            if (processed[j]) continue;
-
-            const auto& mem1 = memoryContext.ShortTermMemories[i];
-            const auto& mem2 = memoryContext.ShortTermMemories[j];
-
-            // Calculate similarity
-            double similarity = 0.0;
-            
-            // Check emotional weight similarity
-            similarity += 0.4 * (1.0 - std::abs(mem1.EmotionalWeight - mem2.EmotionalWeight));
-            
-            // Check shared traits
-            for (const auto& [trait, _] : mem1.TraitInfluences) {
-                if (mem2.TraitInfluences.find(trait) != mem2.TraitInfluences.end()) {
-                    similarity += 0.3;
-                }
-            }
+    // Roughly the reach of the old pairwise threshold: shared traits and
+    // emotional weights within a quarter of each other
+    static const ClusterConfig CLUSTER_CONFIG{
+        .emotional_radius = 0.25,
+        .min_trait_similarity = 0.3
+    };
 
-            if (similarity > 0.6) {
-                cluster.push_back(mem2);
-                processed[j] = true;
-            }
+    auto& memoryContext = activePersona_->Memory;
+    const auto& memories = memoryContext.ShortTermMemories;
+    auto& symbols = SymbolTable::Global();
+
+    // Short-term memories carry no IDs, so the pass keys them by position;
+    // each memory is placed once against nearby centroids
+    MemoryClusterIndex index(CLUSTER_CONFIG);
+    for (size_t i = 0; i < memories.size(); ++i) {
+        const auto& memory = memories[i];
+        ClusterFeatures features;
+        features.traits.reserve(memory.TraitInfluences.size());
+        for (const auto& [trait, influence] : memory.TraitInfluences) {
+            features.traits.emplace_back(symbols.Intern(SymbolKind::Trait, trait), influence);
         }
-
-        if (cluster.size() > 1) {
-            clusters.push_back(cluster);
+        std::sort(features.traits.begin(), features.traits.end());
+        for (const auto& tag : memory.Tags) {
+            features.tags.push_back(symbols.Intern(SymbolKind::Tag, tag));
         }
+        std::sort(features.tags.begin(), features.tags.end());
+        features.tags.erase(std::unique(features.tags.begin(), features.tags.end()), features.tags.end());
+        features.emotional_weight = memory.EmotionalWeight;
+        features.timestamp = memory.Timestamp;
+        index.Upsert(std::to_string(i), std::move(features));
     }
+    index.Maintain();
 
     // Process each cluster
-    for (const auto& cluster : clusters) {
+    std::vector<MemoryEvent> cluster;
+    for (auto id : index.ClusterIDs()) {
+        const auto& members = index.Cluster(id)->memory_ids;
+        if (members.size() < 2) continue;
+
+        // Position order, as the members were recorded
+        std::vector<size_t> positions;
+        positions.reserve(members.size());
+        for (const auto& key : members) {
+            positions.push_back(std::stoul(key));
+        }
+        std::sort(positions.begin(), positions.end());
+
+        cluster.clear();
+        for (size_t position : positions) {
+            cluster.push_back(memories[position]);
+        }
         ProcessMemoryCluster(cluster);
     }
 }
@@ -1309,6 +1794,7 @@ void PersonaSystem::UpdateMemoryWeightsWithEmotion() {
 
         // Update memory importance
         memory.Importance = std::min(1.0, memory.Importance + emotionalBoost);
+        promotionPending_ = promotionPending_ || memory.Importance > PROMOTION_IMPORTANCE;
     }
 }
 
@@ -2,18 +2,55 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <mutex>
 #include "persona.hpp"
+#include "decay.hpp"
 #include "memory.hpp"
+#include "memory_snapshot.hpp"
+#include "personality_history.hpp"
+#include "interaction_pipeline.hpp"
+#include "trait_correlation.hpp"
 #include "../database/database.hpp"
 
 namespace shandris::cognitive {
 
+// One entry of a history backfill: an interaction and the memories it left
+struct HistoricalInteraction {
+    std::shared_ptr<Interaction> interaction;  // may be null, for memories alone
+    std::vector<MemoryEvent> memories;
+};
+
+struct IngestOptions {
+    // Entries between analysis checkpoints; 0 runs the passes once, at the end
+    size_t checkpoint_interval = 0;
+    // Database writes per persistence job, each job one transaction
+    size_t write_batch_size = 512;
+};
+
+struct IngestStats {
+    size_t interactions = 0;
+    size_t memories = 0;
+    size_t checkpoints = 0;
+    size_t write_batches = 0;
+};
+
+// Threading contract: the public calls lock the persona state, so any
+// thread may call them, and background passes take the same lock. Sync(),
+// SwitchPersona and LoadPersonalityState wait for the pipeline and must not
+// be called from a pipeline job. GetActivePersona hands out shared state;
+// read it only while no other thread is calling in. Every instance shares
+// the process's database connection, so database calls from all of them,
+// persistence jobs and whole write batches alike, are serialized by one
+// process-wide lock; a persistence job must not wait on another system.
 class PersonaSystem {
 public:
     PersonaSystem();
+    // Analysis passes run on a shared pool instead of a thread of their own
+    explicit PersonaSystem(std::shared_ptr<WorkStealingExecutor> analysisExecutor);
     ~PersonaSystem();
 
     void InitializeDefaultPersonas();
@@ -27,6 +64,28 @@ public:
         const std::shared_ptr<Interaction>& interaction,
         const std::shared_ptr<PersonaContext>& context);
 
+    // Foreground path: updates in-memory state and returns the reply style.
+    // Persistence, clustering, pattern recognition and reflection run on
+    // background stages; Sync() waits for everything queued so far.
+    InteractionResponse RespondToInteraction(const std::shared_ptr<Interaction>& interaction);
+    void AddMemory(const MemoryEvent& memory);
+    void Sync();
+    // Periodic housekeeping for the host's timer: queues a flush of memory
+    // writes that have waited past their delay and a slice of memory
+    // maintenance. Coalesces while either is still queued, so calling it
+    // more often than it runs is harmless.
+    void Tick();
+
+    // Backfill: applies a time-ordered history to the active persona in
+    // order, as RespondToInteraction and AddMemory would, and returns once it
+    // is applied and its writes are queued. Memory, clustering, pattern and
+    // reflection passes run only at checkpoints, as if every call in between
+    // had coalesced into them, and the writes go out in transactions of
+    // write_batch_size. Syncs first and holds the persona state throughout.
+    IngestStats IngestHistory(const std::vector<HistoricalInteraction>& history,
+                              const IngestOptions& options = {});
+    PipelineStats GetPipelineStats(PipelineStage stage) const;
+
     void UpdateTrait(const std::string& traitName, double influence, const std::string& evidence);
     void UpdateTraitEvidence(const std::string& traitName, const std::string& evidence);
     void EvolvePersonality(const std::shared_ptr<Interaction>& interaction);
@@ -39,14 +98,65 @@ public:
     InteractionResponse CalculateResponseStyle(const std::shared_ptr<Interaction>& interaction) const;
     PersonaStyleRule GetResponseStyle(const std::shared_ptr<PersonaContext>& context) const;
 
+    // Saves are queued; loads Sync() first so they read back queued saves
+    void SavePersonalityState();
+    // Prefers the attached snapshot's profile unless it was saved since
+    void LoadPersonalityState();
+
+    // Profiles in an attached snapshot take precedence over the database, so
+    // write snapshots at checkpoints, after the profiles have been saved
+    void AttachSnapshot(std::shared_ptr<const MappedSnapshot> snapshot);
+    void AppendToSnapshot(SnapshotWriter& writer) const;
+
+    // Whether long-term memories of the same type and content merge, a slice
+    // per ProcessMemories cycle and on arrival. Off by default: merging sums
+    // their trait influences, which changes how memories move the traits.
+    void SetAutoConsolidation(bool enabled);
+
+    // Recall goes through the manager's ranked text index once attached
+    void SetMemoryManager(std::shared_ptr<MemoryManager> memoryManager);
+    std::vector<MemoryEvent> RecallRelevantMemories(const std::string& context) const;
+
+    // Up to k relevant memories of the active persona, best first, pointing
+    // into its memory context; valid until that context next changes
+    void RecallRelevantMemories(const std::string& context, size_t k,
+                                std::chrono::system_clock::time_point now,
+                                std::vector<const MemoryEvent*>& results) const;
+
 private:
     void CheckTraitConsistency();
     void PropagateTraitInfluence(const std::string& traitName, double influence);
+    // Rebuilds the declared links when the persona or its stored links changed
+    void SyncTraitCorrelations();
     void UpdateAttachmentLevel(const std::chrono::system_clock::time_point& now);
     void CalculateEmotionalInfluence(const std::shared_ptr<Interaction>& interaction);
     void ApplyTimeBasedEffects();
+    // Rebuilds the expiry queue when the persona or its effects changed
+    void SyncEffectDeadlines();
+    // Whether the sweep bookkeeping covers the active short-term memories
+    bool MemorySweepTracked() const;
+    void TrackShortTermMemory(const MemoryEvent& memory);
+    void RescheduleMemorySweep();
+    void MoveToLongTerm(const MemoryEvent& memory);
+    // Merges up to CONSOLIDATION_SLICE long-term memories into the ones
+    // before them; true while unmerged ones are left
+    bool ConsolidateMemories();
+    bool ConsolidationTracked() const;
+    // Position of the merged memory with this key, or npos; a position that
+    // holds some other memory now marks the index stale
+    size_t ConsolidatedPosition(const std::string& key);
     void AdjustResponseBiases(const std::shared_ptr<Interaction>& interaction);
     void UpdateEmotionalState(const std::shared_ptr<Interaction>& interaction);
+    void ScheduleMemoryProcessing();
+    void ScheduleReflection();
+    // The locked part of AddMemory
+    void AppendMemory(const MemoryEvent& memory);
+    // Queues a database write, or collects it while a backfill batches them
+    void Persist(InteractionPipeline::Job write);
+    void SubmitBatchedWrites(std::vector<InteractionPipeline::Job>& writes, size_t batchSize, IngestStats& stats);
+
+    static nlohmann::json SerializePersonalityState(const Persona& persona);
+    static void ApplyPersonalityState(Persona& persona, const nlohmann::json& state);
 
     std::unordered_map<std::string, std::shared_ptr<Persona>> personas_;
     std::shared_ptr<Persona> activePersona_;
@@ -56,6 +166,49 @@ private:
     std::unique_ptr<TransitionManager> transitions_;
     std::unique_ptr<TraitManager> traits_;
     database::Database& db_;
+
+    std::shared_ptr<const MappedSnapshot> snapshot_;
+    std::unordered_set<std::string> staleProfiles_;
+    std::shared_ptr<MemoryManager> memoryManager_;
+    // Delta snapshots per persona ID
+    std::unordered_map<std::string, PersonalityHistory> histories_;
+
+    // Declared links of the active persona, resolved once instead of
+    // string-matched on every propagation
+    TraitCorrelationMatrix traitCorrelations_;
+    std::string traitCorrelationsPersona_;
+    size_t traitCorrelationsSynced_ = 0;  // stored links the matrix reflects
+
+    // Expiry of each time-based effect, so a tick visits only due ones
+    DeadlineQueue<std::string> effectDeadlines_;
+    std::string effectDeadlinesPersona_;
+
+    // When ProcessMemories next has short-term work: the earliest memory
+    // age-out, or a memory over the promotion threshold
+    std::chrono::system_clock::time_point shortTermDeadline_ = std::chrono::system_clock::time_point::max();
+    bool promotionPending_ = false;
+    std::string memorySweepPersona_;
+    size_t memorySweepTracked_ = 0;  // short-term memories the above reflect
+
+    // The first consolidated_ long-term memories are merged by type and
+    // content, and the index maps each of their keys to its position.
+    // Persona memories carry no ID, and within the merged prefix the key is
+    // unique, so it names the memory: entries are checked against the
+    // memory they point at rather than trusted while the count matches.
+    bool autoConsolidation_ = false;
+    std::unordered_map<std::string, size_t> consolidationIndex_;
+    std::string consolidationPersona_;
+    size_t consolidated_ = 0;
+    size_t consolidationTracked_ = 0;  // long-term memories the above reflect
+
+    // Guards persona state between callers and the analysis stage; recursive
+    // because public mutators such as UpdateTrait also run inside passes
+    mutable std::recursive_mutex stateMutex_;
+    std::shared_ptr<WorkStealingExecutor> executor_;
+    // Set while IngestHistory runs; guarded by stateMutex_
+    std::vector<InteractionPipeline::Job>* batchedWrites_ = nullptr;
+    // Last, so it drains before anything its jobs touch is destroyed
+    std::unique_ptr<InteractionPipeline> pipeline_;
 };
 
 } // namespace shandris::cognitive
@@ -0,0 +1,197 @@
+#include "personality_history.hpp"
+#include "decay.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace shandris {
+namespace cognitive {
+
+PersonalityHistory::PersonalityHistory(size_t capacity, double decayPerDay)
+    : ring_(std::max<size_t>(capacity, 1)), decayPerDay_(decayPerDay) {
+}
+
+PersonalityHistory::MemoryID PersonalityHistory::MemoryReference(std::string_view type, std::string_view content,
+                                                                 TimePoint timestamp) {
+    // Type and content are length-prefixed, so no text can run into the next field
+    std::string key = std::to_string(type.size()) + ':';
+    key.append(type);
+    key += std::to_string(content.size()) + ':';
+    key.append(content);
+    key += std::to_string(timestamp.time_since_epoch().count());
+
+    auto [it, inserted] = memoryIDs_.try_emplace(std::move(key), 0);
+    if (inserted) {
+        if (freeMemoryIDs_.empty()) {
+            it->second = static_cast<MemoryID>(memoryKeys_.size());
+            memoryKeys_.emplace_back();
+        } else {
+            it->second = freeMemoryIDs_.back();
+            freeMemoryIDs_.pop_back();
+        }
+        memoryKeys_[it->second] = {it->first, 0};
+        unrecordedMemoryIDs_.push_back(it->second);
+    }
+    return it->second;
+}
+
+void PersonalityHistory::ReleaseMemory(MemoryID id) {
+    MemoryKeyEntry& entry = memoryKeys_[id];
+    memoryIDs_.erase(entry.key);
+    entry = MemoryKeyEntry{};
+    freeMemoryIDs_.push_back(id);
+}
+
+double PersonalityHistory::WeightAt(TimePoint timestamp) const {
+    return std::exp(decayPerDay_ * std::chrono::duration<double, DecayDays>(timestamp - origin_).count());
+}
+
+bool PersonalityHistory::Changed(SymbolID trait, double value) const {
+    auto it = runs_.find(trait);
+    return it == runs_.end() || it->second.current != value;
+}
+
+const PersonalityHistory::Snapshot& PersonalityHistory::At(size_t index) const {
+    return ring_[(head_ + index) % ring_.size()].snapshot;
+}
+
+void PersonalityHistory::Record(Snapshot snapshot) {
+    // Held before the eviction, which may drop the same memories
+    for (MemoryID id : snapshot.memories) {
+        ++memoryKeys_[id].refs;
+    }
+    if (size_ == ring_.size()) {
+        EvictOldest();
+    }
+    for (MemoryID id : unrecordedMemoryIDs_) {
+        const MemoryKeyEntry& entry = memoryKeys_[id];
+        if (entry.refs == 0 && !entry.key.empty()) ReleaseMemory(id);
+    }
+    unrecordedMemoryIDs_.clear();
+
+    const TimePoint timestamp = snapshot.timestamp;
+    auto anchor = [&] {
+        if (!hasOrigin_) {
+            origin_ = timestamp;
+            hasOrigin_ = true;
+        }
+    };
+    anchor();
+    if (decayPerDay_ * std::chrono::duration<double, DecayDays>(timestamp - origin_).count() > MAX_WEIGHT_EXPONENT) {
+        Resync();
+        anchor();
+    }
+
+    Entry& entry = ring_[(head_ + size_) % ring_.size()];
+    entry.snapshot = std::move(snapshot);
+    entry.weight = WeightAt(timestamp);
+    Append(entry, runs_, total_);
+    ++size_;
+}
+
+void PersonalityHistory::Append(Entry& entry, std::unordered_map<SymbolID, Run>& runs, double& total) {
+    entry.before = total;
+    auto& changes = entry.snapshot.changes;
+    size_t kept = 0;
+    for (const auto& [trait, value] : changes) {
+        auto [it, inserted] = runs.try_emplace(trait);
+        Run& run = it->second;
+        if (inserted) {
+            run = {value, total, value, total, 0.0};
+        } else if (run.current == value) {
+            continue;
+        } else {
+            run.closed += run.current * (total - run.currentStart);
+            run.current = value;
+            run.currentStart = total;
+        }
+        changes[kept++] = {trait, value};
+    }
+    changes.resize(kept);
+    total += entry.weight;
+}
+
+void PersonalityHistory::EvictOldest() {
+    Entry& entry = ring_[head_];
+    const double start = entry.before;
+
+    // Every snapshot before this one is gone, and with it the run each of
+    // these changes ended
+    for (const auto& [trait, value] : entry.snapshot.changes) {
+        Run& run = runs_[trait];
+        run.closed -= run.first * (start - run.firstStart);
+        run.first = value;
+        run.firstStart = start;
+    }
+    for (MemoryID id : entry.snapshot.memories) {
+        if (--memoryKeys_[id].refs == 0) ReleaseMemory(id);
+    }
+
+    entry = Entry{};
+    head_ = (head_ + 1) % ring_.size();
+    --size_;
+    evicted_ = size_ ? ring_[head_].before : total_;
+
+    if (++evictionsSinceResync_ >= ring_.size()) {
+        Resync();
+    }
+}
+
+void PersonalityHistory::Resync() {
+    // Values carried in from before the oldest retained snapshot start the
+    // rebuilt runs; the retained changes are then replayed over fresh weights
+    std::unordered_map<SymbolID, Run> runs;
+    runs.reserve(runs_.size());
+    for (const auto& [trait, run] : runs_) {
+        if (run.firstStart < evicted_ || size_ == 0) {
+            runs[trait] = {run.first, 0.0, run.first, 0.0, 0.0};
+        }
+    }
+
+    hasOrigin_ = size_ > 0;
+    if (hasOrigin_) {
+        origin_ = ring_[head_].snapshot.timestamp;
+    }
+    double total = 0.0;
+    for (size_t i = 0; i < size_; ++i) {
+        Entry& entry = ring_[(head_ + i) % ring_.size()];
+        entry.weight = WeightAt(entry.snapshot.timestamp);
+        Append(entry, runs, total);
+    }
+
+    runs_ = std::move(runs);
+    total_ = total;
+    evicted_ = 0.0;
+    evictionsSinceResync_ = 0;
+}
+
+void PersonalityHistory::Clear() {
+    std::fill(ring_.begin(), ring_.end(), Entry{});
+    head_ = 0;
+    size_ = 0;
+    runs_.clear();
+    total_ = 0.0;
+    evicted_ = 0.0;
+    hasOrigin_ = false;
+    evictionsSinceResync_ = 0;
+    memoryKeys_.clear();
+    memoryIDs_.clear();
+    freeMemoryIDs_.clear();
+    unrecordedMemoryIDs_.clear();
+}
+
+bool PersonalityHistory::WeightedAverage(SymbolID trait, double& average) const {
+    auto it = runs_.find(trait);
+    if (it == runs_.end()) return false;
+
+    const Run& run = it->second;
+    const double weight = total_ - std::max(evicted_, run.firstStart);
+    if (!(weight > 0.0)) return false;
+
+    // The oldest run is clipped to the retained snapshots
+    const double clipped = run.first * std::max(0.0, evicted_ - run.firstStart);
+    average = (run.closed + run.current * (total_ - run.currentStart) - clipped) / weight;
+    return true;
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+// Fixed-capacity ring of personality snapshots stored as deltas: each
+// snapshot keeps only the traits whose value changed since the one before
+// it, and references short-term memories instead of copying them. The
+// time-weighted average of every trait over the retained snapshots is kept
+// up to date, so recording is O(changed traits) and reading an average is
+// O(1).
+//
+// Memory references are IDs local to the history. Each names a key the
+// history owns, and the key is freed once no retained snapshot refers to
+// it, so the table stays as large as the snapshots it serves.
+//
+// A snapshot taken at t weighs exp(-decay * (now - t)) in days. The now
+// factor is common to every weight and cancels in the average, so weights
+// are stored relative to an origin instead and never need refreshing.
+// Values are carried between changes as runs over a prefix sum of the
+// weights; evicting a snapshot only touches the traits it changed.
+class PersonalityHistory {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+    using MemoryID = uint32_t;
+
+    static constexpr size_t DEFAULT_CAPACITY = 100;
+    static constexpr double DEFAULT_DECAY_PER_DAY = 0.1;
+
+    struct Snapshot {
+        TimePoint timestamp;
+        std::vector<std::pair<SymbolID, double>> changes;  // traits that differ from the previous snapshot
+        std::vector<MemoryID> memories;                     // MemoryReference of each short-term memory
+        double mood = 0.0;
+        double arousal = 0.0;
+    };
+
+    explicit PersonalityHistory(size_t capacity = DEFAULT_CAPACITY, double decayPerDay = DEFAULT_DECAY_PER_DAY);
+
+    // Whether value differs from the trait's latest recorded one, i.e.
+    // whether the next snapshot needs to carry it
+    bool Changed(SymbolID trait, double value) const;
+    // Unchanged entries in changes are dropped; the oldest snapshot is
+    // evicted once the ring is full
+    void Record(Snapshot snapshot);
+    void Clear();
+
+    size_t Size() const { return size_; }
+    size_t Capacity() const { return ring_.size(); }
+    // Oldest first; index < Size()
+    const Snapshot& At(size_t index) const;
+
+    // Time-weighted average of the trait across the retained snapshots,
+    // counting each snapshot from the trait's first recorded one; false if
+    // none of them has it. A trait keeps its last value until it changes.
+    bool WeightedAverage(SymbolID trait, double& average) const;
+
+    // Persona memories carry no ID, so a reference keys the memory by its
+    // type, content and timestamp. Memories that share a text stay apart,
+    // and the same memory gets the same reference while one is retained.
+    // A reference not recorded by the next Record is released there.
+    MemoryID MemoryReference(std::string_view type, std::string_view content, TimePoint timestamp);
+    // The key of a reference held by a retained snapshot
+    const std::string& MemoryKey(MemoryID id) const { return memoryKeys_[id].key; }
+    size_t MemoryKeyCount() const { return memoryIDs_.size(); }
+
+private:
+    // Restarts the weights from the oldest retained snapshot once they grow
+    // this far, or after Capacity() evictions, to bound rounding drift
+    static constexpr double MAX_WEIGHT_EXPONENT = 64.0;
+
+    struct Entry {
+        Snapshot snapshot;
+        double before = 0.0;    // weight prefix up to this snapshot
+        double weight = 0.0;
+    };
+
+    // A trait's value runs: the open one, and the oldest with any retained
+    // snapshot. Starts are weight prefixes.
+    struct Run {
+        double current = 0.0;
+        double currentStart = 0.0;
+        double first = 0.0;
+        double firstStart = 0.0;
+        double closed = 0.0;    // value x weight of the closed runs, unclipped
+    };
+
+    struct MemoryKeyEntry {
+        std::string key;    // empty once freed
+        size_t refs = 0;    // retained snapshots referring to it
+    };
+
+    double WeightAt(TimePoint timestamp) const;
+    void ReleaseMemory(MemoryID id);
+    void Append(Entry& entry, std::unordered_map<SymbolID, Run>& runs, double& total);
+    void EvictOldest();
+    void Resync();
+
+    std::vector<Entry> ring_;
+    size_t head_ = 0;    // oldest entry
+    size_t size_ = 0;
+    double decayPerDay_;
+
+    std::unordered_map<SymbolID, Run> runs_;
+    double total_ = 0.0;      // weight prefix through the newest snapshot
+    double evicted_ = 0.0;    // weight prefix through the newest evicted one
+    TimePoint origin_{};
+    bool hasOrigin_ = false;
+    size_t evictionsSinceResync_ = 0;
+
+    std::vector<MemoryKeyEntry> memoryKeys_;    // by MemoryID
+    std::unordered_map<std::string, MemoryID> memoryIDs_;
+    std::vector<MemoryID> freeMemoryIDs_;
+    std::vector<MemoryID> unrecordedMemoryIDs_;  // handed out since the last Record
+};
+
+} // namespace cognitive
+} // namespace shandris
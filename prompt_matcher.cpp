@@ -0,0 +1,225 @@
+#include "prompt_matcher.hpp"
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <stdexcept>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+uint8_t FoldCase(unsigned char c) {
+    return static_cast<uint8_t>(std::tolower(c));
+}
+
+// Pattern IDs carry their kind in the top byte and a payload below
+enum class PromptPattern : uint32_t {
+    NameMarker = 1,
+    Mood,
+    MoodClear
+};
+
+constexpr uint32_t PATTERN_KIND_SHIFT = 24;
+
+uint32_t PatternID(PromptPattern kind, uint32_t payload = 0) {
+    return (static_cast<uint32_t>(kind) << PATTERN_KIND_SHIFT) | payload;
+}
+
+PromptPattern PatternKind(uint32_t id) {
+    return static_cast<PromptPattern>(id >> PATTERN_KIND_SHIFT);
+}
+
+uint32_t PatternPayload(uint32_t id) {
+    return id & ((1u << PATTERN_KIND_SHIFT) - 1);
+}
+
+const PhraseMatcher& PromptAutomaton() {
+    static const PhraseMatcher matcher = [] {
+        static const char* MOOD_PHRASINGS[] = {"i'm feeling ", "i feel ", "i am "};
+        static const char* CLEAR_PHRASES[] = {
+            "forget my mood",
+            "reset my mood",
+            "ignore how i feel",
+            "never mind my feelings",
+            "i'm over it",
+            "it doesn't matter how i feel",
+            "change the subject",
+            "move on from that",
+            "stop talking about my mood"
+        };
+
+        PhraseMatcher built;
+        built.AddPattern("my name is", PatternID(PromptPattern::NameMarker));
+        const auto& moods = PromptMoods();
+        for (uint32_t m = 0; m < moods.size(); ++m) {
+            for (const char* phrasing : MOOD_PHRASINGS) {
+                built.AddPattern(std::string(phrasing) + moods[m], PatternID(PromptPattern::Mood, m));
+            }
+        }
+        for (const char* phrase : CLEAR_PHRASES) {
+            built.AddPattern(phrase, PatternID(PromptPattern::MoodClear));
+        }
+        built.Build();
+        return built;
+    }();
+    return matcher;
+}
+
+} // namespace
+
+void PhraseMatcher::AddPattern(std::string_view pattern, uint32_t id) {
+    if (pattern.empty()) {
+        throw std::invalid_argument("PhraseMatcher::AddPattern: empty pattern");
+    }
+    std::string folded(pattern.size(), '\0');
+    std::transform(pattern.begin(), pattern.end(), folded.begin(),
+                   [](char c) { return static_cast<char>(FoldCase(static_cast<unsigned char>(c))); });
+    patterns_.emplace_back(std::move(folded), id);
+}
+
+void PhraseMatcher::Build() {
+    // Byte classes: one per distinct pattern byte, upper and lower case shared
+    byte_class_.fill(0);
+    class_count_ = 1;
+    for (const auto& [pattern, id] : patterns_) {
+        for (unsigned char c : pattern) {
+            if (byte_class_[c] == 0) {
+                if (class_count_ == 256) throw std::length_error("PhraseMatcher: too many byte classes");
+                byte_class_[c] = static_cast<uint8_t>(class_count_++);
+            }
+        }
+    }
+    for (int c = 0; c < 256; ++c) {
+        byte_class_[c] = byte_class_[FoldCase(static_cast<unsigned char>(c))];
+    }
+
+    // Trie; 0 marks a missing edge and is never a child since it is the root
+    std::vector<StateID> trie(class_count_, 0);
+    std::vector<std::vector<Output>> stateOutputs(1);
+    for (const auto& [pattern, id] : patterns_) {
+        StateID state = 0;
+        for (unsigned char c : pattern) {
+            StateID& next = trie[state * class_count_ + byte_class_[c]];
+            if (next == 0) {
+                next = static_cast<StateID>(stateOutputs.size());
+                stateOutputs.emplace_back();
+                trie.resize(trie.size() + class_count_, 0);
+            }
+            state = trie[state * class_count_ + byte_class_[c]];
+        }
+        stateOutputs[state].push_back({id, static_cast<uint32_t>(pattern.size())});
+    }
+    state_count_ = stateOutputs.size();
+
+    // Breadth-first failure links, resolved into full DFA transitions
+    transitions_ = trie;
+    std::vector<StateID> fail(state_count_, 0);
+    std::deque<StateID> queue;
+    for (size_t c = 1; c < class_count_; ++c) {
+        if (StateID child = trie[c]) queue.push_back(child);
+    }
+    while (!queue.empty()) {
+        StateID state = queue.front();
+        queue.pop_front();
+
+        const auto& inherited = stateOutputs[fail[state]];
+        stateOutputs[state].insert(stateOutputs[state].end(), inherited.begin(), inherited.end());
+
+        for (size_t c = 1; c < class_count_; ++c) {
+            StateID child = trie[state * class_count_ + c];
+            StateID fallback = transitions_[fail[state] * class_count_ + c];
+            if (child) {
+                fail[child] = fallback;
+                queue.push_back(child);
+            } else {
+                transitions_[state * class_count_ + c] = fallback;
+            }
+        }
+    }
+
+    output_offsets_.assign(1, 0);
+    outputs_.clear();
+    for (const auto& list : stateOutputs) {
+        outputs_.insert(outputs_.end(), list.begin(), list.end());
+        output_offsets_.push_back(static_cast<uint32_t>(outputs_.size()));
+    }
+}
+
+void PhraseMatcher::Scan(std::string_view text, std::vector<PhraseMatch>& matches) const {
+    matches.clear();
+    if (state_count_ == 0) return;
+
+    StateID state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        // Class 0 bytes appear in no pattern, so every state goes back to the root
+        state = transitions_[state * class_count_ + byte_class_[static_cast<unsigned char>(text[i])]];
+        for (uint32_t o = output_offsets_[state]; o < output_offsets_[state + 1]; ++o) {
+            matches.push_back({outputs_[o].pattern, i + 1 - outputs_[o].length, i + 1});
+        }
+    }
+}
+
+const std::vector<std::string>& PromptMoods() {
+    static const std::vector<std::string> moods = {
+        "happy", "sad", "angry", "tired", "excited",
+        "grumpy", "anxious", "stressed", "curious", "bored"
+    };
+    return moods;
+}
+
+PromptAnalysis AnalyzePrompt(std::string_view prompt) {
+    thread_local std::vector<PhraseMatch> matches;
+    PromptAutomaton().Scan(prompt, matches);
+
+    PromptAnalysis analysis;
+    size_t nameMarkerBegin = std::string::npos;
+    for (const auto& match : matches) {
+        switch (PatternKind(match.pattern)) {
+            case PromptPattern::NameMarker:
+                // Matches arrive by end position; keep the earliest start
+                if (match.begin < nameMarkerBegin) {
+                    nameMarkerBegin = match.begin;
+                    analysis.name_start = match.end;
+                }
+                break;
+            case PromptPattern::Mood: {
+                int mood = static_cast<int>(PatternPayload(match.pattern));
+                if (analysis.mood < 0 || mood < analysis.mood) {
+                    analysis.mood = mood;
+                }
+                break;
+            }
+            case PromptPattern::MoodClear:
+                analysis.mood_clear = true;
+                break;
+        }
+    }
+    return analysis;
+}
+
+std::string ExtractName(const std::string& prompt, const PromptAnalysis& analysis) {
+    if (analysis.name_start == std::string::npos) {
+        return "";
+    }
+
+    // Skip leading whitespace, then take the first word
+    size_t begin = analysis.name_start;
+    while (begin < prompt.size() && std::isspace(static_cast<unsigned char>(prompt[begin]))) {
+        ++begin;
+    }
+    size_t end = prompt.find(' ', begin);
+    std::string namePart = prompt.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+    if (!namePart.empty()) {
+        namePart[0] = std::toupper(namePart[0]);
+    }
+    return namePart;
+}
+
+std::string ExtractMood(const PromptAnalysis& analysis) {
+    return analysis.mood >= 0 ? PromptMoods()[analysis.mood] : "";
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace shandris {
+namespace cognitive {
+
+struct PhraseMatch {
+    uint32_t pattern;  // ID passed to AddPattern
+    size_t begin;      // byte offset of the first matched character
+    size_t end;        // one past the last
+};
+
+// Case-insensitive Aho-Corasick automaton. Patterns are compiled into a
+// dense DFA over byte classes, so a scan is one table lookup per input
+// byte whatever the number of patterns. Case folding is part of the class
+// map, so callers never lowercase a copy of their input.
+class PhraseMatcher {
+public:
+    void AddPattern(std::string_view pattern, uint32_t id);
+    void Build();
+
+    // Every match, in order of end position, in a single pass
+    void Scan(std::string_view text, std::vector<PhraseMatch>& matches) const;
+
+    size_t StateCount() const { return state_count_; }
+
+private:
+    using StateID = uint32_t;
+
+    struct Output {
+        uint32_t pattern;
+        uint32_t length;
+    };
+
+    std::vector<std::pair<std::string, uint32_t>> patterns_;
+    std::array<uint8_t, 256> byte_class_{};  // 0 is "no pattern uses this byte"
+    size_t class_count_ = 1;
+    size_t state_count_ = 0;
+    std::vector<StateID> transitions_;      // state * class_count_ + class
+    std::vector<uint32_t> output_offsets_;  // outputs_[offsets[s], offsets[s + 1])
+    std::vector<Output> outputs_;
+};
+
+// Everything the prompt handlers need, gathered in one scan
+struct PromptAnalysis {
+    size_t name_start = std::string::npos;  // just past the first "my name is"
+    int mood = -1;                          // index into PromptMoods(), highest priority match
+    bool mood_clear = false;
+};
+
+PromptAnalysis AnalyzePrompt(std::string_view prompt);
+
+// Moods in priority order
+const std::vector<std::string>& PromptMoods();
+
+std::string ExtractName(const std::string& prompt, const PromptAnalysis& analysis);
+std::string ExtractMood(const PromptAnalysis& analysis);
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace shandris {
+
+// Importance decayed by whole hours of age, as memory recall has always ranked
+inline double RecallScore(double importance, std::chrono::system_clock::time_point timestamp,
+                          std::chrono::system_clock::time_point now) {
+    auto hours = std::chrono::duration_cast<std::chrono::hours>(now - timestamp).count();
+    return importance / (1.0 + static_cast<double>(hours));
+}
+
+// Bounded top-k selection over borrowed events. Each candidate is scored
+// once against a single "now", so rankings are stable and the cost is
+// O(n log k) with no copies of the events themselves.
+template<typename Event>
+class TopKRecall {
+public:
+    TopKRecall(size_t k, std::chrono::system_clock::time_point now) : k_(k), now_(now) {
+        heap_.reserve(std::min<size_t>(k, 256));
+    }
+
+    void Offer(const Event& event, double importance, std::chrono::system_clock::time_point timestamp) {
+        if (k_ == 0) return;
+        Candidate candidate{RecallScore(importance, timestamp, now_), offered_++, &event};
+        if (heap_.size() < k_) {
+            heap_.push_back(candidate);
+            std::push_heap(heap_.begin(), heap_.end(), Better);
+        } else if (Better(candidate, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), Better);
+            heap_.back() = candidate;
+            std::push_heap(heap_.begin(), heap_.end(), Better);
+        }
+    }
+
+    // Best first; equal scores keep the order they were offered in
+    void Finish(std::vector<const Event*>& results) {
+        std::sort_heap(heap_.begin(), heap_.end(), Better);
+        results.clear();
+        results.reserve(heap_.size());
+        for (const auto& candidate : heap_) {
+            results.push_back(candidate.event);
+        }
+        heap_.clear();
+    }
+
+private:
+    struct Candidate {
+        double score;
+        size_t order;
+        const Event* event;
+    };
+
+    // Heap ordered so the worst kept candidate sits at the front
+    static bool Better(const Candidate& a, const Candidate& b) {
+        return a.score > b.score || (a.score == b.score && a.order < b.order);
+    }
+
+    size_t k_;
+    std::chrono::system_clock::time_point now_;
+    size_t offered_ = 0;
+    std::vector<Candidate> heap_;
+};
+
+// Emotional weight of recalled events summed by event type, so per-trait
+// trigger checks read a table instead of re-running recall
+using TriggerWeights = std::unordered_map<std::string, double>;
+
+// 1 + 0.2 x the weight of every matching event, capped at 2
+inline double TriggerFactor(const std::vector<std::string>& triggers, const TriggerWeights& weights) {
+    double factor = 1.0;
+    for (size_t i = 0; i < triggers.size(); ++i) {
+        // A trigger listed twice still counts each event once
+        if (std::find(triggers.begin(), triggers.begin() + i, triggers[i]) != triggers.begin() + i) continue;
+        auto it = weights.find(triggers[i]);
+        if (it != weights.end()) {
+            factor += 0.2 * it->second;
+        }
+    }
+    return std::min(2.0, factor);
+}
+
+} // namespace shandris
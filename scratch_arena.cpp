@@ -0,0 +1,83 @@
+#include "scratch_arena.hpp"
+#include <algorithm>
+#include <new>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+struct ThreadScratch {
+    ScratchArena arena;
+    size_t depth = 0;
+};
+
+ThreadScratch& CurrentThreadScratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+} // namespace
+
+void* ScratchArena::Overflow::do_allocate(size_t bytes, size_t alignment) {
+    this->bytes += bytes;
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void ScratchArena::Overflow::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    ::operator delete(p, bytes, std::align_val_t(alignment));
+}
+
+ScratchArena::ScratchArena(size_t initialBytes) {
+    Rebuild(std::max<size_t>(initialBytes, 1));
+}
+
+void ScratchArena::Rebuild(size_t capacity) {
+    // The arena returns its overflow blocks before the block it bumps through goes
+    arena_.reset();
+    block_ = std::make_unique<std::byte[]>(capacity);
+    capacity_ = capacity;
+    arena_.emplace(block_.get(), capacity_, &overflow_);
+}
+
+void ScratchArena::Reset() {
+    ++stats_.resets;
+    const size_t overflowed = overflow_.bytes;
+    overflow_.bytes = 0;
+    if (overflowed > 0 && capacity_ < MAX_RETAINED_BYTES) {
+        ++stats_.grows;
+        Rebuild(std::min(capacity_ + overflowed, MAX_RETAINED_BYTES));
+        return;
+    }
+    arena_->release();
+}
+
+ScratchStats ScratchArena::Stats() const {
+    ScratchStats stats = stats_;
+    stats.capacity = capacity_;
+    stats.overflow = overflow_.bytes;
+    return stats;
+}
+
+ScratchScope::ScratchScope() {
+    ++CurrentThreadScratch().depth;
+}
+
+ScratchScope::~ScratchScope() {
+    ThreadScratch& scratch = CurrentThreadScratch();
+    if (--scratch.depth == 0) {
+        scratch.arena.Reset();
+    }
+}
+
+std::pmr::memory_resource* ScratchResource() {
+    ThreadScratch& scratch = CurrentThreadScratch();
+    return scratch.depth > 0 ? scratch.arena.Resource() : std::pmr::get_default_resource();
+}
+
+ScratchStats ThreadScratchStats() {
+    return CurrentThreadScratch().arena.Stats();
+}
+
+} // namespace cognitive
+} // namespace shandris
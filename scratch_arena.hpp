@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace shandris {
+namespace cognitive {
+
+struct ScratchStats {
+    uint64_t resets = 0;
+    uint64_t grows = 0;       // resets that enlarged the block after an overflow
+    size_t capacity = 0;      // bytes in the retained block
+    size_t overflow = 0;      // bytes taken from the heap since the last reset
+};
+
+// Monotonic arena for one interaction or maintenance pass. Allocation is a
+// pointer bump, deallocation is free, and Reset drops everything at once.
+// The retained block grows to the busiest cycle seen, so in steady state a
+// cycle makes no heap calls at all.
+class ScratchArena {
+public:
+    static constexpr size_t DEFAULT_INITIAL_BYTES = 64 * 1024;
+    static constexpr size_t MAX_RETAINED_BYTES = 4 * 1024 * 1024;
+
+    explicit ScratchArena(size_t initialBytes = DEFAULT_INITIAL_BYTES);
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    std::pmr::memory_resource* Resource() { return &*arena_; }
+    void Reset();
+    ScratchStats Stats() const;
+
+private:
+    // Heap fallback that records how far a cycle overflowed the block
+    class Overflow : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    void Rebuild(size_t capacity);
+
+    std::unique_ptr<std::byte[]> block_;
+    size_t capacity_ = 0;
+    Overflow overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+    ScratchStats stats_;
+};
+
+// Binds this thread's arena for the enclosing interaction or pass; the
+// outermost scope resets it on exit. Nothing allocated from
+// ScratchResource() may outlive the scope that was open at the time.
+class ScratchScope {
+public:
+    ScratchScope();
+    ~ScratchScope();
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+// This thread's arena inside a ScratchScope, the default resource outside
+std::pmr::memory_resource* ScratchResource();
+ScratchStats ThreadScratchStats();
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,389 @@
+#include "session_store.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+// Session IDs and names are arbitrary strings; file names are their hex
+std::string HexName(std::string_view value) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(value.size() * 2);
+    for (unsigned char c : value) {
+        hex += DIGITS[c >> 4];
+        hex += DIGITS[c & 0xF];
+    }
+    return hex;
+}
+
+bool ReadFile(const std::filesystem::path& path, std::string& contents) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// Written beside the target and renamed over it
+bool ReplaceFile(const std::filesystem::path& path, const std::string& contents) {
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!out) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+// Global()'s spill, until the host sets its own; null if the directory
+// cannot be created, which leaves every session resident
+std::shared_ptr<SessionSpill> DefaultSpill() {
+    try {
+        return std::make_shared<DirectorySpill>(std::filesystem::temp_directory_path() / "shandris-sessions");
+    } catch (const std::exception& e) {
+        std::cerr << "Session spill disabled: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+} // namespace
+
+DirectorySpill::DirectorySpill(std::filesystem::path directory) : directory_(std::move(directory)) {
+    std::filesystem::create_directories(directory_ / "sessions");
+    std::filesystem::create_directories(directory_ / "users");
+}
+
+std::filesystem::path DirectorySpill::SessionPath(const std::string& sessionID) const {
+    return directory_ / "sessions" / HexName(sessionID);
+}
+
+std::filesystem::path DirectorySpill::UserPath(const std::string& userName) const {
+    return directory_ / "users" / HexName(userName);
+}
+
+bool DirectorySpill::Save(const std::string& sessionID, const std::string& userName, const std::string& bytes) {
+    std::filesystem::path session = SessionPath(sessionID);
+    if (!ReplaceFile(session, bytes)) return false;
+
+    // The session's name sits beside it, so a rename can retire the old link
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::filesystem::path nameFile = session;
+    nameFile += ".user";
+    std::string previous;
+    if (ReadFile(nameFile, previous) && previous != userName) {
+        std::string owner;
+        if (!previous.empty() && ReadFile(UserPath(previous), owner) && owner == sessionID) {
+            std::filesystem::remove(UserPath(previous));
+        }
+    }
+    if (!ReplaceFile(nameFile, userName)) return false;
+    return userName.empty() || ReplaceFile(UserPath(userName), sessionID);
+}
+
+bool DirectorySpill::Load(const std::string& sessionID, std::string& bytes) {
+    return ReadFile(SessionPath(sessionID), bytes);
+}
+
+void DirectorySpill::Erase(const std::string& sessionID) {
+    std::filesystem::path session = SessionPath(sessionID);
+    std::filesystem::path nameFile = session;
+    nameFile += ".user";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string userName;
+    std::string owner;
+    if (ReadFile(nameFile, userName) && !userName.empty()
+        && ReadFile(UserPath(userName), owner) && owner == sessionID) {
+        std::filesystem::remove(UserPath(userName));
+    }
+    std::filesystem::remove(nameFile);
+    std::filesystem::remove(session);
+}
+
+std::string DirectorySpill::FindUser(const std::string& userName) {
+    std::string sessionID;
+    return ReadFile(UserPath(userName), sessionID) ? sessionID : std::string();
+}
+
+DatabaseSpill::DatabaseSpill(std::shared_ptr<database::Database> db) : db_(std::move(db)) {
+}
+
+bool DatabaseSpill::Save(const std::string& sessionID, const std::string& userName, const std::string& bytes) {
+    try {
+        const char* sql = R"(
+            INSERT INTO session_contexts (session_id, user_name, state, updated_at)
+            VALUES (?, ?, ?, ?)
+            ON CONFLICT(session_id) DO UPDATE SET
+                user_name = excluded.user_name,
+                state = excluded.state,
+                updated_at = excluded.updated_at
+        )";
+        return db_->ExecuteSQL(sql, {
+            sessionID,
+            userName,
+            bytes,
+            std::to_string(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()))
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "Error spilling session: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool DatabaseSpill::Load(const std::string& sessionID, std::string& bytes) {
+    try {
+        auto result = db_->ExecuteQuery("SELECT state FROM session_contexts WHERE session_id = ?", {sessionID});
+        if (result.empty()) return false;
+        bytes = result[0]["state"];
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading spilled session: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void DatabaseSpill::Erase(const std::string& sessionID) {
+    try {
+        db_->ExecuteSQL("DELETE FROM session_contexts WHERE session_id = ?", {sessionID});
+    } catch (const std::exception& e) {
+        std::cerr << "Error erasing spilled session: " << e.what() << std::endl;
+    }
+}
+
+std::string DatabaseSpill::FindUser(const std::string& userName) {
+    try {
+        auto result = db_->ExecuteQuery(
+            "SELECT session_id FROM session_contexts WHERE user_name = ? LIMIT 1", {userName});
+        return result.empty() ? std::string() : std::string(result[0]["session_id"]);
+    } catch (const std::exception& e) {
+        std::cerr << "Error finding user: " << e.what() << std::endl;
+        return {};
+    }
+}
+
+SessionStore::SessionStore() : SessionStore(Config{}) {
+}
+
+SessionStore::SessionStore(Config config, std::shared_ptr<SessionSpill> spill)
+    : config_(config), spill_(std::move(spill)) {
+    shards_.resize(std::max<size_t>(config_.shards, 1));
+    for (auto& shard : shards_) {
+        shard = std::make_unique<Shard>();
+    }
+}
+
+SessionStore& SessionStore::Global() {
+    static SessionStore store(Config{}, DefaultSpill());
+    return store;
+}
+
+void SessionStore::SetSpill(std::shared_ptr<SessionSpill> spill) {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    spill_ = std::move(spill);
+}
+
+std::shared_ptr<SessionSpill> SessionStore::Spill() const {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    return spill_;
+}
+
+std::string SessionStore::NormalizeName(std::string_view userName) {
+    std::string name(userName);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+        return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    });
+    return name;
+}
+
+SessionStore::Shard& SessionStore::ShardFor(const std::string& sessionID) const {
+    return *shards_[std::hash<std::string>{}(sessionID) % shards_.size()];
+}
+
+std::shared_ptr<SessionStore::Entry> SessionStore::Acquire(const std::string& sessionID, bool create) {
+    Shard& shard = ShardFor(sessionID);
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.sessions.find(sessionID);
+    if (it == shard.sessions.end()) {
+        auto spill = Spill();
+        std::string bytes;
+        const bool spilled = spill && spill->Load(sessionID, bytes);
+        if (!spilled && !create) return nullptr;
+
+        auto entry = std::make_shared<Entry>();
+        if (spilled) {
+            entry->state = nlohmann::json::parse(bytes).get<SessionState>();
+            rehydrated_.fetch_add(1, std::memory_order_relaxed);
+            Reindex(sessionID, {}, entry->state.user_name);
+        }
+        it = shard.sessions.emplace(sessionID, std::move(entry)).first;
+    }
+
+    std::shared_ptr<Entry> entry = it->second;
+    entry->last_used = now;
+    // Held above, so the sweep cannot take this one
+    if (now - shard.last_sweep >= config_.idle_ttl / 4) {
+        Sweep(shard, now);
+    }
+    return entry;
+}
+
+bool SessionStore::Update(const std::string& sessionID, const std::function<void(SessionState&)>& fn,
+                          bool create) {
+    std::shared_ptr<Entry> entry = Acquire(sessionID, create);
+    if (!entry) return false;
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    const std::string before = entry->state.user_name;
+    entry->dirty = true;
+    try {
+        fn(entry->state);
+    } catch (...) {
+        Reindex(sessionID, before, entry->state.user_name);
+        throw;
+    }
+    Reindex(sessionID, before, entry->state.user_name);
+    return true;
+}
+
+bool SessionStore::Read(const std::string& sessionID, const std::function<void(const SessionState&)>& fn) {
+    std::shared_ptr<Entry> entry = Acquire(sessionID, false);
+    if (!entry) return false;
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    fn(entry->state);
+    return true;
+}
+
+void SessionStore::Erase(const std::string& sessionID) {
+    Shard& shard = ShardFor(sessionID);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.sessions.find(sessionID); it != shard.sessions.end()) {
+            std::string userName;
+            {
+                std::lock_guard<std::mutex> entryLock(it->second->mutex);
+                userName = it->second->state.user_name;
+            }
+            Reindex(sessionID, userName, {});
+            shard.sessions.erase(it);
+        }
+    }
+    if (auto spill = Spill()) {
+        spill->Erase(sessionID);
+    }
+}
+
+void SessionStore::Reindex(const std::string& sessionID, const std::string& before, const std::string& after) {
+    if (before == after) return;
+    std::unique_lock<std::shared_mutex> lock(users_mutex_);
+    if (!before.empty()) {
+        auto it = users_.find(NormalizeName(before));
+        if (it != users_.end() && it->second == sessionID) {
+            users_.erase(it);
+        }
+    }
+    if (!after.empty()) {
+        users_[NormalizeName(after)] = sessionID;
+    }
+}
+
+std::string SessionStore::FindUser(std::string_view userName) const {
+    const std::string name = NormalizeName(userName);
+    if (name.empty()) return {};
+    {
+        std::shared_lock<std::shared_mutex> lock(users_mutex_);
+        if (auto it = users_.find(name); it != users_.end()) {
+            return it->second;
+        }
+    }
+
+    auto spill = Spill();
+    if (!spill) return {};
+    std::string sessionID = spill->FindUser(name);
+    if (sessionID.empty()) return {};
+
+    // The spilled copy is stale if the session came back and was renamed
+    Shard& shard = ShardFor(sessionID);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto it = shard.sessions.find(sessionID); it != shard.sessions.end()) {
+        std::lock_guard<std::mutex> entryLock(it->second->mutex);
+        if (NormalizeName(it->second->state.user_name) != name) return {};
+    }
+    return sessionID;
+}
+
+size_t SessionStore::Sweep(Shard& shard, std::chrono::steady_clock::time_point now) {
+    shard.last_sweep = now;
+    auto spill = Spill();
+    if (!spill) return 0;
+
+    size_t evicted = 0;
+    for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+        Entry& entry = *it->second;
+        // In use by a caller, or still warm
+        if (it->second.use_count() > 1 || now - entry.last_used < config_.idle_ttl) {
+            ++it;
+            continue;
+        }
+
+        std::string userName;
+        {
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            userName = entry.state.user_name;
+            if (entry.dirty) {
+                bool saved = false;
+                try {
+                    saved = spill->Save(it->first, NormalizeName(userName), nlohmann::json(entry.state).dump());
+                } catch (const std::exception& e) {
+                    std::cerr << "Error spilling session " << it->first << ": " << e.what() << std::endl;
+                }
+                if (!saved) {
+                    // Kept resident; the next sweep tries again
+                    spill_failures_.fetch_add(1, std::memory_order_relaxed);
+                    ++it;
+                    continue;
+                }
+                spilled_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        Reindex(it->first, userName, {});
+        it = shard.sessions.erase(it);
+        ++evicted;
+    }
+    return evicted;
+}
+
+size_t SessionStore::EvictIdle(std::chrono::steady_clock::time_point now) {
+    size_t evicted = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        evicted += Sweep(*shard, now);
+    }
+    return evicted;
+}
+
+SessionStore::Stats SessionStore::GetStats() const {
+    Stats stats;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.resident += shard->sessions.size();
+    }
+    stats.spilled = spilled_.load(std::memory_order_relaxed);
+    stats.rehydrated = rehydrated_.load(std::memory_order_relaxed);
+    stats.spill_failures = spill_failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "memory.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+// Everything kept per session ID
+struct SessionState {
+    MemoryContext context;
+    std::map<std::string, std::string> traits;
+    std::vector<std::string> mood_history;
+    std::string user_name;    // indexed for FindUser
+    bool has_profile = false;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(SessionState,
+        context, traits, mood_history, user_name, has_profile)
+};
+
+// Where idle sessions go and come back from. userName is the session's
+// current name, kept alongside so names resolve while it is spilled. All
+// calls may come from any thread.
+class SessionSpill {
+public:
+    virtual ~SessionSpill() = default;
+
+    virtual bool Save(const std::string& sessionID, const std::string& userName, const std::string& bytes) = 0;
+    // False if the session was never spilled
+    virtual bool Load(const std::string& sessionID, std::string& bytes) = 0;
+    virtual void Erase(const std::string& sessionID) = 0;
+    // Session ID whose spilled copy has this (normalized) name, or empty
+    virtual std::string FindUser(const std::string& userName) = 0;
+};
+
+// One file per session under directory, plus one per name pointing at its
+// session; files are replaced by rename, so a crash leaves the old copy
+class DirectorySpill : public SessionSpill {
+public:
+    explicit DirectorySpill(std::filesystem::path directory);
+
+    bool Save(const std::string& sessionID, const std::string& userName, const std::string& bytes) override;
+    bool Load(const std::string& sessionID, std::string& bytes) override;
+    void Erase(const std::string& sessionID) override;
+    std::string FindUser(const std::string& userName) override;
+
+private:
+    std::filesystem::path SessionPath(const std::string& sessionID) const;
+    std::filesystem::path UserPath(const std::string& userName) const;
+
+    std::filesystem::path directory_;
+    std::mutex mutex_;    // serializes the name files of concurrent saves
+};
+
+// Rows of session_contexts (session_id primary key, user_name indexed,
+// state, updated_at)
+class DatabaseSpill : public SessionSpill {
+public:
+    explicit DatabaseSpill(std::shared_ptr<database::Database> db);
+
+    bool Save(const std::string& sessionID, const std::string& userName, const std::string& bytes) override;
+    bool Load(const std::string& sessionID, std::string& bytes) override;
+    void Erase(const std::string& sessionID) override;
+    std::string FindUser(const std::string& userName) override;
+
+private:
+    std::shared_ptr<database::Database> db_;
+};
+
+// Concurrent store of per-session state, sharded by session ID hash so
+// unrelated sessions never contend on one lock. Sessions idle for longer
+// than the TTL are written to the spill and dropped, and come back on the
+// next access, so memory tracks the active sessions rather than every
+// session seen. Without a spill nothing is evicted.
+//
+// A shard's lock is held while one of its sessions loads or spills; each
+// session has its own lock for the callbacks. Callbacks must not call back
+// into the store.
+class SessionStore {
+public:
+    static constexpr size_t DEFAULT_SHARDS = 64;
+    static constexpr std::chrono::steady_clock::duration DEFAULT_IDLE_TTL = std::chrono::minutes(30);
+
+    struct Config {
+        size_t shards = DEFAULT_SHARDS;
+        std::chrono::steady_clock::duration idle_ttl = DEFAULT_IDLE_TTL;
+    };
+
+    struct Stats {
+        size_t resident = 0;
+        uint64_t spilled = 0;
+        uint64_t rehydrated = 0;
+        uint64_t spill_failures = 0;
+    };
+
+    SessionStore();
+    explicit SessionStore(Config config, std::shared_ptr<SessionSpill> spill = nullptr);
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // Backs the sessionID-keyed functions below. Spills to a DirectorySpill
+    // under the system temporary directory unless SetSpill replaces it,
+    // e.g. with a DatabaseSpill
+    static SessionStore& Global();
+
+    void SetSpill(std::shared_ptr<SessionSpill> spill);
+
+    // fn under the session's lock, bringing the session back from the spill
+    // first, or creating it unless create is false; false if fn did not run.
+    // Throws if a spilled copy cannot be read.
+    bool Update(const std::string& sessionID, const std::function<void(SessionState&)>& fn,
+                bool create = true);
+    // fn if the session exists, resident or spilled; false otherwise
+    bool Read(const std::string& sessionID, const std::function<void(const SessionState&)>& fn);
+    // Drops the session and its spilled copy
+    void Erase(const std::string& sessionID);
+
+    // Session of a user by name, ASCII case-insensitive; empty if none
+    std::string FindUser(std::string_view userName) const;
+
+    // Spills sessions idle since before now - idle_ttl; returns how many.
+    // Also runs per shard as it is accessed, at most every quarter TTL.
+    size_t EvictIdle(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        SessionState state;
+        bool dirty = false;    // changed since the spilled copy
+        std::chrono::steady_clock::time_point last_used;    // guarded by the shard
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Entry>> sessions;
+        std::chrono::steady_clock::time_point last_sweep;
+    };
+
+    static std::string NormalizeName(std::string_view userName);
+
+    Shard& ShardFor(const std::string& sessionID) const;
+    std::shared_ptr<SessionSpill> Spill() const;
+    // The session pinned against eviction while the pointer is held; null
+    // if it does not exist and create is false
+    std::shared_ptr<Entry> Acquire(const std::string& sessionID, bool create);
+    size_t Sweep(Shard& shard, std::chrono::steady_clock::time_point now);
+    void Reindex(const std::string& sessionID, const std::string& before, const std::string& after);
+
+    const Config config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    mutable std::mutex spill_mutex_;
+    std::shared_ptr<SessionSpill> spill_;
+
+    // Normalized name to session, for resident sessions; spilled ones are
+    // found through the spill
+    mutable std::shared_mutex users_mutex_;
+    std::unordered_map<std::string, std::string> users_;
+
+    std::atomic<uint64_t> spilled_{0};
+    std::atomic<uint64_t> rehydrated_{0};
+    std::atomic<uint64_t> spill_failures_{0};
+};
+
+// Session state through SessionStore::Global(), defined in memory.cpp
+std::map<std::string, std::string> RecallTraits(const std::string& sessionID);
+// Merges traits into the session's, creating the session
+void StoreTraits(const std::string& sessionID, const std::map<std::string, std::string>& traits);
+std::string FindUserByName(const std::string& name);
+bool HasExistingProfile(const std::string& sessionID);
+// Names the session's user and marks the profile as existing
+void SaveUserProfile(const std::string& sessionID, const std::string& userName);
+std::vector<std::string> GetMoodHistory(const std::string& sessionID);
+void SaveMoodHistory(const std::string& sessionID, const std::vector<std::string>& moods);
+
+} // namespace cognitive
+} // namespace shandris
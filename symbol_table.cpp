@@ -0,0 +1,58 @@
+#include "symbol_table.hpp"
+#include <mutex>
+
+namespace shandris {
+namespace cognitive {
+
+SymbolTable& SymbolTable::Global() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolID SymbolTable::Intern(SymbolKind kind, const std::string& name) {
+    auto& table = tables_[static_cast<size_t>(kind)];
+
+    // Lookups vastly outnumber new symbols, so try the shared path first
+    {
+        std::shared_lock lock(mutex_);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    auto [it, inserted] = table.ids.emplace(name, static_cast<SymbolID>(table.names.size()));
+    if (inserted) {
+        table.names.push_back(name);
+    }
+    return it->second;
+}
+
+bool SymbolTable::Find(SymbolKind kind, const std::string& name, SymbolID& id) const {
+    const auto& table = tables_[static_cast<size_t>(kind)];
+    std::shared_lock lock(mutex_);
+    auto it = table.ids.find(name);
+    if (it == table.ids.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+const std::string& SymbolTable::Name(SymbolKind kind, SymbolID id) const {
+    const auto& table = tables_[static_cast<size_t>(kind)];
+    std::shared_lock lock(mutex_);
+    if (id >= table.names.size()) {
+        throw std::out_of_range("Unknown symbol ID: " + std::to_string(id));
+    }
+    return table.names[id];
+}
+
+size_t SymbolTable::Size(SymbolKind kind) const {
+    std::shared_lock lock(mutex_);
+    return tables_[static_cast<size_t>(kind)].names.size();
+}
+
+} // namespace cognitive
+} // namespace shandris
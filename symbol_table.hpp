@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <unordered_map>
+#include <shared_mutex>
+#include <algorithm>
+#include <utility>
+#include <initializer_list>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace shandris {
+namespace cognitive {
+
+using SymbolID = uint32_t;
+
+enum class SymbolKind : uint8_t {
+    Trait,
+    Tag,
+    Trigger,
+    Emotion,
+    Count
+};
+
+// Process-wide table handing out dense IDs per kind. Names are only
+// resolved at the JSON/DB boundary; everything else compares IDs.
+class SymbolTable {
+public:
+    static SymbolTable& Global();
+
+    SymbolID Intern(SymbolKind kind, const std::string& name);
+    bool Find(SymbolKind kind, const std::string& name, SymbolID& id) const;
+    const std::string& Name(SymbolKind kind, SymbolID id) const;
+    size_t Size(SymbolKind kind) const;
+
+    // Sorted, deduplicated IDs for a range of names or the keys of a map
+    template<typename Range>
+    std::vector<SymbolID> InternAll(SymbolKind kind, const Range& names) {
+        std::vector<SymbolID> ids;
+        ids.reserve(names.size());
+        for (const auto& name : names) {
+            ids.push_back(Intern(kind, name));
+        }
+        Normalize(ids);
+        return ids;
+    }
+
+    template<typename Map>
+    std::vector<SymbolID> InternKeys(SymbolKind kind, const Map& values) {
+        std::vector<SymbolID> ids;
+        ids.reserve(values.size());
+        for (const auto& [name, _] : values) {
+            ids.push_back(Intern(kind, name));
+        }
+        Normalize(ids);
+        return ids;
+    }
+
+private:
+    struct Table {
+        std::unordered_map<std::string, SymbolID> ids;
+        std::deque<std::string> names; // stable references for Name()
+    };
+
+    static void Normalize(std::vector<SymbolID>& ids) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::array<Table, static_cast<size_t>(SymbolKind::Count)> tables_;
+};
+
+inline SymbolID InternTrait(const std::string& name) {
+    return SymbolTable::Global().Intern(SymbolKind::Trait, name);
+}
+
+inline const std::string& TraitName(SymbolID id) {
+    return SymbolTable::Global().Name(SymbolKind::Trait, id);
+}
+
+// Sorted flat set of symbol IDs with the std::set calls the memory code uses
+template<SymbolKind Kind>
+class SymbolSet {
+public:
+    using value_type = SymbolID;
+    using const_iterator = std::vector<SymbolID>::const_iterator;
+    using iterator = const_iterator;
+
+    SymbolSet() = default;
+    SymbolSet(std::initializer_list<SymbolID> ids) : ids_(ids) {
+        std::sort(ids_.begin(), ids_.end());
+        ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+    }
+
+    bool insert(SymbolID id) {
+        auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+        if (it != ids_.end() && *it == id) return false;
+        ids_.insert(it, id);
+        return true;
+    }
+    bool insert(const std::string& name) {
+        return insert(SymbolTable::Global().Intern(Kind, name));
+    }
+
+    size_t erase(SymbolID id) {
+        auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+        if (it == ids_.end() || *it != id) return 0;
+        ids_.erase(it);
+        return 1;
+    }
+
+    const_iterator find(SymbolID id) const {
+        auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+        return (it != ids_.end() && *it == id) ? it : ids_.end();
+    }
+    size_t count(SymbolID id) const { return find(id) != ids_.end() ? 1 : 0; }
+
+    const_iterator begin() const { return ids_.begin(); }
+    const_iterator end() const { return ids_.end(); }
+    size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+    void clear() { ids_.clear(); }
+    void reserve(size_t n) { ids_.reserve(n); }
+
+    const std::vector<SymbolID>& ids() const { return ids_; }
+
+    bool operator==(const SymbolSet& other) const { return ids_ == other.ids_; }
+    bool operator!=(const SymbolSet& other) const { return ids_ != other.ids_; }
+
+private:
+    std::vector<SymbolID> ids_;
+};
+
+// Sorted flat map keyed by symbol ID, contiguous in memory. Like a vector,
+// inserting a key invalidates references to every entry; take the entries
+// one call needs through try_emplace first, or hold them by key
+template<SymbolKind Kind, typename T>
+class SymbolMap {
+public:
+    using key_type = SymbolID;
+    using mapped_type = T;
+    using value_type = std::pair<SymbolID, T>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    SymbolMap() = default;
+
+    T& operator[](SymbolID id) {
+        return try_emplace(id).first->second;
+    }
+    T& operator[](const std::string& name) {
+        return (*this)[SymbolTable::Global().Intern(Kind, name)];
+    }
+
+    std::pair<iterator, bool> try_emplace(SymbolID id) {
+        auto it = LowerBound(id);
+        if (it != entries_.end() && it->first == id) return {it, false};
+        return {entries_.emplace(it, id, T{}), true};
+    }
+
+    iterator find(SymbolID id) {
+        auto it = LowerBound(id);
+        return (it != entries_.end() && it->first == id) ? it : entries_.end();
+    }
+    const_iterator find(SymbolID id) const {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), id, KeyLess{});
+        return (it != entries_.end() && it->first == id) ? it : entries_.end();
+    }
+    size_t count(SymbolID id) const { return find(id) != entries_.end() ? 1 : 0; }
+
+    T& at(SymbolID id) {
+        auto it = find(id);
+        if (it == entries_.end()) throw std::out_of_range("SymbolMap::at");
+        return it->second;
+    }
+    const T& at(SymbolID id) const {
+        auto it = find(id);
+        if (it == entries_.end()) throw std::out_of_range("SymbolMap::at");
+        return it->second;
+    }
+
+    size_t erase(SymbolID id) {
+        auto it = find(id);
+        if (it == entries_.end()) return 0;
+        entries_.erase(it);
+        return 1;
+    }
+    // Drops every entry pred accepts in one pass; the rest keep their order
+    template<typename Pred>
+    size_t erase_if(Pred pred) {
+        auto kept = std::remove_if(entries_.begin(), entries_.end(),
+                                   [&pred](const value_type& entry) { return pred(entry); });
+        const size_t erased = static_cast<size_t>(entries_.end() - kept);
+        entries_.erase(kept, entries_.end());
+        return erased;
+    }
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    void clear() { entries_.clear(); }
+    void reserve(size_t n) { entries_.reserve(n); }
+
+    bool operator==(const SymbolMap& other) const { return entries_ == other.entries_; }
+    bool operator!=(const SymbolMap& other) const { return entries_ != other.entries_; }
+
+private:
+    struct KeyLess {
+        bool operator()(const value_type& entry, SymbolID id) const { return entry.first < id; }
+    };
+
+    iterator LowerBound(SymbolID id) {
+        return std::lower_bound(entries_.begin(), entries_.end(), id, KeyLess{});
+    }
+
+    std::vector<value_type> entries_;
+};
+
+using TagSet = SymbolSet<SymbolKind::Tag>;
+using TriggerSet = SymbolSet<SymbolKind::Trigger>;
+using TraitInfluenceMap = SymbolMap<SymbolKind::Trait, double>;
+
+template<typename T>
+using TraitTable = SymbolMap<SymbolKind::Trait, T>;
+
+// JSON keeps the string form so stored rows and payloads are unchanged.
+// Sets go out sorted by name: ID order depends on interning order, which
+// differs between processes
+template<SymbolKind Kind>
+void to_json(nlohmann::json& j, const SymbolSet<Kind>& set) {
+    const auto& table = SymbolTable::Global();
+    std::vector<const std::string*> names;
+    names.reserve(set.size());
+    for (SymbolID id : set) {
+        names.push_back(&table.Name(Kind, id));
+    }
+    std::sort(names.begin(), names.end(),
+              [](const std::string* a, const std::string* b) { return *a < *b; });
+    j = nlohmann::json::array();
+    for (const std::string* name : names) {
+        j.push_back(*name);
+    }
+}
+
+template<SymbolKind Kind>
+void from_json(const nlohmann::json& j, SymbolSet<Kind>& set) {
+    set.clear();
+    set.reserve(j.size());
+    for (const auto& name : j) {
+        set.insert(name.template get<std::string>());
+    }
+}
+
+template<SymbolKind Kind, typename T>
+void to_json(nlohmann::json& j, const SymbolMap<Kind, T>& map) {
+    j = nlohmann::json::object();
+    const auto& table = SymbolTable::Global();
+    for (const auto& [id, value] : map) {
+        j[table.Name(Kind, id)] = value;
+    }
+}
+
+template<SymbolKind Kind, typename T>
+void from_json(const nlohmann::json& j, SymbolMap<Kind, T>& map) {
+    map.clear();
+    map.reserve(j.size());
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        map[it.key()] = it.value().template get<T>();
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
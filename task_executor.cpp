@@ -0,0 +1,182 @@
+#include "task_executor.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace shandris::cognitive {
+
+namespace {
+
+// Index of the worker running on this thread, for the executor that owns it
+thread_local const WorkStealingExecutor* currentExecutor = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread(&WorkStealingExecutor::Run, this, i);
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void WorkStealingExecutor::Post(Task task) {
+    size_t target = currentExecutor == this
+        ? currentWorker
+        : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    // Counted first so WaitIdle cannot see an empty pool with a task in flight
+    queued_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks.push_back(std::move(task));
+    }
+
+    // Taking the lock orders this with a worker about to sleep
+    { std::lock_guard<std::mutex> lock(wakeMutex_); }
+    wake_.notify_one();
+}
+
+bool WorkStealingExecutor::InWorker() const {
+    return currentExecutor == this;
+}
+
+bool WorkStealingExecutor::TryTake(size_t self, Task& task) {
+    {
+        Worker& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(self + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingExecutor::Run(size_t self) {
+    currentExecutor = this;
+    currentWorker = self;
+
+    Task task;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait(lock, [&] { return stopping_ || queued_.load() > 0; });
+            if (stopping_ && queued_.load() == 0) return;
+            ++running_;
+        }
+
+        bool took = false;
+        {
+            // However the task exits, or WaitIdle would wait on it forever
+            struct Finish {
+                WorkStealingExecutor& executor;
+                ~Finish() {
+                    std::lock_guard<std::mutex> lock(executor.wakeMutex_);
+                    --executor.running_;
+                    if (executor.running_ == 0 && executor.queued_.load() == 0) executor.idle_.notify_all();
+                }
+            } finish{*this};
+
+            took = TryTake(self, task);
+            if (took) {
+                queued_.fetch_sub(1);
+                try {
+                    task();
+                } catch (const std::exception& e) {
+                    std::cerr << "Error in executor task: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Error in executor task: unknown exception" << std::endl;
+                }
+                task = nullptr;
+                executed_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        // Another worker got there first; let it run rather than spin
+        if (!took) std::this_thread::yield();
+    }
+}
+
+void WorkStealingExecutor::WaitIdle() {
+    if (currentExecutor == this) {
+        throw std::logic_error("WorkStealingExecutor::WaitIdle called from a worker");
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    idle_.wait(lock, [&] { return running_ == 0 && queued_.load() == 0; });
+}
+
+ExecutorStats WorkStealingExecutor::Stats() const {
+    ExecutorStats stats;
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::shared_ptr<Strand> Strand::Create(WorkStealingExecutor& executor) {
+    return std::shared_ptr<Strand>(new Strand(executor));
+}
+
+void Strand::Post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        if (scheduled_) return;
+        scheduled_ = true;
+    }
+    executor_.Post([self = shared_from_this()] { self->RunTurn(); });
+}
+
+void Strand::RunTurn() {
+    for (size_t i = 0; i < MAX_TASKS_PER_TURN; ++i) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) {
+                scheduled_ = false;
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Error in strand task: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Error in strand task: unknown exception" << std::endl;
+        }
+    }
+
+    // Still scheduled; requeue behind whatever else is waiting
+    executor_.Post([self = shared_from_this()] { self->RunTurn(); });
+}
+
+} // namespace shandris::cognitive
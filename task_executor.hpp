@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace shandris::cognitive {
+
+struct ExecutorStats {
+    uint64_t executed = 0;
+    uint64_t stolen = 0;  // run by a worker other than the one it was queued on
+};
+
+// Fixed pool of workers, each with its own task deque. A worker takes its
+// newest task first, which keeps follow-up work hot in its cache, and when
+// it runs dry it steals the oldest task of another worker. Tasks posted from
+// outside the pool are spread round-robin.
+class WorkStealingExecutor {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses the hardware concurrency
+    explicit WorkStealingExecutor(size_t threads = 0);
+    // Runs everything still queued, then joins the workers
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    void Post(Task task);
+
+    // Returns once no task is queued or running
+    void WaitIdle();
+
+    size_t ThreadCount() const { return workers_.size(); }
+    // Whether the calling thread is one of this executor's workers
+    bool InWorker() const;
+    ExecutorStats Stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    bool TryTake(size_t self, Task& task);
+    void Run(size_t self);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> nextWorker_{0};
+    std::atomic<size_t> queued_{0};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+    size_t running_ = 0;  // guarded by wakeMutex_
+    bool stopping_ = false;
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+};
+
+// Serializes tasks over an executor: tasks posted to one strand run one at
+// a time, in order, on whichever worker is free, so state owned by the
+// strand needs no lock of its own. The executor must outlive the strand.
+class Strand : public std::enable_shared_from_this<Strand> {
+public:
+    using Task = WorkStealingExecutor::Task;
+
+    static constexpr size_t MAX_TASKS_PER_TURN = 16;
+
+    static std::shared_ptr<Strand> Create(WorkStealingExecutor& executor);
+
+    void Post(Task task);
+
+private:
+    explicit Strand(WorkStealingExecutor& executor) : executor_(executor) {}
+
+    // Runs a bounded turn, then yields the worker back to other strands
+    void RunTurn();
+
+    WorkStealingExecutor& executor_;
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+    bool scheduled_ = false;
+};
+
+} // namespace shandris::cognitive
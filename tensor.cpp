@@ -0,0 +1,54 @@
+#include "tensor.hpp"
+
+namespace shandris {
+
+Tensor2 Tensor2::FromNested(const std::vector<std::vector<double>>& nested) {
+    size_t cols = nested.empty() ? 0 : nested[0].size();
+    Tensor2 tensor(nested.size(), cols);
+    for (size_t i = 0; i < nested.size(); ++i) {
+        if (nested[i].size() != cols) {
+            throw std::invalid_argument("Tensor2::FromNested: ragged rows");
+        }
+        std::copy(nested[i].begin(), nested[i].end(), tensor.Row(i));
+    }
+    return tensor;
+}
+
+std::vector<std::vector<double>> Tensor2::ToNested() const {
+    std::vector<std::vector<double>> nested(rows());
+    for (size_t i = 0; i < rows(); ++i) {
+        nested[i].assign(Row(i), Row(i) + cols());
+    }
+    return nested;
+}
+
+Tensor3 Tensor3::FromNested(const std::vector<std::vector<std::vector<double>>>& nested) {
+    size_t d1 = nested.empty() ? 0 : nested[0].size();
+    size_t d2 = (d1 == 0) ? 0 : nested[0][0].size();
+    Tensor3 tensor(nested.size(), d1, d2);
+    for (size_t i = 0; i < nested.size(); ++i) {
+        if (nested[i].size() != d1) {
+            throw std::invalid_argument("Tensor3::FromNested: ragged layers");
+        }
+        for (size_t j = 0; j < d1; ++j) {
+            if (nested[i][j].size() != d2) {
+                throw std::invalid_argument("Tensor3::FromNested: ragged rows");
+            }
+            std::copy(nested[i][j].begin(), nested[i][j].end(), tensor.Row(i, j));
+        }
+    }
+    return tensor;
+}
+
+std::vector<std::vector<std::vector<double>>> Tensor3::ToNested() const {
+    std::vector<std::vector<std::vector<double>>> nested(dim(0));
+    for (size_t i = 0; i < dim(0); ++i) {
+        nested[i].resize(dim(1));
+        for (size_t j = 0; j < dim(1); ++j) {
+            nested[i][j].assign(Row(i, j), Row(i, j) + dim(2));
+        }
+    }
+    return nested;
+}
+
+} // namespace shandris
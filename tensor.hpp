@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <new>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+namespace shandris {
+
+// Cache-line alignment so rows start on a vector-load boundary
+static constexpr size_t TENSOR_ALIGNMENT = 64;
+
+template<typename T, size_t Alignment = TENSOR_ALIGNMENT>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+using TensorStorage = std::vector<double, AlignedAllocator<double>>;
+
+// Strided 1-D view, e.g. a column of a matrix or a fiber along axis 0
+template<typename T>
+class StridedView {
+public:
+    StridedView(T* data, size_t size, size_t stride) : data_(data), size_(size), stride_(stride) {}
+
+    T& operator[](size_t i) const { return data_[i * stride_]; }
+    size_t size() const { return size_; }
+    size_t stride() const { return stride_; }
+
+private:
+    T* data_;
+    size_t size_;
+    size_t stride_;
+};
+
+// Strided 2-D view over tensor storage, e.g. one layer of a Tensor3
+template<typename T>
+class MatrixView {
+public:
+    MatrixView(T* data, size_t rows, size_t cols, size_t rowStride, size_t colStride = 1)
+        : data_(data), rows_(rows), cols_(cols), row_stride_(rowStride), col_stride_(colStride) {}
+
+    T& operator()(size_t i, size_t j) const { return data_[i * row_stride_ + j * col_stride_]; }
+    StridedView<T> Row(size_t i) const { return {data_ + i * row_stride_, cols_, col_stride_}; }
+    StridedView<T> Column(size_t j) const { return {data_ + j * col_stride_, rows_, row_stride_}; }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    bool contiguous() const { return col_stride_ == 1 && row_stride_ == cols_; }
+
+    // Apply f to every element in row-major order
+    template<typename F>
+    void ForEach(F&& f) const {
+        for (size_t i = 0; i < rows_; ++i) {
+            T* row = data_ + i * row_stride_;
+            for (size_t j = 0; j < cols_; ++j) {
+                f(row[j * col_stride_]);
+            }
+        }
+    }
+
+private:
+    T* data_;
+    size_t rows_;
+    size_t cols_;
+    size_t row_stride_;
+    size_t col_stride_;
+};
+
+// Dense, aligned, row-major matrix
+class Tensor2 {
+public:
+    using Shape = std::array<size_t, 2>;
+
+    Tensor2() = default;
+    Tensor2(size_t rows, size_t cols, double value = 0.0) : shape_{rows, cols}, data_(rows * cols, value) {}
+
+    // Reshape without releasing capacity; existing values are unspecified
+    void Resize(size_t rows, size_t cols) {
+        shape_ = {rows, cols};
+        data_.resize(rows * cols);
+    }
+    void Resize(const Shape& shape) { Resize(shape[0], shape[1]); }
+    void Fill(double value) { std::fill(data_.begin(), data_.end(), value); }
+
+    double& operator()(size_t i, size_t j) { return data_[i * shape_[1] + j]; }
+    double operator()(size_t i, size_t j) const { return data_[i * shape_[1] + j]; }
+
+    double* Row(size_t i) { return data_.data() + i * shape_[1]; }
+    const double* Row(size_t i) const { return data_.data() + i * shape_[1]; }
+    StridedView<const double> Column(size_t j) const { return {data_.data() + j, shape_[0], shape_[1]}; }
+
+    MatrixView<double> View() { return {data_.data(), shape_[0], shape_[1], shape_[1]}; }
+    MatrixView<const double> View() const { return {data_.data(), shape_[0], shape_[1], shape_[1]}; }
+
+    const Shape& shape() const { return shape_; }
+    size_t rows() const { return shape_[0]; }
+    size_t cols() const { return shape_[1]; }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+
+    double* data() { return data_.data(); }
+    const double* data() const { return data_.data(); }
+    double* begin() { return data_.data(); }
+    double* end() { return data_.data() + data_.size(); }
+    const double* begin() const { return data_.data(); }
+    const double* end() const { return data_.data() + data_.size(); }
+
+    static Tensor2 FromNested(const std::vector<std::vector<double>>& nested);
+    std::vector<std::vector<double>> ToNested() const;
+
+private:
+    Shape shape_{0, 0};
+    TensorStorage data_;
+};
+
+// Dense, aligned, row-major 3-D tensor; element (i, j, k) lives at
+// (i * dim1 + j) * dim2 + k
+class Tensor3 {
+public:
+    using Shape = std::array<size_t, 3>;
+
+    Tensor3() = default;
+    Tensor3(size_t d0, size_t d1, size_t d2, double value = 0.0)
+        : shape_{d0, d1, d2}, data_(d0 * d1 * d2, value) {}
+
+    // Reshape without releasing capacity; existing values are unspecified
+    void Resize(size_t d0, size_t d1, size_t d2) {
+        shape_ = {d0, d1, d2};
+        data_.resize(d0 * d1 * d2);
+    }
+    void Resize(const Shape& shape) { Resize(shape[0], shape[1], shape[2]); }
+    void Fill(double value) { std::fill(data_.begin(), data_.end(), value); }
+
+    // Copy values from other, reusing this tensor's buffer
+    void CopyFrom(const Tensor3& other) {
+        if (this == &other) return;
+        Resize(other.shape_);
+        std::copy(other.begin(), other.end(), begin());
+    }
+
+    double& operator()(size_t i, size_t j, size_t k) { return data_[Offset(i, j, k)]; }
+    double operator()(size_t i, size_t j, size_t k) const { return data_[Offset(i, j, k)]; }
+
+    // Contiguous innermost row (i, j, *)
+    double* Row(size_t i, size_t j) { return data_.data() + Offset(i, j, 0); }
+    const double* Row(size_t i, size_t j) const { return data_.data() + Offset(i, j, 0); }
+
+    // Layer i as a dim1 x dim2 matrix
+    MatrixView<double> Layer(size_t i) {
+        return {data_.data() + Offset(i, 0, 0), shape_[1], shape_[2], shape_[2]};
+    }
+    MatrixView<const double> Layer(size_t i) const {
+        return {data_.data() + Offset(i, 0, 0), shape_[1], shape_[2], shape_[2]};
+    }
+
+    // Plane at fixed k as a dim0 x dim1 matrix
+    MatrixView<const double> Plane(size_t k) const {
+        return {data_.data() + k, shape_[0], shape_[1], shape_[1] * shape_[2], shape_[2]};
+    }
+
+    // Values (*, j, k) along axis 0
+    StridedView<const double> Fiber(size_t j, size_t k) const {
+        return {data_.data() + Offset(0, j, k), shape_[0], shape_[1] * shape_[2]};
+    }
+
+    const Shape& shape() const { return shape_; }
+    size_t dim(size_t axis) const { return shape_[axis]; }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+
+    double* data() { return data_.data(); }
+    const double* data() const { return data_.data(); }
+    double* begin() { return data_.data(); }
+    double* end() { return data_.data() + data_.size(); }
+    const double* begin() const { return data_.data(); }
+    const double* end() const { return data_.data() + data_.size(); }
+
+    static Tensor3 FromNested(const std::vector<std::vector<std::vector<double>>>& nested);
+    std::vector<std::vector<std::vector<double>>> ToNested() const;
+
+private:
+    size_t Offset(size_t i, size_t j, size_t k) const { return (i * shape_[1] + j) * shape_[2] + k; }
+
+    Shape shape_{0, 0, 0};
+    TensorStorage data_;
+};
+
+// Elementwise kernels. Every output may alias any input of the same shape,
+// so each also serves as the in-place variant.
+
+// out = f(a)
+template<typename F>
+void TransformTensor(const Tensor3& a, Tensor3& out, F&& f) {
+    out.Resize(a.shape());
+    const double* in = a.data();
+    double* dst = out.data();
+    for (size_t n = 0; n < a.size(); ++n) {
+        dst[n] = f(in[n]);
+    }
+}
+
+// out = f(a, b)
+template<typename F>
+void TransformTensor(const Tensor3& a, const Tensor3& b, Tensor3& out, F&& f) {
+    if (a.shape() != b.shape()) {
+        throw std::invalid_argument("TransformTensor: shape mismatch");
+    }
+    out.Resize(a.shape());
+    const double* lhs = a.data();
+    const double* rhs = b.data();
+    double* dst = out.data();
+    for (size_t n = 0; n < a.size(); ++n) {
+        dst[n] = f(lhs[n], rhs[n]);
+    }
+}
+
+// out = (1 - t) * a + t * b
+inline void BlendTensors(const Tensor3& a, const Tensor3& b, double t, Tensor3& out) {
+    TransformTensor(a, b, out, [t](double x, double y) { return (1.0 - t) * x + t * y; });
+}
+
+} // namespace shandris
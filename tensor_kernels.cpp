@@ -0,0 +1,492 @@
+#include "tensor_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHANDRIS_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define SHANDRIS_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace shandris {
+
+namespace {
+
+// Scalar reference kernels
+
+double ScalarDot(const double* a, const double* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+double ScalarSumSquares(const double* a, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += a[i] * a[i];
+    return sum;
+}
+
+double ScalarSumAbs(const double* a, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += std::abs(a[i]);
+    return sum;
+}
+
+double ScalarSumAbsDiff(const double* a, const double* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+double ScalarMaxAbs(const double* a, size_t n) {
+    double result = 0.0;
+    for (size_t i = 0; i < n; ++i) result = std::max(result, std::abs(a[i]));
+    return result;
+}
+
+void ScalarScale(double* a, size_t n, double scale) {
+    for (size_t i = 0; i < n; ++i) a[i] *= scale;
+}
+
+void ScalarAddClamp(double* a, size_t n, double delta, double lo, double hi) {
+    for (size_t i = 0; i < n; ++i) a[i] = std::min(std::max(a[i] + delta, lo), hi);
+}
+
+inline double DiffuseOne(const double* prev, const double* next,
+                         const double* up, const double* down,
+                         const double* center, size_t k, double timeStep) {
+    double laplacian = prev[k] + next[k] + up[k] + down[k] +
+                       center[k - 1] + center[k + 1] - 6 * center[k];
+    return center[k] + timeStep * laplacian;
+}
+
+void ScalarDiffuseRow(const double* prev, const double* next,
+                      const double* up, const double* down,
+                      const double* center, double* dst,
+                      size_t cols, double timeStep) {
+    for (size_t k = 1; k + 1 < cols; ++k) {
+        dst[k] = DiffuseOne(prev, next, up, down, center, k, timeStep);
+    }
+}
+
+constexpr TensorKernels SCALAR_KERNELS{
+    KernelISA::Scalar,
+    ScalarDot, ScalarSumSquares, ScalarSumAbs, ScalarSumAbsDiff, ScalarMaxAbs,
+    ScalarScale, ScalarAddClamp, ScalarDiffuseRow
+};
+
+#ifdef SHANDRIS_KERNELS_X86
+
+// AVX2 kernels, 4 doubles per lane
+
+#define SHANDRIS_AVX2 __attribute__((target("avx2,fma")))
+
+SHANDRIS_AVX2 inline double HorizontalSum(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    low = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+SHANDRIS_AVX2 inline double HorizontalMax(__m256d v) {
+    __m128d low = _mm256_castpd256_pd128(v);
+    __m128d high = _mm256_extractf128_pd(v, 1);
+    low = _mm_max_pd(low, high);
+    return _mm_cvtsd_f64(_mm_max_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+SHANDRIS_AVX2 inline __m256d Abs(__m256d v) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+SHANDRIS_AVX2 double Avx2Dot(const double* a, const double* b, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+    }
+    double sum = HorizontalSum(_mm256_add_pd(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+SHANDRIS_AVX2 double Avx2SumSquares(const double* a, size_t n) {
+    return Avx2Dot(a, a, n);
+}
+
+SHANDRIS_AVX2 double Avx2SumAbs(const double* a, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc, Abs(_mm256_loadu_pd(a + i)));
+    }
+    double sum = HorizontalSum(acc);
+    for (; i < n; ++i) sum += std::abs(a[i]);
+    return sum;
+}
+
+SHANDRIS_AVX2 double Avx2SumAbsDiff(const double* a, const double* b, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        acc = _mm256_add_pd(acc, Abs(diff));
+    }
+    double sum = HorizontalSum(acc);
+    for (; i < n; ++i) sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+SHANDRIS_AVX2 double Avx2MaxAbs(const double* a, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_max_pd(acc, Abs(_mm256_loadu_pd(a + i)));
+    }
+    double result = HorizontalMax(acc);
+    for (; i < n; ++i) result = std::max(result, std::abs(a[i]));
+    return result;
+}
+
+SHANDRIS_AVX2 void Avx2Scale(double* a, size_t n, double scale) {
+    const __m256d factor = _mm256_set1_pd(scale);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+    }
+    for (; i < n; ++i) a[i] *= scale;
+}
+
+SHANDRIS_AVX2 void Avx2AddClamp(double* a, size_t n, double delta, double lo, double hi) {
+    const __m256d step = _mm256_set1_pd(delta);
+    const __m256d low = _mm256_set1_pd(lo);
+    const __m256d high = _mm256_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_add_pd(_mm256_loadu_pd(a + i), step);
+        _mm256_storeu_pd(a + i, _mm256_min_pd(_mm256_max_pd(v, low), high));
+    }
+    for (; i < n; ++i) a[i] = std::min(std::max(a[i] + delta, lo), hi);
+}
+
+SHANDRIS_AVX2 void Avx2DiffuseRow(const double* prev, const double* next,
+                                  const double* up, const double* down,
+                                  const double* center, double* dst,
+                                  size_t cols, double timeStep) {
+    const __m256d dt = _mm256_set1_pd(timeStep);
+    const __m256d six = _mm256_set1_pd(6.0);
+    size_t k = 1;
+    for (; k + 4 < cols; k += 4) {
+        __m256d c = _mm256_loadu_pd(center + k);
+        __m256d sum = _mm256_add_pd(_mm256_loadu_pd(prev + k), _mm256_loadu_pd(next + k));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(up + k));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(down + k));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(center + k - 1));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(center + k + 1));
+        __m256d laplacian = _mm256_sub_pd(sum, _mm256_mul_pd(six, c));
+        _mm256_storeu_pd(dst + k, _mm256_add_pd(c, _mm256_mul_pd(dt, laplacian)));
+    }
+    for (; k + 1 < cols; ++k) {
+        dst[k] = DiffuseOne(prev, next, up, down, center, k, timeStep);
+    }
+}
+
+constexpr TensorKernels AVX2_KERNELS{
+    KernelISA::AVX2,
+    Avx2Dot, Avx2SumSquares, Avx2SumAbs, Avx2SumAbsDiff, Avx2MaxAbs,
+    Avx2Scale, Avx2AddClamp, Avx2DiffuseRow
+};
+
+// AVX-512 kernels, 8 doubles per lane
+
+// GCC 12's avx512fintrin.h self-initializes its undefined placeholders and
+// trips -Wuninitialized from inside the intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+#define SHANDRIS_AVX512 __attribute__((target("avx512f")))
+
+SHANDRIS_AVX512 double Avx512Dot(const double* a, const double* b, size_t n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), acc0);
+    }
+    double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+SHANDRIS_AVX512 double Avx512SumSquares(const double* a, size_t n) {
+    return Avx512Dot(a, a, n);
+}
+
+SHANDRIS_AVX512 double Avx512SumAbs(const double* a, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_pd(acc, _mm512_abs_pd(_mm512_loadu_pd(a + i)));
+    }
+    double sum = _mm512_reduce_add_pd(acc);
+    for (; i < n; ++i) sum += std::abs(a[i]);
+    return sum;
+}
+
+SHANDRIS_AVX512 double Avx512SumAbsDiff(const double* a, const double* b, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d diff = _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i));
+        acc = _mm512_add_pd(acc, _mm512_abs_pd(diff));
+    }
+    double sum = _mm512_reduce_add_pd(acc);
+    for (; i < n; ++i) sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+SHANDRIS_AVX512 double Avx512MaxAbs(const double* a, size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_max_pd(acc, _mm512_abs_pd(_mm512_loadu_pd(a + i)));
+    }
+    double result = _mm512_reduce_max_pd(acc);
+    for (; i < n; ++i) result = std::max(result, std::abs(a[i]));
+    return result;
+}
+
+SHANDRIS_AVX512 void Avx512Scale(double* a, size_t n, double scale) {
+    const __m512d factor = _mm512_set1_pd(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(a + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), factor));
+    }
+    for (; i < n; ++i) a[i] *= scale;
+}
+
+SHANDRIS_AVX512 void Avx512AddClamp(double* a, size_t n, double delta, double lo, double hi) {
+    const __m512d step = _mm512_set1_pd(delta);
+    const __m512d low = _mm512_set1_pd(lo);
+    const __m512d high = _mm512_set1_pd(hi);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_add_pd(_mm512_loadu_pd(a + i), step);
+        _mm512_storeu_pd(a + i, _mm512_min_pd(_mm512_max_pd(v, low), high));
+    }
+    for (; i < n; ++i) a[i] = std::min(std::max(a[i] + delta, lo), hi);
+}
+
+SHANDRIS_AVX512 void Avx512DiffuseRow(const double* prev, const double* next,
+                                      const double* up, const double* down,
+                                      const double* center, double* dst,
+                                      size_t cols, double timeStep) {
+    const __m512d dt = _mm512_set1_pd(timeStep);
+    const __m512d six = _mm512_set1_pd(6.0);
+    size_t k = 1;
+    for (; k + 8 < cols; k += 8) {
+        __m512d c = _mm512_loadu_pd(center + k);
+        __m512d sum = _mm512_add_pd(_mm512_loadu_pd(prev + k), _mm512_loadu_pd(next + k));
+        sum = _mm512_add_pd(sum, _mm512_loadu_pd(up + k));
+        sum = _mm512_add_pd(sum, _mm512_loadu_pd(down + k));
+        sum = _mm512_add_pd(sum, _mm512_loadu_pd(center + k - 1));
+        sum = _mm512_add_pd(sum, _mm512_loadu_pd(center + k + 1));
+        __m512d laplacian = _mm512_sub_pd(sum, _mm512_mul_pd(six, c));
+        _mm512_storeu_pd(dst + k, _mm512_add_pd(c, _mm512_mul_pd(dt, laplacian)));
+    }
+    for (; k + 1 < cols; ++k) {
+        dst[k] = DiffuseOne(prev, next, up, down, center, k, timeStep);
+    }
+}
+
+constexpr TensorKernels AVX512_KERNELS{
+    KernelISA::AVX512,
+    Avx512Dot, Avx512SumSquares, Avx512SumAbs, Avx512SumAbsDiff, Avx512MaxAbs,
+    Avx512Scale, Avx512AddClamp, Avx512DiffuseRow
+};
+
+#pragma GCC diagnostic pop
+
+#endif // SHANDRIS_KERNELS_X86
+
+#ifdef SHANDRIS_KERNELS_NEON
+
+// NEON kernels, 2 doubles per lane
+
+double NeonDot(const double* a, const double* b, size_t n) {
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+    }
+    double sum = vaddvq_f64(vaddq_f64(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+double NeonSumSquares(const double* a, size_t n) {
+    return NeonDot(a, a, n);
+}
+
+double NeonSumAbs(const double* a, size_t n) {
+    float64x2_t acc = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = vaddq_f64(acc, vabsq_f64(vld1q_f64(a + i)));
+    }
+    double sum = vaddvq_f64(acc);
+    for (; i < n; ++i) sum += std::abs(a[i]);
+    return sum;
+}
+
+double NeonSumAbsDiff(const double* a, const double* b, size_t n) {
+    float64x2_t acc = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = vaddq_f64(acc, vabdq_f64(vld1q_f64(a + i), vld1q_f64(b + i)));
+    }
+    double sum = vaddvq_f64(acc);
+    for (; i < n; ++i) sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+double NeonMaxAbs(const double* a, size_t n) {
+    float64x2_t acc = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = vmaxq_f64(acc, vabsq_f64(vld1q_f64(a + i)));
+    }
+    double result = vmaxvq_f64(acc);
+    for (; i < n; ++i) result = std::max(result, std::abs(a[i]));
+    return result;
+}
+
+void NeonScale(double* a, size_t n, double scale) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(a + i, vmulq_n_f64(vld1q_f64(a + i), scale));
+    }
+    for (; i < n; ++i) a[i] *= scale;
+}
+
+void NeonAddClamp(double* a, size_t n, double delta, double lo, double hi) {
+    const float64x2_t step = vdupq_n_f64(delta);
+    const float64x2_t low = vdupq_n_f64(lo);
+    const float64x2_t high = vdupq_n_f64(hi);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vaddq_f64(vld1q_f64(a + i), step);
+        vst1q_f64(a + i, vminq_f64(vmaxq_f64(v, low), high));
+    }
+    for (; i < n; ++i) a[i] = std::min(std::max(a[i] + delta, lo), hi);
+}
+
+void NeonDiffuseRow(const double* prev, const double* next,
+                    const double* up, const double* down,
+                    const double* center, double* dst,
+                    size_t cols, double timeStep) {
+    const float64x2_t six = vdupq_n_f64(6.0);
+    size_t k = 1;
+    for (; k + 2 < cols; k += 2) {
+        float64x2_t c = vld1q_f64(center + k);
+        float64x2_t sum = vaddq_f64(vld1q_f64(prev + k), vld1q_f64(next + k));
+        sum = vaddq_f64(sum, vld1q_f64(up + k));
+        sum = vaddq_f64(sum, vld1q_f64(down + k));
+        sum = vaddq_f64(sum, vld1q_f64(center + k - 1));
+        sum = vaddq_f64(sum, vld1q_f64(center + k + 1));
+        float64x2_t laplacian = vsubq_f64(sum, vmulq_f64(six, c));
+        vst1q_f64(dst + k, vaddq_f64(c, vmulq_n_f64(laplacian, timeStep)));
+    }
+    for (; k + 1 < cols; ++k) {
+        dst[k] = DiffuseOne(prev, next, up, down, center, k, timeStep);
+    }
+}
+
+constexpr TensorKernels NEON_KERNELS{
+    KernelISA::NEON,
+    NeonDot, NeonSumSquares, NeonSumAbs, NeonSumAbsDiff, NeonMaxAbs,
+    NeonScale, NeonAddClamp, NeonDiffuseRow
+};
+
+#endif // SHANDRIS_KERNELS_NEON
+
+bool IsSupported(KernelISA isa) {
+    switch (isa) {
+        case KernelISA::Scalar:
+            return true;
+#ifdef SHANDRIS_KERNELS_X86
+        case KernelISA::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case KernelISA::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+#ifdef SHANDRIS_KERNELS_NEON
+        case KernelISA::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+KernelISA DetectKernelISA() {
+    static const KernelISA detected = [] {
+        for (KernelISA isa : {KernelISA::AVX512, KernelISA::AVX2, KernelISA::NEON}) {
+            if (IsSupported(isa)) return isa;
+        }
+        return KernelISA::Scalar;
+    }();
+    return detected;
+}
+
+const TensorKernels& Kernels() {
+    static const TensorKernels& active = KernelsFor(DetectKernelISA());
+    return active;
+}
+
+const TensorKernels& KernelsFor(KernelISA isa) {
+    if (!IsSupported(isa)) return SCALAR_KERNELS;
+    switch (isa) {
+#ifdef SHANDRIS_KERNELS_X86
+        case KernelISA::AVX2:
+            return AVX2_KERNELS;
+        case KernelISA::AVX512:
+            return AVX512_KERNELS;
+#endif
+#ifdef SHANDRIS_KERNELS_NEON
+        case KernelISA::NEON:
+            return NEON_KERNELS;
+#endif
+        default:
+            return SCALAR_KERNELS;
+    }
+}
+
+const char* KernelISAName(KernelISA isa) {
+    switch (isa) {
+        case KernelISA::AVX2: return "avx2";
+        case KernelISA::AVX512: return "avx512";
+        case KernelISA::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+} // namespace shandris
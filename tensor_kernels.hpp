@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+namespace shandris {
+
+enum class KernelISA {
+    Scalar,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+// Flat kernels over contiguous tensor storage. Every ISA computes the same
+// values; reductions may differ from Scalar by summation order only.
+struct TensorKernels {
+    KernelISA isa;
+
+    double (*Dot)(const double* a, const double* b, size_t n);
+    double (*SumSquares)(const double* a, size_t n);
+    double (*SumAbs)(const double* a, size_t n);
+    double (*SumAbsDiff)(const double* a, const double* b, size_t n);
+    double (*MaxAbs)(const double* a, size_t n);
+
+    // a[i] *= scale
+    void (*Scale)(double* a, size_t n, double scale);
+    // a[i] = clamp(a[i] + delta, lo, hi)
+    void (*AddClamp)(double* a, size_t n, double delta, double lo, double hi);
+
+    // 7-point diffusion step over the interior of one row, k in [1, cols - 1):
+    // dst[k] = center[k] + timeStep * (prev[k] + next[k] + up[k] + down[k] +
+    //                                  center[k - 1] + center[k + 1] - 6 * center[k])
+    // dst must not overlap any input row.
+    void (*DiffuseRow)(const double* prev, const double* next,
+                       const double* up, const double* down,
+                       const double* center, double* dst,
+                       size_t cols, double timeStep);
+};
+
+// Best ISA supported by the running CPU, detected once
+KernelISA DetectKernelISA();
+
+// Kernels for the detected ISA
+const TensorKernels& Kernels();
+
+// Kernels for a specific ISA; falls back to Scalar when isa was not compiled
+// in or is not supported by this CPU
+const TensorKernels& KernelsFor(KernelISA isa);
+
+const char* KernelISAName(KernelISA isa);
+
+} // namespace shandris
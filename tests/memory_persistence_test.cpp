@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "../memory.hpp"
+#include "../memory_snapshot.hpp"
+
+namespace shandris::cognitive {
+namespace {
+
+MemoryEvent MakeMemory(const std::string& id) {
+    auto& symbols = SymbolTable::Global();
+    MemoryEvent memory;
+    memory.id = id;
+    memory.content = "walked along the shore at dusk";
+    memory.context = "persistence-test";
+    memory.importance = 0.75;
+    memory.emotional_weight = 0.4;
+    memory.trait_influences[symbols.Intern(SymbolKind::Trait, "warmth")] = 0.6;
+    memory.trait_influences[symbols.Intern(SymbolKind::Trait, "curiosity")] = -0.25;
+    memory.tags.insert(symbols.Intern(SymbolKind::Tag, "sea"));
+    memory.tags.insert(symbols.Intern(SymbolKind::Tag, "evening"));
+    memory.created_at = std::chrono::system_clock::from_time_t(1700000000);
+    memory.updated_at = std::chrono::system_clock::from_time_t(1700000100);
+    return memory;
+}
+
+// Stored times are whole unix seconds
+std::chrono::system_clock::time_point StoredNow() {
+    return std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+}
+
+class MemoryPersistenceTest : public ::testing::TestWithParam<codec::ColumnEncoding> {
+protected:
+    void TearDown() override {
+        MemoryManager cleanup;
+        if (cleanup.Initialize()) {
+            cleanup.DeleteMemory(id_);
+            cleanup.DeleteEmotionalState(id_);
+            cleanup.FlushPendingWrites();
+        }
+    }
+
+    std::string id_ = GetParam() == codec::ColumnEncoding::Binary ? "roundtrip-binary" : "roundtrip-json";
+};
+
+// Save, flush, then load into a fresh manager through the bulk loader
+TEST_P(MemoryPersistenceTest, BulkLoadRestoresTagsAndTraits) {
+    const MemoryEvent saved = MakeMemory(id_);
+    const auto savedAt = StoredNow();
+    {
+        MemoryManager writer;
+        writer.SetColumnEncoding(GetParam());
+        ASSERT_TRUE(writer.Initialize());
+        ASSERT_TRUE(writer.SaveMemory(saved));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+    }
+
+    MemoryManager reader;
+    ASSERT_TRUE(reader.Initialize());
+    reader.LoadFromDatabase();
+
+    MemoryEvent loaded;
+    ASSERT_TRUE(reader.LoadMemory(id_, loaded));
+    EXPECT_EQ(loaded.content, saved.content);
+    EXPECT_EQ(loaded.context, saved.context);
+    EXPECT_DOUBLE_EQ(loaded.importance, saved.importance);
+    EXPECT_DOUBLE_EQ(loaded.emotional_weight, saved.emotional_weight);
+    EXPECT_EQ(loaded.trait_influences, saved.trait_influences);
+    EXPECT_EQ(loaded.tags, saved.tags);
+    EXPECT_EQ(loaded.created_at, saved.created_at);
+    // Stamped when written, not taken from the caller
+    EXPECT_GE(loaded.updated_at, savedAt);
+}
+
+// An update rewrites a stored memory but keeps created_at, and never
+// creates a missing one
+TEST_P(MemoryPersistenceTest, UpdateKeepsCreatedAtAndNeverInserts) {
+    const MemoryEvent saved = MakeMemory(id_);
+    MemoryEvent missing = MakeMemory(id_ + "-missing");
+    {
+        MemoryManager writer;
+        writer.SetColumnEncoding(GetParam());
+        ASSERT_TRUE(writer.Initialize());
+        ASSERT_TRUE(writer.SaveMemory(saved));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+
+        MemoryEvent changed = saved;
+        changed.content = "watched the tide come in";
+        changed.created_at = std::chrono::system_clock::from_time_t(1800000000);
+        ASSERT_TRUE(writer.UpdateMemory(changed));
+        EXPECT_FALSE(writer.UpdateMemory(missing));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+    }
+
+    MemoryManager reader;
+    ASSERT_TRUE(reader.Initialize());
+    MemoryEvent loaded;
+    ASSERT_TRUE(reader.LoadMemory(id_, loaded));
+    EXPECT_EQ(loaded.content, "watched the tide come in");
+    EXPECT_EQ(loaded.created_at, saved.created_at);
+    EXPECT_FALSE(reader.LoadMemory(missing.id, loaded));
+}
+
+// Updating an emotional state rewrites it; a missing or deleted one stays
+// missing
+TEST_P(MemoryPersistenceTest, UpdateEmotionalStateNeverInserts) {
+    EmotionalState state;
+    state.id = id_;
+    state.happiness = 0.6;
+    state.trust = 0.3;
+    state.timestamp = std::chrono::system_clock::from_time_t(1700000000);
+    {
+        MemoryManager writer;
+        ASSERT_TRUE(writer.Initialize());
+        EXPECT_FALSE(writer.UpdateEmotionalState(state));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+
+        EmotionalState loaded;
+        EXPECT_FALSE(writer.LoadEmotionalState(id_, loaded));
+
+        ASSERT_TRUE(writer.SaveEmotionalState(state));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+        state.happiness = 0.2;
+        ASSERT_TRUE(writer.UpdateEmotionalState(state));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+    }
+
+    MemoryManager reader;
+    ASSERT_TRUE(reader.Initialize());
+    EmotionalState loaded;
+    ASSERT_TRUE(reader.LoadEmotionalState(id_, loaded));
+    EXPECT_DOUBLE_EQ(loaded.happiness, 0.2);
+    EXPECT_DOUBLE_EQ(loaded.trust, 0.3);
+
+    ASSERT_TRUE(reader.DeleteEmotionalState(id_));
+    EXPECT_FALSE(reader.UpdateEmotionalState(state));
+    ASSERT_TRUE(reader.FlushPendingWrites());
+    EXPECT_FALSE(reader.LoadEmotionalState(id_, loaded));
+}
+
+// A memory updated after the snapshot was written is replayed over it
+TEST_P(MemoryPersistenceTest, WarmStartReplaysUpdatesAfterSnapshot) {
+    const MemoryEvent saved = MakeMemory(id_);
+    const std::string path = ::testing::TempDir() + id_ + ".snapshot";
+    {
+        MemoryManager writer;
+        writer.SetColumnEncoding(GetParam());
+        ASSERT_TRUE(writer.Initialize());
+        ASSERT_TRUE(writer.SaveMemory(saved));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+
+        SnapshotWriter snapshot;
+        writer.AppendToSnapshot(snapshot);
+        ASSERT_TRUE(snapshot.WriteFile(path, std::chrono::system_clock::to_time_t(StoredNow())));
+
+        MemoryEvent changed = saved;
+        changed.content = "watched the tide come in";
+        ASSERT_TRUE(writer.UpdateMemory(changed));
+        ASSERT_TRUE(writer.FlushPendingWrites());
+    }
+
+    MemoryManager reader;
+    ASSERT_TRUE(reader.Initialize());
+    ASSERT_TRUE(reader.WarmStart(MappedSnapshot::Open(path)));
+    MemoryEvent loaded;
+    ASSERT_TRUE(reader.LoadMemory(id_, loaded));
+    EXPECT_EQ(loaded.content, "watched the tide come in");
+    std::remove(path.c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(ColumnEncodings, MemoryPersistenceTest,
+                         ::testing::Values(codec::ColumnEncoding::Json, codec::ColumnEncoding::Binary));
+
+} // namespace
+} // namespace shandris::cognitive
@@ -0,0 +1,303 @@
+#include "text_index.hpp"
+#include "memory.hpp"
+#include "maintenance_scheduler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iterator>
+
+namespace shandris {
+namespace cognitive {
+
+namespace {
+
+constexpr size_t MIN_TOKEN_LENGTH = 2;
+constexpr size_t DOCS_PER_CHUNK = 1024;  // tokenized per parallel task
+constexpr size_t MIN_TOMBSTONES_FOR_COMPACTION = 1024;
+constexpr char TAG_TERM_PREFIX = '#';  // never produced by Tokenize
+
+void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t GetVarint(const uint8_t*& in) {
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = *in++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+bool IsTokenChar(unsigned char c) {
+    return std::isalnum(c) || c == '_';
+}
+
+int64_t ToUnixSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+void MemoryTextIndex::Tokenize(std::string_view text, std::vector<std::string>& tokens) {
+    tokens.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && !IsTokenChar(static_cast<unsigned char>(text[i]))) ++i;
+        size_t begin = i;
+        while (i < text.size() && IsTokenChar(static_cast<unsigned char>(text[i]))) ++i;
+        if (i - begin >= MIN_TOKEN_LENGTH) {
+            std::string token(text.substr(begin, i - begin));
+            for (char& c : token) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            tokens.push_back(std::move(token));
+        }
+    }
+}
+
+MemoryTextIndex::DocTerms MemoryTextIndex::Analyze(const MemoryEvent& memory) {
+    DocTerms result;
+    std::vector<std::string> tokens;
+    Tokenize(memory.content, tokens);
+    result.length = static_cast<uint32_t>(tokens.size());
+
+    // Tags are whole terms of their own, lowercased like tokens
+    auto& symbols = SymbolTable::Global();
+    for (SymbolID tag : memory.tags) {
+        std::string term(1, TAG_TERM_PREFIX);
+        for (char c : symbols.Name(SymbolKind::Tag, tag)) {
+            term += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        tokens.push_back(std::move(term));
+    }
+
+    std::sort(tokens.begin(), tokens.end());
+    for (size_t i = 0; i < tokens.size();) {
+        size_t j = i;
+        while (j < tokens.size() && tokens[j] == tokens[i]) ++j;
+        result.terms.emplace_back(std::move(tokens[i]), static_cast<uint32_t>(j - i));
+        i = j;
+    }
+    return result;
+}
+
+void MemoryTextIndex::Append(const MemoryEvent& memory, DocTerms&& terms) {
+    auto existing = doc_ids_.find(memory.id);
+    if (existing != doc_ids_.end()) {
+        Tombstone(existing->second);
+    }
+
+    DocID doc = static_cast<DocID>(docs_.size());
+    docs_.push_back({memory.id, terms.length, memory.importance, ToUnixSeconds(memory.created_at), true});
+    doc_ids_[memory.id] = doc;
+    ++live_count_;
+    total_length_ += terms.length;
+
+    for (auto& [term, frequency] : terms.terms) {
+        auto [it, inserted] = terms_.try_emplace(std::move(term), static_cast<TermID>(postings_.size()));
+        if (inserted) postings_.emplace_back();
+
+        // New documents always get the highest ID, so deltas stay positive
+        PostingList& list = postings_[it->second];
+        PutVarint(list.bytes, list.doc_count == 0 ? doc : doc - list.last_doc);
+        PutVarint(list.bytes, frequency);
+        list.last_doc = doc;
+        ++list.doc_count;
+    }
+}
+
+void MemoryTextIndex::Upsert(const MemoryEvent& memory) {
+    Append(memory, Analyze(memory));
+    MaybeCompact();
+}
+
+void MemoryTextIndex::Remove(const std::string& id) {
+    auto it = doc_ids_.find(id);
+    if (it == doc_ids_.end()) return;
+    Tombstone(it->second);
+    doc_ids_.erase(it);
+    MaybeCompact();
+}
+
+void MemoryTextIndex::Tombstone(DocID doc) {
+    Document& document = docs_[doc];
+    if (!document.live) return;
+    document.live = false;
+    --live_count_;
+    total_length_ -= document.length;
+}
+
+void MemoryTextIndex::Clear() {
+    docs_.clear();
+    doc_ids_.clear();
+    terms_.clear();
+    postings_.clear();
+    live_count_ = 0;
+    total_length_ = 0;
+}
+
+void MemoryTextIndex::Rebuild(const MemoryMap& memories, WorkStealingExecutor* executor) {
+    Clear();
+
+    // Tokenizing dominates, so it runs on the executor; appends stay serial
+    // and in map order so document IDs are deterministic
+    std::vector<DocTerms> analyzed(memories.size());
+    std::vector<const MemoryEvent*> ordered;
+    ordered.reserve(memories.size());
+    for (const auto& [id, memory] : memories) {
+        ordered.push_back(&memory);
+    }
+
+    auto analyzeChunk = [&](size_t chunk) {
+        const size_t last = std::min(ordered.size(), (chunk + 1) * DOCS_PER_CHUNK);
+        for (size_t i = chunk * DOCS_PER_CHUNK; i < last; ++i) analyzed[i] = Analyze(*ordered[i]);
+    };
+    const size_t chunks = (ordered.size() + DOCS_PER_CHUNK - 1) / DOCS_PER_CHUNK;
+    if (executor) {
+        ParallelFor(*executor, chunks, analyzeChunk);
+    } else {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) analyzeChunk(chunk);
+    }
+
+    docs_.reserve(ordered.size());
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        Append(*ordered[i], std::move(analyzed[i]));
+    }
+}
+
+void MemoryTextIndex::MaybeCompact() {
+    size_t tombstones = docs_.size() - live_count_;
+    if (tombstones >= MIN_TOMBSTONES_FOR_COMPACTION && tombstones * 4 >= docs_.size()) {
+        Compact();
+    }
+}
+
+void MemoryTextIndex::Compact() {
+    // Renumber live documents densely, keeping their order
+    constexpr DocID DEAD = ~DocID{0};
+    std::vector<DocID> remap(docs_.size(), DEAD);
+    std::vector<Document> docs;
+    docs.reserve(live_count_);
+    for (DocID doc = 0; doc < docs_.size(); ++doc) {
+        if (docs_[doc].live) {
+            remap[doc] = static_cast<DocID>(docs.size());
+            docs.push_back(std::move(docs_[doc]));
+        }
+    }
+
+    std::unordered_map<std::string, TermID> terms;
+    std::vector<PostingList> postings;
+    for (auto& [term, termID] : terms_) {
+        const PostingList& old = postings_[termID];
+        PostingList list;
+        const uint8_t* in = old.bytes.data();
+        DocID doc = 0;
+        for (uint32_t i = 0; i < old.doc_count; ++i) {
+            doc += GetVarint(in);
+            uint32_t frequency = GetVarint(in);
+            if (remap[doc] == DEAD) continue;
+            PutVarint(list.bytes, list.doc_count == 0 ? remap[doc] : remap[doc] - list.last_doc);
+            PutVarint(list.bytes, frequency);
+            list.last_doc = remap[doc];
+            ++list.doc_count;
+        }
+        if (list.doc_count == 0) continue;
+        list.bytes.shrink_to_fit();
+        terms.emplace(term, static_cast<TermID>(postings.size()));
+        postings.push_back(std::move(list));
+    }
+
+    docs_ = std::move(docs);
+    terms_ = std::move(terms);
+    postings_ = std::move(postings);
+    doc_ids_.clear();
+    for (DocID doc = 0; doc < docs_.size(); ++doc) {
+        doc_ids_[docs_[doc].id] = doc;
+    }
+}
+
+std::vector<TextSearchResult> MemoryTextIndex::Search(std::string_view query, size_t k,
+                                                      std::chrono::system_clock::time_point now,
+                                                      const TextRankingParams& params) const {
+    std::vector<TextSearchResult> results;
+    if (k == 0 || live_count_ == 0) return results;
+
+    std::vector<std::string> tokens;
+    Tokenize(query, tokens);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    // Dense per-thread accumulators, reset only where touched
+    thread_local std::vector<double> scores;
+    thread_local std::vector<DocID> touched;
+    if (scores.size() < docs_.size()) scores.resize(docs_.size(), 0.0);
+    touched.clear();
+
+    const double docCount = static_cast<double>(live_count_);
+    const double averageLength = std::max(1.0, static_cast<double>(total_length_) / docCount);
+
+    auto scoreTerm = [&](const std::string& term, bool isTag) {
+        auto it = terms_.find(term);
+        if (it == terms_.end()) return;
+        const PostingList& list = postings_[it->second];
+
+        // Document frequency still counts tombstones until the next
+        // compaction; clamping keeps idf, and so every score, positive
+        double df = static_cast<double>(list.doc_count);
+        double idf = std::log(1.0 + (std::max(docCount - df, 0.0) + 0.5) / (df + 0.5));
+
+        const uint8_t* in = list.bytes.data();
+        DocID doc = 0;
+        for (uint32_t i = 0; i < list.doc_count; ++i) {
+            doc += GetVarint(in);
+            double tf = GetVarint(in);
+            const Document& document = docs_[doc];
+            if (!document.live) continue;
+
+            // Tags carry no length; score them as if the document were average
+            double length = isTag ? averageLength : document.length;
+            double norm = params.k1 * (1.0 - params.b + params.b * length / averageLength);
+            double score = idf * tf * (params.k1 + 1.0) / (tf + norm);
+            if (isTag) score *= params.tag_boost;
+
+            if (scores[doc] == 0.0) touched.push_back(doc);
+            scores[doc] += score;
+        }
+    };
+
+    for (const auto& token : tokens) {
+        scoreTerm(token, false);
+        scoreTerm(TAG_TERM_PREFIX + token, true);
+    }
+
+    // Priors only for documents that matched at all
+    const int64_t nowSeconds = ToUnixSeconds(now);
+    const double halfLife = std::max<double>(
+        std::chrono::duration_cast<std::chrono::seconds>(params.recency_half_life).count(), 1.0);
+    results.reserve(std::min(k, touched.size()) + 1);
+    auto worse = [](const TextSearchResult& a, const TextSearchResult& b) { return a.score > b.score; };
+    for (DocID doc : touched) {
+        const Document& document = docs_[doc];
+        double age = std::max<double>(static_cast<double>(nowSeconds - document.created_at), 0.0);
+        double score = scores[doc] + params.importance_weight * document.importance +
+                       params.recency_weight * std::exp2(-age / halfLife);
+        scores[doc] = 0.0;
+
+        if (results.size() < k) {
+            results.push_back({document.id, score});
+            std::push_heap(results.begin(), results.end(), worse);
+        } else if (score > results.front().score) {
+            std::pop_heap(results.begin(), results.end(), worse);
+            results.back() = {document.id, score};
+            std::push_heap(results.begin(), results.end(), worse);
+        }
+    }
+    std::sort_heap(results.begin(), results.end(), worse);
+    return results;
+}
+
+} // namespace cognitive
+} // namespace shandris
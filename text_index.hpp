@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "memory_pool.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+class WorkStealingExecutor;
+
+struct TextRankingParams {
+    double k1 = 1.2;                  // BM25 term-frequency saturation
+    double b = 0.75;                  // BM25 length normalization
+    double tag_boost = 2.0;           // weight of a tag hit relative to a content hit
+    double importance_weight = 1.0;   // added per unit of memory importance
+    double recency_weight = 1.0;      // added for a brand new memory, halving every half-life
+    std::chrono::hours recency_half_life{72};
+};
+
+struct TextSearchResult {
+    std::string id;
+    double score;
+};
+
+// Incrementally maintained inverted index over memory content tokens and
+// tags. Posting lists are delta-and-varint encoded byte streams; updates
+// and deletes tombstone the old document and the lists are compacted once
+// tombstones pass a quarter of the index. Queries rank matches with BM25
+// plus importance and recency.
+class MemoryTextIndex {
+public:
+    void Upsert(const MemoryEvent& memory);
+    void Remove(const std::string& id);
+    void Clear();
+
+    // Replace the contents with memories, tokenizing in parallel on
+    // executor when given; safe to call from one of its tasks
+    void Rebuild(const MemoryMap& memories, WorkStealingExecutor* executor = nullptr);
+
+    // Up to k matches for the tokens of query, best first
+    std::vector<TextSearchResult> Search(std::string_view query, size_t k,
+                                         std::chrono::system_clock::time_point now,
+                                         const TextRankingParams& params = {}) const;
+
+    size_t Size() const { return live_count_; }
+    size_t TermCount() const { return postings_.size(); }
+
+    // Lowercased runs of letters, digits and underscores
+    static void Tokenize(std::string_view text, std::vector<std::string>& tokens);
+
+private:
+    using DocID = uint32_t;
+    using TermID = uint32_t;
+
+    struct Document {
+        std::string id;
+        uint32_t length;  // content tokens
+        double importance;
+        int64_t created_at;
+        bool live;
+    };
+
+    struct PostingList {
+        std::vector<uint8_t> bytes;  // (doc delta, term frequency) varint pairs
+        DocID last_doc = 0;
+        uint32_t doc_count = 0;      // includes tombstoned docs until compaction
+    };
+
+    // Term frequencies for one document, ready to append
+    struct DocTerms {
+        std::vector<std::pair<std::string, uint32_t>> terms;
+        uint32_t length = 0;
+    };
+
+    static DocTerms Analyze(const MemoryEvent& memory);
+    void Append(const MemoryEvent& memory, DocTerms&& terms);
+    void Tombstone(DocID doc);
+    void MaybeCompact();
+    void Compact();
+
+    std::vector<Document> docs_;
+    std::unordered_map<std::string, DocID> doc_ids_;  // live documents only
+    std::unordered_map<std::string, TermID> terms_;
+    std::vector<PostingList> postings_;
+    size_t live_count_ = 0;
+    uint64_t total_length_ = 0;  // over live documents
+};
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,127 @@
+#include "trait_aggregates.hpp"
+#include "memory.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace shandris {
+namespace cognitive {
+
+double TraitMoments::Variance() const {
+    if (count == 0) return 0.0;
+    double mean = sum / count;
+    // Clamped: subtracting removed memories can leave tiny negative residue
+    return std::max(sum_squares / count - mean * mean, 0.0);
+}
+
+double TraitPairMoments::Correlation() const {
+    if (count < 2) return 0.0;
+    double n = static_cast<double>(count);
+    double numerator = n * products - source_sum * target_sum;
+    double denominator = std::sqrt(std::max(n * source_squares - source_sum * source_sum, 0.0) *
+                                   std::max(n * target_squares - target_sum * target_sum, 0.0));
+    return denominator > 0.0 ? numerator / denominator : 0.0;
+}
+
+TraitAggregates::Contribution TraitAggregates::Extract(const MemoryEvent& memory) {
+    Contribution contribution;
+    contribution.influences.reserve(memory.trait_influences.size());
+    for (const auto& [trait, influence] : memory.trait_influences) {
+        contribution.influences.emplace_back(trait, influence);
+    }
+    contribution.emotional_weight = memory.emotional_weight;
+    return contribution;
+}
+
+void TraitAggregates::Apply(const Contribution& contribution, int sign) {
+    const double weight = contribution.emotional_weight;
+    for (const auto& [trait, influence] : contribution.influences) {
+        auto it = traits_.try_emplace(trait).first;
+        TraitMoments& moments = it->second;
+        moments.count += sign;
+        moments.sum += sign * influence;
+        moments.sum_squares += sign * influence * influence;
+        // Emptied entries go, so sums never drift on a trait no memory carries
+        if (moments.count == 0) traits_.erase(it);
+
+        if (weight > 0.0) {
+            auto emotion = emotions_.try_emplace(trait).first;
+            emotion->second.count += sign;
+            emotion->second.sum += sign * weight;
+            if (emotion->second.count == 0) emotions_.erase(emotion);
+        }
+
+        for (const auto& [other, otherInfluence] : contribution.influences) {
+            if (other == trait) continue;
+            auto& partners = pairs_[trait];
+            auto pair = partners.try_emplace(other).first;
+            TraitPairMoments& moments = pair->second;
+            moments.count += sign;
+            moments.source_sum += sign * influence;
+            moments.target_sum += sign * otherInfluence;
+            moments.source_squares += sign * influence * influence;
+            moments.target_squares += sign * otherInfluence * otherInfluence;
+            moments.products += sign * influence * otherInfluence;
+            if (moments.count == 0) {
+                partners.erase(pair);
+                if (partners.empty()) pairs_.erase(trait);
+            }
+        }
+    }
+}
+
+void TraitAggregates::Upsert(const MemoryEvent& memory) {
+    Contribution contribution = Extract(memory);
+    auto [it, inserted] = indexed_.try_emplace(memory.id);
+    if (!inserted) {
+        Apply(it->second, -1);
+    }
+    Apply(contribution, +1);
+    it->second = std::move(contribution);
+}
+
+void TraitAggregates::Remove(const std::string& id) {
+    auto it = indexed_.find(id);
+    if (it == indexed_.end()) return;
+    Apply(it->second, -1);
+    indexed_.erase(it);
+}
+
+void TraitAggregates::Clear() {
+    indexed_.clear();
+    traits_.clear();
+    emotions_.clear();
+    pairs_.clear();
+}
+
+void TraitAggregates::Rebuild(const MemoryMap& memories) {
+    Clear();
+    indexed_.reserve(memories.size());
+    for (const auto& [id, memory] : memories) {
+        Upsert(memory);
+    }
+}
+
+const TraitMoments* TraitAggregates::Influence(SymbolID trait) const {
+    auto it = traits_.find(trait);
+    return it != traits_.end() ? &it->second : nullptr;
+}
+
+const TraitPairMoments* TraitAggregates::Pair(SymbolID source, SymbolID target) const {
+    auto partners = pairs_.find(source);
+    if (partners == pairs_.end()) return nullptr;
+    auto it = partners->second.find(target);
+    return it != partners->second.end() ? &it->second : nullptr;
+}
+
+const std::unordered_map<SymbolID, TraitPairMoments>* TraitAggregates::Partners(SymbolID source) const {
+    auto it = pairs_.find(source);
+    return it != pairs_.end() ? &it->second : nullptr;
+}
+
+double TraitAggregates::EmotionalCorrelation(SymbolID trait) const {
+    auto it = emotions_.find(trait);
+    return it != emotions_.end() && it->second.count ? it->second.sum / it->second.count : 0.0;
+}
+
+} // namespace cognitive
+} // namespace shandris
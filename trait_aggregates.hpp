@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "memory_pool.hpp"
+#include "symbol_table.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+struct MemoryEvent;
+
+// Running sums of one trait's influence over the memories carrying it
+struct TraitMoments {
+    uint64_t count = 0;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+
+    double Mean() const { return count ? sum / count : 0.0; }
+    double Variance() const;
+};
+
+// Running sums over the memories carrying both traits of a pair, seen
+// from the source trait
+struct TraitPairMoments {
+    uint64_t count = 0;
+    double source_sum = 0.0;
+    double target_sum = 0.0;
+    double source_squares = 0.0;
+    double target_squares = 0.0;
+    double products = 0.0;
+
+    // Mean influence of the target trait where both are present
+    double TargetMean() const { return count ? target_sum / count : 0.0; }
+    // Pearson correlation of the two influences; 0 when undefined
+    double Correlation() const;
+};
+
+// Sufficient statistics for baselines and trait interactions, kept in step
+// with the working set. Each memory's last indexed contribution is kept, so
+// an upsert subtracts exactly what it added before, whatever happened to the
+// memory in between. Reads are O(1) per trait or pair.
+class TraitAggregates {
+public:
+    void Upsert(const MemoryEvent& memory);
+    void Remove(const std::string& id);
+    void Clear();
+    void Rebuild(const MemoryMap& memories);
+
+    size_t Size() const { return indexed_.size(); }
+
+    // Null when no memory carries the trait
+    const TraitMoments* Influence(SymbolID trait) const;
+    const TraitPairMoments* Pair(SymbolID source, SymbolID target) const;
+
+    // Every trait co-occurring with source, keyed by target
+    const std::unordered_map<SymbolID, TraitPairMoments>* Partners(SymbolID source) const;
+
+    // Mean positive emotional weight of the memories carrying the trait
+    double EmotionalCorrelation(SymbolID trait) const;
+
+private:
+    struct Contribution {
+        std::vector<std::pair<SymbolID, double>> influences;
+        double emotional_weight = 0.0;
+    };
+
+    struct EmotionalMoments {
+        uint64_t count = 0;
+        double sum = 0.0;
+    };
+
+    static Contribution Extract(const MemoryEvent& memory);
+    void Apply(const Contribution& contribution, int sign);
+
+    std::unordered_map<std::string, Contribution> indexed_;
+    std::unordered_map<SymbolID, TraitMoments> traits_;
+    std::unordered_map<SymbolID, EmotionalMoments> emotions_;
+    std::unordered_map<SymbolID, std::unordered_map<SymbolID, TraitPairMoments>> pairs_;
+};
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,170 @@
+#include "trait_correlation.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace shandris {
+namespace cognitive {
+
+void TraitCoMoments::Add(double x, double y, double decay) {
+    weight *= decay;
+    m2_x *= decay;
+    m2_y *= decay;
+    co_moment *= decay;
+
+    ++observations;
+    weight += 1.0;
+    const double dx = x - mean_x;
+    const double dy = y - mean_y;
+    mean_x += dx / weight;
+    mean_y += dy / weight;
+    m2_x += dx * (x - mean_x);
+    m2_y += dy * (y - mean_y);
+    co_moment += dx * (y - mean_y);
+}
+
+double TraitCoMoments::Correlation() const {
+    if (observations < 2) return 0.0;
+    const double denominator = std::sqrt(std::max(m2_x, 0.0) * std::max(m2_y, 0.0));
+    return denominator > 0.0 ? co_moment / denominator : 0.0;
+}
+
+TraitCorrelationMatrix::TraitCorrelationMatrix(double forgetting, Clock::duration alignment)
+    : forgetting_(NO_FORGETTING), alignment_(alignment) {
+    SetForgetting(forgetting);
+    SetAlignment(alignment);
+}
+
+void TraitCorrelationMatrix::SetForgetting(double forgetting) {
+    forgetting_ = std::clamp(forgetting, 0.0, NO_FORGETTING);
+}
+
+void TraitCorrelationMatrix::SetAlignment(Clock::duration alignment) {
+    Flush();
+    alignment_ = std::max(alignment, Clock::duration(1));
+}
+
+uint64_t TraitCorrelationMatrix::PairKey(SymbolID a, SymbolID b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+void TraitCorrelationMatrix::Record(SymbolID trait, double value, Clock::time_point at) {
+    const int64_t bucket = at.time_since_epoch() / alignment_;
+    if (!pending_.empty() && bucket != pending_bucket_) {
+        Flush();
+    }
+    pending_bucket_ = bucket;
+
+    for (auto& [pendingTrait, pendingValue] : pending_) {
+        if (pendingTrait == trait) {
+            pendingValue = value;
+            return;
+        }
+    }
+    pending_.emplace_back(trait, value);
+}
+
+void TraitCorrelationMatrix::Flush() {
+    if (pending_.empty()) return;
+    Sample sample;
+    sample.swap(pending_);
+    Observe(sample);
+}
+
+void TraitCorrelationMatrix::Observe(const Sample& sample) {
+    // Last value per trait, in trait order so each pair has one orientation
+    Sample values(sample.rbegin(), sample.rend());
+    std::stable_sort(values.begin(), values.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    values.erase(std::unique(values.begin(), values.end(),
+                             [](const auto& a, const auto& b) { return a.first == b.first; }),
+                 values.end());
+    if (values.empty()) return;
+
+    ++tick_;
+    for (size_t i = 0; i < values.size(); ++i) {
+        for (size_t j = i + 1; j < values.size(); ++j) {
+            auto [it, inserted] = pairs_.try_emplace(PairKey(values[i].first, values[j].first));
+            TraitCoMoments& moments = it->second;
+            if (inserted) {
+                partners_[values[i].first].push_back(values[j].first);
+                partners_[values[j].first].push_back(values[i].first);
+            }
+            const double decay = (forgetting_ < NO_FORGETTING && moments.observations)
+                ? std::pow(forgetting_, static_cast<double>(tick_ - moments.last_tick))
+                : 1.0;
+            moments.Add(values[i].second, values[j].second, decay);
+            moments.last_tick = tick_;
+        }
+    }
+}
+
+void TraitCorrelationMatrix::Declare(SymbolID source, SymbolID target, double correlation) {
+    auto& links = declared_[source];
+    for (auto& [linked, value] : links) {
+        if (linked == target) {
+            value = correlation;
+            return;
+        }
+    }
+    links.emplace_back(target, correlation);
+    ++declared_count_;
+}
+
+void TraitCorrelationMatrix::ClearDeclared() {
+    declared_.clear();
+    declared_count_ = 0;
+}
+
+void TraitCorrelationMatrix::Clear() {
+    pending_.clear();
+    pairs_.clear();
+    partners_.clear();
+    tick_ = 0;
+    ClearDeclared();
+}
+
+const TraitCoMoments* TraitCorrelationMatrix::Moments(SymbolID a, SymbolID b) const {
+    auto it = pairs_.find(PairKey(a, b));
+    return it != pairs_.end() ? &it->second : nullptr;
+}
+
+double TraitCorrelationMatrix::LearnedCorrelation(SymbolID a, SymbolID b) const {
+    if (a == b) return 1.0;
+    const TraitCoMoments* moments = Moments(a, b);
+    return moments ? moments->Correlation() : 0.0;
+}
+
+double TraitCorrelationMatrix::Correlation(SymbolID source, SymbolID target) const {
+    if (const auto* links = Declared(source)) {
+        for (const auto& [linked, value] : *links) {
+            if (linked == target) return value;
+        }
+    }
+    return LearnedCorrelation(source, target);
+}
+
+const std::vector<SymbolID>* TraitCorrelationMatrix::Partners(SymbolID trait) const {
+    auto it = partners_.find(trait);
+    return it != partners_.end() ? &it->second : nullptr;
+}
+
+const std::vector<std::pair<SymbolID, double>>* TraitCorrelationMatrix::Declared(SymbolID source) const {
+    auto it = declared_.find(source);
+    return it != declared_.end() ? &it->second : nullptr;
+}
+
+void TraitCorrelationMatrix::FillDense(const std::vector<SymbolID>& traits, Tensor2& out) const {
+    const size_t n = traits.size();
+    out.Resize(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        out(i, i) = 1.0;
+        for (size_t j = i + 1; j < n; ++j) {
+            out(i, j) = Correlation(traits[i], traits[j]);
+            out(j, i) = Correlation(traits[j], traits[i]);
+        }
+    }
+}
+
+} // namespace cognitive
+} // namespace shandris
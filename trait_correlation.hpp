@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "symbol_table.hpp"
+#include "tensor.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+// Weighted co-moments of two traits over the observations carrying both
+struct TraitCoMoments {
+    uint64_t observations = 0;
+    uint64_t last_tick = 0;
+    double weight = 0.0;
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    double m2_x = 0.0;
+    double m2_y = 0.0;
+    double co_moment = 0.0;
+
+    // decay scales the earlier observations before this one is added
+    void Add(double x, double y, double decay);
+    // Pearson correlation; 0 when undefined
+    double Correlation() const;
+};
+
+// Pairwise trait correlations kept up to date as samples arrive. Samples
+// recorded within the same alignment bucket form one observation, and every
+// pair present in an observation updates its co-moments, so reads never
+// rescan history. A forgetting factor below 1 down-weights each pair's
+// older observations by that factor per observation since. Declared
+// correlations (persona templates, explicit links) are directional and take
+// precedence over learned ones.
+class TraitCorrelationMatrix {
+public:
+    using Clock = std::chrono::system_clock;
+    using Sample = std::vector<std::pair<SymbolID, double>>;
+
+    static constexpr double NO_FORGETTING = 1.0;
+
+    explicit TraitCorrelationMatrix(double forgetting = NO_FORGETTING,
+                                    Clock::duration alignment = std::chrono::seconds(1));
+
+    void SetForgetting(double forgetting);
+    void SetAlignment(Clock::duration alignment);
+
+    // Buffers the sample; a later bucket closes the open observation
+    void Record(SymbolID trait, double value, Clock::time_point at);
+    // Closes the open observation, if any
+    void Flush();
+    // One aligned observation; a trait listed twice keeps its last value
+    void Observe(const Sample& sample);
+
+    void Declare(SymbolID source, SymbolID target, double correlation);
+    void ClearDeclared();
+    void Clear();
+
+    double LearnedCorrelation(SymbolID a, SymbolID b) const;
+    // Declared value when there is one, learned otherwise
+    double Correlation(SymbolID source, SymbolID target) const;
+    const TraitCoMoments* Moments(SymbolID a, SymbolID b) const;
+
+    // Traits co-observed with trait; null when there are none
+    const std::vector<SymbolID>* Partners(SymbolID trait) const;
+    // Declared links out of source; null when there are none
+    const std::vector<std::pair<SymbolID, double>>* Declared(SymbolID source) const;
+
+    size_t DeclaredCount() const { return declared_count_; }
+    uint64_t Observations() const { return tick_; }
+
+    // Row-major correlations for traits, unit diagonal, into out
+    void FillDense(const std::vector<SymbolID>& traits, Tensor2& out) const;
+
+private:
+    static uint64_t PairKey(SymbolID a, SymbolID b);
+
+    double forgetting_;
+    Clock::duration alignment_;
+    uint64_t tick_ = 0;
+
+    Sample pending_;
+    int64_t pending_bucket_ = 0;
+
+    std::unordered_map<uint64_t, TraitCoMoments> pairs_;
+    std::unordered_map<SymbolID, std::vector<SymbolID>> partners_;
+    std::unordered_map<SymbolID, std::vector<std::pair<SymbolID, double>>> declared_;
+    size_t declared_count_ = 0;
+};
+
+} // namespace cognitive
+} // namespace shandris
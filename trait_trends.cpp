@@ -0,0 +1,166 @@
+#include "trait_trends.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace shandris {
+namespace cognitive {
+
+TraitTrendStream::TraitTrendStream(size_t retention)
+    : retention_(std::max<size_t>(retention, 1)) {
+}
+
+double TraitTrendStream::SecondDifference(size_t i) const {
+    return std::abs(samples_[i] - 2 * samples_[i - 1] + samples_[i - 2]);
+}
+
+void TraitTrendStream::Add(double value) {
+    samples_.push_back(value);
+    const size_t n = samples_.size();
+
+    // Each sum covers the newest min(n, window) samples
+    short_sum_ += value;
+    long_sum_ += value;
+    seasonal_sum_ += value;
+    tail_sum_ += value;
+    if (n <= EDGE_WINDOW) head_sum_ += value;
+    if (n > SHORT_WINDOW) short_sum_ -= samples_[n - 1 - SHORT_WINDOW];
+    if (n > LONG_WINDOW) long_sum_ -= samples_[n - 1 - LONG_WINDOW];
+    if (n > SEASONAL_WINDOW) seasonal_sum_ -= samples_[n - 1 - SEASONAL_WINDOW];
+    if (n > EDGE_WINDOW) tail_sum_ -= samples_[n - 1 - EDGE_WINDOW];
+
+    if (n >= SHORT_WINDOW) {
+        short_averages_.push_back(short_sum_ / SHORT_WINDOW);
+    }
+    if (n >= LONG_WINDOW) {
+        previous_long_average_ = long_average_;
+        long_average_ = long_sum_ / LONG_WINDOW;
+    }
+    if (n >= SEASONAL_WINDOW) {
+        const double average = seasonal_sum_ / SEASONAL_WINDOW;
+        if (!seasonal_averages_.empty()) {
+            seasonal_change_sum_ += std::abs(average - seasonal_averages_.back());
+        }
+        seasonal_averages_.push_back(average);
+    }
+    if (n >= 3) {
+        second_difference_sum_ += SecondDifference(n - 1);
+    }
+
+    const double delta = value - mean_;
+    mean_ += delta / n;
+    squared_deviations_ += delta * (value - mean_);
+
+    while (samples_.size() > retention_) {
+        EvictOldest();
+    }
+}
+
+void TraitTrendStream::EvictOldest() {
+    const size_t n = samples_.size();
+    const double value = samples_.front();
+
+    // The oldest sample starts the first window of each series
+    if (n >= 3) second_difference_sum_ -= SecondDifference(2);
+    if (n >= SHORT_WINDOW) short_averages_.pop_front();
+    if (n >= SEASONAL_WINDOW) {
+        if (seasonal_averages_.size() >= 2) {
+            seasonal_change_sum_ -= std::abs(seasonal_averages_[1] - seasonal_averages_[0]);
+        }
+        seasonal_averages_.pop_front();
+    }
+    // Only a window wider than the history still holds the evicted sample
+    if (n <= SHORT_WINDOW) short_sum_ -= value;
+    if (n <= LONG_WINDOW) long_sum_ -= value;
+    if (n <= SEASONAL_WINDOW) seasonal_sum_ -= value;
+    if (n <= EDGE_WINDOW) tail_sum_ -= value;
+    // The oldest window slides up by one
+    head_sum_ -= value;
+    if (n > EDGE_WINDOW) head_sum_ += samples_[EDGE_WINDOW];
+
+    if (n == 1) {
+        mean_ = 0.0;
+        squared_deviations_ = 0.0;
+    } else {
+        const double delta = value - mean_;
+        mean_ -= delta / (n - 1);
+        squared_deviations_ -= delta * (value - mean_);
+    }
+    samples_.pop_front();
+
+    if (++evictions_since_resync_ >= retention_) {
+        Resync();
+    }
+}
+
+void TraitTrendStream::Resync() {
+    // One replay per retention_ evictions keeps Add amortized O(1)
+    const std::deque<double> values = samples_;
+    Reset(values);
+}
+
+void TraitTrendStream::Reset(const std::deque<double>& values) {
+    samples_.clear();
+    short_averages_.clear();
+    seasonal_averages_.clear();
+    short_sum_ = long_sum_ = seasonal_sum_ = 0.0;
+    head_sum_ = tail_sum_ = 0.0;
+    long_average_ = previous_long_average_ = 0.0;
+    mean_ = squared_deviations_ = 0.0;
+    seasonal_change_sum_ = second_difference_sum_ = 0.0;
+    evictions_since_resync_ = 0;
+
+    const size_t first = values.size() > retention_ ? values.size() - retention_ : 0;
+    for (size_t i = first; i < values.size(); ++i) {
+        Add(values[i]);
+    }
+}
+
+void TraitTrendStream::SetRetention(size_t retention) {
+    retention_ = std::max<size_t>(retention, 1);
+    while (samples_.size() > retention_) {
+        EvictOldest();
+    }
+}
+
+double TraitTrendStream::Volatility() const {
+    if (samples_.empty()) return 0.0;
+    // Clamped: removals can leave a tiny negative residue
+    return std::sqrt(std::max(squared_deviations_, 0.0) / samples_.size());
+}
+
+double TraitTrendStream::EdgeTrend() const {
+    if (samples_.size() < EDGE_WINDOW) return 0.0;
+    return (tail_sum_ - head_sum_) / EDGE_WINDOW;
+}
+
+void TraitTrendStream::Fill(TraitTrendAnalysis& analysis) const {
+    const size_t n = samples_.size();
+    const size_t shortCount = short_averages_.size();
+
+    if (shortCount >= 2) {
+        analysis.short_term_slope =
+            (short_averages_[shortCount - 1] - short_averages_[shortCount - 2]) / SHORT_WINDOW;
+    }
+    if (n >= LONG_WINDOW + 1) {
+        analysis.long_term_slope = (long_average_ - previous_long_average_) / LONG_WINDOW;
+    }
+    if (shortCount >= 3) {
+        analysis.acceleration = (short_averages_[shortCount - 1] - 2 * short_averages_[shortCount - 2] +
+                                 short_averages_[shortCount - 3]) / (SHORT_WINDOW * SHORT_WINDOW);
+    }
+
+    analysis.volatility = Volatility();
+
+    if (seasonal_averages_.size() >= 2) {
+        analysis.seasonality = seasonal_change_sum_ / (seasonal_averages_.size() - 1);
+    }
+    if (n >= 4) {
+        analysis.cyclicality = second_difference_sum_ / (n - 2);
+    }
+
+    analysis.moving_averages.assign(short_averages_.begin(), short_averages_.end());
+    analysis.seasonal_components.assign(seasonal_averages_.begin(), seasonal_averages_.end());
+}
+
+} // namespace cognitive
+} // namespace shandris
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "memory_types.hpp"
+
+namespace shandris {
+namespace cognitive {
+
+// Trend statistics over a trait's most recent samples, kept up to date as
+// samples arrive. Every figure describes exactly the retained window, so
+// Fill produces what a full recomputation over that history would: rolling
+// sums give the moving averages, slopes and edge trend, a sliding Welford pair gives
+// the volatility, and the seasonality and cyclicality sums add the newest
+// term and drop the evicted one. Adding a sample is O(1).
+class TraitTrendStream {
+public:
+    static constexpr size_t SHORT_WINDOW = 5;
+    static constexpr size_t LONG_WINDOW = 20;
+    static constexpr size_t SEASONAL_WINDOW = 24;  // assuming daily seasonality
+    static constexpr size_t EDGE_WINDOW = 10;
+    static constexpr size_t DEFAULT_RETENTION = 100;
+
+    explicit TraitTrendStream(size_t retention = DEFAULT_RETENTION);
+
+    void Add(double value);
+    // Replays a stored history, keeping the newest samples that fit
+    void Reset(const std::deque<double>& values);
+    // Shrinking drops the oldest samples now; growing keeps more from here on
+    void SetRetention(size_t retention);
+
+    size_t Retention() const { return retention_; }
+    size_t Size() const { return samples_.size(); }
+
+    double Mean() const { return mean_; }
+    // Population standard deviation of the retained samples
+    double Volatility() const;
+    // Mean of the newest EDGE_WINDOW samples minus that of the oldest
+    // EDGE_WINDOW; 0 until that many are retained
+    double EdgeTrend() const;
+
+    // Writes slopes, acceleration, volatility, seasonality, cyclicality and
+    // both series; statistics without enough samples keep their old values
+    void Fill(TraitTrendAnalysis& analysis) const;
+
+private:
+    void EvictOldest();
+    // Recomputes every running sum from the window, bounding rounding drift
+    void Resync();
+    double SecondDifference(size_t i) const;
+
+    size_t retention_;
+    std::deque<double> samples_;
+    std::deque<double> short_averages_;
+    std::deque<double> seasonal_averages_;
+
+    double short_sum_ = 0.0;
+    double long_sum_ = 0.0;
+    double seasonal_sum_ = 0.0;
+    double head_sum_ = 0.0;    // oldest EDGE_WINDOW samples
+    double tail_sum_ = 0.0;    // newest EDGE_WINDOW samples
+    double long_average_ = 0.0;
+    double previous_long_average_ = 0.0;
+
+    double mean_ = 0.0;
+    double squared_deviations_ = 0.0;
+
+    double seasonal_change_sum_ = 0.0;
+    double second_difference_sum_ = 0.0;
+
+    size_t evictions_since_resync_ = 0;
+};
+
+} // namespace cognitive
+} // namespace shandris
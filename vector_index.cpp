@@ -0,0 +1,306 @@
+#include "vector_index.hpp"
+#include "tensor_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace shandris {
+
+namespace {
+
+struct ByAscendingSimilarity {
+    template<typename T>
+    bool operator()(const T& a, const T& b) const { return a.similarity > b.similarity; }
+};
+
+struct ByDescendingSimilarity {
+    template<typename T>
+    bool operator()(const T& a, const T& b) const { return a.similarity < b.similarity; }
+};
+
+// Per-thread visited marks; a new epoch per search avoids clearing
+struct VisitedSet {
+    std::vector<uint32_t> marks;
+    uint32_t epoch = 0;
+
+    void Reset(size_t size) {
+        if (marks.size() < size) marks.resize(size, 0);
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    }
+    bool Visit(size_t node) {
+        if (marks[node] == epoch) return false;
+        marks[node] = epoch;
+        return true;
+    }
+};
+
+VisitedSet& ThreadVisitedSet() {
+    thread_local VisitedSet visited;
+    return visited;
+}
+
+} // namespace
+
+size_t VectorIndex::Add(const std::vector<double>& vector) {
+    if (count_ == 0 && dimension_ == 0) {
+        dimension_ = vector.size();
+    }
+    if (vector.size() != dimension_) {
+        throw std::invalid_argument("VectorIndex::Add: dimension mismatch");
+    }
+
+    size_t id = count_++;
+    rows_.resize(count_ * dimension_);
+    Normalize(vector.data(), rows_.data() + id * dimension_, dimension_);
+    OnAdd(id);
+    return id;
+}
+
+void VectorIndex::Clear() {
+    dimension_ = 0;
+    count_ = 0;
+    rows_.clear();
+    OnClear();
+}
+
+double VectorIndex::Similarity(const double* a, const double* b) const {
+    return Kernels().Dot(a, b, dimension_);
+}
+
+const double* VectorIndex::NormalizeQuery(const std::vector<double>& query) const {
+    if (count_ == 0) return nullptr;
+    if (query.size() != dimension_) {
+        throw std::invalid_argument("VectorIndex::Search: dimension mismatch");
+    }
+    thread_local TensorStorage normalized;
+    normalized.resize(dimension_);
+    Normalize(query.data(), normalized.data(), dimension_);
+    return normalized.data();
+}
+
+void VectorIndex::Normalize(const double* in, double* out, size_t n) {
+    double norm = std::sqrt(Kernels().SumSquares(in, n));
+    // Zero vectors stay zero and score 0 against everything
+    double scale = norm > 0.0 ? 1.0 / norm : 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i] * scale;
+    }
+}
+
+void FlatVectorIndex::Search(const std::vector<double>& query, size_t k,
+                             std::vector<VectorSearchResult>& results) const {
+    results.clear();
+    const double* normalized = NormalizeQuery(query);
+    if (!normalized || k == 0) return;
+
+    // Min-heap of the best k seen so far
+    results.reserve(std::min(k, Size()) + 1);
+    for (size_t id = 0; id < Size(); ++id) {
+        double similarity = Similarity(normalized, Row(id));
+        if (results.size() < k) {
+            results.push_back({id, similarity});
+            std::push_heap(results.begin(), results.end(), ByAscendingSimilarity{});
+        } else if (similarity > results.front().similarity) {
+            std::pop_heap(results.begin(), results.end(), ByAscendingSimilarity{});
+            results.back() = {id, similarity};
+            std::push_heap(results.begin(), results.end(), ByAscendingSimilarity{});
+        }
+    }
+    std::sort_heap(results.begin(), results.end(), ByAscendingSimilarity{});
+}
+
+HnswVectorIndex::HnswVectorIndex(const HnswParams& params)
+    : params_(params), rng_(params.seed) {
+    params_.max_connections = std::max<size_t>(params_.max_connections, 2);
+    level_scale_ = 1.0 / std::log(static_cast<double>(params_.max_connections));
+}
+
+size_t HnswVectorIndex::RandomLevel() {
+    std::uniform_real_distribution<double> uniform(std::numeric_limits<double>::min(), 1.0);
+    return static_cast<size_t>(-std::log(uniform(rng_)) * level_scale_);
+}
+
+void HnswVectorIndex::OnClear() {
+    links_.clear();
+    entry_point_ = 0;
+    max_level_ = 0;
+}
+
+void HnswVectorIndex::OnAdd(size_t id) {
+    const NodeID node = static_cast<NodeID>(id);
+    const size_t level = RandomLevel();
+    links_.emplace_back(level + 1);
+
+    if (node == 0) {
+        entry_point_ = node;
+        max_level_ = level;
+        return;
+    }
+
+    const double* vector = Row(node);
+    NodeID entry = entry_point_;
+    if (max_level_ > level) {
+        entry = GreedyClosest(vector, entry, max_level_, level + 1);
+    }
+
+    std::vector<Candidate> found;
+    for (size_t l = std::min(level, max_level_) + 1; l-- > 0;) {
+        SearchLayer(vector, entry, params_.ef_construction, l, found);
+        entry = found.front().node;
+
+        SelectNeighbors(found, MaxLinks(l));
+        for (const auto& neighbor : found) {
+            links_[node][l].push_back(neighbor.node);
+            Link(neighbor.node, node, l);
+        }
+    }
+
+    if (level > max_level_) {
+        max_level_ = level;
+        entry_point_ = node;
+    }
+}
+
+void HnswVectorIndex::Search(const std::vector<double>& query, size_t k,
+                             std::vector<VectorSearchResult>& results) const {
+    results.clear();
+    const double* normalized = NormalizeQuery(query);
+    if (!normalized || k == 0) return;
+
+    NodeID entry = GreedyClosest(normalized, entry_point_, max_level_, 1);
+
+    std::vector<Candidate> found;
+    SearchLayer(normalized, entry, std::max(params_.ef_search, k), 0, found);
+
+    size_t count = std::min(k, found.size());
+    results.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back({found[i].node, found[i].similarity});
+    }
+}
+
+HnswVectorIndex::NodeID HnswVectorIndex::GreedyClosest(const double* query, NodeID entry,
+                                                       size_t fromLevel, size_t toLevel) const {
+    double best = Similarity(query, Row(entry));
+    for (size_t l = fromLevel + 1; l-- > toLevel;) {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (NodeID neighbor : links_[entry][l]) {
+                double similarity = Similarity(query, Row(neighbor));
+                if (similarity > best) {
+                    best = similarity;
+                    entry = neighbor;
+                    improved = true;
+                }
+            }
+        }
+    }
+    return entry;
+}
+
+void HnswVectorIndex::SearchLayer(const double* query, NodeID entry, size_t ef, size_t level,
+                                  std::vector<Candidate>& found) const {
+    auto& visited = ThreadVisitedSet();
+    visited.Reset(links_.size());
+
+    // Frontier ordered best-first; results kept as a min-heap of size ef
+    std::priority_queue<Candidate, std::vector<Candidate>, ByDescendingSimilarity> frontier;
+    found.clear();
+
+    Candidate start{Similarity(query, Row(entry)), entry};
+    visited.Visit(entry);
+    frontier.push(start);
+    found.push_back(start);
+
+    while (!frontier.empty()) {
+        Candidate current = frontier.top();
+        if (found.size() >= ef && current.similarity < found.front().similarity) break;
+        frontier.pop();
+
+        for (NodeID neighbor : links_[current.node][level]) {
+            if (!visited.Visit(neighbor)) continue;
+
+            double similarity = Similarity(query, Row(neighbor));
+            if (found.size() < ef || similarity > found.front().similarity) {
+                frontier.push({similarity, neighbor});
+                found.push_back({similarity, neighbor});
+                std::push_heap(found.begin(), found.end(), ByAscendingSimilarity{});
+                if (found.size() > ef) {
+                    std::pop_heap(found.begin(), found.end(), ByAscendingSimilarity{});
+                    found.pop_back();
+                }
+            }
+        }
+    }
+
+    // Best first
+    std::sort_heap(found.begin(), found.end(), ByAscendingSimilarity{});
+}
+
+void HnswVectorIndex::SelectNeighbors(std::vector<Candidate>& candidates, size_t maxLinks) const {
+    // Candidates arrive best first. Prefer ones not already covered by a
+    // closer selected neighbour, which keeps the graph navigable across
+    // clusters, then fill up with the closest leftovers.
+    if (candidates.size() <= maxLinks) return;
+
+    std::vector<Candidate> selected;
+    std::vector<Candidate> skipped;
+    selected.reserve(maxLinks);
+    for (const auto& candidate : candidates) {
+        if (selected.size() >= maxLinks) break;
+        bool covered = false;
+        for (const auto& chosen : selected) {
+            if (Similarity(Row(candidate.node), Row(chosen.node)) > candidate.similarity) {
+                covered = true;
+                break;
+            }
+        }
+        (covered ? skipped : selected).push_back(candidate);
+    }
+    for (size_t i = 0; i < skipped.size() && selected.size() < maxLinks; ++i) {
+        selected.push_back(skipped[i]);
+    }
+    candidates.swap(selected);
+}
+
+void HnswVectorIndex::Link(NodeID from, NodeID to, size_t level) {
+    auto& neighbors = links_[from][level];
+    neighbors.push_back(to);
+
+    const size_t maxLinks = MaxLinks(level);
+    if (neighbors.size() <= maxLinks) return;
+
+    // Over capacity: re-select from the current neighbours of from
+    std::vector<Candidate> candidates;
+    candidates.reserve(neighbors.size());
+    const double* origin = Row(from);
+    for (NodeID neighbor : neighbors) {
+        candidates.push_back({Similarity(origin, Row(neighbor)), neighbor});
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.similarity > b.similarity; });
+    SelectNeighbors(candidates, maxLinks);
+
+    neighbors.clear();
+    for (const auto& candidate : candidates) {
+        neighbors.push_back(candidate.node);
+    }
+}
+
+std::unique_ptr<VectorIndex> CreateVectorIndex(VectorIndexType type, const HnswParams& params) {
+    switch (type) {
+        case VectorIndexType::HNSW:
+            return std::make_unique<HnswVectorIndex>(params);
+        case VectorIndexType::Flat:
+        default:
+            return std::make_unique<FlatVectorIndex>();
+    }
+}
+
+} // namespace shandris
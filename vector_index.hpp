@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include "tensor.hpp"
+
+namespace shandris {
+
+enum class VectorIndexType {
+    Flat,
+    HNSW
+};
+
+struct VectorSearchResult {
+    size_t id;
+    double similarity;
+};
+
+struct HnswParams {
+    size_t max_connections = 16;   // links per node above layer 0, twice that on layer 0
+    size_t ef_construction = 100;  // candidate list size while inserting
+    size_t ef_search = 64;         // candidate list size while searching; raise for recall
+    uint32_t seed = 42;
+};
+
+// Cosine-similarity index over fixed-dimension vectors. IDs are dense and
+// assigned in insertion order, so callers can map them back to their own
+// append-only storage.
+class VectorIndex {
+public:
+    virtual ~VectorIndex() = default;
+
+    // The first vector fixes the dimension; later ones must match
+    size_t Add(const std::vector<double>& vector);
+    void Clear();
+
+    size_t Size() const { return count_; }
+    size_t Dimension() const { return dimension_; }
+
+    // Up to k results ordered by descending similarity
+    virtual void Search(const std::vector<double>& query, size_t k,
+                        std::vector<VectorSearchResult>& results) const = 0;
+
+protected:
+    // Called after the normalized vector for id is stored
+    virtual void OnAdd(size_t id) = 0;
+    virtual void OnClear() = 0;
+
+    const double* Row(size_t id) const { return rows_.data() + id * dimension_; }
+    double Similarity(const double* a, const double* b) const;
+
+    // Unit-length copy of query, or an empty buffer when the index is empty
+    const double* NormalizeQuery(const std::vector<double>& query) const;
+
+private:
+    static void Normalize(const double* in, double* out, size_t n);
+
+    size_t dimension_ = 0;
+    size_t count_ = 0;
+    TensorStorage rows_;  // unit-length rows, contiguous
+};
+
+// Exact scan with a bounded heap for the top k
+class FlatVectorIndex : public VectorIndex {
+public:
+    void Search(const std::vector<double>& query, size_t k,
+                std::vector<VectorSearchResult>& results) const override;
+
+protected:
+    void OnAdd(size_t) override {}
+    void OnClear() override {}
+};
+
+// Hierarchical navigable small-world graph. Approximate; recall is tuned
+// with HnswParams::ef_search or SetEfSearch.
+class HnswVectorIndex : public VectorIndex {
+public:
+    explicit HnswVectorIndex(const HnswParams& params = {});
+
+    void SetEfSearch(size_t efSearch) { params_.ef_search = efSearch; }
+    const HnswParams& Params() const { return params_; }
+
+    void Search(const std::vector<double>& query, size_t k,
+                std::vector<VectorSearchResult>& results) const override;
+
+protected:
+    void OnAdd(size_t id) override;
+    void OnClear() override;
+
+private:
+    using NodeID = uint32_t;
+
+    struct Candidate {
+        double similarity;
+        NodeID node;
+    };
+
+    size_t MaxLinks(size_t level) const {
+        return level == 0 ? params_.max_connections * 2 : params_.max_connections;
+    }
+    size_t RandomLevel();
+
+    NodeID GreedyClosest(const double* query, NodeID entry, size_t fromLevel, size_t toLevel) const;
+    void SearchLayer(const double* query, NodeID entry, size_t ef, size_t level,
+                     std::vector<Candidate>& found) const;
+    void SelectNeighbors(std::vector<Candidate>& candidates, size_t maxLinks) const;
+    void Link(NodeID from, NodeID to, size_t level);
+
+    HnswParams params_;
+    double level_scale_;
+    std::mt19937 rng_;
+
+    // links_[node][level] holds the neighbours of node on that level
+    std::vector<std::vector<std::vector<NodeID>>> links_;
+    NodeID entry_point_ = 0;
+    size_t max_level_ = 0;
+};
+
+std::unique_ptr<VectorIndex> CreateVectorIndex(VectorIndexType type, const HnswParams& params = {});
+
+} // namespace shandris